@@ -15,7 +15,7 @@
 
 #include "ArduinoCellular.h"
 
-ArduinoCellular cellular = ArduinoCellular();
+ArduinoCellular cellular;
 
 void printMessages(std::vector<SMS> msg){
      for(int i = 0; i < msg.size(); i++){
@@ -49,10 +49,20 @@ void loop(){
     }
 
     // Prompt user which SMS to delete
-    Serial.println("Enter the index of the SMS you want to delete:");
+    Serial.println("Enter the index of the SMS you want to delete, 'r' to delete all read SMS or 'a' to delete all SMS:");
     
     while(Serial.available() == 0);
-    auto index = Serial.readStringUntil('\n').toInt();
+    String input = Serial.readStringUntil('\n');
+    input.trim();
+
+    if(input == "r" || input == "a"){
+        Serial.println("Deleting SMS...");
+        int deleted = cellular.deleteSMS(input == "r" ? SMS_DELETE_READ : SMS_DELETE_ALL);
+        Serial.print(deleted); Serial.println(" SMS deleted.");
+        return;
+    }
+
+    auto index = input.toInt();
     Serial.println("Deleting SMS...");
 
     if(cellular.deleteSMS(index)){
@@ -12,7 +12,7 @@
 
 #include "ArduinoCellular.h"
 
-ArduinoCellular cellular = ArduinoCellular();
+ArduinoCellular cellular;
 
 void setup(){
     Serial.begin(115200);
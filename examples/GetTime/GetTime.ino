@@ -13,7 +13,7 @@
 
 #include "ArduinoCellular.h"
 
-ArduinoCellular cellular = ArduinoCellular();
+ArduinoCellular cellular;
 
 void setup(){
     Serial.begin(115200);
@@ -22,24 +22,29 @@ const char server[]   = "vsh.pp.ua";
 const char resource[] = "/TinyGSM/logo.txt";
 const int  port       = 80;
 
-ArduinoCellular cellular = ArduinoCellular();
-HttpClient client = cellular.getHTTPClient(server, port);
+ArduinoCellular cellular;
 
 void getResource(){
 
+  // The client is taken from a pool and returned when it goes out of scope.
+  // The connection stays open, so the next request to the same server skips opening the socket.
+  PooledHTTPClient client = cellular.acquireHTTPClient(server, port);
+  if(!client.isValid()){
+    Serial.println("No HTTP client available.");
+    return;
+  }
+
   Serial.println("Making GET request...");
 
-  client.get(resource);
+  client->get(resource);
 
-  int statusCode = client.responseStatusCode();
-  String response = client.responseBody();
+  int statusCode = client->responseStatusCode();
+  String response = client->responseBody();
 
   Serial.print("Status code: ");
   Serial.println(statusCode);
   Serial.print("Response: ");
   Serial.println(response);
-
-  client.stop();
 }
 
 void setup(){
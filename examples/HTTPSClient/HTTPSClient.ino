@@ -22,7 +22,7 @@ const char server[]   = "example.com";
 const char resource[] = "/";
 const int  port       = 443;
 
-ArduinoCellular cellular = ArduinoCellular();
+ArduinoCellular cellular;
 HttpClient client = cellular.getHTTPSClient(server, port);
 
 void getResource(){
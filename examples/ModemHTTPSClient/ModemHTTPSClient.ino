@@ -0,0 +1,98 @@
+/**
+ * Example demonstrating how to make HTTPS requests with the HTTP and TLS stacks of the modem
+ * instead of BearSSL on the board. The response body is streamed to the serial monitor
+ * while it arrives, so it never has to fit into memory.
+ *
+ * Instructions:
+ * 1. Insert a SIM card with or without PIN code in the Arduino Pro 4G Module.
+ * 2. Provide sufficient power to the Arduino Pro 4G Module. Ideally, use a 5V power supply
+ *   with a current rating of at least 2A and connect it to the VIN and GND pins.
+ * 3. Specify the APN, login, and password for your cellular network provider.
+ * 4. Upload the CA certificate of the server to the modem file system, e.g. as UFS:cacert.pem with AT+QFUPL.
+ * 5. Upload the sketch to the connected Arduino board.
+ * 6. Open the serial monitor to view the output.
+ *
+ * Initial author: Arduino
+*/
+
+#include <Arduino.h>
+#include "ArduinoCellular.h"
+#include "arduino_secrets.h"
+
+const char server[]   = "example.com";
+const char resource[] = "/";
+const int  port       = 443;
+const char caCertificate[] = "UFS:cacert.pem";
+
+ArduinoCellular cellular;
+
+void getResource(ModemHTTPClient & client){
+  Serial.println("Making GET request...");
+  client.get(resource);
+
+  int statusCode = client.responseStatusCode();
+  Serial.print("Status code: ");
+  Serial.println(statusCode);
+
+  while(client.headerAvailable()){
+    Serial.print(client.readHeaderName());
+    Serial.print(": ");
+    Serial.println(client.readHeaderValue());
+  }
+
+  Serial.println("Response:");
+  uint8_t buffer[64];
+  while(!client.endOfBodyReached()){
+    int length = client.read(buffer, sizeof(buffer));
+    if(length > 0){
+      Serial.write(buffer, length);
+    }
+  }
+  Serial.println();
+}
+
+void postData(ModemHTTPClient & client){
+  Serial.println("Making POST request...");
+  const char json[] = "{\"temperature\":21.5}";
+
+  // The body is streamed to the modem, its length has to be announced first
+  client.beginRequest();
+  client.post("/post");
+  client.sendHeader("Content-Type", "application/json");
+  client.sendHeader("Content-Length", strlen(json));
+  client.beginBody();
+  client.print(json);
+  client.endRequest();
+
+  Serial.print("Status code: ");
+  Serial.println(client.responseStatusCode());
+  client.stop(); // Discards the response
+}
+
+void setup(){
+    Serial.begin(115200);
+    while (!Serial);
+
+    // cellular.setDebugStream(Serial); // Uncomment this line to enable debug output
+    cellular.begin();
+
+    if(String(SECRET_PINNUMBER).length() > 0 && !cellular.unlockSIM(SECRET_PINNUMBER)){
+        Serial.println("Failed to unlock SIM card.");
+        while(true); // Stop here
+    }
+
+    Serial.println("Connecting...");
+    if(!cellular.connect(SECRET_GPRS_APN, SECRET_GPRS_LOGIN, SECRET_GPRS_PASSWORD)){
+        Serial.println("Failed to connect to the network.");
+        while(true); // Stop here
+    }
+    Serial.println("Connected!");
+
+    ModemHTTPClient client = cellular.getModemHTTPSClient(server, port);
+    client.setCACertificate(caCertificate);
+    // client.setInsecure(); // Instead of the CA certificate, accepts any server. Only for testing!
+    getResource(client);
+    postData(client);
+}
+
+void loop(){}
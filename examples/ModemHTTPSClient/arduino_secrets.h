@@ -0,0 +1,4 @@
+#define SECRET_PINNUMBER     "" // replace with your SIM card PIN
+#define SECRET_GPRS_APN      "apn" // replace with your GPRS APN
+#define SECRET_GPRS_LOGIN    "login"    // replace with your GPRS login
+#define SECRET_GPRS_PASSWORD "password" // replace with your GPRS password
\ No newline at end of file
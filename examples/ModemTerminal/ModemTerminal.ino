@@ -15,7 +15,7 @@
 #include "ArduinoCellular.h"
 #include "arduino_secrets.h"
 
-ArduinoCellular cellular = ArduinoCellular();
+ArduinoCellular cellular;
 
 void setup(){
     Serial.begin(115200);
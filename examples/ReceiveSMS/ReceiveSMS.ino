@@ -1,6 +1,7 @@
 /**
  * This example demonstrates how to receive SMS messages using ArduinoCellular library.
- * It supports both polling and interrupt based methods to check for new SMS messages.
+ * New messages are announced by the modem (+CMTI) and fetched by index from cellular.poll(),
+ * so the inbox does not need to be polled.
  * 
  * Instructions:
  * 1. Insert a SIM card with or without PIN code in the Arduino Pro 4G Module.
@@ -16,13 +17,9 @@
 
 #include "ArduinoCellular.h"
 
-constexpr int NEW_SMS_INTERRUPT_PIN = A0;
+ArduinoCellular cellular;
 
-ArduinoCellular cellular = ArduinoCellular();
-volatile boolean smsReceived = false;
-constexpr int POLLING_INTERVAL_MS = 1 * 60 * 1000; // 1 minute
-
-void printMessages(std::vector<SMS> msg){
+void printMessages(const std::vector<SMS> &msg){
      for(int i = 0; i < msg.size(); i++){
         Serial.println("SMS:");
         Serial.print("* Index: "); Serial.println(msg[i].index);
@@ -32,8 +29,14 @@ void printMessages(std::vector<SMS> msg){
         Serial.println("--------------------\n");
     }
 }
-void onSMSReceived(){
-    smsReceived = true;
+
+void onSMSReceived(const SMSView &sms, void * context){
+    Serial.println("New SMS received!");
+    Serial.print("* Index: "); Serial.println(sms.index);
+    Serial.print("* From: "); Serial.println(sms.sender);
+    Serial.print("* Timestamp: "); Serial.println(sms.timestamp.getISO8601());
+    Serial.println("* Message: "); Serial.println(sms.message);
+    Serial.println("--------------------\n");
 }
 
 void setup(){
@@ -58,8 +61,8 @@ void setup(){
     //Serial.println("Sending USSD command...");
     //Serial.println(cellular.sendUSSDCommand("*123#"));
 
-    // Register interrupt based callback for new SMS
-    attachInterrupt(digitalPinToInterrupt(NEW_SMS_INTERRUPT_PIN), onSMSReceived, RISING);
+    // Register the callback for new SMS
+    cellular.onSMSReceived(onSMSReceived);
 
     std::vector<SMS> readSMS = cellular.getReadSMS();
     if(readSMS.size() > 0){
@@ -75,22 +78,6 @@ void setup(){
 }
 
 void loop(){
-    static unsigned long lastPoll = 0;
-    static bool checkForNewSMS = false;
-
-    if(millis() - lastPoll > POLLING_INTERVAL_MS){
-        checkForNewSMS = true;
-        lastPoll = millis();
-    }
-
-    if(smsReceived || checkForNewSMS){
-        smsReceived = false;
-        checkForNewSMS = false;
-        std::vector<SMS> unreadSMS = cellular.getUnreadSMS();
-
-        if (unreadSMS.size() > 0){
-            Serial.println("New SMS received!");
-            printMessages(unreadSMS);
-        }
-    }
+    // Fetches the new messages announced by the modem and calls onSMSReceived()
+    cellular.poll();
 }
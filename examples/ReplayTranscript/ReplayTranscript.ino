@@ -0,0 +1,93 @@
+/**
+ * This example replays a transcript recorded with a TranscriptRecorder, e.g. by building
+ * a sketch with ARDUINO_CELLULAR_RECORD_TRANSCRIPT defined, and times the library against it.
+ * It does not need a 4G module and also runs on a host build, so that incidents from the field
+ * can be reproduced, debugged and profiled on a PC.
+ *
+ * Instructions:
+ * 1. Paste the transcript into TRANSCRIPT and the library calls that produced it into session().
+ * 2. Upload the sketch to the connected Arduino board, or build it for the host with the core in extras/host/core.
+ * 3. Open the serial monitor to view the results.
+*/
+
+#include "ArduinoCellular.h"
+#include "TranscriptPlayer.h"
+
+// begin(), getSignalQuality() and getGNSSFix() on an EG25
+const char TRANSCRIPT[] = R"(> 0 AT\r\n
+< 363 \r\n
+< 174 OK\r\n
+> 268 ATE0\r\n
+< 522 \r\n
+< 174 OK\r\n
+> 260 AT+CMEE=0\r\n
+< 1035 \r\n
+< 95 OK\r\n
+> 260 AT+CTZR=0\r\n
+< 956 \r\n
+< 174 OK\r\n
+> 260 AT+CTZU=1\r\n
+< 955 \r\n
+< 174 OK\r\n
+> 260 ATI\r\n
+< 5434 \r\n
+< 174 Quectel\r\n
+< 781 EG25\r\n
+< 521 Revision: EG25GGBR07A08M2G\r\n
+< 2431 \r\n
+< 173 OK\r\n
+> 269 AT+CMGF=1;+CSCS="GSM";+CNMI=2,1,0,0,0\r\n
+< 2210 \r\n
+< 174 OK\r\n
+> 261 AT+CSQ\r\n
+< 5694 \r\n
+< 174 +CSQ: 24,99\r\n
+< 1128 \r\n
+< 174 OK\r\n
+> 286 AT+QGPSLOC=2\r\n
+< 11215 \r\n
+< 174 +QGPSLOC: 095809.0,45.06513,7.65843,1.3,280.0,3,0.00,0.0,0.0,170
+< 5555 424,07\r\n
+< 695 \r\n
+< 173 OK\r\n
+)";
+
+const float SPEEDS[] = { 1.0f, 10.0f, 0.0f };
+
+void session(ArduinoCellular & cellular){
+    cellular.begin();
+    cellular.getSignalQuality();
+#if ARDUINO_CELLULAR_GNSS
+    GNSSFix fix;
+    cellular.getGNSSFix(fix, 0);
+#endif
+}
+
+void setup(){
+    Serial.begin(115200);
+    while (!Serial);
+
+    for(float speed : SPEEDS){
+        TranscriptPlayer player(TRANSCRIPT);
+        player.setSpeed(speed);
+        ModemInterface modem(player, -1); // -1: No power pin, no UART to configure
+        ArduinoCellular cellular(modem);
+
+        unsigned long start = micros();
+        session(cellular);
+        unsigned long duration = micros() - start;
+
+        Serial.print("Speed "); Serial.print(speed);
+        Serial.print(" | records: "); Serial.print(player.getRecordNumber());
+        Serial.print(player.isFinished() ? " (complete)" : " (incomplete)");
+        Serial.print(" | mismatches: "); Serial.print(player.getMismatchCount());
+        if(player.getMismatchCount() > 0){
+            Serial.print(" from record "); Serial.print(player.getFirstMismatchRecord());
+        }
+        Serial.print(" | time: "); Serial.print(duration); Serial.println(" us");
+    }
+}
+
+void loop(){
+    delay(1000);
+}
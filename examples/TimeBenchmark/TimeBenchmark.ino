@@ -0,0 +1,132 @@
+/**
+ * This example checks the date and time conversions of the Time class for every day
+ * from 1970 to 2100 and measures how long they take.
+ * It does not need a 4G module and also runs on a host build.
+ *
+ * Instructions:
+ * 1. Upload the sketch to the connected Arduino board.
+ * 2. Open the serial monitor to view the results.
+*/
+
+#include "ArduinoCellular.h"
+
+constexpr int FIRST_YEAR = 1970;
+constexpr int LAST_YEAR = 2100;
+constexpr unsigned long CONVERSIONS = 100000;
+
+unsigned long failures = 0;
+
+int daysInMonth(int year, int month){
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month == 2 && leapYear ? 29 : days[month - 1];
+}
+
+void fail(const char * check, const Time & time){
+    if(failures++ < 10){
+        Serial.print("FAILED "); Serial.print(check); Serial.print(": "); Serial.println(time.getISO8601());
+    }
+}
+
+// Walks the calendar day by day and compares every conversion with the running day count
+void checkCalendar(){
+    long expectedDays = 0;
+    char buffer[Time::ISO8601Length + 1];
+
+    for(int year = FIRST_YEAR; year <= LAST_YEAR; year++){
+        for(int month = 1; month <= 12; month++){
+            for(int day = 1; day <= daysInMonth(year, month); day++, expectedDays++){
+                Time time(year, month, day, 23, 59, 59);
+
+                if(Time::daysFromCivil(year, month, day) != expectedDays){
+                    fail("daysFromCivil", time);
+                }
+                Time::CivilDate date = Time::civilFromDays(expectedDays);
+                if(date.year != year || date.month != month || date.day != day){
+                    fail("civilFromDays", time);
+                }
+                if(time.getUNIXTimestamp() != static_cast<unsigned long>(expectedDays) * 86400UL + 86399UL){
+                    fail("getUNIXTimestamp", time);
+                }
+
+                Time parsed;
+                parsed.parseUNIXTimestamp(time.getUNIXTimestamp());
+                if(parsed.getYear() != year || parsed.getMonth() != month || parsed.getDay() != day
+                   || parsed.getHour() != 23 || parsed.getMinute() != 59 || parsed.getSecond() != 59){
+                    fail("parseUNIXTimestamp", time);
+                }
+
+                time.formatISO8601(buffer, sizeof(buffer));
+                if(!parsed.parseISO8601(buffer) || parsed.getUNIXTimestamp() != time.getUNIXTimestamp()){
+                    fail("ISO8601 round trip", time);
+                }
+            }
+        }
+    }
+}
+
+// Quarter hour offsets as reported by +CCLK, e.g. Nepal (+05:45) and Newfoundland (-03:30)
+void checkOffsets(){
+    const int offsets[] = { 0, 60, -60, 345, -210, 840, -720 };
+    Time utc(2024, 2, 29, 0, 10, 0);
+
+    for(int offset : offsets){
+        Time local;
+        local.parseUNIXTimestamp(utc.getUNIXTimestamp(), offset);
+        if(local.getUNIXTimestamp() != utc.getUNIXTimestamp() || local.getOffsetMinutes() != offset){
+            fail("offset", local);
+        }
+
+        Time parsed;
+        if(!parsed.parseISO8601(local.getISO8601().c_str()) || parsed.getUNIXTimestamp() != utc.getUNIXTimestamp()){
+            fail("offset ISO8601 round trip", local);
+        }
+    }
+
+    Time parsed;
+    if(!parsed.parseISO8601("2024-04-17T09:58:09.250Z") || parsed.getUNIXTimestamp() != 1713347889UL){
+        fail("fractional seconds", parsed);
+    }
+    if(parsed.parseISO8601("2024-04-17") || parsed.parseISO8601("2024-04-17T09:58:09+0x:00")){
+        fail("invalid string accepted", parsed);
+    }
+}
+
+void measureConversions(){
+    volatile unsigned long sink = 0;
+    char buffer[Time::ISO8601Length + 1];
+    Time time;
+
+    unsigned long start = micros();
+    for(unsigned long i = 0; i < CONVERSIONS; i++){
+        time.parseUNIXTimestamp(i * 41231UL);
+        sink += time.getUNIXTimestamp();
+    }
+    unsigned long duration = micros() - start;
+    Serial.print("UNIX timestamp round trip: "); Serial.print(duration * 1000UL / CONVERSIONS); Serial.println(" ns");
+
+    start = micros();
+    for(unsigned long i = 0; i < CONVERSIONS; i++){
+        time.formatISO8601(buffer, sizeof(buffer));
+        time.parseISO8601(buffer);
+        sink += time.getSecond();
+    }
+    duration = micros() - start;
+    Serial.print("ISO8601 round trip:        "); Serial.print(duration * 1000UL / CONVERSIONS); Serial.println(" ns");
+}
+
+void setup(){
+    Serial.begin(115200);
+    while (!Serial);
+
+    checkCalendar();
+    checkOffsets();
+    Serial.print("Checked "); Serial.print(FIRST_YEAR); Serial.print(" to "); Serial.print(LAST_YEAR);
+    Serial.print(": "); Serial.print(failures); Serial.println(" failures");
+
+    measureConversions();
+}
+
+void loop(){
+    delay(1000);
+}
@@ -0,0 +1,411 @@
+#include "SimulatedModem.h"
+
+namespace {
+
+const SimulatedModem::Rule bg96Rules[] = {
+    { "I", "\r\nQuectel\r\nBG96\r\nRevision: BG96MAR02A07M1G\r\n\r\nOK\r\n", 5 },
+    { "+QGPSLOC", "\r\n+QGPSLOC: 095809.0,45.06513,7.65843,1.3,280.0,3,0.00,0.0,0.0,170424,07\r\n\r\nOK\r\n", 10 },
+};
+
+const SimulatedModem::Rule ec200aRules[] = {
+    { "I", "\r\nQuectel\r\nEC200A\r\nRevision: EC200AEUHAR01A13M16\r\n\r\nOK\r\n", 5 },
+    // The EC200A-EU has no GNSS receiver
+    { "+QGPS", "\r\n+CME ERROR: 504\r\n", 5 },
+};
+
+const SimulatedModem::Rule eg25Rules[] = {
+    { "I", "\r\nQuectel\r\nEG25\r\nRevision: EG25GGBR07A08M2G\r\n\r\nOK\r\n", 5 },
+    { "+QGPSLOC", "\r\n+QGPSLOC: 095809.0,45.06513,7.65843,1.3,280.0,3,0.00,0.0,0.0,170424,07\r\n\r\nOK\r\n", 10 },
+    { "+QGPSXTRADATA?", "\r\n+QGPSXTRADATA: 10080,\"2024/04/17,08:00:00\"\r\n\r\nOK\r\n", 5 },
+    { "+QGPSGNMEA=\"RMC\"", "\r\n+QGPSGNMEA: $GPRMC,095809.00,A,4503.9078,N,00739.5058,E,1.250,85.40,170424,,,A*59\r\n\r\nOK\r\n", 8 },
+    { "+QGPSGNMEA=\"GSA\"", "\r\n+QGPSGNMEA: $GPGSA,A,3,02,05,12,15,18,24,25,29,,,,,1.9,1.3,1.4*3E\r\n\r\nOK\r\n", 8 },
+    { "+QGPSGNMEA=\"GGA\"", "\r\n+QGPSGNMEA: $GPGGA,095809.00,4503.9078,N,00739.5058,E,1,08,1.3,280.0,M,48.0,M,,*6C\r\n\r\nOK\r\n", 8 },
+};
+
+const SimulatedModem::Rule commonRules[] = {
+    { "+CPIN?", "\r\n+CPIN: READY\r\n\r\nOK\r\n", 5 },
+    { "+CEREG?", "\r\n+CEREG: 0,1\r\n\r\nOK\r\n", 5 },
+    { "+CGREG?", "\r\n+CGREG: 0,1\r\n\r\nOK\r\n", 5 },
+    { "+CREG?", "\r\n+CREG: 0,1\r\n\r\nOK\r\n", 5 },
+    { "+CSQ", "\r\n+CSQ: 24,99\r\n\r\nOK\r\n", 5 },
+    { "+CGATT?", "\r\n+CGATT: 1\r\n\r\nOK\r\n", 5 },
+    { "+QIACT?", "\r\n+QIACT: 1,1,1,\"10.0.0.2\"\r\n\r\nOK\r\n", 10 },
+    { "+QIACT=", "\r\nOK\r\n", 800 },
+    { "+CCLK?", "\r\n+CCLK: \"24/04/17,09:58:09+08\"\r\n\r\nOK\r\n", 5 },
+    { "+QNTP=", "\r\nOK\r\n\r\n+QNTP: 0,\"2024/04/17,09:58:09+08\"\r\n", 300 },
+    { "+CMGL", "\r\nOK\r\n", 20 },
+    { "+CMGR", "\r\n+CMGR: \"REC UNREAD\",\"+491701234567\",,\"24/04/17,09:58:09+08\"\r\nHello from the simulated modem\r\n\r\nOK\r\n", 30 },
+    { "+CPMS?", "\r\n+CPMS: \"SM\",0,50,\"SM\",0,50,\"SM\",0,50\r\n\r\nOK\r\n", 5 },
+    { "+CMGS", "\r\n+CMGS: 12\r\n\r\nOK\r\n", 1500 },
+    { "+QFUPL", "\r\n+QFUPL: 4096,6b5e\r\n\r\nOK\r\n", 50 },
+    { "+QISEND", "\r\nSEND OK\r\n", 2 },
+    { "+QIRD", "\r\n+QIRD: 0\r\n\r\nOK\r\n", 5 },
+    { "+QHTTPURL", "\r\nOK\r\n", 5 },
+    { "+QHTTPGET", "\r\nOK\r\n\r\n+QHTTPGET: 0,200,13\r\n", 300 },
+    { "+QHTTPPOST", "\r\nOK\r\n\r\n+QHTTPPOST: 0,200,13\r\n", 300 },
+    { "+QHTTPREAD", "\r\nCONNECT\r\nHTTP/1.1 200 OK\r\nContent-Length: 13\r\n\r\nHello, World!\r\nOK\r\n\r\n+QHTTPREAD: 0\r\n", 5 },
+    { "+CUSD", "\r\nOK\r\n\r\n+CUSD: 0,\"Your balance is 5.00\",15\r\n", 1000 },
+};
+
+const char okResponse[] = "\r\nOK\r\n";
+const char promptResponse[] = "\r\n> ";
+const char connectResponse[] = "\r\nCONNECT\r\n";
+
+template <size_t N>
+const SimulatedModem::Rule * matchRule(const SimulatedModem::Rule (&table)[N], const char * command) {
+    for (size_t i = 0; i < N; i++) {
+        if (strncmp(command, table[i].command, strlen(table[i].command)) == 0) {
+            return &table[i];
+        }
+    }
+    return nullptr;
+}
+
+// Commands after which the modem prompts with "> " and reads a payload terminated by Ctrl+Z
+bool expectsPayload(const char * command) {
+    return strncmp(command, "+CMGS", 5) == 0;
+}
+
+// Commands after which the modem answers CONNECT or "> " and reads a payload, returns the parameter with its size
+const char * countedPayloadSize(const char * command) {
+    const char * parameters = strchr(command, '=');
+    if (parameters == nullptr) {
+        return nullptr;
+    }
+    if (strncmp(command, "+QHTTPURL=", 10) == 0 || strncmp(command, "+QHTTPPOST=", 11) == 0) {
+        return parameters + 1;
+    }
+    // +QHTTPGET=<response time> has no payload, only the variant with custom request headers has
+    const char * second = strchr(parameters, ',');
+    if (strncmp(command, "+QFUPL=", 7) == 0 || strncmp(command, "+QISEND=", 8) == 0 || strncmp(command, "+QHTTPGET=", 10) == 0) {
+        return second != nullptr ? second + 1 : nullptr;
+    }
+    return nullptr;
+}
+
+}
+
+SimulatedModem::SimulatedModem(Dialect dialect, unsigned long baudRate) : dialect(dialect) {
+    setBaudRate(baudRate);
+}
+
+bool SimulatedModem::addRule(const char * command, const char * response, unsigned long latency) {
+    if (ruleCount >= maxRules) {
+        return false;
+    }
+    rules[ruleCount++] = { command, response, latency };
+    return true;
+}
+
+void SimulatedModem::clearRules() {
+    ruleCount = 0;
+}
+
+void SimulatedModem::setBaudRate(unsigned long baudRate) {
+    // A UART frame is 10 bits long (start bit, 8 data bits, stop bit)
+    byteTimeNanos = baudRate == 0 ? 0 : static_cast<uint32_t>(10000000000ULL / baudRate);
+    payloadBytesQueued = 0;
+}
+
+bool SimulatedModem::injectURC(const char * urc, unsigned long delay) {
+    return enqueue(urc, delay * 1000UL, micros());
+}
+
+void SimulatedModem::restart() {
+    segmentHead = 0;
+    segmentCount = 0;
+    commandLength = 0;
+    payloadRule = nullptr;
+    payloadRemaining = 0;
+    lineFeedPending = false;
+    smsLinkKept = false;
+    smsLinkOpen = false;
+    echo = true;
+    asleep = false;
+    dataMode = false;
+    payloadBytesQueued = 0;
+}
+
+void SimulatedModem::sleep(unsigned long wakeLatency) {
+    this->wakeLatency = wakeLatency;
+    asleep = true;
+    waking = false;
+}
+
+void SimulatedModem::resetCounters() {
+    commandCount = 0;
+    bytesWritten = 0;
+    bytesRead = 0;
+}
+
+const SimulatedModem::Rule * SimulatedModem::findRule(const char * command) const {
+    for (size_t i = 0; i < ruleCount; i++) {
+        if (strncmp(command, rules[i].command, strlen(rules[i].command)) == 0) {
+            return &rules[i];
+        }
+    }
+
+    const Rule * rule = nullptr;
+    switch (dialect) {
+        case BG96: rule = matchRule(bg96Rules, command); break;
+        case EC200A: rule = matchRule(ec200aRules, command); break;
+        case EG25: rule = matchRule(eg25Rules, command); break;
+    }
+    return rule != nullptr ? rule : matchRule(commonRules, command);
+}
+
+bool SimulatedModem::enqueue(const char * data, unsigned long latencyMicros, unsigned long now) {
+    if (segmentCount >= maxPendingResponses) {
+        return false;
+    }
+
+    size_t length = strlen(data);
+    unsigned long start = now + latencyMicros;
+    // The wire is serial, a response cannot start before the previous one has been transmitted
+    if (segmentCount > 0 && static_cast<long>(wireFreeAt - start) > 0) {
+        start = wireFreeAt;
+    }
+    wireFreeAt = start + static_cast<unsigned long>((static_cast<uint64_t>(length) * byteTimeNanos) / 1000);
+
+    segments[(segmentHead + segmentCount) % maxPendingResponses] = { data, length, 0, start };
+    segmentCount++;
+    return true;
+}
+
+unsigned long SimulatedModem::transmitBacklog(unsigned long now) const {
+    unsigned long freeAt = payloadStartedAt + static_cast<unsigned long>((static_cast<uint64_t>(payloadBytesQueued) * byteTimeNanos) / 1000);
+    long backlog = static_cast<long>(freeAt - now);
+    return backlog > 0 ? static_cast<unsigned long>(backlog) : 0;
+}
+
+void SimulatedModem::transmitPayloadByte() {
+    if (byteTimeNanos == 0) {
+        return;
+    }
+    unsigned long now = micros();
+    if (transmitBacklog(now) == 0) {
+        payloadStartedAt = now;
+        payloadBytesQueued = 0;
+    }
+    // A full transmit buffer blocks the writer until the UART has sent enough bytes
+    unsigned long bufferMicros = static_cast<unsigned long>((static_cast<uint64_t>(transmitBufferSize) * byteTimeNanos) / 1000);
+    while (transmitBacklog(micros()) > bufferMicros) {
+        yield();
+    }
+    payloadBytesQueued++;
+}
+
+void SimulatedModem::flush() {
+    while (transmitBacklog(micros()) > 0) {
+        yield();
+    }
+}
+
+void SimulatedModem::processCommand(unsigned long now) {
+    command[commandLength] = '\0';
+    // The modem receives the command only after its last byte and any payload before it have been transmitted
+    unsigned long transmitMicros = transmitBacklog(now) + static_cast<unsigned long>((static_cast<uint64_t>(commandLength + 1) * byteTimeNanos) / 1000);
+    commandLength = 0;
+
+    if ((command[0] != 'A' && command[0] != 'a') || (command[1] != 'T' && command[1] != 't')) {
+        return;
+    }
+    if (asleep) {
+        if (!waking) {
+            waking = true;
+            awakeAt = now + wakeLatency * 1000UL;
+        }
+        if (static_cast<long>(now - awakeAt) < 0) {
+            // The modem is not ready yet, the command line is lost
+            return;
+        }
+        asleep = false;
+    }
+    commandCount++;
+
+    if (echo) {
+        // The characters are echoed as they arrive, so the echo is complete with the command line
+        size_t length = strlen(command);
+        memcpy(echoLine, command, length);
+        echoLine[length] = '\r';
+        echoLine[length + 1] = '\0';
+        enqueue(echoLine, 0, now - transmitMicros);
+    }
+
+    const char * body = command + 2;
+    if (body[0] == 'E' || body[0] == 'e') {
+        echo = body[1] == '1';
+    }
+    if (strncmp(body, "+CMMS=", 6) == 0) {
+        smsLinkKept = body[6] != '0';
+        smsLinkOpen = smsLinkOpen && smsLinkKept;
+    }
+    const Rule * rule = body[0] != '\0' ? findRule(body) : nullptr;
+
+    if (rule == nullptr && strncmp(body, "+QIOPEN=", 8) == 0) {
+        openSocket(body + 8, transmitMicros, now);
+    } else if (rule == nullptr) {
+        enqueue(okResponse, transmitMicros, now);
+    } else if (countedPayloadSize(body) != nullptr) {
+        payloadRemaining = strtoul(countedPayloadSize(body), nullptr, 10);
+        if (payloadRemaining > 0) {
+            payloadRule = rule;
+            lineFeedPending = true;
+            enqueue(strncmp(body, "+QISEND", 7) == 0 ? promptResponse : connectResponse, transmitMicros, now);
+        } else {
+            enqueue(rule->response, transmitMicros + rule->latency * 1000UL, now);
+        }
+    } else if (expectsPayload(body)) {
+        payloadRule = rule;
+        enqueue(promptResponse, transmitMicros, now);
+    } else {
+        enqueue(rule->response, transmitMicros + rule->latency * 1000UL, now);
+    }
+}
+
+void SimulatedModem::openSocket(const char * parameters, unsigned long transmitMicros, unsigned long now) {
+    // <contextID>,<connectID>,<service type>,<host>,<port>,<local port>,<access mode>
+    int connectId = 0;
+    int accessMode = 0;
+    const char * field = parameters;
+    for (int index = 0; field != nullptr; index++) {
+        if (index == 1) {
+            connectId = atoi(field);
+        } else if (index == 6) {
+            accessMode = atoi(field);
+        }
+        field = strchr(field, ',');
+        if (field != nullptr) {
+            field++;
+        }
+    }
+
+    unsigned long openMicros = transmitMicros + socketOpenLatency * 1000UL;
+    if (accessMode == 2) {
+        // Transparent access mode, the UART carries the payload once connected
+        dataMode = true;
+        escapeCount = 0;
+        lastWriteAt = now;
+        enqueue(connectResponse, openMicros, now);
+        return;
+    }
+    snprintf(socketResult, sizeof(socketResult), "\r\n+QIOPEN: %d,0\r\n", connectId);
+    enqueue(okResponse, transmitMicros, now);
+    enqueue(socketResult, openMicros, now);
+}
+
+size_t SimulatedModem::write(uint8_t c) {
+    bytesWritten++;
+
+    if (dataMode) {
+        transmitPayloadByte();
+        unsigned long now = micros();
+        // +++ after a pause of the guard time leaves data mode, the pause after it is not checked
+        if (c == '+' && (escapeCount > 0 || now - lastWriteAt >= escapeGuardTime * 1000UL)) {
+            if (++escapeCount == 3) {
+                dataMode = false;
+                escapeCount = 0;
+                enqueue(okResponse, escapeGuardTime * 1000UL, now);
+            }
+        } else {
+            escapeCount = 0;
+        }
+        lastWriteAt = now;
+        return 1;
+    }
+
+    if (payloadRule != nullptr && payloadRemaining > 0) {
+        // The line feed after the command line is not part of the payload
+        if (lineFeedPending) {
+            lineFeedPending = false;
+            if (c == '\n') {
+                return 1;
+            }
+        }
+        // Counted payloads may contain any byte
+        transmitPayloadByte();
+        if (--payloadRemaining == 0) {
+            unsigned long now = micros();
+            enqueue(payloadRule->response, transmitBacklog(now) + payloadRule->latency * 1000UL, now);
+            payloadRule = nullptr;
+            commandLength = 0;
+        }
+        return 1;
+    }
+
+    if (payloadRule != nullptr) {
+        if (c == 0x1A) {
+            unsigned long transmitMicros = static_cast<unsigned long>((static_cast<uint64_t>(commandLength + 1) * byteTimeNanos) / 1000);
+            unsigned long latency = payloadRule->latency;
+            if (smsLinkOpen && latency > smsLinkSetupLatency) {
+                latency -= smsLinkSetupLatency;
+            }
+            smsLinkOpen = smsLinkKept;
+            enqueue(payloadRule->response, transmitMicros + latency * 1000UL, micros());
+            payloadRule = nullptr;
+            commandLength = 0;
+        } else if (c == 0x1B) {
+            // ESC aborts the payload without sending it
+            payloadRule = nullptr;
+            commandLength = 0;
+        } else {
+            // Only the payload length matters for the timing model
+            commandLength++;
+        }
+        return 1;
+    }
+
+    if (c == '\r' || c == '\n') {
+        if (commandLength > 0) {
+            processCommand(micros());
+        }
+    } else if (commandLength < maxCommandLength) {
+        command[commandLength++] = static_cast<char>(c);
+    }
+    return 1;
+}
+
+size_t SimulatedModem::arrivedBytes(const Segment & segment, unsigned long now) const {
+    long elapsed = static_cast<long>(now - segment.start);
+    if (elapsed < 0) {
+        return 0;
+    }
+    if (byteTimeNanos == 0) {
+        return segment.length;
+    }
+    uint64_t arrived = (static_cast<uint64_t>(elapsed) * 1000) / byteTimeNanos;
+    return arrived < segment.length ? static_cast<size_t>(arrived) : segment.length;
+}
+
+void SimulatedModem::dropConsumedSegments() {
+    while (segmentCount > 0 && segments[segmentHead].position >= segments[segmentHead].length) {
+        segmentHead = (segmentHead + 1) % maxPendingResponses;
+        segmentCount--;
+    }
+}
+
+int SimulatedModem::available() {
+    dropConsumedSegments();
+    if (segmentCount == 0) {
+        return 0;
+    }
+    const Segment & segment = segments[segmentHead];
+    return static_cast<int>(arrivedBytes(segment, micros()) - segment.position);
+}
+
+int SimulatedModem::peek() {
+    if (available() <= 0) {
+        return -1;
+    }
+    const Segment & segment = segments[segmentHead];
+    return static_cast<uint8_t>(segment.data[segment.position]);
+}
+
+int SimulatedModem::read() {
+    if (available() <= 0) {
+        return -1;
+    }
+    Segment & segment = segments[segmentHead];
+    bytesRead++;
+    return static_cast<uint8_t>(segment.data[segment.position++]);
+}
@@ -0,0 +1,210 @@
+/**
+ * @file SimulatedModem.h
+ * @brief Header file for the SimulatedModem class.
+ */
+
+#ifndef ARDUINO_CELLULAR_SIMULATED_MODEM_H
+#define ARDUINO_CELLULAR_SIMULATED_MODEM_H
+
+#include <Arduino.h>
+
+/**
+ * @class SimulatedModem
+ * @brief A scripted Stream that emulates the AT dialect of the Quectel BG96, EC200A and EG25 modems.
+ *
+ * The simulated modem answers AT command lines written to it with scripted responses and
+ * delivers them byte by byte as if they were travelling over a UART at the configured baud rate.
+ * It can be passed to a ModemInterface (with a power pin of -1) to exercise and benchmark
+ * ArduinoCellular without a modem or a SIM card.
+ *
+ * Responses are matched by command prefix (the part after "AT"), user rules first and the
+ * built-in rules for the selected dialect afterwards. Commands without a matching rule are
+ * answered with "OK". All strings handed to the simulator must stay valid while it is in use.
+ *
+ * Sockets opened with +QIOPEN always connect. +QISEND reads the announced number of bytes after its prompt,
+ * and a socket in transparent access mode swallows all bytes until the +++ escape sequence. +QHTTPGET and
+ * +QHTTPPOST read the request the same way and are answered with status 200 and a short body for +QHTTPREAD.
+ * Payload bytes take their transmission time on the wire to the modem, and write() blocks once
+ * transmitBufferSize bytes are pending.
+ *
+ * Like a real modem, the simulated one echoes command lines until it receives ATE0. Only the last
+ * command line is kept for the echo, so commands should not be pipelined while echo is on.
+ */
+class SimulatedModem : public Stream {
+    public:
+        /**
+         * @enum Dialect
+         * @brief The modem variant whose responses are emulated.
+         */
+        enum Dialect {
+            BG96,   /**< Quectel BG96, the TinyGSM reference modem. */
+            EC200A, /**< Quectel EC200A-EU, no GNSS receiver. */
+            EG25    /**< Quectel EG25-G, with GNSS receiver. */
+        };
+
+        /**
+         * @struct Rule
+         * @brief A scripted response to an AT command.
+         */
+        struct Rule {
+            const char * command; /**< The command prefix to match, without the leading "AT" (e.g. "+CSQ"). */
+            const char * response; /**< The raw bytes sent back, including line terminators and the final result code. */
+            unsigned long latency; /**< The processing time of the modem before the response starts (In milliseconds). */
+        };
+
+        static constexpr size_t maxRules = 32; /**< Maximum number of user rules. */
+        static constexpr size_t maxPendingResponses = 16; /**< Maximum number of responses queued on the wire. */
+        static constexpr size_t maxCommandLength = 256; /**< Maximum length of a command line. */
+        static constexpr size_t transmitBufferSize = 256; /**< Payload bytes the emulated host UART buffers before write() blocks. */
+        static constexpr unsigned long socketOpenLatency = 150; /**< Time until +QIOPEN reports the connection (In milliseconds). */
+        static constexpr unsigned long escapeGuardTime = 1000; /**< Pause before +++ that leaves transparent mode (In milliseconds). */
+        static constexpr unsigned long smsLinkSetupLatency = 1200; /**< Part of the +CMGS latency spent setting up the radio link, saved while +CMMS keeps it open (In milliseconds). */
+
+        /**
+         * @brief Creates a simulated modem.
+         * @param dialect The modem variant to emulate.
+         * @param baudRate The emulated UART baud rate. 0 delivers responses instantly.
+         */
+        SimulatedModem(Dialect dialect = EG25, unsigned long baudRate = 115200);
+
+        /**
+         * @brief Adds a scripted response. Rules added later do not override earlier ones with the same prefix.
+         * @param command The command prefix to match, without the leading "AT".
+         * @param response The raw response bytes, e.g. "\r\n+CSQ: 20,99\r\n\r\nOK\r\n".
+         * @param latency The processing time of the modem before the response starts (In milliseconds).
+         * @return True if the rule was added, false if the rule table is full.
+         */
+        bool addRule(const char * command, const char * response, unsigned long latency = 0);
+
+        /**
+         * @brief Removes all user rules. The built-in rules stay active.
+         */
+        void clearRules();
+
+        /**
+         * @brief Sets the emulated UART baud rate.
+         * @param baudRate The baud rate. 0 delivers responses instantly.
+         */
+        void setBaudRate(unsigned long baudRate);
+
+        /**
+         * @brief Queues an unsolicited result code, e.g. "\r\n+CMTI: \"SM\",3\r\n".
+         * @param urc The raw bytes of the URC.
+         * @param delay The time until the URC is emitted (In milliseconds).
+         * @return True if the URC was queued, false if the output queue is full.
+         */
+        bool injectURC(const char * urc, unsigned long delay = 0);
+
+        /**
+         * @brief Emulates a restart of the modem. Pending responses are dropped and the settings return
+         * to their power-on defaults, so command lines are echoed again until ATE0.
+         */
+        void restart();
+
+        /**
+         * @brief Emulates the sleep mode enabled with +QSCLK=1. The first command line received afterwards wakes
+         * the modem up, like a falling DTR edge, and all command lines received before it is awake are lost.
+         * @param wakeLatency The time the modem needs to wake up (In milliseconds).
+         */
+        void sleep(unsigned long wakeLatency);
+
+        /**
+         * @brief Checks if the modem sleeps or is still waking up.
+         * @return True until the first command line after the wake latency.
+         */
+        bool isAsleep() const { return asleep; }
+
+        /**
+         * @brief Checks if command lines are echoed.
+         * @return True until ATE0 is received, and again after restart().
+         */
+        bool isEchoing() const { return echo; }
+
+        /**
+         * @brief Resets the round trip and byte counters.
+         */
+        void resetCounters();
+
+        /**
+         * @brief Gets the number of command lines received, i.e. the number of round trips.
+         * @return The number of commands.
+         */
+        unsigned long getCommandCount() const { return commandCount; }
+
+        /**
+         * @brief Gets the number of bytes written to the modem by the library.
+         * @return The number of bytes sent to the modem.
+         */
+        unsigned long getBytesWritten() const { return bytesWritten; }
+
+        /**
+         * @brief Gets the number of bytes read from the modem by the library.
+         * @return The number of bytes received from the modem.
+         */
+        unsigned long getBytesRead() const { return bytesRead; }
+
+        int available() override;
+        int read() override;
+        int peek() override;
+        size_t write(uint8_t c) override;
+        using Print::write;
+
+        /**
+         * @brief Waits until all payload bytes have been transmitted.
+         */
+        void flush() override;
+
+    private:
+        struct Segment {
+            const char * data;
+            size_t length;
+            size_t position;
+            unsigned long start;
+        };
+
+        const Rule * findRule(const char * command) const;
+        void processCommand(unsigned long now);
+        void openSocket(const char * parameters, unsigned long transmitMicros, unsigned long now);
+        bool enqueue(const char * data, unsigned long latencyMicros, unsigned long now);
+        unsigned long transmitBacklog(unsigned long now) const;
+        void transmitPayloadByte();
+        size_t arrivedBytes(const Segment & segment, unsigned long now) const;
+        void dropConsumedSegments();
+
+        Dialect dialect;
+        uint32_t byteTimeNanos = 0;
+
+        Rule rules[maxRules];
+        size_t ruleCount = 0;
+
+        Segment segments[maxPendingResponses];
+        size_t segmentHead = 0;
+        size_t segmentCount = 0;
+        unsigned long wireFreeAt = 0;
+        unsigned long payloadStartedAt = 0; /**< When the payload bytes still on the wire to the modem started (In microseconds). */
+        size_t payloadBytesQueued = 0; /**< Payload bytes transmitted or buffered since payloadStartedAt. */
+
+        char command[maxCommandLength + 1];
+        size_t commandLength = 0;
+        char echoLine[maxCommandLength + 2]; /**< The echo of the last command line, including the carriage return. */
+        bool echo = true; /**< True if command lines are echoed (ATE1). */
+        bool dataMode = false; /**< True while a socket in transparent access mode owns the UART. */
+        uint8_t escapeCount = 0; /**< Number of '+' of the escape sequence received so far. */
+        unsigned long lastWriteAt = 0; /**< When the last byte was received in data mode (In microseconds). */
+        char socketResult[24]; /**< The +QIOPEN URC of the last opened socket. */
+        bool asleep = false; /**< True while the modem sleeps or wakes up. */
+        bool waking = false; /**< True once a command line has started the wake-up. */
+        unsigned long wakeLatency = 0; /**< The time the modem needs to wake up (In milliseconds). */
+        unsigned long awakeAt = 0; /**< When the wake-up completes (In microseconds). */
+        const Rule * payloadRule = nullptr;
+        size_t payloadRemaining = 0; /**< Bytes still expected of a counted payload, 0 for one terminated by Ctrl+Z. */
+        bool lineFeedPending = false; /**< True until the byte after the command line of a counted payload has been seen. */
+        bool smsLinkKept = false; /**< True while +CMMS keeps the radio link open between messages. */
+        bool smsLinkOpen = false; /**< True if the radio link of the last message is still open. */
+
+        unsigned long commandCount = 0;
+        unsigned long bytesWritten = 0;
+        unsigned long bytesRead = 0;
+};
+
+#endif
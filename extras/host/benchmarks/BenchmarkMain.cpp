@@ -0,0 +1,13 @@
+#include <Arduino.h>
+#include <ModemInterface.h>
+
+// The global modem of the library, a board has it on its modem UART
+ModemInterface modem(Serial, -1);
+
+void setup();
+
+// The benchmarks report everything from setup(), loop() would run forever
+int main() {
+    setup();
+    return 0;
+}
@@ -0,0 +1,309 @@
+/**
+ * This benchmark measures the ArduinoCellular library against a simulated modem.
+ * It reports the number of AT round trips, the bytes on the wire and the wall time
+ * of the most common operations, so that performance changes can be measured without
+ * a 4G module or a SIM card.
+ *
+ * Instructions:
+ * 1. Run "make benchmark" in extras/host to build and run it on a PC.
+ *
+ * Initial author: Arduino
+*/
+
+#include <malloc.h>
+#include "ArduinoCellular.h"
+#include "SimulatedModem.h"
+
+constexpr int INBOX_SIZE = 50;
+constexpr unsigned long BAUD_RATES[] = { 115200, 921600 };
+
+SimulatedModem simulatedModem(SimulatedModem::EG25);
+ModemInterface simulatedInterface(simulatedModem, -1); // -1: No power pin, no UART to configure
+ArduinoCellular cellular(simulatedInterface);
+SMSBatch smsBatch(INBOX_SIZE * 96); // The arena is allocated once, before any measurement
+ModemHTTPClient modemHTTPS(simulatedInterface, "example.com", 443, true); // Configures the modem on its first request
+
+char inbox[INBOX_SIZE * 128 + 8];
+
+const char * const RECIPIENTS[] = { "+393331234567", "+393331234568", "+393331234569", "+393331234570", "+393331234571" };
+char longMessage[400];
+
+void buildInbox(){
+    size_t length = 0;
+    for(int i = 0; i < INBOX_SIZE; i++){
+        length += snprintf(inbox + length, sizeof(inbox) - length,
+            "\r\n+CMGL: %d,\"REC UNREAD\",\"+393331234567\",\"\",\"24/04/17,09:%02d:09+08\"\r\nSimulated message number %d",
+            i + 1, i % 60, i + 1);
+    }
+    snprintf(inbox + length, sizeof(inbox) - length, "\r\n\r\nOK\r\n");
+}
+
+size_t heapInUse(){
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return mallinfo().uordblks;
+#endif
+}
+
+// Heap growth while the result of an operation is still alive
+size_t heapDelta = 0;
+
+void measure(const char * name, void (*operation)()){
+    simulatedModem.resetCounters();
+    heapDelta = 0;
+    unsigned long start = micros();
+    operation();
+    unsigned long duration = micros() - start;
+
+    Serial.print(name);
+    Serial.print(" | round trips: "); Serial.print(simulatedModem.getCommandCount());
+    Serial.print(" | TX: "); Serial.print(simulatedModem.getBytesWritten()); Serial.print(" B");
+    Serial.print(" | RX: "); Serial.print(simulatedModem.getBytesRead()); Serial.print(" B");
+    Serial.print(" | time: "); Serial.print(duration); Serial.print(" us");
+    Serial.print(" | heap: "); Serial.print(heapDelta); Serial.println(" B");
+}
+
+// Set while a new SMS has been announced by the simulated modem but not delivered yet
+bool awaitingSMS = false;
+
+// Runs asynchronous operations to completion and reports the longest poll() call
+void measureAsync(const char * name, void (*operation)()){
+    simulatedModem.resetCounters();
+    unsigned long start = micros();
+    unsigned long longestPoll = 0;
+    operation();
+    while(!cellular.isIdle() || awaitingSMS){
+        unsigned long pollStart = micros();
+        cellular.poll();
+        unsigned long pollDuration = micros() - pollStart;
+        if(pollDuration > longestPoll){
+            longestPoll = pollDuration;
+        }
+    }
+    unsigned long duration = micros() - start;
+
+    Serial.print(name);
+    Serial.print(" | round trips: "); Serial.print(simulatedModem.getCommandCount());
+    Serial.print(" | time: "); Serial.print(duration); Serial.print(" us");
+    Serial.print(" | longest poll(): "); Serial.print(longestPoll); Serial.println(" us");
+}
+
+#if ARDUINO_CELLULAR_GNSS
+// Serves a fixed number of bytes, standing in for an XTRA file on an SD card
+class XTRAFileStream : public Stream {
+    public:
+        size_t remaining = 0;
+        int available() override { return remaining; }
+        int read() override { return remaining > 0 ? static_cast<int>(--remaining & 0xFF) : -1; }
+        int peek() override { return remaining > 0 ? static_cast<int>((remaining - 1) & 0xFF) : -1; }
+        size_t write(uint8_t c) override { return 0; }
+        using Print::write;
+} xtraFile;
+
+uint32_t streamedFixes = 0;
+
+// Streams fixes at 10 Hz for one second and reports the longest poll() call
+void measureGNSSStream(){
+    streamedFixes = 0;
+    cellular.startGNSSStream([](const GNSSFix & fix, void * context){ streamedFixes++; }, nullptr, 100);
+    simulatedModem.resetCounters();
+    unsigned long start = millis();
+    unsigned long longestPoll = 0;
+    while(millis() - start < 1000 || !cellular.isIdle()){
+        if(millis() - start >= 1000){
+            cellular.stopGNSSStream();
+        }
+        unsigned long pollStart = micros();
+        cellular.poll();
+        unsigned long pollDuration = micros() - pollStart;
+        if(pollDuration > longestPoll){
+            longestPoll = pollDuration;
+        }
+    }
+    cellular.stopGNSSStream();
+
+    GNSSFix fix;
+    cellular.getLatestFix(fix);
+    Serial.print("GNSS stream 10 Hz  ");
+    Serial.print(" | fixes in 1 s: "); Serial.print(streamedFixes);
+    Serial.print(" | round trips: "); Serial.print(simulatedModem.getCommandCount());
+    Serial.print(" | longest poll(): "); Serial.print(longestPoll); Serial.print(" us");
+    Serial.print(" | latitude: "); Serial.println(fix.getLatitude(), 5);
+}
+#endif
+
+void setup(){
+    Serial.begin(115200);
+    while (!Serial);
+
+    buildInbox();
+    for(size_t i = 0; i < sizeof(longMessage) - 1; i++){
+        longMessage[i] = 'a' + i % 26;
+    }
+    simulatedModem.addRule("+CMGL", inbox, 50);
+    simulatedModem.addRule("+CPMS?", "\r\n+CPMS: \"SM\",50,50,\"SM\",50,50,\"SM\",50,50\r\n\r\nOK\r\n", 5);
+    modemHTTPS.setCACertificate("UFS:cacert.pem");
+#if ARDUINO_CELLULAR_SMS
+    cellular.onSMSReceived([](const SMSView & sms, void * context){ awaitingSMS = false; });
+#endif
+
+    for(unsigned long baudRate : BAUD_RATES){
+        simulatedModem.setBaudRate(baudRate);
+        Serial.print("--- Simulated EG25 at "); Serial.print(baudRate); Serial.println(" baud ---");
+
+        measure("begin()            ", [](){ cellular.begin(); });
+        measure("beginWarm()        ", [](){ cellular.beginWarm(); });
+        simulatedModem.restart();
+        measure("beginWarm() restart", [](){ cellular.beginWarm(); });
+        const BootTimings & boot = cellular.getBootTimings();
+        Serial.print("Boot phases: probe "); Serial.print(boot.probe);
+        Serial.print(" ms | init "); Serial.print(boot.init);
+        Serial.print(" ms | configuration "); Serial.print(boot.configuration);
+        Serial.print(" ms | total "); Serial.println(boot.total);
+        measure("power saving setup ", [](){
+            cellular.setPSM(true, 3600, 60);
+            cellular.setEDRX(true, 81920);
+            cellular.setSleepMode(true);
+        });
+        simulatedModem.sleep(30);
+        measure("wake() from sleep  ", [](){ cellular.wake(); });
+        Serial.print("Wake latency: "); Serial.print(cellular.getWakeStats().last);
+        Serial.println(" ms (simulated wake-up 30 ms)");
+        measure("connect()          ", [](){ cellular.connect("internet", "", "", false); });
+        measureAsync("connectAsync()     ", [](){ cellular.connectAsync("internet"); });
+        measure("modem HTTPS GET    ", [](){
+            size_t heapBefore = heapInUse();
+            modemHTTPS.get("/");
+            if(modemHTTPS.responseStatusCode() != 200 || modemHTTPS.contentLength() != 13){
+                Serial.println("Unexpected HTTP response!");
+            }
+            uint8_t body[16];
+            while(!modemHTTPS.endOfBodyReached()){
+                modemHTTPS.read(body, sizeof(body));
+            }
+            heapDelta = heapInUse() - heapBefore;
+        });
+        const ConnectionTimings & timings = cellular.getConnectionTimings();
+        Serial.print("Connection phases: SIM "); Serial.print(timings.sim);
+        Serial.print(" ms | registration "); Serial.print(timings.registration);
+        Serial.print(" ms | PDP "); Serial.print(timings.pdp);
+        Serial.print(" ms | DNS "); Serial.print(timings.dns);
+        Serial.print(" ms | retries "); Serial.println(timings.retries);
+#if ARDUINO_CELLULAR_SMS
+        measure("getUnreadSMS()     ", [](){
+            size_t heapBefore = heapInUse();
+            std::vector<SMS> messages = cellular.getUnreadSMS();
+            heapDelta = heapInUse() - heapBefore;
+            if(messages.size() != INBOX_SIZE){
+                Serial.println("Unexpected number of messages!");
+            }
+        });
+        measure("getUnreadSMS(batch)", [](){
+            size_t heapBefore = heapInUse();
+            cellular.getUnreadSMS(smsBatch);
+            heapDelta = heapInUse() - heapBefore;
+            if(smsBatch.size() != INBOX_SIZE){
+                Serial.println("Unexpected number of messages!");
+            }
+        });
+        Serial.print("SMSBatch arena: "); Serial.print(smsBatch.getUsedBytes());
+        Serial.print(" of "); Serial.print(smsBatch.getCapacity()); Serial.println(" B used");
+        measure("syncSMS() first    ", [](){
+            cellular.resetSMSSync();
+            if(cellular.syncSMS(nullptr) != INBOX_SIZE){
+                Serial.println("Unexpected number of messages!");
+            }
+        });
+        measure("syncSMS() unchanged", [](){
+            if(cellular.syncSMS(nullptr) != 0){
+                Serial.println("Unexpected new messages!");
+            }
+        });
+        measure("deleteSMS(50)      ", [](){
+            uint16_t indices[INBOX_SIZE];
+            for(size_t i = 0; i < INBOX_SIZE; i++){
+                indices[i] = i;
+            }
+            cellular.deleteSMS(indices, INBOX_SIZE);
+        });
+#endif
+#if ARDUINO_CELLULAR_GNSS
+        measure("getGPSLocation()   ", [](){ cellular.getGPSLocation(5000); });
+        measure("getGNSSFix() x10   ", [](){
+            GNSSFix fix;
+            for(int i = 0; i < 10; i++){
+                // The first read queries the modem, the others are served from the cache
+                if(!cellular.getGNSSFix(fix, i == 0 ? 0 : 1000)){
+                    Serial.println("No fix!");
+                }
+            }
+        });
+#endif
+        measure("getCellularTime()  ", [](){ cellular.getCellularTime(); });
+        measure("getUNIXTime()      ", [](){ cellular.getUNIXTime(); });
+#if ARDUINO_CELLULAR_SMS
+        measure("sendSMS()          ", [](){ cellular.sendSMS("+393331234567", "Benchmark"); });
+        measure("sendSMS() x5       ", [](){
+            for(const char * number : RECIPIENTS){
+                cellular.sendSMS(number, "Benchmark");
+            }
+        });
+        measure("sendSMSBatch(5)    ", [](){
+            int16_t references[5];
+            if(cellular.sendSMSBatch(RECIPIENTS, 5, "Benchmark", references) != 5){
+                Serial.println("Batch incomplete!");
+            }
+        });
+        measure("sendSMSPDU() 3 seg ", [](){
+            if(cellular.sendSMSPDU("+393331234567", longMessage) != 3){
+                Serial.println("Unexpected number of segments!");
+            }
+        });
+        measureAsync("sendSMSAsync()     ", [](){ cellular.sendSMSAsync("+393331234567", "Benchmark"); });
+#endif
+#if ARDUINO_CELLULAR_GNSS
+        measureAsync("getGPSLocationAsync", [](){
+            cellular.getGPSLocationAsync([](bool success, const Geolocation & location, void * context){}, nullptr, 5000);
+        });
+        measureGNSSStream();
+        measure("uploadXTRA() 4 KB  ", [](){
+            xtraFile.remaining = 4096;
+            if(!cellular.uploadXTRA(xtraFile, 4096)){
+                Serial.println("Upload failed!");
+            }
+        });
+        measure("injectXTRA()       ", [](){ cellular.injectXTRA(); });
+        measure("startGNSS() cold   ", [](){
+            cellular.startGNSS(GNSS_START_COLD);
+            GNSSFix fix;
+            while(!cellular.getGNSSFix(fix)){
+                delay(100);
+            }
+        });
+        const TTFFStats & ttff = cellular.getTTFFStats(GNSS_START_COLD);
+        Serial.print("Cold starts: "); Serial.print(ttff.count);
+        Serial.print(" | TTFF last: "); Serial.print(ttff.last); Serial.print(" ms");
+        Serial.print(" | average: "); Serial.print(ttff.getAverage()); Serial.println(" ms");
+#endif
+#if ARDUINO_CELLULAR_SMS
+        measureAsync("onSMSReceived()    ", [](){
+            awaitingSMS = true;
+            simulatedModem.injectURC("\r\n+CMTI: \"SM\",3\r\n");
+        });
+#endif
+    }
+
+    // Per command statistics of all runs, as they would be reported upstream
+    static char stats[2048];
+    unsigned long start = micros();
+    size_t length = cellular.getStats().serialize(stats, sizeof(stats));
+    unsigned long duration = micros() - start;
+    Serial.print("--- Command statistics: "); Serial.print(length); Serial.print(" B serialized in ");
+    Serial.print(duration); Serial.println(" us ---");
+    Serial.print(stats);
+}
+
+void loop(){
+    delay(1000);
+}
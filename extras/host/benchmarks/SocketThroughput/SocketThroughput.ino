@@ -0,0 +1,97 @@
+/**
+ * This benchmark measures the upload throughput of the BulkSocketClient against a simulated modem.
+ * It compares small chunks that wait for every SEND OK, as a TinyGSM client sends them, with large
+ * chunks, pipelined chunks and transparent access mode at several UART baud rates.
+ *
+ * Instructions:
+ * 1. Run "make benchmark" in extras/host to build and run it on a PC.
+ *
+ * Initial author: Arduino
+*/
+
+#include "ArduinoCellular.h"
+#include "BulkSocketClient.h"
+#include "SimulatedModem.h"
+
+constexpr size_t UPLOAD_SIZE = 64 * 1024;
+constexpr size_t BLOCK_SIZE = 512; // The size of each write() call
+constexpr unsigned long BAUD_RATES[] = { 115200, 460800, 921600 };
+
+struct TransferMode {
+    const char * name;
+    size_t chunkSize;
+    uint8_t pipelineDepth;
+    bool transparent;
+};
+
+const TransferMode MODES[] = {
+    { "512 B chunks, wait SEND OK ", 512, 1, false }, // One +QISEND per write(), like a TinyGSM client
+    { "1460 B chunks, wait SEND OK", 1460, 1, false },
+    { "1460 B chunks, pipeline 4  ", 1460, 4, false },
+    { "transparent mode           ", 0, 1, true }
+};
+
+SimulatedModem simulatedModem(SimulatedModem::EG25);
+ModemInterface simulatedInterface(simulatedModem, -1); // -1: No power pin, no UART to configure
+ArduinoCellular cellular(simulatedInterface);
+
+uint8_t block[BLOCK_SIZE];
+
+void measure(const TransferMode & mode, unsigned long baudRate){
+    BulkSocketOptions options;
+    options.chunkSize = mode.chunkSize;
+    options.pipelineDepth = mode.pipelineDepth;
+    options.transparent = mode.transparent;
+    StaticBulkSocketClient<> client(simulatedInterface, options);
+
+    if(!client.connect("192.0.2.1", 5000)){
+        Serial.println("Could not open the socket!");
+        return;
+    }
+
+    simulatedModem.resetCounters();
+    unsigned long start = micros();
+    for(size_t sent = 0; sent < UPLOAD_SIZE; sent += BLOCK_SIZE){
+        client.write(block, BLOCK_SIZE);
+    }
+    client.flush();
+    unsigned long duration = micros() - start;
+    unsigned long commands = simulatedModem.getCommandCount();
+    unsigned long wireBytes = simulatedModem.getBytesWritten() + simulatedModem.getBytesRead();
+    client.stop();
+
+    // 10 bits per byte on the wire
+    float throughput = UPLOAD_SIZE * 1000.0f / duration;
+    float utilisation = 100.0f * UPLOAD_SIZE * 10.0f / (baudRate * (duration / 1000000.0f));
+
+    Serial.print(mode.name);
+    Serial.print(" | commands: "); Serial.print(commands);
+    Serial.print(" | overhead: "); Serial.print(wireBytes - UPLOAD_SIZE); Serial.print(" B");
+    Serial.print(" | time: "); Serial.print(duration / 1000); Serial.print(" ms");
+    Serial.print(" | "); Serial.print(throughput, 1); Serial.print(" kB/s");
+    Serial.print(" | UART: "); Serial.print(utilisation, 0); Serial.print(" %");
+    Serial.print(" | failures: "); Serial.println(client.getSendFailures());
+}
+
+void setup(){
+    Serial.begin(115200);
+    while (!Serial);
+
+    for(size_t i = 0; i < BLOCK_SIZE; i++){
+        block[i] = static_cast<uint8_t>(i);
+    }
+
+    for(unsigned long baudRate : BAUD_RATES){
+        simulatedModem.setBaudRate(baudRate);
+        Serial.print("--- Upload of "); Serial.print(UPLOAD_SIZE / 1024); Serial.print(" kB to a simulated EG25 at ");
+        Serial.print(baudRate); Serial.println(" baud ---");
+
+        cellular.begin();
+        for(const TransferMode & mode : MODES){
+            measure(mode, baudRate);
+        }
+    }
+}
+
+void loop(){
+}
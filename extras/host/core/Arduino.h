@@ -0,0 +1,258 @@
+/**
+ * @file Arduino.h
+ * @brief A minimal stand-in for the Arduino core, so that the library builds and runs on a PC.
+ *
+ * Only the parts of the core API used by the library, the host tests and the benchmarks exist.
+ * Time is taken from the monotonic clock of the host, Serial writes to the standard output
+ * and the pin functions do nothing.
+ */
+
+#ifndef ARDUINO_CELLULAR_HOST_ARDUINO_H
+#define ARDUINO_CELLULAR_HOST_ARDUINO_H
+
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define INPUT 0
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+#define RISING 3
+#define A0 14
+#define DEC 10
+#define HEX 16
+
+#define F(string) (string)
+#define noInterrupts()
+#define interrupts()
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return static_cast<unsigned long>(duration_cast<microseconds>(steady_clock::now() - start).count());
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(unsigned int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+inline void yield() {}
+
+inline void pinMode(int pin, int mode) {}
+inline void digitalWrite(int pin, int value) {}
+inline int digitalRead(int pin) { return LOW; }
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(int interrupt, void (*handler)(), int mode) {}
+
+inline long random(long max) { return rand() % max; }
+inline long random(long min, long max) { return min + rand() % (max - min); }
+
+class __FlashStringHelper;
+
+class String {
+    public:
+        String() {}
+        String(const char * text) { if (text) value = text; }
+        String(const std::string & text) : value(text) {}
+        String(char c) : value(1, c) {}
+        String(int number, int base = DEC) { format(base == HEX ? "%x" : "%d", number); }
+        String(unsigned int number, int base = DEC) { format(base == HEX ? "%x" : "%u", number); }
+        String(long number) : value(std::to_string(number)) {}
+        String(unsigned long number) : value(std::to_string(number)) {}
+        String(long long number) : value(std::to_string(number)) {}
+        String(double number, int decimals = 2) { format("%.*f", decimals, number); }
+
+        unsigned int length() const { return value.size(); }
+        const char * c_str() const { return value.c_str(); }
+        bool reserve(unsigned int size) { value.reserve(size); return true; }
+        char charAt(unsigned int index) const { return index < value.size() ? value[index] : 0; }
+        char operator[](unsigned int index) const { return charAt(index); }
+
+        int indexOf(char c, unsigned int from = 0) const { return position(value.find(c, from)); }
+        int indexOf(const char * text, unsigned int from = 0) const { return position(value.find(text, from)); }
+        int indexOf(const String & text, unsigned int from = 0) const { return position(value.find(text.value, from)); }
+        int lastIndexOf(char c) const { return position(value.rfind(c)); }
+        int lastIndexOf(char c, int from) const { return from < 0 ? -1 : position(value.rfind(c, from)); }
+
+        String substring(unsigned int from) const { return from > value.size() ? String() : String(value.substr(from)); }
+        String substring(unsigned int from, unsigned int to) const {
+            if (from > to) std::swap(from, to);
+            return from > value.size() ? String() : String(value.substr(from, to - from));
+        }
+
+        long toInt() const { return atol(value.c_str()); }
+        float toFloat() const { return atof(value.c_str()); }
+        bool startsWith(const String & prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+        bool endsWith(const String & suffix) const {
+            return value.size() >= suffix.value.size()
+                && value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+        }
+        bool equals(const String & other) const { return value == other.value; }
+
+        void remove(unsigned int index) { if (index < value.size()) value.erase(index); }
+        void remove(unsigned int index, unsigned int count) { if (index < value.size()) value.erase(index, count); }
+        void trim() {
+            size_t first = value.find_first_not_of(" \r\n\t");
+            size_t last = value.find_last_not_of(" \r\n\t");
+            value = first == std::string::npos ? "" : value.substr(first, last - first + 1);
+        }
+        void toUpperCase() { for (char & c : value) c = toupper(c); }
+
+        bool concat(const String & other) { value += other.value; return true; }
+        bool concat(char c) { value += c; return true; }
+        bool concat(const char * text, unsigned int length) { value.append(text, length); return true; }
+        String & operator+=(const String & other) { value += other.value; return *this; }
+        String & operator+=(const char * text) { value += text; return *this; }
+        String & operator+=(char c) { value += c; return *this; }
+        String & operator+=(int number) { value += std::to_string(number); return *this; }
+
+        bool operator==(const String & other) const { return value == other.value; }
+        bool operator==(const char * text) const { return value == text; }
+        bool operator!=(const String & other) const { return value != other.value; }
+        bool operator!=(const char * text) const { return value != text; }
+
+        friend String operator+(const String & a, const String & b) { return String(a.value + b.value); }
+        friend String operator+(const String & a, const char * b) { return String(a.value + b); }
+        friend String operator+(const char * a, const String & b) { return String(a + b.value); }
+        friend String operator+(const String & a, char b) { return String(a.value + b); }
+        friend String operator+(const String & a, int b) { return String(a.value + std::to_string(b)); }
+
+    private:
+        template<typename... Args> void format(const char * format, Args... args) {
+            char buffer[64];
+            snprintf(buffer, sizeof(buffer), format, args...);
+            value = buffer;
+        }
+
+        static int position(size_t index) { return index == std::string::npos ? -1 : static_cast<int>(index); }
+
+        std::string value;
+};
+
+class Print {
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t * buffer, size_t size) {
+            size_t written = 0;
+            while (size--) written += write(*buffer++);
+            return written;
+        }
+        size_t write(const char * text) { return write(reinterpret_cast<const uint8_t *>(text), strlen(text)); }
+        size_t write(const char * buffer, size_t size) { return write(reinterpret_cast<const uint8_t *>(buffer), size); }
+        virtual int availableForWrite() { return 0; }
+        virtual void flush() {}
+
+        size_t print(const char * text) { return write(text); }
+        size_t print(const __FlashStringHelper * text) { return write(reinterpret_cast<const char *>(text)); }
+        size_t print(const String & text) { return write(text.c_str()); }
+        size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+        size_t print(int number, int base = DEC) { return print(String(number, base)); }
+        size_t print(unsigned int number, int base = DEC) { return print(String(number, base)); }
+        size_t print(long number, int base = DEC) { return print(String(number)); }
+        size_t print(unsigned long number, int base = DEC) { return print(String(number)); }
+        size_t print(long long number) { return print(String(number)); }
+        size_t print(double number, int decimals = 2) { return print(String(number, decimals)); }
+
+        size_t println() { return print("\r\n"); }
+        template<typename T> size_t println(T value) { return print(value) + println(); }
+        template<typename T> size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+class Stream : public Print {
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+
+        void setTimeout(unsigned long timeout) { this->timeout = timeout; }
+        size_t readBytes(char * buffer, size_t size) {
+            size_t count = 0;
+            while (count < size) {
+                int c = timedRead();
+                if (c < 0) break;
+                buffer[count++] = static_cast<char>(c);
+            }
+            return count;
+        }
+        size_t readBytes(uint8_t * buffer, size_t size) { return readBytes(reinterpret_cast<char *>(buffer), size); }
+        String readStringUntil(char terminator) {
+            String result;
+            for (int c = timedRead(); c >= 0 && c != terminator; c = timedRead()) result += static_cast<char>(c);
+            return result;
+        }
+
+    protected:
+        int timedRead() {
+            unsigned long start = millis();
+            do {
+                int c = read();
+                if (c >= 0) return c;
+            } while (millis() - start < timeout);
+            return -1;
+        }
+
+        unsigned long timeout = 1000;
+};
+
+class IPAddress {
+    public:
+        IPAddress() {}
+        IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{ a, b, c, d } {}
+        uint8_t operator[](int index) const { return octets[index]; }
+        String toString() const {
+            char buffer[16];
+            snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+            return String(buffer);
+        }
+
+    private:
+        uint8_t octets[4] = { 0, 0, 0, 0 };
+};
+
+class Client : public Stream {
+    public:
+        virtual int connect(IPAddress ip, uint16_t port) = 0;
+        virtual int connect(const char * host, uint16_t port) = 0;
+        virtual uint8_t connected() = 0;
+        virtual void stop() = 0;
+        virtual operator bool() { return true; }
+        virtual int read(uint8_t * buffer, size_t size) {
+            size_t count = 0;
+            while (count < size && available()) buffer[count++] = read();
+            return count;
+        }
+        using Stream::read;
+};
+
+namespace arduino {
+    /**
+     * @brief A serial port that writes to the standard output and never receives anything.
+     */
+    class HardwareSerial : public Stream {
+        public:
+            void begin(unsigned long baudRate) {}
+            int available() override { return 0; }
+            int read() override { return -1; }
+            int peek() override { return -1; }
+            size_t write(uint8_t c) override { return putchar(c) == EOF ? 0 : 1; }
+            using Print::write;
+            operator bool() { return true; }
+    };
+}
+
+typedef arduino::HardwareSerial HardwareSerial;
+
+extern HardwareSerial Serial;
+
+#endif
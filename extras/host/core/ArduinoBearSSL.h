@@ -0,0 +1,42 @@
+/**
+ * @file ArduinoBearSSL.h
+ * @brief A stand-in for ArduinoBearSSL, so that the library builds on a PC.
+ *
+ * The client passes everything through to the underlying client without encryption.
+ */
+
+#ifndef ARDUINO_CELLULAR_HOST_ARDUINO_BEAR_SSL_H
+#define ARDUINO_CELLULAR_HOST_ARDUINO_BEAR_SSL_H
+
+#include <Arduino.h>
+
+class BearSSLClient : public Client {
+    public:
+        BearSSLClient(Client & client) : client(&client) {}
+        int connect(IPAddress ip, uint16_t port) override { return client->connect(ip, port); }
+        int connect(const char * host, uint16_t port) override { return client->connect(host, port); }
+        uint8_t connected() override { return client->connected(); }
+        void stop() override { client->stop(); }
+        int available() override { return client->available(); }
+        int read() override { return client->read(); }
+        int peek() override { return client->peek(); }
+        size_t write(uint8_t c) override { return client->write(c); }
+        using Print::write;
+        using Client::read;
+
+    private:
+        Client * client;
+};
+
+class ArduinoBearSSLClass {
+    public:
+        void onGetTime(unsigned long (*function)()) { getTimeFunction = function; }
+        unsigned long getTime() { return getTimeFunction ? getTimeFunction() : 0; }
+
+    private:
+        unsigned long (*getTimeFunction)() = nullptr;
+};
+
+extern ArduinoBearSSLClass ArduinoBearSSL;
+
+#endif
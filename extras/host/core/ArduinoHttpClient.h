@@ -0,0 +1,53 @@
+/**
+ * @file ArduinoHttpClient.h
+ * @brief A stand-in for ArduinoHttpClient, so that the library builds on a PC.
+ *
+ * Only the constants and the construction of HttpClient exist, requests are not implemented.
+ */
+
+#ifndef ARDUINO_CELLULAR_HOST_ARDUINO_HTTP_CLIENT_H
+#define ARDUINO_CELLULAR_HOST_ARDUINO_HTTP_CLIENT_H
+
+#include <Arduino.h>
+
+static const int HTTP_SUCCESS = 0;
+static const int HTTP_ERROR_CONNECTION_FAILED = -1;
+static const int HTTP_ERROR_API = -2;
+static const int HTTP_ERROR_TIMED_OUT = -3;
+static const int HTTP_ERROR_INVALID_RESPONSE = -4;
+
+#define HTTP_METHOD_GET "GET"
+#define HTTP_METHOD_POST "POST"
+#define HTTP_HEADER_CONTENT_LENGTH "Content-Length"
+#define HTTP_HEADER_CONTENT_TYPE "Content-Type"
+#define HTTP_HEADER_USER_AGENT "User-Agent"
+
+class HttpClient : public Client {
+    public:
+        static const int kNoContentLengthHeader = -1;
+        static const int kHttpPort = 80;
+        static const int kHttpsPort = 443;
+
+        HttpClient(Client & client, const char * server, uint16_t port = kHttpPort) : client(&client), server(server), port(port) {}
+        HttpClient(Client & client, const String & server, uint16_t port = kHttpPort) : HttpClient(client, server.c_str(), port) {}
+
+        void connectionKeepAlive() {}
+
+        int connect(IPAddress ip, uint16_t port) override { return client->connect(ip, port); }
+        int connect(const char * host, uint16_t port) override { return client->connect(host, port); }
+        uint8_t connected() override { return client->connected(); }
+        void stop() override { client->stop(); }
+        int available() override { return client->available(); }
+        int read() override { return client->read(); }
+        int peek() override { return client->peek(); }
+        size_t write(uint8_t c) override { return client->write(c); }
+        using Print::write;
+        using Client::read;
+
+    private:
+        Client * client;
+        const char * server;
+        uint16_t port;
+};
+
+#endif
@@ -0,0 +1,5 @@
+#include <Arduino.h>
+#include <ArduinoBearSSL.h>
+
+HardwareSerial Serial;
+ArduinoBearSSLClass ArduinoBearSSL;
@@ -0,0 +1,11 @@
+/**
+ * @file StreamDebugger.h
+ * @brief A stand-in for StreamDebugger, so that the library builds on a PC.
+ */
+
+#ifndef ARDUINO_CELLULAR_HOST_STREAM_DEBUGGER_H
+#define ARDUINO_CELLULAR_HOST_STREAM_DEBUGGER_H
+
+#include <Arduino.h>
+
+#endif
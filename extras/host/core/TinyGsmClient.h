@@ -0,0 +1,268 @@
+/**
+ * @file TinyGsmClient.h
+ * @brief A stand-in for the TinyGSM BG96 driver, so that the library builds and runs on a PC.
+ *
+ * It sends the few commands the library leaves to TinyGSM (initialization, SIM, registration,
+ * PDP context, location and time) in the same way, with simplified response handling, so that
+ * the library can be run against the SimulatedModem. Sockets are placeholders that never transfer data.
+ */
+
+#ifndef ARDUINO_CELLULAR_HOST_TINY_GSM_CLIENT_H
+#define ARDUINO_CELLULAR_HOST_TINY_GSM_CLIENT_H
+
+#include <Arduino.h>
+
+#define GF(x) x
+#define GFP(x) x
+#define GSM_NL "\r\n"
+#define GSM_OK "OK" GSM_NL
+#define GSM_ERROR "ERROR" GSM_NL
+#define TINY_GSM_MUX_COUNT 12
+
+typedef const char * GsmConstStr;
+
+enum SimStatus {
+    SIM_ERROR = 0,
+    SIM_READY = 1,
+    SIM_LOCKED = 2,
+    SIM_ANTITHEFT_LOCKED = 3
+};
+
+class TinyGsmBG96 {
+    public:
+        class GsmClientBG96 : public Client {
+            public:
+                GsmClientBG96() {}
+                GsmClientBG96(TinyGsmBG96 & modem, uint8_t mux = 0) : at(&modem), mux(mux) {}
+                bool init(TinyGsmBG96 * modem, uint8_t mux = 0) { at = modem; this->mux = mux; return true; }
+                int connect(IPAddress ip, uint16_t port) override { sock_connected = true; return 1; }
+                int connect(const char * host, uint16_t port) override { sock_connected = true; return 1; }
+                uint8_t connected() override { return sock_connected; }
+                void stop() override { sock_connected = false; }
+                void stop(uint32_t maxWaitMs) { stop(); }
+                int available() override { return 0; }
+                int read() override { return -1; }
+                int peek() override { return -1; }
+                size_t write(uint8_t c) override { return 1; }
+                using Print::write;
+                using Client::read;
+
+                TinyGsmBG96 * at = nullptr;
+                uint8_t mux = 0;
+                bool sock_connected = false;
+                bool got_data = false;
+        };
+
+        explicit TinyGsmBG96(Stream & stream) : stream(stream) {}
+
+        template<typename... Args> void sendAT(Args... command) {
+            stream.print("AT");
+            int unused[] = { 0, (stream.print(command), 0)... };
+            (void)unused;
+            stream.print(GSM_NL);
+            stream.flush();
+        }
+
+        int8_t waitResponse(uint32_t timeout, String & data, GsmConstStr r1 = GSM_OK, GsmConstStr r2 = GSM_ERROR,
+                            GsmConstStr r3 = "+CME ERROR:", GsmConstStr r4 = "+CMS ERROR:", GsmConstStr r5 = nullptr) {
+            GsmConstStr expected[] = { r1, r2, r3, r4, r5 };
+            unsigned long start = millis();
+            do {
+                while (stream.available() > 0) {
+                    int c = stream.read();
+                    if (c <= 0) continue;
+                    data += static_cast<char>(c);
+                    for (int8_t i = 0; i < 5; i++) {
+                        if (expected[i] && data.endsWith(expected[i])) return i + 1;
+                    }
+                }
+            } while (millis() - start < timeout);
+            data = "";
+            return 0;
+        }
+
+        int8_t waitResponse(uint32_t timeout, GsmConstStr r1 = GSM_OK, GsmConstStr r2 = GSM_ERROR,
+                            GsmConstStr r3 = "+CME ERROR:", GsmConstStr r4 = "+CMS ERROR:", GsmConstStr r5 = nullptr) {
+            String data;
+            return waitResponse(timeout, data, r1, r2, r3, r4, r5);
+        }
+
+        int8_t waitResponse(GsmConstStr r1 = GSM_OK, GsmConstStr r2 = GSM_ERROR,
+                            GsmConstStr r3 = "+CME ERROR:", GsmConstStr r4 = "+CMS ERROR:", GsmConstStr r5 = nullptr) {
+            return waitResponse(1000, r1, r2, r3, r4, r5);
+        }
+
+        bool testAT(uint32_t timeout = 10000) {
+            for (unsigned long start = millis(); millis() - start < timeout; delay(100)) {
+                sendAT("");
+                if (waitResponse(200) == 1) return true;
+            }
+            return false;
+        }
+
+        bool init(const char * pin = nullptr) {
+            if (!testAT()) return false;
+            sendAT("E0");
+            if (waitResponse() != 1) return false;
+            sendAT("+CMEE=0");
+            waitResponse();
+            sendAT("+CTZR=0");
+            waitResponse();
+            sendAT("+CTZU=1");
+            waitResponse();
+            return true;
+        }
+
+        bool restart(const char * pin = nullptr) { return init(pin); }
+        String getModemName() { return "BG96"; }
+
+        SimStatus getSimStatus(uint32_t timeout = 10000) {
+            sendAT("+CPIN?");
+            if (waitResponse("+CPIN:") != 1) return SIM_ERROR;
+            int8_t status = waitResponse("READY", "SIM PIN", "SIM PUK", "NOT INSERTED", "NOT READY");
+            waitResponse();
+            return status == 1 ? SIM_READY : (status == 2 || status == 3) ? SIM_LOCKED : SIM_ERROR;
+        }
+
+        bool simUnlock(const char * pin) {
+            sendAT("+CPIN=\"", pin, "\"");
+            return waitResponse() == 1;
+        }
+
+        bool isNetworkConnected() {
+            sendAT("+CEREG?");
+            String data;
+            if (waitResponse(1000, data) != 1) return false;
+            return data.indexOf(",1") >= 0 || data.indexOf(",5") >= 0;
+        }
+
+        bool waitForNetwork(uint32_t timeout = 60000L, bool checkSignal = false) {
+            for (unsigned long start = millis(); millis() - start < timeout; delay(250)) {
+                if (isNetworkConnected()) return true;
+            }
+            return false;
+        }
+
+        bool gprsConnect(const char * apn, const char * user = nullptr, const char * password = nullptr) {
+            sendAT("+QIDEACT=1");
+            waitResponse();
+            sendAT("+QICSGP=1,1,\"", apn, "\",\"", user ? user : "", "\",\"", password ? password : "", "\"");
+            if (waitResponse() != 1) return false;
+            sendAT("+QIACT=1");
+            if (waitResponse(150000L) != 1) return false;
+            sendAT("+CGATT=1");
+            return waitResponse(60000L) == 1;
+        }
+
+        bool isGprsConnected() {
+            sendAT("+CGATT?");
+            return waitResponse() == 1;
+        }
+
+        IPAddress localIP() { return IPAddress(); }
+
+        int16_t getSignalQuality() {
+            sendAT("+CSQ");
+            String data;
+            waitResponse(1000, data);
+            int field = data.indexOf("+CSQ: ");
+            return field < 0 ? 99 : atoi(data.c_str() + field + 6);
+        }
+
+        String sendUSSD(const String & code) {
+            sendAT("+CUSD=1,\"", code.c_str(), "\"");
+            String data;
+            waitResponse(10000, data);
+            return data;
+        }
+
+        bool enableGPS() {
+            sendAT("+QGPS=1");
+            return waitResponse() == 1;
+        }
+
+        bool disableGPS() {
+            sendAT("+QGPSEND");
+            return waitResponse() == 1;
+        }
+
+        bool getGPS(float * latitude, float * longitude, float * speed = nullptr, float * altitude = nullptr,
+                    int * visibleSatellites = nullptr, int * usedSatellites = nullptr, float * accuracy = nullptr,
+                    int * year = nullptr, int * month = nullptr, int * day = nullptr,
+                    int * hour = nullptr, int * minute = nullptr, int * second = nullptr) {
+            sendAT("+QGPSLOC=2");
+            String data;
+            if (waitResponse(1000, data, GSM_NL "+QGPSLOC:") != 1) return false;
+            String line = stream.readStringUntil('\n');
+            waitResponse();
+            int time = line.indexOf(',');
+            int latitudeEnd = line.indexOf(',', time + 1);
+            int longitudeEnd = line.indexOf(',', latitudeEnd + 1);
+            *latitude = line.substring(time + 1, latitudeEnd).toFloat();
+            *longitude = line.substring(latitudeEnd + 1, longitudeEnd).toFloat();
+            return true;
+        }
+
+        bool getGPSTime(int * year, int * month, int * day, int * hour, int * minute, int * second) {
+            sendAT("+QGPSLOC=2");
+            String data;
+            if (waitResponse(1000, data, GSM_NL "+QGPSLOC:") != 1) return false;
+            String line = stream.readStringUntil('\n');
+            waitResponse();
+            // <hhmmss.sss>,...,<ddmmyy>,<satellites>
+            int date = line.lastIndexOf(',', line.lastIndexOf(',') - 1) + 1;
+            int time = line.indexOf(':') + 1;
+            while (line.charAt(time) == ' ') time++;
+            *hour = line.substring(time, time + 2).toInt();
+            *minute = line.substring(time + 2, time + 4).toInt();
+            *second = line.substring(time + 4, time + 6).toInt();
+            *day = line.substring(date, date + 2).toInt();
+            *month = line.substring(date + 2, date + 4).toInt();
+            *year = line.substring(date + 4, date + 6).toInt() + 2000;
+            return true;
+        }
+
+        bool getNetworkTime(int * year, int * month, int * day, int * hour, int * minute, int * second, float * timezone) {
+            sendAT("+CCLK?");
+            String data;
+            if (waitResponse(2000, data, "+CCLK: \"") != 1) return false;
+            String time = stream.readStringUntil('"');
+            waitResponse();
+            *year = time.substring(0, 2).toInt() + 2000;
+            *month = time.substring(3, 5).toInt();
+            *day = time.substring(6, 8).toInt();
+            *hour = time.substring(9, 11).toInt();
+            *minute = time.substring(12, 14).toInt();
+            *second = time.substring(15, 17).toInt();
+            *timezone = time.substring(17).toInt() / 4.0f;
+            return true;
+        }
+
+        byte NTPServerSync(String server = "pool.ntp.org", byte timezone = 0) {
+            sendAT("+QNTP=1,\"", server.c_str(), "\"");
+            return waitResponse(10000) == 1 ? 0 : 1;
+        }
+
+        Stream & stream;
+        GsmClientBG96 * sockets[TINY_GSM_MUX_COUNT] = {};
+
+    protected:
+        bool handleURCs(String & data) {
+            if (!data.endsWith(GSM_NL "+QIURC:")) return false;
+            // +QIURC: "<recv|closed>",<mux>
+            stream.readStringUntil('"');
+            String urc = stream.readStringUntil('"');
+            stream.readStringUntil(',');
+            int mux = stream.readStringUntil('\n').toInt();
+            if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+                if (urc == "recv") sockets[mux]->got_data = true;
+                if (urc == "closed") sockets[mux]->sock_connected = false;
+            }
+            data = "";
+            return true;
+        }
+};
+
+typedef TinyGsmBG96::GsmClientBG96 TinyGsmClient;
+
+#endif
@@ -0,0 +1,86 @@
+#include "HostTest.h"
+#include <ATCommandMonitor.h>
+
+namespace {
+
+// A modem that discards what is written and answers with the response set last
+class ScriptedModem : public Stream {
+    public:
+        void respond(const char * text) { response = text; }
+        int available() override { return strlen(response); }
+        int read() override { return *response ? static_cast<uint8_t>(*response++) : -1; }
+        int peek() override { return *response ? static_cast<uint8_t>(*response) : -1; }
+        size_t write(uint8_t c) override { return 1; }
+        using Print::write;
+
+    private:
+        const char * response = "";
+};
+
+void exchange(ATCommandMonitor & monitor, ScriptedModem & modem, const char * command, const char * response) {
+    monitor.print(command);
+    modem.respond(response);
+    while (monitor.read() >= 0) {
+    }
+}
+
+}
+
+TEST_CASE(skipsTheAnnouncedPayloadOfQISEND) {
+    ScriptedModem modem;
+    ATCommandMonitor monitor(modem);
+
+    // The payload looks like a command line but belongs to +QISEND
+    exchange(monitor, modem, "AT+QISEND=0,10\r\n", "> ");
+    exchange(monitor, modem, "AT+CSQ\r\nAB", "\r\nSEND OK\r\n");
+
+    const ATCommandStats & stats = monitor.getStats();
+    CHECK_EQUAL(stats.getEntryCount(), 1U);
+    const ATCommandStats::Entry * send = stats.find("AT+QISEND");
+    CHECK(send != nullptr);
+    CHECK_EQUAL(send->count, 1U);
+    CHECK_EQUAL(send->timeouts, 0U);
+    CHECK_EQUAL(send->bytesSent, 26U);
+    CHECK_EQUAL(send->bytesReceived, 13U);
+    CHECK(stats.find("AT+CSQ") == nullptr);
+}
+
+TEST_CASE(skipsTheAnnouncedPayloadOfQFUPL) {
+    ScriptedModem modem;
+    ATCommandMonitor monitor(modem);
+
+    exchange(monitor, modem, "AT+QFUPL=\"UFS:a.txt\",8,5\r\n", "\r\nCONNECT\r\n");
+    exchange(monitor, modem, "AT+CSQ\r\n", "\r\n+QFUPL: 8,1a2b\r\n\r\nOK\r\n");
+    exchange(monitor, modem, "AT+CSQ\r\n", "\r\n+CSQ: 24,99\r\n\r\nOK\r\n");
+
+    const ATCommandStats & stats = monitor.getStats();
+    CHECK_EQUAL(stats.find("AT+QFUPL")->count, 1U);
+    CHECK_EQUAL(stats.find("AT+QFUPL")->bytesSent, 34U);
+    CHECK_EQUAL(stats.find("AT+CSQ")->count, 1U);
+    CHECK_EQUAL(stats.find("AT+CSQ")->timeouts, 0U);
+}
+
+TEST_CASE(countsCommandsWithoutResultAsTimeouts) {
+    ScriptedModem modem;
+    ATCommandMonitor monitor(modem);
+
+    exchange(monitor, modem, "AT+CSQ\r\n", "");
+    exchange(monitor, modem, "AT+CSQ\r\n", "\r\n+CSQ: 24,99\r\n\r\nOK\r\n");
+    exchange(monitor, modem, "AT+CPIN?\r\n", "\r\n+CME ERROR: 10\r\n");
+    exchange(monitor, modem, "", "\r\n+CMTI: \"SM\",1\r\n");
+    CHECK_EQUAL(monitor.getStats().getUnsolicitedBytes(), 17U);
+
+    // A +QISEND whose payload was written may be pipelined
+    exchange(monitor, modem, "AT+QISEND=0,2\r\n", "> ");
+    exchange(monitor, modem, "ab", "");
+    exchange(monitor, modem, "AT+QISEND=0,2\r\n", "> ");
+    exchange(monitor, modem, "cd", "\r\nSEND OK\r\n\r\nSEND OK\r\n");
+
+    const ATCommandStats & stats = monitor.getStats();
+    CHECK_EQUAL(stats.find("AT+CSQ")->count, 2U);
+    CHECK_EQUAL(stats.find("AT+CSQ")->timeouts, 1U);
+    CHECK_EQUAL(stats.find("AT+CPIN")->errors, 1U);
+    CHECK_EQUAL(stats.find("AT+CPIN")->timeouts, 0U);
+    CHECK_EQUAL(stats.find("AT+QISEND")->count, 2U);
+    CHECK_EQUAL(stats.find("AT+QISEND")->timeouts, 0U);
+}
@@ -0,0 +1,61 @@
+#include "HostTest.h"
+#include <ATCommandStats.h>
+
+TEST_CASE(sortsLatenciesIntoDoublingBuckets) {
+    CHECK_EQUAL(ATCommandStats::getBucket(0), 0U);
+    CHECK_EQUAL(ATCommandStats::getBucket(1), 1U);
+    CHECK_EQUAL(ATCommandStats::getBucket(2), 2U);
+    CHECK_EQUAL(ATCommandStats::getBucket(3), 2U);
+    CHECK_EQUAL(ATCommandStats::getBucket(4), 3U);
+    CHECK_EQUAL(ATCommandStats::getBucket(16383), 14U);
+    CHECK_EQUAL(ATCommandStats::getBucket(16384), 15U);
+    CHECK_EQUAL(ATCommandStats::getBucket(32768), 15U);
+    CHECK_EQUAL(ATCommandStats::getBucket(0xFFFFFFFFUL), ATCommandStats::bucketCount - 1);
+}
+
+TEST_CASE(collectsCommandsBeyondTheSlotsUnderAStar) {
+    ATCommandStats stats;
+    char name[8];
+    for (size_t i = 0; i < ATCommandStats::slotCount + 2; i++) {
+        snprintf(name, sizeof(name), "AT+C%u", static_cast<unsigned int>(i));
+        stats.record(name, strlen(name)).count++;
+    }
+    CHECK_EQUAL(stats.getEntryCount(), ATCommandStats::slotCount);
+    CHECK(stats.find("AT+C0") != nullptr);
+    CHECK(stats.find(name) == nullptr);
+    CHECK_EQUAL(stats.find("*")->count, 3U);
+
+    // Names are truncated, and a command that already has a slot keeps it
+    stats.record("AT+C0=1", 5).count++;
+    CHECK_EQUAL(stats.find("AT+C0")->count, 2U);
+    CHECK_EQUAL(static_cast<const char *>(stats.record("AT+QABCDEFGHIJKLMNOPQRSTUVWXYZ", 30).command), "*");
+}
+
+TEST_CASE(serializesOneLinePerCommand) {
+    ATCommandStats stats;
+    stats.addUnsolicitedBytes(12);
+    ATCommandStats::Entry & csq = stats.record("AT+CSQ", 6);
+    csq.count = 3;
+    csq.timeouts = 1;
+    csq.bytesSent = 24;
+    csq.bytesReceived = 60;
+    csq.totalLatency = 40;
+    csq.maxLatency = 30;
+    csq.histogram[ATCommandStats::getBucket(10)] = 1;
+    csq.histogram[ATCommandStats::getBucket(30)] = 1;
+    ATCommandStats::Entry & cpin = stats.record("AT+CPIN", 7);
+    cpin.count = 1;
+    cpin.errors = 1;
+    CHECK_EQUAL(csq.getAverageLatency(), 20U);
+    CHECK_EQUAL(cpin.getAverageLatency(), 0U);
+
+    const char expected[] = "ATSTATS 1 16 12\nAT+CSQ 3 1 0 24 60 40 30 0,0,0,0,1,1\nAT+CPIN 1 0 1 0 0 0 0\n";
+    char text[128];
+    CHECK_EQUAL(stats.serialize(text, sizeof(text)), strlen(expected));
+    CHECK_EQUAL(static_cast<const char *>(text), expected);
+
+    // A truncated text is terminated, and the length tells the size needed
+    CHECK_EQUAL(stats.serialize(text, 10), strlen(expected));
+    CHECK_EQUAL(static_cast<const char *>(text), "ATSTATS 1");
+    CHECK_EQUAL(stats.serialize(nullptr, 0), strlen(expected));
+}
@@ -0,0 +1,157 @@
+#include "HostTest.h"
+#include <HTTPClientPool.h>
+#include <TranscriptPlayer.h>
+
+#include <utility>
+
+namespace {
+
+// Opens the connection of a lease and returns it to the pool, a millisecond later than the previous one
+void useAndRelease(PooledHTTPClient & lease) {
+    lease->connect("example.com", 80);
+    delay(2);
+    lease.release();
+}
+
+}
+
+TEST_CASE(reusesTheOpenConnectionOfAServer) {
+    TranscriptPlayer player("");
+    TinyGsmBG96 modem(player);
+    HTTPClientPool pool(modem);
+
+    PooledHTTPClient first = pool.acquire("example.com", 80, false);
+    CHECK(first.isValid());
+    HttpClient * client = &*first;
+    useAndRelease(first);
+    CHECK(!first.isValid());
+
+    PooledHTTPClient second = pool.acquire("example.com", 80, false);
+    CHECK(&*second == client);
+    CHECK(second->connected());
+    CHECK_EQUAL(pool.getReusedCount(), 1U);
+
+    // Another port is another server
+    PooledHTTPClient other = pool.acquire("example.com", 8080, false);
+    CHECK(other.isValid());
+    CHECK(&*other != client);
+    CHECK_EQUAL(pool.getReusedCount(), 1U);
+}
+
+TEST_CASE(reassignsTheLeastRecentlyUsedSlot) {
+    TranscriptPlayer player("");
+    TinyGsmBG96 modem(player);
+    HTTPClientPool pool(modem);
+
+    PooledHTTPClient first = pool.acquire("first.example.com", 80, false);
+    HttpClient * firstClient = &*first;
+    useAndRelease(first);
+    PooledHTTPClient second = pool.acquire("second.example.com", 80, false);
+    useAndRelease(second);
+
+    PooledHTTPClient third = pool.acquire("third.example.com", 80, false);
+    CHECK(&*third == firstClient);
+    CHECK(!third->connected());
+    useAndRelease(third);
+
+    PooledHTTPClient again = pool.acquire("second.example.com", 80, false);
+    CHECK(again->connected());
+    CHECK_EQUAL(pool.getReusedCount(), 1U);
+}
+
+TEST_CASE(leasesEachClientOnce) {
+    TranscriptPlayer player("");
+    TinyGsmBG96 modem(player);
+    HTTPClientPool pool(modem);
+
+    PooledHTTPClient first = pool.acquire("example.com", 80, false);
+    PooledHTTPClient second = pool.acquire("example.com", 80, false);
+    CHECK(second.isValid());
+    CHECK(&*first != &*second);
+    CHECK(!pool.acquire("example.com", 80, false).isValid());
+
+    char longName[HTTPClientPool::maxHostLength + 2];
+    memset(longName, 'a', sizeof(longName) - 1);
+    longName[sizeof(longName) - 1] = '\0';
+    second.release();
+    CHECK(!pool.acquire(longName, 80, false).isValid());
+}
+
+TEST_CASE(releasesTheClientWithTheLease) {
+    TranscriptPlayer player("");
+    TinyGsmBG96 modem(player);
+    HTTPClientPool pool(modem);
+
+    PooledHTTPClient first = pool.acquire("example.com", 80, false);
+    {
+        PooledHTTPClient second = pool.acquire("example.com", 80, false);
+        CHECK(!pool.acquire("example.com", 80, false).isValid());
+    }
+    PooledHTTPClient third = pool.acquire("example.com", 80, false);
+    CHECK(third.isValid());
+
+    // A move hands the client over, assigning over a lease releases its client
+    HttpClient * client = &*first;
+    PooledHTTPClient moved(std::move(first));
+    CHECK(!first.isValid());
+    CHECK(&*moved == client);
+    third = std::move(moved);
+    CHECK(&*third == client);
+    CHECK(pool.acquire("example.com", 80, false).isValid());
+}
+
+TEST_CASE(reclaimsSocketsClosedByTheServer) {
+    TranscriptPlayer player("");
+    TinyGsmBG96 modem(player);
+    HTTPClientPool pool(modem);
+
+    PooledHTTPClient first = pool.acquire("first.example.com", 80, false);
+    PooledHTTPClient second = pool.acquire("second.example.com", 80, false);
+    HttpClient * idle = &*first;
+    useAndRelease(first);
+    second->connect("second.example.com", 80);
+    CHECK_EQUAL(pool.reclaim(), 0U);
+
+    // The sockets closed by the server meanwhile, only the free one is released
+    idle->stop();
+    second->stop();
+    CHECK_EQUAL(pool.reclaim(), 1U);
+    CHECK_EQUAL(pool.reclaim(), 0U);
+
+    // The client reconnects instead of counting as reused
+    PooledHTTPClient again = pool.acquire("first.example.com", 80, false);
+    CHECK(&*again == idle);
+    CHECK_EQUAL(pool.getReusedCount(), 0U);
+}
+
+TEST_CASE(sharesPinnedSlotsWithoutReusingTheirConnection) {
+    TranscriptPlayer player("");
+    TinyGsmBG96 modem(player);
+    HTTPClientPool pool(modem);
+
+    Client & first = pool.pin("first.example.com", 80, false);
+    Client & second = pool.pin("second.example.com", 80, false);
+    CHECK(&first != &second);
+    CHECK(&pool.pin("first.example.com", 80, false) == &first);
+
+    // Pinned slots are reassigned like free ones, the least recently pinned first
+    delay(2);
+    pool.pin("second.example.com", 80, false);
+    Client & third = pool.pin("third.example.com", 80, false);
+    CHECK(&third == &first);
+    CHECK(third.connect("third.example.com", 80) == 1);
+
+    // A lease does not trust the connection the pinned client left open
+    PooledHTTPClient lease = pool.acquire("third.example.com", 80, false);
+    CHECK(lease.isValid());
+    CHECK(!third.connected());
+    CHECK_EQUAL(pool.getReusedCount(), 0U);
+
+    // While every slot is leased, the pinned client cannot connect
+    PooledHTTPClient other = pool.acquire("other.example.com", 80, false);
+    CHECK(other.isValid());
+    Client & unavailable = pool.pin("fourth.example.com", 80, false);
+    CHECK(&unavailable != &first && &unavailable != &second);
+    CHECK(unavailable.connect("fourth.example.com", 80) == 0);
+    CHECK(!unavailable);
+}
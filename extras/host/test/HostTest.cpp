@@ -0,0 +1,56 @@
+#include "HostTest.h"
+
+namespace {
+
+HostTest::TestCase * firstCase = nullptr;
+HostTest::TestCase * lastCase = nullptr;
+unsigned failures = 0;
+
+}
+
+namespace HostTest {
+
+Registration::Registration(TestCase & testCase) {
+    // Static initialization runs file by file, the cases keep their order within a file
+    if (lastCase) {
+        lastCase->next = &testCase;
+    } else {
+        firstCase = &testCase;
+    }
+    lastCase = &testCase;
+}
+
+void fail(const char * file, int line, const char * expression) {
+    printf("%s:%d: CHECK(%s) failed\n", file, line, expression);
+    failures++;
+}
+
+void failEqual(const char * file, int line, const char * expression, long long actual, long long expected) {
+    printf("%s:%d: CHECK_EQUAL(%s) failed: %lld != %lld\n", file, line, expression, actual, expected);
+    failures++;
+}
+
+void failEqual(const char * file, int line, const char * expression, const char * actual, const char * expected) {
+    printf("%s:%d: CHECK_EQUAL(%s) failed: \"%s\" != \"%s\"\n", file, line, expression, actual, expected);
+    failures++;
+}
+
+void checkEqual(const char * file, int line, const char * expression, const char * actual, const char * expected) {
+    if (strcmp(actual, expected) != 0) {
+        failEqual(file, line, expression, actual, expected);
+    }
+}
+
+}
+
+int main() {
+    unsigned count = 0;
+    for (HostTest::TestCase * testCase = firstCase; testCase; testCase = testCase->next) {
+        unsigned failuresBefore = failures;
+        testCase->function();
+        printf("%s %s\n", failures == failuresBefore ? "PASS" : "FAIL", testCase->name);
+        count++;
+    }
+    printf("%u test cases, %u failed checks\n", count, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file HostTest.h
+ * @brief A minimal test harness for the host tests.
+ *
+ * Each TEST_CASE registers itself and is run by main(). CHECK and CHECK_EQUAL report
+ * the failing expression and its location and let the test case continue.
+ */
+
+#ifndef ARDUINO_CELLULAR_HOST_TEST_H
+#define ARDUINO_CELLULAR_HOST_TEST_H
+
+#include <Arduino.h>
+
+namespace HostTest {
+    struct TestCase {
+        const char * name;
+        void (*function)();
+        TestCase * next;
+    };
+
+    /**
+     * @brief Adds a test case to the list run by main().
+     */
+    struct Registration {
+        Registration(TestCase & testCase);
+    };
+
+    /**
+     * @brief Records a failed check.
+     */
+    void fail(const char * file, int line, const char * expression);
+
+    /**
+     * @brief Records a failed comparison and prints both values.
+     */
+    void failEqual(const char * file, int line, const char * expression, long long actual, long long expected);
+    void failEqual(const char * file, int line, const char * expression, const char * actual, const char * expected);
+
+    template<typename A, typename E> void checkEqual(const char * file, int line, const char * expression, A actual, E expected) {
+        if (!(actual == expected)) {
+            failEqual(file, line, expression, static_cast<long long>(actual), static_cast<long long>(expected));
+        }
+    }
+
+    void checkEqual(const char * file, int line, const char * expression, const char * actual, const char * expected);
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static HostTest::TestCase name##Case = { #name, name, nullptr }; \
+    static HostTest::Registration name##Registration(name##Case); \
+    static void name()
+
+#define CHECK(expression) \
+    do { if (!(expression)) HostTest::fail(__FILE__, __LINE__, #expression); } while (0)
+
+#define CHECK_EQUAL(actual, expected) \
+    HostTest::checkEqual(__FILE__, __LINE__, #actual " == " #expected, (actual), (expected))
+
+#endif
@@ -0,0 +1,69 @@
+#include "HostTest.h"
+#include <ModemHTTPClient.h>
+#include "SimulatedModem.h"
+
+namespace {
+
+// The +QHTTPREAD output of a response without headers, as the modem sends it
+#define HTTP_READ(body) "\r\nCONNECT\r\nHTTP/1.1 200 OK\r\n\r\n" body "\r\nOK\r\n\r\n+QHTTPREAD: 0\r\n"
+
+// Runs a GET request against a modem that answers +QHTTPREAD with the given output and returns the body
+String readBody(SimulatedModem & simulated, const char * readOutput) {
+    simulated.addRule("+QHTTPREAD", readOutput);
+    ModemInterface modem(simulated, -1);
+    ModemHTTPClient client(modem, "example.com", 80, false);
+    CHECK_EQUAL(client.get("/"), HTTP_SUCCESS);
+    CHECK_EQUAL(client.responseStatusCode(), 200);
+    String body = client.responseBody();
+    CHECK(client.endOfBodyReached());
+    return body;
+}
+
+}
+
+TEST_CASE(endsTheBodyAtTheReadTrailer) {
+    SimulatedModem simulated(SimulatedModem::EG25, 0);
+    CHECK_EQUAL(readBody(simulated, HTTP_READ("Hello, World!")).c_str(), "Hello, World!");
+}
+
+TEST_CASE(keepsTheLineEndThatEndsTheBody) {
+    SimulatedModem simulated(SimulatedModem::EG25, 0);
+    CHECK_EQUAL(readBody(simulated, HTTP_READ("line\r\n")).c_str(), "line\r\n");
+}
+
+TEST_CASE(keepsPartsOfTheTrailerInTheBody) {
+    SimulatedModem simulated(SimulatedModem::EG25, 0);
+    // Every prefix of the trailer is held back until the bytes after it rule it out
+    #define PARTIAL_TRAILERS "\r\nOK\r\n\r\nOK\r\n\r\n+QHTTPREAD\r\n\r\nOK\r\n\r\n+QHTTPREAD:"
+    CHECK_EQUAL(readBody(simulated, HTTP_READ(PARTIAL_TRAILERS)).c_str(), PARTIAL_TRAILERS);
+}
+
+TEST_CASE(readsABodyThatArrivesAcrossPolls) {
+    // At 9600 baud a byte takes about a millisecond, so most polls find nothing new
+    SimulatedModem simulated(SimulatedModem::EG25, 9600);
+    simulated.addRule("+QHTTPREAD", HTTP_READ("first line\r\nsecond line\r\n"));
+    ModemInterface modem(simulated, -1);
+    ModemHTTPClient client(modem, "example.com", 80, false);
+    CHECK_EQUAL(client.get("/"), HTTP_SUCCESS);
+    CHECK_EQUAL(client.responseStatusCode(), 200);
+    CHECK_EQUAL(client.skipResponseHeaders(), HTTP_SUCCESS);
+
+    char body[64];
+    size_t length = 0;
+    uint32_t emptyPolls = 0;
+    unsigned long startedAt = millis();
+    while (!client.endOfBodyReached() && millis() - startedAt < 2000 && length < sizeof(body) - 1) {
+        if (client.available() <= 0) {
+            emptyPolls++;
+            continue;
+        }
+        int c = client.read();
+        if (c >= 0) {
+            body[length++] = static_cast<char>(c);
+        }
+    }
+    body[length] = '\0';
+    CHECK(client.endOfBodyReached());
+    CHECK(emptyPolls > 0);
+    CHECK_EQUAL(static_cast<const char *>(body), "first line\r\nsecond line\r\n");
+}
@@ -0,0 +1,90 @@
+#include "HostTest.h"
+#include <ModemInterface.h>
+#include <TranscriptPlayer.h>
+
+namespace {
+
+const char TRANSCRIPT[] =
+    "> 0 AT+CPMS?\\r\\n\n"
+    "< 0 \\r\\n+CMTI: \\\"SM\\\",3\\r\\n+CPMS: \\\"SM\\\",3,50\\r\\n+QIURC: \\\"closed\\\",0\\r\\n\\r\\nOK\\r\\n\n";
+
+void countURC(const char * urc, void * context) {
+    ++*static_cast<int *>(context);
+}
+
+}
+
+TEST_CASE(leavesURCsOutOfTheResponse) {
+    TranscriptPlayer player(TRANSCRIPT);
+    player.setSpeed(0);
+    ModemInterface modem(player, -1);
+    URCDispatcher dispatcher;
+    int indications = 0;
+    dispatcher.on("+CMTI:", countURC, &indications);
+    modem.setURCDispatcher(&dispatcher);
+    TinyGsmClient client(modem, 0);
+    client.sock_connected = true;
+    modem.sockets[0] = &client;
+
+    StaticATResponseBuffer<64> response;
+    modem.sendAT("+CPMS?");
+    CHECK_EQUAL(modem.waitResponse(1000, response, nullptr, "+CPMS?"), 1);
+    CHECK_EQUAL(response.c_str(), "\r\n+CPMS: \"SM\",3,50\r\n\r\nOK\r\n");
+    CHECK_EQUAL(dispatcher.dispatch(), 1U);
+    CHECK_EQUAL(indications, 1);
+    CHECK(!client.connected());
+}
+
+TEST_CASE(keepsResponseLinesOfTheRunningCommand) {
+    TranscriptPlayer player("> 0 AT+CMTI?\\r\\n\n< 0 +CMTI: 1\\r\\nOK\\r\\n\n");
+    player.setSpeed(0);
+    ModemInterface modem(player, -1);
+    URCDispatcher dispatcher;
+    int indications = 0;
+    dispatcher.on("+CMTI:", countURC, &indications);
+    modem.setURCDispatcher(&dispatcher);
+
+    StaticATResponseBuffer<64> response;
+    modem.sendAT("+CMTI?");
+    CHECK_EQUAL(modem.waitResponse(1000, response, nullptr, "+CMTI?"), 1);
+    CHECK_EQUAL(response.c_str(), "+CMTI: 1\r\nOK\r\n");
+    CHECK_EQUAL(dispatcher.dispatch(), 0U);
+}
+
+TEST_CASE(collectsStringResponsesWithoutURCs) {
+    TranscriptPlayer player(TRANSCRIPT);
+    player.setSpeed(0);
+    ModemInterface modem(player, -1);
+    URCDispatcher dispatcher;
+    int indications = 0;
+    dispatcher.on("+CMTI:", countURC, &indications);
+    modem.setURCDispatcher(&dispatcher);
+
+    String response;
+    modem.sendAT("+CPMS?");
+    CHECK_EQUAL(modem.collectResponse(1000, response, "+CPMS?"), 1);
+    CHECK_EQUAL(response.c_str(), "\r\n+CPMS: \"SM\",3,50\r\n\r\nOK\r\n");
+    CHECK_EQUAL(dispatcher.dispatch(), 1U);
+    CHECK_EQUAL(indications, 1);
+}
+
+TEST_CASE(waitsForALineAfterTheResult) {
+    TranscriptPlayer player(
+        "> 0 AT+CUSD=1,\\\"*100#\\\"\\r\\n\n"
+        "< 0 \\r\\nOK\\r\\n\\r\\n+CMTI: \\\"SM\\\",4\\r\\n\\r\\n+CUSD: 0,\\\"Your balance is 5.00\\\",15\\r\\n\n");
+    player.setSpeed(0);
+    ModemInterface modem(player, -1);
+    URCDispatcher dispatcher;
+    int indications = 0;
+    dispatcher.on("+CMTI:", countURC, &indications);
+    modem.setURCDispatcher(&dispatcher);
+
+    StaticATResponseBuffer<64> response;
+    modem.sendAT("+CUSD=1,\"*100#\"");
+    CHECK_EQUAL(modem.waitResult(), 1);
+    CHECK(modem.waitLine(1000, "+CUSD:", response));
+    CHECK_EQUAL(response.c_str(), "+CUSD: 0,\"Your balance is 5.00\",15");
+    CHECK_EQUAL(dispatcher.dispatch(), 1U);
+    CHECK_EQUAL(indications, 1);
+    CHECK(!modem.waitLine(10, "+CUSD:", response));
+}
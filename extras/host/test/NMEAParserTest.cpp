@@ -0,0 +1,95 @@
+#include "HostTest.h"
+#include <NMEAParser.h>
+
+namespace {
+
+// Feeds a sentence framed with '$', its checksum and a line end
+void feedSentence(NMEAParser & parser, const char * body, bool corrupt = false) {
+    uint8_t checksum = corrupt ? 1 : 0;
+    parser.feed('$');
+    for (const char * c = body; *c; c++) {
+        checksum ^= static_cast<uint8_t>(*c);
+        parser.feed(*c);
+    }
+    char trailer[8];
+    snprintf(trailer, sizeof(trailer), "*%02X\r\n", checksum);
+    for (const char * c = trailer; *c; c++) {
+        parser.feed(*c);
+    }
+}
+
+}
+
+TEST_CASE(assemblesFixesFromEpochs) {
+    unsigned published = 0;
+    NMEAParser parser([](const GNSSFix & fix, void * context){ (*static_cast<unsigned *>(context))++; }, &published);
+    feedSentence(parser, "GPRMC,095809.00,A,4503.9078,N,00739.5058,E,10.0,84.4,170424,,,A");
+    feedSentence(parser, "GNGSA,A,3,01,02,03,04,05,06,07,08,,,,,1.6,0.9,1.3");
+    CHECK_EQUAL(published, 0U);
+    feedSentence(parser, "GPGGA,095809.00,4503.9078,N,00739.5058,E,1,08,0.9,280.0,M,47.0,M,,");
+    CHECK_EQUAL(published, 1U);
+    CHECK_EQUAL(parser.getFixCount(), 1U);
+
+    GNSSFix fix;
+    CHECK(parser.getLatestFix(fix));
+    CHECK(fix.valid);
+    CHECK_EQUAL(fix.latitude, 450651300);
+    CHECK_EQUAL(fix.longitude, 76584300);
+    CHECK_EQUAL(fix.altitude, 28000);
+    CHECK_EQUAL(fix.hdop, 90);
+    CHECK_EQUAL(fix.satellites, 8);
+    CHECK_EQUAL(fix.dimension, 3);
+    CHECK_EQUAL(fix.speed, 514U);
+    CHECK_EQUAL(fix.course, 8440);
+    CHECK_EQUAL(fix.time.getISO8601().c_str(), "2024-04-17T09:58:09+00:00");
+}
+
+TEST_CASE(handlesSouthAndWest) {
+    NMEAParser parser;
+    feedSentence(parser, "GPGGA,120000,3351.5000,S,15112.6000,W,1,05,1.2,10.0,M,,M,,");
+    GNSSFix fix;
+    CHECK(parser.getLatestFix(fix));
+    CHECK_EQUAL(fix.latitude, -338583333);
+    CHECK_EQUAL(fix.longitude, -1512100000);
+}
+
+TEST_CASE(publishesInvalidFixes) {
+    NMEAParser parser;
+    GNSSFix fix;
+    CHECK(!parser.getLatestFix(fix));
+    feedSentence(parser, "GPGGA,095809.00,,,,,0,00,99.99,,,,,,");
+    CHECK(parser.getLatestFix(fix));
+    CHECK(!fix.valid);
+}
+
+TEST_CASE(dropsCorruptAndForeignText) {
+    NMEAParser parser;
+    for (const char * c = "+QGPSGNMEA: garbage\r\n$GPGGA,broken"; *c; c++) {
+        parser.feed(*c);
+    }
+    feedSentence(parser, "GPGGA,095809.00,4503.9078,N,00739.5058,E,1,08,0.9,280.0,M,47.0,M,,", true);
+    CHECK_EQUAL(parser.getFixCount(), 0U);
+    CHECK_EQUAL(parser.getChecksumErrorCount(), 1U);
+
+    parser.reset();
+    feedSentence(parser, "GPGGA,095809.00,4503.9078,N,00739.5058,E,1,08,0.9,280.0,M,47.0,M,,");
+    CHECK_EQUAL(parser.getFixCount(), 1U);
+}
+
+TEST_CASE(parsesLocationResponses) {
+    GNSSFix fix;
+    CHECK(NMEAParser::parseLocationResponse(
+        "\r\n+QGPSLOC: 095809.0,45.06513,7.65843,1.3,280.0,3,84.24,36.0,19.4,170424,07\r\n\r\nOK\r\n", fix));
+    CHECK(fix.valid);
+    CHECK_EQUAL(fix.latitude, 450651300);
+    CHECK_EQUAL(fix.longitude, 76584300);
+    CHECK_EQUAL(fix.hdop, 130);
+    CHECK_EQUAL(fix.dimension, 3);
+    CHECK_EQUAL(fix.course, 8440);
+    CHECK_EQUAL(fix.speed, 1000U);
+    CHECK_EQUAL(fix.satellites, 7);
+    CHECK_EQUAL(fix.time.getISO8601().c_str(), "2024-04-17T09:58:09+00:00");
+
+    CHECK(!NMEAParser::parseLocationResponse("\r\n+CME ERROR: 516\r\n", fix));
+    CHECK(!fix.valid);
+}
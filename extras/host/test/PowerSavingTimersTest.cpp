@@ -0,0 +1,40 @@
+#include "HostTest.h"
+#include <PowerSavingTimers.h>
+
+TEST_CASE(encodesPeriodicTAU) {
+    char bits[PowerSavingTimers::timerLength + 1];
+    CHECK_EQUAL(PowerSavingTimers::encodePeriodicTAU(60, bits), 60UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "01111110"); // 30 x 2 s
+    CHECK_EQUAL(PowerSavingTimers::encodePeriodicTAU(3600, bits), 3600UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "00000110"); // 6 x 10 min
+    // Rounded up to the next step
+    CHECK_EQUAL(PowerSavingTimers::encodePeriodicTAU(3601, bits), 4200UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "00000111");
+    // Capped at 31 x 320 h
+    CHECK_EQUAL(PowerSavingTimers::encodePeriodicTAU(40000000, bits), 35712000UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "11011111");
+}
+
+TEST_CASE(encodesActiveTime) {
+    char bits[PowerSavingTimers::timerLength + 1];
+    CHECK_EQUAL(PowerSavingTimers::encodeActiveTime(60, bits), 60UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "00011110"); // 30 x 2 s
+    CHECK_EQUAL(PowerSavingTimers::encodeActiveTime(61, bits), 62UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "00011111");
+    CHECK_EQUAL(PowerSavingTimers::encodeActiveTime(3600, bits), 3600UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "01001010"); // 10 x 6 min
+    CHECK_EQUAL(PowerSavingTimers::encodeActiveTime(0, bits), 0UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "00000000");
+}
+
+TEST_CASE(encodesEDRXCycles) {
+    char bits[PowerSavingTimers::cycleLength + 1];
+    CHECK_EQUAL(PowerSavingTimers::encodeEDRXCycle(81920, bits), 81920UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "0101");
+    CHECK_EQUAL(PowerSavingTimers::encodeEDRXCycle(1000, bits), 5120UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "0000");
+    CHECK_EQUAL(PowerSavingTimers::encodeEDRXCycle(90000, bits), 102400UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "0110");
+    CHECK_EQUAL(PowerSavingTimers::encodeEDRXCycle(20000000, bits), 10485760UL);
+    CHECK_EQUAL(static_cast<const char *>(bits), "1111");
+}
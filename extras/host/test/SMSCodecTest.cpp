@@ -0,0 +1,110 @@
+#include "HostTest.h"
+#include <SMSDecoder.h>
+#include <SMSEncoder.h>
+
+namespace {
+
+size_t fromHex(const char * hex, uint8_t * bytes) {
+    size_t length = 0;
+    for (; hex[0] && hex[1]; hex += 2) {
+        char octet[3] = { hex[0], hex[1], '\0' };
+        bytes[length++] = static_cast<uint8_t>(strtoul(octet, nullptr, 16));
+    }
+    return length;
+}
+
+}
+
+TEST_CASE(decodesDeliverPDU) {
+    // Sent by +31641600986 on 2002-08-26 at 19:37:41 in UTC+2
+    uint8_t pdu[64];
+    size_t length = fromHex("07911326040000F0040B911346610089F60000208062917314800CC8F71D14969741F977FD07", pdu);
+    char sender[32];
+    char text[64];
+    SMSDecoder decoder(sender, sizeof(sender), text, sizeof(text));
+    CHECK(decoder.decode(pdu, length));
+    CHECK_EQUAL(static_cast<const char *>(sender), "+31641600986");
+    CHECK_EQUAL(static_cast<const char *>(text), "How are you?");
+    CHECK_EQUAL(decoder.getTextLength(), 12U);
+    CHECK_EQUAL(decoder.getTimestamp().getISO8601().c_str(), "2002-08-26T19:37:41+02:00");
+    CHECK_EQUAL(decoder.getPartCount(), 1);
+
+    // A truncated PDU is rejected
+    CHECK(!decoder.decode(pdu, 20));
+}
+
+TEST_CASE(packsGSM7Septets) {
+    SMSEncoder encoder;
+    CHECK(encoder.setMessage("hellohello"));
+    CHECK_EQUAL(encoder.getEncoding(), SMS_ENCODING_GSM7);
+    CHECK_EQUAL(encoder.getSegmentCount(), 1U);
+
+    uint8_t pdu[SMSEncoder::maxPDULength];
+    size_t length = encoder.encode(0, "+393331234567", 0, pdu);
+    CHECK(length > 0);
+    // The user data is the last part of the PDU, including the SMSC octet
+    uint8_t expected[9];
+    fromHex("E8329BFD4697D9EC37", expected);
+    CHECK_EQUAL(pdu[length - 9], 10); // User data length in septets
+    CHECK(memcmp(pdu + length + 1 - sizeof(expected), expected, sizeof(expected)) == 0);
+}
+
+TEST_CASE(mapsTheGSM7Alphabet) {
+    CHECK_EQUAL(SMSEncoder::toGSM7('@'), 0x00);
+    CHECK_EQUAL(SMSEncoder::toGSM7(0x20AC), 0x1B65); // Euro sign, extension table
+    CHECK_EQUAL(SMSEncoder::toGSM7(0x4E2D), -1);
+    CHECK_EQUAL(SMSEncoder::fromGSM7(0x65, true), 0x20ACU);
+    CHECK_EQUAL(SMSEncoder::fromGSM7(0x11, false), 0x5FU); // Underscore
+
+    const char * text = "\xE2\x82\xAC" "a";
+    CHECK_EQUAL(SMSEncoder::nextCodePoint(text), 0x20ACU);
+    CHECK_EQUAL(*text, 'a');
+    const char * invalid = "\xC3";
+    CHECK_EQUAL(SMSEncoder::nextCodePoint(invalid), 0xFFFDU);
+}
+
+TEST_CASE(roundTripsSegmentedMessages) {
+    static const char * const messages[] = {
+        "Short message with an escape: {[|]} and a euro sign \xE2\x82\xAC",
+        "Unicode \xE4\xB8\xAD\xE6\x96\x87 and an emoji \xF0\x9F\x98\x80 that needs a surrogate pair, "
+        "repeated until it needs more than one segment: \xF0\x9F\x98\x80\xF0\x9F\x98\x80\xF0\x9F\x98\x80",
+        "A long GSM 7-bit message that is split into several segments, each of them carries a user data header "
+        "with the reference, the number of parts and the part number, so that the receiver can put them back together."
+    };
+
+    for (const char * message : messages) {
+        SMSEncoder encoder;
+        CHECK(encoder.setMessage(message));
+
+        char decoded[512] = "";
+        size_t decodedLength = 0;
+        for (size_t segment = 0; segment < encoder.getSegmentCount(); segment++) {
+            uint8_t pdu[SMSEncoder::maxPDULength];
+            size_t length = encoder.encode(segment, "+393331234567", 42, pdu);
+            CHECK(length > 0);
+
+            char sender[32];
+            char text[256];
+            SMSDecoder decoder(sender, sizeof(sender), text, sizeof(text));
+            CHECK(decoder.decode(pdu, length + 1));
+            CHECK_EQUAL(static_cast<const char *>(sender), "+393331234567");
+            if (encoder.getSegmentCount() > 1) {
+                CHECK_EQUAL(decoder.getPartReference(), 42);
+                CHECK_EQUAL(decoder.getPartNumber(), segment + 1);
+                CHECK_EQUAL(decoder.getPartCount(), encoder.getSegmentCount());
+            }
+            memcpy(decoded + decodedLength, text, decoder.getTextLength());
+            decodedLength += decoder.getTextLength();
+        }
+        decoded[decodedLength] = '\0';
+        CHECK_EQUAL(static_cast<const char *>(decoded), message);
+    }
+}
+
+TEST_CASE(rejectsInvalidNumbers) {
+    SMSEncoder encoder;
+    CHECK(encoder.setMessage("Hello"));
+    uint8_t pdu[SMSEncoder::maxPDULength];
+    CHECK_EQUAL(encoder.encode(0, "+39 333", 0, pdu), 0U);
+    CHECK_EQUAL(encoder.encode(0, "123456789012345678901", 0, pdu), 0U);
+}
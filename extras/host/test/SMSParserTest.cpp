@@ -0,0 +1,129 @@
+#include "HostTest.h"
+#include <SMSParser.h>
+
+namespace {
+
+struct ParsedSMS {
+    int16_t index;
+    char sender[SMSParser::maxSenderLength + 1];
+    char message[SMSParser::maxMessageLength + 1];
+    Time timestamp;
+    SMSStatus status;
+    uint8_t partNumber;
+    uint8_t partCount;
+};
+
+struct Inbox {
+    ParsedSMS messages[4];
+    size_t count = 0;
+};
+
+void collect(const SMSView & sms, void * context) {
+    Inbox & inbox = *static_cast<Inbox *>(context);
+    if (inbox.count == 4) {
+        return;
+    }
+    ParsedSMS & parsed = inbox.messages[inbox.count++];
+    parsed.index = sms.index;
+    strcpy(parsed.sender, sms.sender);
+    strcpy(parsed.message, sms.message);
+    parsed.timestamp = sms.timestamp;
+    parsed.status = sms.status;
+    parsed.partNumber = sms.partNumber;
+    parsed.partCount = sms.partCount;
+}
+
+bool feed(SMSParser & parser, const char * response) {
+    bool done = false;
+    for (const char * c = response; *c; c++) {
+        done = parser.feed(*c);
+    }
+    return done;
+}
+
+}
+
+TEST_CASE(parsesTextModeListings) {
+    Inbox inbox;
+    SMSParser parser(collect, &inbox);
+    CHECK(feed(parser,
+        "\r\n+CMGL: 1,\"REC UNREAD\",\"+393331234567\",\"\",\"24/04/17,09:58:09+08\"\r\nFirst message\r\n"
+        "+CMGL: 2,\"REC READ\",\"+393331234568\",\"\",\"24/04/17,10:00:00-04\"\r\nTwo\r\nlines\r\n"
+        "\r\nOK\r\n"));
+    CHECK(parser.succeeded());
+    CHECK_EQUAL(parser.getCount(), 2U);
+    CHECK_EQUAL(inbox.count, 2U);
+
+    CHECK_EQUAL(inbox.messages[0].index, 1);
+    CHECK_EQUAL(static_cast<const char *>(inbox.messages[0].sender), "+393331234567");
+    CHECK_EQUAL(static_cast<const char *>(inbox.messages[0].message), "First message");
+    CHECK_EQUAL(inbox.messages[0].timestamp.getISO8601().c_str(), "2024-04-17T09:58:09+02:00");
+    CHECK_EQUAL(inbox.messages[0].status, SMS_STATUS_UNREAD);
+
+    CHECK_EQUAL(inbox.messages[1].index, 2);
+    CHECK_EQUAL(static_cast<const char *>(inbox.messages[1].message), "Two\nlines");
+    CHECK_EQUAL(inbox.messages[1].timestamp.getOffsetMinutes(), -60);
+    CHECK_EQUAL(inbox.messages[1].status, SMS_STATUS_READ);
+}
+
+TEST_CASE(parsesSingleReads) {
+    Inbox inbox;
+    SMSParser parser(collect, &inbox);
+    parser.setReadIndex(7);
+    CHECK(feed(parser, "\r\n+CMGR: \"REC READ\",\"+393331234567\",\"\",\"24/04/17,09:58:09+08\"\r\nRead me\r\n\r\nOK\r\n"));
+    CHECK_EQUAL(inbox.count, 1U);
+    CHECK_EQUAL(inbox.messages[0].index, 7);
+    CHECK_EQUAL(static_cast<const char *>(inbox.messages[0].message), "Read me");
+}
+
+TEST_CASE(parsesPDUModeListings) {
+    Inbox inbox;
+    SMSParser parser(collect, &inbox);
+    CHECK(feed(parser,
+        "\r\n+CMGL: 3,0,,30\r\n07911326040000F0040B911346610089F60000208062917314800CC8F71D14969741F977FD07\r\n\r\nOK\r\n"));
+    CHECK_EQUAL(inbox.count, 1U);
+    CHECK_EQUAL(inbox.messages[0].index, 3);
+    CHECK_EQUAL(static_cast<const char *>(inbox.messages[0].sender), "+31641600986");
+    CHECK_EQUAL(static_cast<const char *>(inbox.messages[0].message), "How are you?");
+    CHECK_EQUAL(inbox.messages[0].status, SMS_STATUS_UNREAD);
+    CHECK_EQUAL(inbox.messages[0].partCount, 1);
+}
+
+TEST_CASE(separatesInterleavedURCs) {
+    Inbox inbox;
+    URCDispatcher dispatcher;
+    int received = 0;
+    dispatcher.on("+CMTI:", [](const char * urc, void * context){ (*static_cast<int *>(context))++; }, &received);
+
+    SMSParser parser(collect, &inbox);
+    parser.setURCDispatcher(&dispatcher);
+    CHECK(feed(parser,
+        "\r\n+CMGL: 1,\"REC UNREAD\",\"+393331234567\",\"\",\"24/04/17,09:58:09+08\"\r\nBody\r\n"
+        "\r\n+CMTI: \"SM\",2\r\n\r\nOK\r\n"));
+    CHECK_EQUAL(inbox.count, 1U);
+    CHECK_EQUAL(static_cast<const char *>(inbox.messages[0].message), "Body");
+    CHECK_EQUAL(dispatcher.dispatch(), 1U);
+    CHECK_EQUAL(received, 1);
+}
+
+TEST_CASE(reportsErrors) {
+    Inbox inbox;
+    SMSParser parser(collect, &inbox);
+    CHECK(feed(parser, "\r\n+CMS ERROR: 321\r\n"));
+    CHECK(parser.isDone());
+    CHECK(!parser.succeeded());
+    CHECK_EQUAL(inbox.count, 0U);
+
+    parser.reset();
+    CHECK(!parser.isDone());
+    CHECK(feed(parser, "\r\nOK\r\n"));
+    CHECK(parser.succeeded());
+}
+
+TEST_CASE(parsesTimestampsAndStatus) {
+    Time time = SMSParser::parseTimestamp("24/12/31,23:59:59+22", 20);
+    CHECK_EQUAL(time.getISO8601().c_str(), "2024-12-31T23:59:59+05:30");
+    CHECK_EQUAL(SMSParser::parseStatus("STO UNSENT", 10), SMS_STATUS_UNSENT);
+    CHECK_EQUAL(SMSParser::parseStatus("STO SENT", 8), SMS_STATUS_SENT);
+    CHECK_EQUAL(SMSParser::parseStatus("BOGUS", 5), SMS_STATUS_UNKNOWN);
+}
@@ -0,0 +1,64 @@
+#include "HostTest.h"
+#include <TimeUtils.h>
+
+TEST_CASE(convertsComponentsToUNIXTimestamps) {
+    CHECK_EQUAL(Time(1970, 1, 1, 0, 0, 0).getUNIXTimestamp(), 0UL);
+    CHECK_EQUAL(Time(2000, 2, 29, 12, 0, 0).getUNIXTimestamp(), 951825600UL);
+    CHECK_EQUAL(Time(2024, 4, 17, 9, 58, 9).getUNIXTimestamp(), 1713347889UL);
+    // The offset is subtracted to get UTC
+    CHECK_EQUAL(Time(2024, 4, 17, 11, 58, 9, 2).getUNIXTimestamp(), 1713347889UL);
+}
+
+TEST_CASE(convertsEveryDayBackAndForth) {
+    for (long days = 0; days < 47482; days++) { // 1970 to 2100
+        Time::CivilDate date = Time::civilFromDays(days);
+        if (Time::daysFromCivil(date.year, date.month, date.day) != days) {
+            CHECK_EQUAL(Time::daysFromCivil(date.year, date.month, date.day), days);
+            return;
+        }
+    }
+}
+
+TEST_CASE(formatsISO8601) {
+    char buffer[Time::ISO8601Length + 1];
+    Time time(2024, 4, 17, 9, 58, 9, 2);
+    CHECK_EQUAL(time.formatISO8601(buffer, sizeof(buffer)), Time::ISO8601Length);
+    CHECK_EQUAL(static_cast<const char *>(buffer), "2024-04-17T09:58:09+02:00");
+
+    Time nepal;
+    nepal.fromComponents(2024, 4, 17, 9, 58, 9);
+    nepal.setOffsetMinutes(345);
+    CHECK_EQUAL(nepal.getISO8601().c_str(), "2024-04-17T09:58:09+05:45");
+
+    // Too small buffers get an empty string
+    CHECK_EQUAL(time.formatISO8601(buffer, Time::ISO8601Length), 0U);
+    CHECK_EQUAL(buffer[0], '\0');
+}
+
+TEST_CASE(parsesISO8601) {
+    Time time;
+    CHECK(time.parseISO8601("2024-04-17T09:58:09-03:30"));
+    CHECK_EQUAL(time.getYear(), 2024);
+    CHECK_EQUAL(time.getMonth(), 4);
+    CHECK_EQUAL(time.getDay(), 17);
+    CHECK_EQUAL(time.getHour(), 9);
+    CHECK_EQUAL(time.getMinute(), 58);
+    CHECK_EQUAL(time.getSecond(), 9);
+    CHECK_EQUAL(time.getOffsetMinutes(), -210);
+
+    CHECK(time.parseISO8601("2024-04-17 09:58:09.250Z"));
+    CHECK_EQUAL(time.getOffsetMinutes(), 0);
+
+    CHECK(!time.parseISO8601("2024-04-17T09:58"));
+    CHECK(!time.parseISO8601("2024-04-17T09:58:09+02:00 trailing"));
+}
+
+TEST_CASE(parsesUNIXTimestamps) {
+    Time time;
+    time.parseUNIXTimestamp(1713347889, 120);
+    CHECK_EQUAL(time.getISO8601().c_str(), "2024-04-17T11:58:09+02:00");
+    CHECK_EQUAL(time.getUNIXTimestamp(), 1713347889UL);
+
+    time.fromUNIXTimestamp("0");
+    CHECK_EQUAL(time.getISO8601().c_str(), "1970-01-01T00:00:00+00:00");
+}
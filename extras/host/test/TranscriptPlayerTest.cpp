@@ -0,0 +1,118 @@
+#include "HostTest.h"
+#include <TranscriptPlayer.h>
+#include <TranscriptRecorder.h>
+
+namespace {
+
+const char TRANSCRIPT[] =
+    "> 0 AT\\r\\n\n"
+    "< 2000 \\r\\n\n"
+    "< 100 OK\\r\\n\n"
+    "> 300 AT+CSQ\\r\\n\n"
+    "< 1000 \\r\\n+CSQ: 24,99\\r\\n\\r\\nOK\\r\\n\n";
+
+// Reads everything that is available within the timeout
+size_t readResponse(Stream & stream, char * buffer, size_t size, unsigned long timeout) {
+    size_t length = 0;
+    unsigned long start = millis();
+    while (millis() - start < timeout && length < size - 1) {
+        int c = stream.read();
+        if (c >= 0) {
+            buffer[length++] = static_cast<char>(c);
+        }
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+// A modem that answers from a fixed buffer
+class CannedModem : public Stream {
+    public:
+        explicit CannedModem(const char * response) : response(response) {}
+        int available() override { return strlen(response); }
+        int read() override { return *response ? static_cast<uint8_t>(*response++) : -1; }
+        int peek() override { return *response ? static_cast<uint8_t>(*response) : -1; }
+        size_t write(uint8_t c) override { return 1; }
+        using Print::write;
+
+    private:
+        const char * response;
+};
+
+// Collects the transcript in memory
+class TranscriptBuffer : public Print {
+    public:
+        size_t write(uint8_t c) override {
+            if (length < sizeof(text) - 1) {
+                text[length++] = static_cast<char>(c);
+                text[length] = '\0';
+            }
+            return 1;
+        }
+        using Print::write;
+
+        char text[512] = "";
+        size_t length = 0;
+};
+
+}
+
+TEST_CASE(playsResponsesToMatchingCommands) {
+    TranscriptPlayer player(TRANSCRIPT);
+    player.setSpeed(0);
+    char response[64];
+
+    CHECK_EQUAL(player.available(), 0);
+    player.print("AT\r\n");
+    readResponse(player, response, sizeof(response), 10);
+    CHECK_EQUAL(static_cast<const char *>(response), "\r\nOK\r\n");
+
+    player.print("AT+CSQ\r\n");
+    readResponse(player, response, sizeof(response), 10);
+    CHECK_EQUAL(static_cast<const char *>(response), "\r\n+CSQ: 24,99\r\n\r\nOK\r\n");
+    CHECK(player.isFinished());
+    CHECK_EQUAL(player.getRecordNumber(), 5U);
+    CHECK_EQUAL(player.getMismatchCount(), 0U);
+}
+
+TEST_CASE(holdsResponsesForTheirRecordedTime) {
+    TranscriptPlayer player(TRANSCRIPT);
+    player.setSpeed(1);
+    // The recorded time counts from the end of the command
+    unsigned long start = micros();
+    player.print("AT\r\n");
+    while (player.available() == 0 && micros() - start < 100000) {
+    }
+    CHECK(micros() - start >= 2000);
+    CHECK(player.available() > 0);
+}
+
+TEST_CASE(countsMismatchingWrites) {
+    TranscriptPlayer player(TRANSCRIPT);
+    player.setSpeed(0);
+    char response[64];
+    player.print("AT\r\n");
+    readResponse(player, response, sizeof(response), 10);
+    player.print("AT+CSS\r\n");
+    CHECK_EQUAL(player.getMismatchCount(), 1U);
+    CHECK_EQUAL(player.getFirstMismatchRecord(), 4U);
+}
+
+TEST_CASE(replaysRecordedTraffic) {
+    CannedModem modem("\r\nOK\r\n");
+    TranscriptBuffer transcript;
+    TranscriptRecorder recorder(modem, transcript);
+    recorder.print("AT\\\r\n");
+    char response[64];
+    readResponse(recorder, response, sizeof(response), 10);
+    recorder.flush();
+    CHECK_EQUAL(recorder.getRecordCount(), 3U);
+
+    TranscriptPlayer player(transcript.text);
+    player.setSpeed(0);
+    player.print("AT\\\r\n");
+    readResponse(player, response, sizeof(response), 10);
+    CHECK_EQUAL(static_cast<const char *>(response), "\r\nOK\r\n");
+    CHECK(player.isFinished());
+    CHECK_EQUAL(player.getMismatchCount(), 0U);
+}
@@ -0,0 +1,253 @@
+#include "ATCommandEngine.h"
+
+namespace {
+
+// Upper bound of bytes consumed by a single poll() so that its run time stays short
+constexpr size_t maxBytesPerPoll = 256;
+
+bool isErrorResultCode(const char * line) {
+    return strcmp(line, "ERROR") == 0 || strncmp(line, "+CME ERROR", 10) == 0 || strncmp(line, "+CMS ERROR", 10) == 0;
+}
+
+}
+
+ATCommandStatus ATCommandHandle::getStatus() const {
+    if (engine == nullptr || engine->slots[slot].sequence != sequence) {
+        return AT_COMMAND_INVALID;
+    }
+    return engine->slots[slot].status;
+}
+
+bool ATCommandHandle::isDone() const {
+    ATCommandStatus status = getStatus();
+    return status != AT_COMMAND_QUEUED && status != AT_COMMAND_RUNNING;
+}
+
+const char * ATCommandHandle::getResponse() const {
+    if (!isDone() || getStatus() == AT_COMMAND_INVALID) {
+        return "";
+    }
+    return engine->slots[slot].response;
+}
+
+ATCommandEngine::ATCommandEngine(Stream & stream) : stream(&stream) {
+    for (size_t i = 0; i < queueLength; i++) {
+        slots[i].sequence = 0;
+        slots[i].status = AT_COMMAND_INVALID;
+    }
+}
+
+size_t ATCommandEngine::getFreeSlots() const {
+    size_t free = 0;
+    for (size_t i = 0; i < queueLength; i++) {
+        if (slots[i].status != AT_COMMAND_QUEUED && slots[i].status != AT_COMMAND_RUNNING) {
+            free++;
+        }
+    }
+    return free;
+}
+
+int ATCommandEngine::allocateSlot() {
+    // Prefer slots that never held a command, then the one whose result was produced first
+    int candidate = -1;
+    for (size_t i = 0; i < queueLength; i++) {
+        ATCommandStatus status = slots[i].status;
+        if (status == AT_COMMAND_INVALID) {
+            return i;
+        }
+        if (status == AT_COMMAND_QUEUED || status == AT_COMMAND_RUNNING) {
+            continue;
+        }
+        if (candidate < 0 || static_cast<int16_t>(slots[i].sequence - slots[candidate].sequence) < 0) {
+            candidate = i;
+        }
+    }
+    return candidate;
+}
+
+ATCommandHandle ATCommandEngine::enqueue(const char * command, unsigned long timeout, ATCommandCallback callback, void * context) {
+    return enqueueWithPayload(command, nullptr, timeout, callback, context);
+}
+
+ATCommandHandle ATCommandEngine::enqueueStreaming(const char * command, ATResponseSink sink, unsigned long timeout, ATCommandCallback callback, void * context) {
+    ATCommandHandle handle = enqueueWithPayload(command, nullptr, timeout, callback, context);
+    if (handle.isValid()) {
+        slots[handle.slot].sink = sink;
+    }
+    return handle;
+}
+
+ATCommandHandle ATCommandEngine::enqueueWithPayload(const char * command, const char * payload, unsigned long timeout, ATCommandCallback callback, void * context) {
+    size_t commandLength = strlen(command);
+    size_t payloadLength = payload != nullptr ? strlen(payload) + 1 : 0;
+    if (commandLength + 1 + payloadLength > commandBufferSize) {
+        return ATCommandHandle();
+    }
+
+    int index = allocateSlot();
+    if (index < 0) {
+        return ATCommandHandle();
+    }
+
+    Slot & slot = slots[index];
+    memcpy(slot.command, command, commandLength + 1);
+    slot.payload = nullptr;
+    if (payload != nullptr) {
+        // The payload is kept right after the command in the same buffer
+        slot.payload = slot.command + commandLength + 1;
+        memcpy(slot.command + commandLength + 1, payload, payloadLength);
+    }
+    slot.response[0] = '\0';
+    slot.responseLength = 0;
+    slot.timeout = timeout;
+    slot.callback = callback;
+    slot.sink = nullptr;
+    slot.context = context;
+    slot.sequence = nextSequence++;
+    if (nextSequence == 0) {
+        nextSequence = 1;
+    }
+    slot.status = AT_COMMAND_QUEUED;
+
+    pending[(pendingHead + pendingCount) % queueLength] = index;
+    pendingCount++;
+
+    return ATCommandHandle(this, index, slot.sequence);
+}
+
+void ATCommandEngine::start(uint8_t index) {
+    Slot & slot = slots[index];
+    active = index;
+    awaitingPrompt = slot.payload != nullptr;
+    lineLength = 0;
+    slot.status = AT_COMMAND_RUNNING;
+    slot.startedAt = millis();
+
+    stream->print("AT");
+    stream->print(slot.command);
+    stream->print("\r\n");
+}
+
+void ATCommandEngine::complete(ATCommandStatus status) {
+    Slot & slot = slots[active];
+    slot.status = status;
+    active = -1;
+    awaitingPrompt = false;
+
+    // The callback may queue follow-up commands, the engine is ready for them at this point
+    if (slot.callback != nullptr) {
+        slot.callback(status, slot.response, slot.context);
+    }
+}
+
+void ATCommandEngine::appendResponse(const char * text) {
+    Slot & slot = slots[active];
+    size_t available = responseBufferSize - 1 - slot.responseLength;
+
+    if (slot.responseLength > 0 && available > 0) {
+        slot.response[slot.responseLength++] = '\n';
+        available--;
+    }
+
+    size_t length = strlen(text);
+    if (length > available) {
+        length = available;
+    }
+    memcpy(slot.response + slot.responseLength, text, length);
+    slot.responseLength += length;
+    slot.response[slot.responseLength] = '\0';
+}
+
+void ATCommandEngine::processLine() {
+    line[lineLength] = '\0';
+    lineLength = 0;
+
+    const char * text = line;
+    while (*text == ' ') {
+        text++;
+    }
+    if (*text == '\0') {
+        return;
+    }
+
+    if (urcDispatcher != nullptr && urcDispatcher->accepts(text, active >= 0 ? slots[active].command : nullptr)) {
+        urcDispatcher->push(text);
+        return;
+    }
+
+    if (active < 0) {
+        // Nobody is waiting for this line
+        return;
+    }
+
+    if (strncmp(text, "AT", 2) == 0) {
+        // Command echo
+        return;
+    }
+
+    if (strcmp(text, "OK") == 0) {
+        complete(AT_COMMAND_OK);
+    } else if (isErrorResultCode(text)) {
+        appendResponse(text);
+        complete(AT_COMMAND_ERROR);
+    } else {
+        appendResponse(text);
+    }
+}
+
+void ATCommandEngine::resync() {
+    if (active < 0) {
+        lineLength = 0;
+    }
+}
+
+void ATCommandEngine::poll() {
+    for (size_t processed = 0; processed < maxBytesPerPoll && stream->available() > 0; processed++) {
+        char c = static_cast<char>(stream->read());
+
+        if (active >= 0 && slots[active].sink != nullptr) {
+            ATCommandStatus status = slots[active].sink(c, slots[active].context);
+            if (status != AT_COMMAND_RUNNING) {
+                complete(status);
+            }
+            continue;
+        }
+
+        if (awaitingPrompt && c == '>') {
+            Slot & slot = slots[active];
+            awaitingPrompt = false;
+            lineLength = 0;
+            stream->print(slot.payload);
+            stream->write(static_cast<char>(0x1A));
+            // The response timeout starts once the payload has been handed over
+            slot.startedAt = millis();
+            continue;
+        }
+
+        if (c == '\r') {
+            continue;
+        }
+        if (c == '\n') {
+            processLine();
+            continue;
+        }
+        if (lineLength < maxLineLength) {
+            line[lineLength++] = c;
+        }
+    }
+
+    if (active >= 0 && millis() - slots[active].startedAt > slots[active].timeout) {
+        if (awaitingPrompt) {
+            // ESC cancels the input a late prompt would open, so the next command is not taken as its text
+            stream->write(static_cast<char>(0x1B));
+        }
+        complete(AT_COMMAND_TIMEOUT);
+    }
+
+    if (active < 0 && pendingCount > 0) {
+        uint8_t next = pending[pendingHead];
+        pendingHead = (pendingHead + 1) % queueLength;
+        pendingCount--;
+        start(next);
+    }
+}
@@ -0,0 +1,236 @@
+/**
+ * @file ATCommandEngine.h
+ * @brief Header file for the ATCommandEngine class.
+ */
+
+#ifndef ARDUINO_CELLULAR_AT_COMMAND_ENGINE_H
+#define ARDUINO_CELLULAR_AT_COMMAND_ENGINE_H
+
+#include <Arduino.h>
+#include <URCDispatcher.h>
+
+#ifndef ARDUINO_CELLULAR_AT_QUEUE_LENGTH
+/**
+ * Maximum number of asynchronous AT commands that can be queued or awaiting collection.
+ */
+#define ARDUINO_CELLULAR_AT_QUEUE_LENGTH 8
+#endif
+
+#ifndef ARDUINO_CELLULAR_AT_COMMAND_BUFFER
+/**
+ * Size of the buffer holding an asynchronous AT command and its payload (e.g. the text of an SMS).
+ */
+#define ARDUINO_CELLULAR_AT_COMMAND_BUFFER 192
+#endif
+
+#ifndef ARDUINO_CELLULAR_AT_RESPONSE_BUFFER
+/**
+ * Size of the buffer holding the response of an asynchronous AT command. Longer responses are truncated.
+ */
+#define ARDUINO_CELLULAR_AT_RESPONSE_BUFFER 128
+#endif
+
+/**
+ * @enum ATCommandStatus
+ * @brief Represents the state of an asynchronous AT command.
+ */
+enum ATCommandStatus {
+    AT_COMMAND_INVALID, /**< The handle does not refer to a command, or the command result has been discarded. */
+    AT_COMMAND_QUEUED, /**< The command waits for the previous commands to complete. */
+    AT_COMMAND_RUNNING, /**< The command has been sent and the engine waits for the final result code. */
+    AT_COMMAND_OK, /**< The modem answered OK. */
+    AT_COMMAND_ERROR, /**< The modem answered ERROR, +CME ERROR or +CMS ERROR. */
+    AT_COMMAND_TIMEOUT /**< The modem did not answer in time. */
+};
+
+/**
+ * @brief Callback invoked when an asynchronous AT command completes.
+ * @param status The final status of the command.
+ * @param response The information text of the response, lines separated by '\n'. Valid only during the callback.
+ * @param context The user pointer passed when queueing the command.
+ */
+typedef void (*ATCommandCallback)(ATCommandStatus status, const char * response, void * context);
+
+/**
+ * @brief Callback receiving the raw response bytes of a streamed command.
+ * @param c The received character.
+ * @param context The user pointer passed when queueing the command.
+ * @return AT_COMMAND_RUNNING while more bytes are expected, the final status once the response is complete.
+ */
+typedef ATCommandStatus (*ATResponseSink)(char c, void * context);
+
+class ATCommandEngine;
+
+/**
+ * @class ATCommandHandle
+ * @brief A future-like reference to an asynchronous AT command.
+ *
+ * The result of a completed command stays available until its slot is reused by a newer
+ * command, after which the handle reports AT_COMMAND_INVALID.
+ */
+class ATCommandHandle {
+    public:
+        /**
+         * @brief Creates a handle that does not refer to any command.
+         */
+        ATCommandHandle() {}
+
+        /**
+         * @brief Gets the status of the command.
+         * @return The status of the command.
+         */
+        ATCommandStatus getStatus() const;
+
+        /**
+         * @brief Checks whether the command has completed, successfully or not.
+         * @return True if the command is no longer queued or running.
+         */
+        bool isDone() const;
+
+        /**
+         * @brief Gets the information text of the response.
+         * @return The response, or an empty string while the command is pending or if the handle is invalid.
+         */
+        const char * getResponse() const;
+
+        /**
+         * @brief Checks whether the handle refers to a command that was accepted by the queue.
+         * @return True if the command was queued.
+         */
+        bool isValid() const { return engine != nullptr; }
+
+    private:
+        friend class ATCommandEngine;
+        ATCommandHandle(ATCommandEngine * engine, uint8_t slot, uint16_t sequence) : engine(engine), slot(slot), sequence(sequence) {}
+
+        ATCommandEngine * engine = nullptr;
+        uint8_t slot = 0;
+        uint16_t sequence = 0;
+};
+
+/**
+ * @class ATCommandEngine
+ * @brief Non-blocking AT command layer with a bounded request queue.
+ *
+ * Commands are queued and sent one at a time. poll() reads whatever the modem has sent so far,
+ * advances the response state machine and starts the next command; it never waits for the modem.
+ * Completion is reported through callbacks or ATCommandHandle objects.
+ */
+class ATCommandEngine {
+    public:
+        static constexpr size_t queueLength = ARDUINO_CELLULAR_AT_QUEUE_LENGTH; /**< Number of command slots. */
+        static constexpr size_t commandBufferSize = ARDUINO_CELLULAR_AT_COMMAND_BUFFER; /**< Size of the command and payload buffer of a slot. */
+        static constexpr size_t responseBufferSize = ARDUINO_CELLULAR_AT_RESPONSE_BUFFER; /**< Size of the response buffer of a slot. */
+        static constexpr size_t maxLineLength = 128; /**< Maximum length of a received line. */
+
+        /**
+         * @brief Creates an engine that talks to the modem over the given stream.
+         * @param stream The stream connected to the modem.
+         */
+        explicit ATCommandEngine(Stream & stream);
+
+        /**
+         * @brief Queues an AT command.
+         * @param command The command without the leading "AT", e.g. "+CSQ".
+         * @param timeout The time the modem has to answer once the command has been sent (In milliseconds).
+         * @param callback The function called on completion, may be nullptr.
+         * @param context A user pointer passed to the callback.
+         * @return A handle to the command. The handle is invalid if the queue is full.
+         */
+        ATCommandHandle enqueue(const char * command, unsigned long timeout = 1000, ATCommandCallback callback = nullptr, void * context = nullptr);
+
+        /**
+         * @brief Queues an AT command that is followed by a payload once the modem prompts with "> ".
+         * The payload is terminated with Ctrl+Z, as required by +CMGS.
+         * @param command The command without the leading "AT".
+         * @param payload The payload sent after the prompt.
+         * @param timeout The time the modem has to answer once the payload has been sent (In milliseconds).
+         * @param callback The function called on completion, may be nullptr.
+         * @param context A user pointer passed to the callback.
+         * @return A handle to the command. The handle is invalid if the queue is full or the payload does not fit.
+         */
+        ATCommandHandle enqueueWithPayload(const char * command, const char * payload, unsigned long timeout = 1000, ATCommandCallback callback = nullptr, void * context = nullptr);
+
+        /**
+         * @brief Queues an AT command whose response is passed byte by byte to a sink instead of being buffered.
+         * Use it for responses of unbounded length such as +CMGR or +CMGL.
+         * @param command The command without the leading "AT".
+         * @param sink The function receiving the response bytes and detecting its end.
+         * @param timeout The time the modem has to answer once the command has been sent (In milliseconds).
+         * @param callback The function called on completion, may be nullptr.
+         * @param context A user pointer passed to the sink and the callback.
+         * @return A handle to the command. The handle is invalid if the queue is full.
+         */
+        ATCommandHandle enqueueStreaming(const char * command, ATResponseSink sink, unsigned long timeout = 1000, ATCommandCallback callback = nullptr, void * context = nullptr);
+
+        /**
+         * @brief Processes received data, completes and starts commands. Never blocks.
+         * Must be called frequently, e.g. from loop().
+         */
+        void poll();
+
+        /**
+         * @brief Checks whether no command is queued or running.
+         * Blocking library calls must not be used while the engine is busy.
+         * @return True if the engine is idle.
+         */
+        bool isIdle() const { return active < 0 && pendingCount == 0; }
+
+        /**
+         * @brief Discards the partially received line, e.g. noise picked up while the modem was asleep,
+         * so that the next line is parsed from its start. Has no effect on queued or running commands.
+         */
+        void resync();
+
+        /**
+         * @brief Gets the number of free command slots.
+         * @return The number of commands that can still be queued.
+         */
+        size_t getFreeSlots() const;
+
+        /**
+         * @brief Sets the dispatcher that receives the unsolicited result codes found in the modem output.
+         * URCs are recognized both between and inside command responses.
+         * @param dispatcher The dispatcher, or nullptr to treat all lines as responses.
+         */
+        void setURCDispatcher(URCDispatcher * dispatcher) { urcDispatcher = dispatcher; }
+
+    private:
+        friend class ATCommandHandle;
+
+        struct Slot {
+            char command[commandBufferSize];
+            const char * payload;
+            char response[responseBufferSize];
+            size_t responseLength;
+            unsigned long timeout;
+            unsigned long startedAt;
+            ATCommandCallback callback;
+            ATResponseSink sink;
+            void * context;
+            uint16_t sequence;
+            ATCommandStatus status;
+        };
+
+        int allocateSlot();
+        void start(uint8_t slot);
+        void complete(ATCommandStatus status);
+        void processLine();
+        void appendResponse(const char * text);
+
+        Stream * stream;
+        Slot slots[queueLength];
+        uint8_t pending[queueLength];
+        uint8_t pendingHead = 0;
+        uint8_t pendingCount = 0;
+        int active = -1;
+        uint16_t nextSequence = 1;
+        bool awaitingPrompt = false;
+
+        char line[maxLineLength + 1];
+        size_t lineLength = 0;
+
+        URCDispatcher * urcDispatcher = nullptr;
+};
+
+#endif
@@ -0,0 +1,204 @@
+#include "ATCommandMonitor.h"
+
+namespace {
+
+// Finds the announced payload length of +QISEND=<connectID>,<length>, +QFUPL=<name>,<size>,
+// +QHTTPURL=<length>, +QHTTPPOST=<length> and +QHTTPGET=<response time>,<length>
+const char * payloadSize(const char * command) {
+    const char * parameters = strchr(command, '=');
+    if (parameters == nullptr) {
+        return nullptr;
+    }
+    if (strncmp(command, "AT+QHTTPURL=", 12) == 0 || strncmp(command, "AT+QHTTPPOST=", 13) == 0) {
+        return parameters + 1;
+    }
+    const char * second = strchr(parameters, ',');
+    if (strncmp(command, "AT+QISEND=", 10) == 0 || strncmp(command, "AT+QFUPL=", 9) == 0 || strncmp(command, "AT+QHTTPGET=", 12) == 0) {
+        return second != nullptr ? second + 1 : nullptr;
+    }
+    return nullptr;
+}
+
+}
+
+ATCommandMonitor::ATCommandMonitor(Stream & modem) : modem(modem) {
+}
+
+void ATCommandMonitor::resetStats() {
+    stats.reset();
+    current = nullptr;
+    previous = nullptr;
+}
+
+void ATCommandMonitor::setSuspended(bool suspended) {
+    if (suspended && current != nullptr) {
+        // E.g. the CONNECT of a transparent socket
+        endCommand(false);
+    }
+    if (!suspended) {
+        atLineStart = true;
+        inCommand = false;
+        payload = false;
+        countedPayload = 0;
+        lineFeedPending = false;
+        lineLength = 0;
+    }
+    this->suspended = suspended;
+}
+
+int ATCommandMonitor::available() {
+    return modem.available();
+}
+
+int ATCommandMonitor::read() {
+    int c = modem.read();
+    if (c >= 0 && !suspended) {
+        received(static_cast<uint8_t>(c));
+    }
+    return c;
+}
+
+int ATCommandMonitor::peek() {
+    return modem.peek();
+}
+
+size_t ATCommandMonitor::write(uint8_t c) {
+    if (!suspended) {
+        sent(c);
+    }
+    return modem.write(c);
+}
+
+size_t ATCommandMonitor::write(const uint8_t * buffer, size_t size) {
+    for (size_t i = 0; i < size && !suspended; i++) {
+        sent(buffer[i]);
+    }
+    return modem.write(buffer, size);
+}
+
+void ATCommandMonitor::flush() {
+    modem.flush();
+}
+
+void ATCommandMonitor::sent(uint8_t c) {
+    if (countedPayload > 0 && !inCommand) {
+        ATCommandStats::Entry * entry = current != nullptr ? current : previous;
+        if (entry != nullptr) {
+            entry->bytesSent++;
+        }
+        // The line feed after the command line is not part of the payload
+        if (lineFeedPending) {
+            lineFeedPending = false;
+            if (c == '\n') {
+                return;
+            }
+        }
+        if (--countedPayload == 0) {
+            payload = false;
+            payloadWritten = true;
+            atLineStart = true;
+        }
+        return;
+    }
+
+    // Ctrl+Z and ESC end the text of an SMS message, the next command follows without a line end
+    bool lineEnd = c == '\r' || c == '\n' || c == 0x1A || c == 0x1B;
+    if (!payload && atLineStart && (c == 'A' || c == 'a')) {
+        inCommand = true;
+        commandLength = 0;
+        lineBytes = 0;
+    }
+
+    if (inCommand) {
+        lineBytes++;
+        if (lineEnd) {
+            inCommand = false;
+            startCommand();
+        } else if (commandLength < sizeof(command) - 1) {
+            command[commandLength++] = static_cast<char>(c);
+        }
+    } else {
+        // Line ends and data written after the command line
+        ATCommandStats::Entry * entry = current != nullptr ? current : previous;
+        if (entry != nullptr) {
+            entry->bytesSent++;
+        }
+    }
+    atLineStart = lineEnd;
+}
+
+void ATCommandMonitor::startCommand() {
+    // A command whose payload was written completely may be pipelined, its result is still to come
+    if (current != nullptr && !payloadWritten) {
+        current->timeouts++;
+    }
+    payloadWritten = false;
+
+    // The parameters do not identify the command
+    size_t length = strcspn(command, "=?;");
+    if (length > commandLength) {
+        length = commandLength;
+    }
+    current = &stats.record(command, length);
+    current->count++;
+    current->bytesSent += lineBytes;
+    previous = current;
+    payload = false;
+    lineLength = 0;
+    startedAt = micros();
+
+    // The payload follows a prompt or CONNECT that may not have been read yet, so its length is tracked instead
+    command[commandLength] = '\0';
+    const char * size = payloadSize(command);
+    countedPayload = size != nullptr ? strtoul(size, nullptr, 10) : 0;
+    lineFeedPending = countedPayload > 0;
+}
+
+void ATCommandMonitor::received(uint8_t c) {
+    if (current != nullptr) {
+        current->bytesReceived++;
+    } else {
+        stats.addUnsolicitedBytes(1);
+    }
+
+    if (c == '\r') {
+        return;
+    }
+    if (c != '\n') {
+        if (lineLength < sizeof(line) - 1) {
+            line[lineLength++] = static_cast<char>(c);
+        }
+        // The prompt for the text of an SMS message is not followed by a line end
+        if (lineLength == 1 && c == '>' && current != nullptr) {
+            payload = true;
+        }
+        return;
+    }
+
+    line[lineLength] = '\0';
+    lineLength = 0;
+    if (current == nullptr) {
+        return;
+    }
+    if (strcmp(line, "OK") == 0 || strcmp(line, "SEND OK") == 0) {
+        endCommand(false);
+    } else if (strcmp(line, "SEND FAIL") == 0 || strncmp(line, "ERROR", 5) == 0 || strncmp(line, "+CME ERROR", 10) == 0 || strncmp(line, "+CMS ERROR", 10) == 0) {
+        endCommand(true);
+    } else if (strncmp(line, "CONNECT", 7) == 0) {
+        payload = true;
+    }
+}
+
+void ATCommandMonitor::endCommand(bool error) {
+    uint32_t latency = (micros() - startedAt) / 1000;
+    if (error) {
+        current->errors++;
+    }
+    current->totalLatency += latency;
+    if (latency > current->maxLatency) {
+        current->maxLatency = latency;
+    }
+    current->histogram[ATCommandStats::getBucket(latency)]++;
+    current = nullptr;
+    payload = false;
+}
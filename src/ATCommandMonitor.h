@@ -0,0 +1,97 @@
+/**
+ * @file ATCommandMonitor.h
+ * @brief Header file for the ATCommandMonitor class.
+ */
+
+#ifndef ARDUINO_CELLULAR_AT_COMMAND_MONITOR_H
+#define ARDUINO_CELLULAR_AT_COMMAND_MONITOR_H
+
+#include <Arduino.h>
+#include <ATCommandStats.h>
+
+/**
+ * @class ATCommandMonitor
+ * @brief A Stream that passes the traffic between the library and the modem through and collects ATCommandStats.
+ *
+ * A command starts with the "AT" at the beginning of a line written to the modem and runs until a final result code
+ * (OK, ERROR, +CME ERROR or +CMS ERROR, and SEND OK or SEND FAIL for +QISEND) is read. A command that is still running
+ * when the next one starts is counted as timeout, unless it is a +QISEND whose payload has been written, which
+ * socket clients may pipeline.
+ * Bytes written after the command line, e.g. the text of an SMS message, count towards the command. Payloads whose
+ * length the command announces (+QISEND, +QFUPL and the +QHTTP commands) are skipped by length, so data that
+ * looks like a command line is not taken for one.
+ * The monitor only looks at each byte once and never allocates memory, so it can stay enabled in production.
+ *
+ * ModemInterface routes all traffic, blocking, asynchronous and that of TinyGSM, through a monitor.
+ */
+class ATCommandMonitor : public Stream {
+    public:
+        /**
+         * @brief Creates a monitor.
+         * @param modem The stream connected to the modem.
+         */
+        explicit ATCommandMonitor(Stream & modem);
+
+        /**
+         * @brief Gets the stream connected to the modem.
+         * @return The stream.
+         */
+        Stream & getStream() const { return modem; }
+
+        /**
+         * @brief Gets the collected statistics.
+         * @return The statistics, updated as the modem is used.
+         */
+        const ATCommandStats & getStats() const { return stats; }
+
+        /**
+         * @brief Clears the collected statistics.
+         */
+        void resetStats();
+
+        /**
+         * @brief Stops or resumes looking at the traffic, e.g. while the UART carries the payload of a transparent
+         * socket. The traffic is passed through while suspended. Suspending ends the running command, which is
+         * taken as answered, and resuming expects the next command at the start of a line.
+         * @param suspended True to suspend.
+         */
+        void setSuspended(bool suspended);
+
+        int available() override;
+        int read() override;
+        int peek() override;
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t * buffer, size_t size) override;
+        using Print::write;
+        void flush() override;
+
+    private:
+        void sent(uint8_t c);
+        void received(uint8_t c);
+        void startCommand();
+        void endCommand(bool error);
+
+        Stream & modem;
+        ATCommandStats stats;
+
+        ATCommandStats::Entry * current = nullptr; /**< The statistics of the running command, nullptr if none runs. */
+        ATCommandStats::Entry * previous = nullptr; /**< The statistics of the last command, receives its payload bytes. */
+        unsigned long startedAt = 0; /**< When the command line of the running command was complete (In microseconds). */
+
+        char command[40]; /**< The beginning of the command line being written, long enough for the announced payload length. */
+        uint8_t commandLength = 0;
+        uint16_t lineBytes = 0; /**< Length of the command line being written. */
+        bool atLineStart = true; /**< True if the next byte written starts a line. */
+        bool inCommand = false; /**< True while a command line is being written. */
+        bool payload = false; /**< True after a "> " prompt or CONNECT, when written bytes are data and not commands. */
+        uint32_t countedPayload = 0; /**< Bytes of an announced payload, e.g. of +QISEND, that are still to be written. */
+        bool lineFeedPending = false; /**< True until the byte after the command line of a counted payload has been seen. */
+        bool payloadWritten = false; /**< True once the announced payload of the running command has been written. */
+
+        char line[12]; /**< The beginning of the line being read, to detect final result codes. */
+        uint8_t lineLength = 0;
+
+        bool suspended = false; /**< True while the traffic is passed through without being looked at. */
+};
+
+#endif
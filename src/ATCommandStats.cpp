@@ -0,0 +1,98 @@
+#include "ATCommandStats.h"
+
+#include <stdarg.h>
+
+namespace {
+
+// Appends like snprintf, counting the characters that do not fit
+void append(char * buffer, size_t size, size_t & length, const char * format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int written = vsnprintf(length < size ? buffer + length : nullptr, length < size ? size - length : 0, format, arguments);
+    va_end(arguments);
+    if (written > 0) {
+        length += written;
+    }
+}
+
+}
+
+uint32_t ATCommandStats::Entry::getAverageLatency() const {
+    uint32_t answered = count - timeouts;
+    return answered > 0 ? totalLatency / answered : 0;
+}
+
+ATCommandStats::ATCommandStats() {
+    reset();
+}
+
+void ATCommandStats::reset() {
+    memset(entries, 0, sizeof(entries));
+    entryCount = 0;
+    unsolicitedBytes = 0;
+}
+
+const ATCommandStats::Entry * ATCommandStats::find(const char * command) const {
+    for (size_t i = 0; i < entryCount; i++) {
+        if (strcmp(entries[i].command, command) == 0) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+ATCommandStats::Entry & ATCommandStats::record(const char * command, size_t length) {
+    if (length > maxCommandLength) {
+        length = maxCommandLength;
+    }
+    for (size_t i = 0; i < entryCount; i++) {
+        if (strncmp(entries[i].command, command, length) == 0 && entries[i].command[length] == '\0') {
+            return entries[i];
+        }
+    }
+
+    if (entryCount < slotCount - 1) {
+        Entry & entry = entries[entryCount++];
+        memcpy(entry.command, command, length);
+        entry.command[length] = '\0';
+        return entry;
+    }
+    // The last slot collects all commands that found the table full
+    Entry & overflow = entries[slotCount - 1];
+    if (entryCount < slotCount) {
+        strcpy(overflow.command, "*");
+        entryCount = slotCount;
+    }
+    return overflow;
+}
+
+size_t ATCommandStats::getBucket(uint32_t latency) {
+    if (latency == 0) {
+        return 0;
+    }
+    size_t bucket = 32 - __builtin_clz(latency);
+    return bucket < bucketCount ? bucket : bucketCount - 1;
+}
+
+size_t ATCommandStats::serialize(char * buffer, size_t size) const {
+    size_t length = 0;
+    append(buffer, size, length, "ATSTATS 1 %u %lu\n", static_cast<unsigned int>(bucketCount), static_cast<unsigned long>(unsolicitedBytes));
+    for (size_t i = 0; i < entryCount; i++) {
+        const Entry & entry = entries[i];
+        append(buffer, size, length, "%s %lu %lu %lu %lu %lu %lu %lu", entry.command,
+               static_cast<unsigned long>(entry.count), static_cast<unsigned long>(entry.timeouts),
+               static_cast<unsigned long>(entry.errors), static_cast<unsigned long>(entry.bytesSent),
+               static_cast<unsigned long>(entry.bytesReceived), static_cast<unsigned long>(entry.totalLatency),
+               static_cast<unsigned long>(entry.maxLatency));
+
+        size_t last = bucketCount;
+        while (last > 0 && entry.histogram[last - 1] == 0) {
+            last--;
+        }
+        for (size_t bucket = 0; bucket < last; bucket++) {
+            append(buffer, size, length, bucket == 0 ? " %lu" : ",%lu", static_cast<unsigned long>(entry.histogram[bucket]));
+        }
+        append(buffer, size, length, "\n");
+    }
+    return length;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file ATCommandStats.h
+ * @brief Header file for the ATCommandStats class.
+ */
+
+#ifndef ARDUINO_CELLULAR_AT_COMMAND_STATS_H
+#define ARDUINO_CELLULAR_AT_COMMAND_STATS_H
+
+#include <Arduino.h>
+
+#ifndef ARDUINO_CELLULAR_COMMAND_STATS_SLOTS
+/**
+ * Number of distinct commands tracked by ATCommandStats. Further commands are counted together under "*".
+ */
+#define ARDUINO_CELLULAR_COMMAND_STATS_SLOTS 24
+#endif
+
+/**
+ * @class ATCommandStats
+ * @brief Counters and latency histograms of the AT commands sent to the modem, per command.
+ *
+ * Commands are identified by the beginning of the command line up to the first '=', '?' or ';',
+ * e.g. "AT+CSQ" or "AT+QGPSLOC". Each command has a fixed slot with its number of calls, timeouts and error
+ * responses, the bytes sent and received while it ran, and a histogram of the time from the end of the
+ * command line to the final result code. The histogram buckets double in width:
+ * bucket 0 holds latencies below 1 ms, bucket i latencies from 2^(i-1) to 2^i ms, the last bucket everything longer.
+ *
+ * The statistics are collected by an ATCommandMonitor. Copy the object to take a consistent snapshot.
+ */
+class ATCommandStats {
+    public:
+        static constexpr size_t slotCount = ARDUINO_CELLULAR_COMMAND_STATS_SLOTS; /**< Number of tracked commands, including "*". */
+        static constexpr size_t bucketCount = 16; /**< Number of latency buckets. */
+        static constexpr size_t maxCommandLength = 19; /**< Longest tracked command name, longer names are truncated. */
+
+        static_assert(slotCount >= 2, "The statistics need at least one command slot and the overflow slot");
+
+        /**
+         * @struct Entry
+         * @brief The statistics of one command.
+         */
+        struct Entry {
+            char command[maxCommandLength + 1]; /**< The command, e.g. "AT+CSQ". */
+            uint32_t count; /**< Number of times the command was sent. */
+            uint32_t timeouts; /**< Number of times no final result code arrived before the next command. */
+            uint32_t errors; /**< Number of ERROR, +CME ERROR and +CMS ERROR responses. */
+            uint32_t bytesSent; /**< Bytes written from the start of the command to the start of the next one. */
+            uint32_t bytesReceived; /**< Bytes read while the command was running. */
+            uint32_t totalLatency; /**< Sum of the latencies of all answered calls (In milliseconds). */
+            uint32_t maxLatency; /**< Longest latency (In milliseconds). */
+            uint32_t histogram[bucketCount]; /**< Number of answered calls per latency bucket. */
+
+            /**
+             * @brief Gets the average latency of the answered calls.
+             * @return The average (In milliseconds).
+             */
+            uint32_t getAverageLatency() const;
+        };
+
+        /**
+         * @brief Creates empty statistics.
+         */
+        ATCommandStats();
+
+        /**
+         * @brief Clears all counters.
+         */
+        void reset();
+
+        /**
+         * @brief Gets the number of tracked commands.
+         * @return The number of used slots.
+         */
+        size_t getEntryCount() const { return entryCount; }
+
+        /**
+         * @brief Gets the statistics of a tracked command.
+         * @param index The slot, from 0 to getEntryCount() - 1.
+         * @return The statistics.
+         */
+        const Entry & getEntry(size_t index) const { return entries[index]; }
+
+        /**
+         * @brief Finds the statistics of a command.
+         * @param command The command, e.g. "AT+CSQ".
+         * @return The statistics, nullptr if the command has not been sent.
+         */
+        const Entry * find(const char * command) const;
+
+        /**
+         * @brief Gets the number of bytes received while no command was running, i.e. unsolicited result codes.
+         * @return The number of bytes.
+         */
+        uint32_t getUnsolicitedBytes() const { return unsolicitedBytes; }
+
+        /**
+         * @brief Writes the statistics in a compact text form, one line per command:
+         * <command> <count> <timeouts> <errors> <bytes sent> <bytes received> <total ms> <max ms> <histogram>
+         * The histogram is a comma separated list of the bucket counts without trailing zero buckets.
+         * The first line is "ATSTATS 1 <bucket count> <unsolicited bytes>".
+         * @param buffer The buffer, always null terminated if size is not 0.
+         * @param size The size of the buffer.
+         * @return The length of the complete text, which was truncated if it is not smaller than size.
+         */
+        size_t serialize(char * buffer, size_t size) const;
+
+        /**
+         * @brief Gets the statistics slot of a command, allocating it if needed.
+         * @param command The command name.
+         * @param length The length of the name.
+         * @return The slot.
+         */
+        Entry & record(const char * command, size_t length);
+
+        /**
+         * @brief Adds bytes received while no command was running.
+         * @param count The number of bytes.
+         */
+        void addUnsolicitedBytes(uint32_t count) { unsolicitedBytes += count; }
+
+        /**
+         * @brief Gets the histogram bucket of a latency.
+         * @param latency The latency (In milliseconds).
+         * @return The bucket.
+         */
+        static size_t getBucket(uint32_t latency);
+
+    private:
+        Entry entries[slotCount];
+        size_t entryCount = 0;
+        uint32_t unsolicitedBytes = 0;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "ATResponseBuffer.h"
+
+namespace {
+
+void reverse(char * buffer, size_t from, size_t to) {
+    while (from + 1 < to) {
+        char swapped = buffer[from];
+        buffer[from++] = buffer[--to];
+        buffer[to] = swapped;
+    }
+}
+
+}
+
+ATResponseBuffer::ATResponseBuffer() : buffer(&empty), capacity(0), keepEnd(false) {
+}
+
+ATResponseBuffer::ATResponseBuffer(char * buffer, size_t size, bool keepEnd)
+    : buffer(size > 0 ? buffer : &empty), capacity(size > 0 ? size - 1 : 0), keepEnd(keepEnd) {
+    this->buffer[0] = '\0';
+}
+
+void ATResponseBuffer::clear() {
+    used = 0;
+    start = 0;
+    dropped = 0;
+    buffer[0] = '\0';
+}
+
+void ATResponseBuffer::append(char c) {
+    if (used < capacity) {
+        buffer[(start + used) % capacity] = c;
+        used++;
+        return;
+    }
+    dropped++;
+    if (keepEnd && capacity > 0) {
+        // Overwrite the oldest character
+        buffer[start] = c;
+        start = (start + 1) % capacity;
+    }
+}
+
+const char * ATResponseBuffer::c_str() {
+    if (start > 0) {
+        // Rotate the ring to the start of the memory by reversing both parts and then the whole
+        reverse(buffer, 0, start);
+        reverse(buffer, start, used);
+        reverse(buffer, 0, used);
+        start = 0;
+    }
+    buffer[used] = '\0';
+    return buffer;
+}
+
+const char * ATResponseBuffer::find(const char * text) {
+    return strstr(c_str(), text);
+}
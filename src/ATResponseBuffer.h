@@ -0,0 +1,106 @@
+/**
+ * @file ATResponseBuffer.h
+ * @brief Header file for the ATResponseBuffer class.
+ */
+
+#ifndef ARDUINO_CELLULAR_AT_RESPONSE_BUFFER_H
+#define ARDUINO_CELLULAR_AT_RESPONSE_BUFFER_H
+
+#include <Arduino.h>
+
+/**
+ * @class ATResponseBuffer
+ * @brief Collects the response to an AT command in caller supplied memory instead of a String.
+ *
+ * A response that does not fit is truncated and the number of dropped characters is reported.
+ * By default the beginning of the response is kept; in ring mode the end is kept instead,
+ * which is where the interesting part of long listings such as +QENG or +CMGL often is.
+ * The content is always null terminated, so a buffer of size N holds N - 1 characters.
+ */
+class ATResponseBuffer {
+    public:
+        /**
+         * @brief Creates a buffer that discards the response, for when only the result code matters.
+         */
+        ATResponseBuffer();
+
+        /**
+         * @brief Creates a buffer.
+         * @param buffer The memory the response is written to, must stay valid while the buffer is in use.
+         * @param size The size of the memory (In bytes).
+         * @param keepEnd True to keep the end of a response that does not fit (ring mode), false to keep its beginning.
+         */
+        ATResponseBuffer(char * buffer, size_t size, bool keepEnd = false);
+
+        /**
+         * @brief Empties the buffer.
+         */
+        void clear();
+
+        /**
+         * @brief Appends a character of the response.
+         * @param c The character.
+         */
+        void append(char c);
+
+        /**
+         * @brief Gets the response as C string.
+         * In ring mode, the content is moved to the start of the memory first.
+         * @return The response.
+         */
+        const char * c_str();
+
+        /**
+         * @brief Gets the length of the stored response.
+         * @return The number of stored characters.
+         */
+        size_t length() const { return used; }
+
+        /**
+         * @brief Checks if characters of the response were dropped.
+         * @return True if the response did not fit.
+         */
+        bool isTruncated() const { return dropped > 0; }
+
+        /**
+         * @brief Gets the number of characters of the response that did not fit.
+         * @return The number of dropped characters.
+         */
+        size_t getDroppedCount() const { return dropped; }
+
+        /**
+         * @brief Finds a text in the stored response.
+         * @param text The text to search for.
+         * @return A pointer to the first occurrence, nullptr if there is none.
+         */
+        const char * find(const char * text);
+
+    private:
+        char * buffer;
+        size_t capacity; /**< Number of characters that fit, without the terminator. */
+        size_t used = 0;
+        size_t start = 0; /**< Position of the first character in ring mode. */
+        size_t dropped = 0;
+        bool keepEnd;
+        char empty = '\0'; /**< The content of a buffer without memory. */
+};
+
+/**
+ * @class StaticATResponseBuffer
+ * @brief An ATResponseBuffer with its own memory, e.g. on the stack.
+ * @tparam N The size of the memory (In bytes).
+ */
+template<size_t N>
+class StaticATResponseBuffer : public ATResponseBuffer {
+    public:
+        /**
+         * @brief Creates a buffer.
+         * @param keepEnd True to keep the end of a response that does not fit, false to keep its beginning.
+         */
+        explicit StaticATResponseBuffer(bool keepEnd = false) : ATResponseBuffer(storage, N, keepEnd) {}
+
+    private:
+        char storage[N];
+};
+
+#endif
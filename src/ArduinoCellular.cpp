@@ -5,433 +5,1824 @@
   #include "Watchdog.h"
 #endif
 
+namespace {
+
+// The settings applied by begin(): SMS text mode, the GSM character set and +CMTI indications for new messages
+constexpr char configurationCommand[] =
+#if ARDUINO_CELLULAR_SMS
+    "+CMGF=1;+CSCS=\"GSM\";+CNMI=2,1,0,0,0";
+#else
+    "+CSCS=\"GSM\"";
+#endif
+
+// FNV-1a hash, evaluated at compile time
+constexpr uint32_t hashText(const char * text, uint32_t hash = 2166136261UL) {
+    return *text == '\0' ? hash : hashText(text + 1, (hash ^ static_cast<uint8_t>(*text)) * 16777619UL);
+}
+
+/**
+ * The configuration last applied to the modem. It survives resets of the microcontroller, but not of the modem,
+ * which beginWarm() detects from the echo. The check word tells a stored record from random memory after power-up.
+ * The SMS format is noted before every switch to PDU mode, as the library may be reset before it switches back.
+ */
+struct ConfigurationRecord {
+    static constexpr uint32_t magic = 0x43454C4CUL;
+    static constexpr uint32_t configurationFingerprint = hashText(configurationCommand) ^ ARDUINO_CELLULAR_PROFILE;
+
+    uint32_t marker;
+    uint32_t fingerprint;
+    uint32_t model;
+    uint32_t smsPDUMode;
+    uint32_t check;
+
+    uint32_t checkWord() const {
+        return ~(marker ^ fingerprint ^ (model * 2654435761UL) ^ (smsPDUMode << 31));
+    }
+
+    bool matches() const {
+        return marker == magic && fingerprint == configurationFingerprint && check == checkWord();
+    }
+
+    void store(ModemModel detected) {
+        marker = magic;
+        fingerprint = configurationFingerprint;
+        model = static_cast<uint32_t>(detected);
+        smsPDUMode = 0;
+        check = checkWord();
+    }
+
+    void noteSMSFormat(bool pdu) {
+        if(matches()){
+            smsPDUMode = pdu ? 1 : 0;
+            check = checkWord();
+        }
+    }
+
+    void clear() {
+        marker = 0;
+    }
+};
+
+ARDUINO_CELLULAR_NOINIT ConfigurationRecord configurationRecord;
+
+// Checks the <stat> field of a +CREG?, +CEREG? or +CGREG? response for home network or roaming registration
+bool isRegistered(const char * response){
+    const char * stat = strchr(response, ',');
+    if(stat == nullptr){
+        return false;
+    }
+    int status = atoi(stat + 1);
+    return status == 1 || status == 5;
+}
+
+// The text between the first and the last quote of a response line, e.g. the message of +CUSD
+String quotedText(const char * line){
+    const char * start = strchr(line, '"');
+    const char * end = strrchr(line, '"');
+    if(start == nullptr || end == start){
+        return String();
+    }
+    String text;
+    text.reserve(end - start - 1);
+    for(const char * c = start + 1; c < end; c++){
+        text += *c;
+    }
+    return text;
+}
+
+}
+
+ArduinoCellular * ArduinoCellular::timeSource = nullptr;
+
 unsigned long ArduinoCellular::getTime() {
-    int year, month, day, hour, minute, second;
-    float tz;
-    modem.getNetworkTime(&year, &month, &day, &hour, &minute, &second, &tz);
-    return Time(year, month, day, hour, minute, second).getUNIXTimestamp();
+    return timeSource != nullptr ? timeSource->getUNIXTime() : 0;
+}
+
+ArduinoCellular::ArduinoCellular() : ArduinoCellular(::modem) {
+}
+
+#if ARDUINO_CELLULAR_SMS
+ArduinoCellular::ArduinoCellular(ModemInterface& modem) : modem(modem), commandEngine(*modem.stream), incomingSMSParser(deliverIncomingSMS, this), httpClients(modem) {
+    commandEngine.setURCDispatcher(&urcDispatcher);
+    modem.setURCDispatcher(&urcDispatcher);
+    urcDispatcher.on("+CMTI:", onNewMessageIndication, this);
+    incomingSMSParser.setURCDispatcher(&urcDispatcher);
+}
+#else
+ArduinoCellular::ArduinoCellular(ModemInterface& modem) : modem(modem), commandEngine(*modem.stream), httpClients(modem) {
+    commandEngine.setURCDispatcher(&urcDispatcher);
+    modem.setURCDispatcher(&urcDispatcher);
+}
+#endif
+
+void ArduinoCellular::begin() {
+    unsigned long startedAt = millis();
+    bootTimings = BootTimings();
+    modem.powerOn();
+    bootTimings.power = millis() - startedAt;
+    initializeModem(startedAt);
+}
+
+bool ArduinoCellular::beginWarm() {
+    unsigned long startedAt = millis();
+    bootTimings = BootTimings();
+    modem.powerOn(false);
+    bootTimings.power = millis() - startedAt;
+
+    unsigned long phaseStartedAt = millis();
+    StaticATResponseBuffer<32> probe;
+    bootTimings.warm = modem.probe(probe);
+    bootTimings.probe = millis() - phaseStartedAt;
+
+    if(!bootTimings.warm){
+        // The modem is off or still booting, give it the rest of the boot time
+        phaseStartedAt = millis();
+        modem.powerOn();
+        bootTimings.power += millis() - phaseStartedAt;
+        initializeModem(startedAt);
+        return false;
+    }
+
+    // The ATE0 of the last initialization is lost when the modem restarts
+    bool restarted = probe.find("AT") != nullptr;
+    if(!restarted && configurationRecord.matches()){
+        if(ModemProfile::detect){
+            this->model = static_cast<ModemModel>(configurationRecord.model);
+        }
+#if ARDUINO_CELLULAR_SMS
+        // The library was reset while the modem was in PDU mode, the configuration expects text mode
+        if(configurationRecord.smsPDUMode != 0 && !selectSMSFormat(false)){
+            initializeModem(startedAt);
+            return true;
+        }
+#endif
+        bootTimings.configurationSkipped = true;
+        completeBegin(startedAt);
+        return true;
+    }
+
+    initializeModem(startedAt);
+    return true;
+}
+
+void ArduinoCellular::initializeModem(unsigned long startedAt) {
+    unsigned long phaseStartedAt = millis();
+    modem.init();
+ 
+    // A fixed profile knows the model, the constant condition removes the detection
+    if(ModemProfile::detect){
+        StaticATResponseBuffer<128> modemInfo;
+        this->sendATCommand("I", modemInfo);
+        if(modemInfo.find(EC200AProfile::identifier()) != nullptr){
+            this->model = ModemModel::EC200;
+        } else if (modemInfo.find(EG25Profile::identifier()) != nullptr){
+            this->model = ModemModel::EG25;
+        } else if (modemInfo.find(BG96Profile::identifier()) != nullptr){
+            this->model = ModemModel::BG96;
+        } else {
+            this->model = ModemModel::Unsupported;
+        }
+    }
+    bootTimings.init = millis() - phaseStartedAt;
+
+    // All settings in one round trip
+    phaseStartedAt = millis();
+    modem.sendAT(configurationCommand);
+    if(modem.waitResult() == 1){
+        configurationRecord.store(this->model);
+    } else {
+        configurationRecord.clear();
+    }
+    bootTimings.configuration = millis() - phaseStartedAt;
+
+    completeBegin(startedAt);
+}
+
+void ArduinoCellular::completeBegin(unsigned long startedAt) {
+#if defined(ARDUINO_CELLULAR_BEARSSL)
+    timeSource = this;
+    ArduinoBearSSL.onGetTime(ArduinoCellular::getTime);
+#endif
+
+    bootTimings.total = millis() - startedAt;
+}
+
+const BootTimings & ArduinoCellular::getBootTimings() const {
+    return bootTimings;
+}
+
+bool ArduinoCellular::setPSM(bool enable, unsigned long periodicTAU, unsigned long activeTime){
+    if(!enable){
+        modem.sendAT(GF("+CPSMS=0"));
+        return modem.waitResult() == 1;
+    }
+
+    char tau[PowerSavingTimers::timerLength + 1];
+    char active[PowerSavingTimers::timerLength + 1];
+    PowerSavingTimers::encodePeriodicTAU(periodicTAU, tau);
+    PowerSavingTimers::encodeActiveTime(activeTime, active);
+    // +CPSMS=<mode>,<RAU>,<GPRS-READY>,<TAU>,<active time>, the 2G and 3G timers are left at their defaults
+    modem.sendAT(GF("+CPSMS=1,,,\""), tau, GF("\",\""), active, GF("\""));
+    return modem.waitResult() == 1;
+}
+
+bool ArduinoCellular::setEDRX(bool enable, unsigned long cycle, EDRXAccessTechnology technology){
+    if(!enable){
+        modem.sendAT(GF("+CEDRXS=0"));
+        return modem.waitResult() == 1;
+    }
+
+    char value[PowerSavingTimers::cycleLength + 1];
+    PowerSavingTimers::encodeEDRXCycle(cycle, value);
+    modem.sendAT(GF("+CEDRXS=1,"), static_cast<int>(technology), GF(",\""), value, GF("\""));
+    return modem.waitResult() == 1;
+}
+
+bool ArduinoCellular::setSleepMode(bool enable, int dtrPin){
+    if(dtrPin >= 0){
+        modem.setDTRPin(dtrPin);
+    }
+    modem.sendAT(enable ? GF("+QSCLK=1") : GF("+QSCLK=0"));
+    return modem.waitResult() == 1;
+}
+
+bool ArduinoCellular::sleep(){
+    if(!commandEngine.isIdle()){
+        return false;
+    }
+    return modem.setDTR(true);
+}
+
+bool ArduinoCellular::wake(unsigned long timeout){
+    if(!commandEngine.isIdle()){
+        return false;
+    }
+
+    unsigned long startedAt = millis();
+    modem.setDTR(false);
+    commandEngine.resync();
+
+    // Commands sent before the modem is ready are lost, the probe is repeated until one is answered
+    bool awake = false;
+    while(!awake && millis() - startedAt < timeout){
+        ATCommandHandle probe = commandEngine.enqueue("", wakeProbeTimeout);
+        if(!probe.isValid()){
+            break;
+        }
+        while(!probe.isDone()){
+            commandEngine.poll();
+            urcDispatcher.dispatch();
+        }
+        awake = probe.getStatus() == AT_COMMAND_OK;
+    }
+
+    if(!awake){
+        wakeStats.failures++;
+        return false;
+    }
+
+    unsigned long latency = millis() - startedAt;
+    wakeStats.last = latency;
+    if(wakeStats.count == 0 || latency < wakeStats.minimum){
+        wakeStats.minimum = latency;
+    }
+    if(latency > wakeStats.maximum){
+        wakeStats.maximum = latency;
+    }
+    wakeStats.total += latency;
+    wakeStats.count++;
+    return true;
+}
+
+const WakeStats & ArduinoCellular::getWakeStats() const {
+    return wakeStats;
+}
+
+void ArduinoCellular::resetWakeStats(){
+    wakeStats = WakeStats();
+}
+
+bool ArduinoCellular::connect(String apn, bool waitForever) {
+    return connect(apn, String(""), String(""), waitForever);
+}
+
+
+bool ArduinoCellular::connect(String apn, String username, String password, bool waitForever){
+    if(!connectAsync(apn.c_str(), username.c_str(), password.c_str(), nullptr, nullptr, waitForever)){
+        return false;
+    }
+
+    while(connection.phase != CONNECTION_CONNECTED && connection.phase != CONNECTION_FAILED){
+        poll();
+        #if defined(ARDUINO_ARCH_MBED)
+            if(mbed::Watchdog::get_instance().is_running()) {
+                mbed::Watchdog::get_instance().kick();
+            }
+        #endif
+    }
+
+    return connection.phase == CONNECTION_CONNECTED;
+}
+
+
+#if ARDUINO_CELLULAR_GNSS
+Geolocation ArduinoCellular::getGPSLocation(unsigned long timeout){
+    if (supportsGNSS()){
+        Geolocation loc = { 0.0f, 0.0f };
+        GNSSFix fix;
+        unsigned long startTime = millis();
+
+        // The validity flag tells a missing fix apart from the coordinates 0.0, 0.0
+        while(!getGNSSFix(fix, 0) && (millis() - startTime < timeout)) {
+            delay(1000);
+        }
+        if(fix.valid){
+            loc.latitude = fix.getLatitude();
+            loc.longitude = fix.getLongitude();
+        }
+
+        return loc;
+    } else {
+        if(this->debugStream != nullptr){
+            this->debugStream->println("Unsupported modem model");
+        }
+        return Geolocation();
+    }
+}
+
+bool ArduinoCellular::getGNSSFix(GNSSFix & fix, unsigned long maxAge){
+    if(maxAge > 0 && getCachedFix(fix, maxAge)){
+        return fix.valid;
+    }
+    if(!supportsGNSS()){
+        if(this->debugStream != nullptr){
+            this->debugStream->println("Unsupported modem model");
+        }
+        fix = GNSSFix();
+        return false;
+    }
+
+    queryGNSSFix();
+    fix = lastFix;
+    return fix.valid;
+}
+
+bool ArduinoCellular::queryGNSSFix(){
+    // Mode 2 reports degrees with decimals, and the date, which makes the fix self-contained
+    modem.sendAT(GF("+QGPSLOC=2"));
+    StaticATResponseBuffer<ModemProfile::locationResponseSize> response;
+    modem.waitResponse(1000, response, nullptr, "+QGPSLOC=2");
+    NMEAParser::parseLocationResponse(response.c_str(), lastFix);
+    lastFixCached = true;
+    recordFirstFix(lastFix);
+    return lastFix.valid;
+}
+
+bool ArduinoCellular::getCachedFix(GNSSFix & fix, unsigned long maxAge) const {
+    unsigned long now = millis();
+    // Until the first fix after a restart of the receiver, older fixes would spoil the time to first fix
+    unsigned long oldest = ttff.running ? now - ttff.startedAt : maxAge;
+    if(oldest < maxAge){
+        maxAge = oldest;
+    }
+
+    bool found = false;
+    if(lastFixCached && now - lastFix.acquiredAt < maxAge){
+        fix = lastFix;
+        found = true;
+    }
+
+    // The stream may hold a more recent fix
+    GNSSFix streamed;
+    if(nmeaParser.getLatestFix(streamed) && now - streamed.acquiredAt < maxAge
+       && (!found || static_cast<long>(streamed.acquiredAt - fix.acquiredAt) > 0)){
+        fix = streamed;
+        found = true;
+    }
+    return found;
+}
+
+bool ArduinoCellular::startGNSS(GNSSStartType type){
+    if(!supportsGNSS()){
+        if(this->debugStream != nullptr){
+            this->debugStream->println("Unsupported modem model");
+        }
+        return false;
+    }
+
+    // Aiding data can only be deleted while the receiver is off, +QGPSEND fails if it already is
+    modem.sendAT(GF("+QGPSEND"));
+    modem.waitResult();
+    modem.sendAT(GF("+QGPSDEL="), static_cast<int>(type));
+    if(modem.waitResult() != 1){
+        return false;
+    }
+    modem.sendAT(GF("+QGPS=1"));
+    if(modem.waitResult() != 1){
+        return false;
+    }
+
+    if(ttff.running){
+        ttffStats[ttff.type].abandoned++;
+    }
+    lastFixCached = false;
+    nmeaParser.reset();
+    ttff.type = type;
+    ttff.startedAt = millis();
+    ttff.running = true;
+    return true;
+}
+
+const TTFFStats & ArduinoCellular::getTTFFStats(GNSSStartType type) const {
+    return ttffStats[type];
+}
+
+void ArduinoCellular::recordFirstFix(const GNSSFix & fix){
+    if(!ttff.running || !fix.valid || static_cast<long>(fix.acquiredAt - ttff.startedAt) < 0){
+        return;
+    }
+    ttff.running = false;
+
+    unsigned long duration = fix.acquiredAt - ttff.startedAt;
+    TTFFStats & stats = ttffStats[ttff.type];
+    if(stats.count == 0 || duration < stats.minimum){
+        stats.minimum = duration;
+    }
+    if(duration > stats.maximum){
+        stats.maximum = duration;
+    }
+    stats.last = duration;
+    stats.total += duration;
+    stats.count++;
+
+    if(this->debugStream != nullptr){
+        this->debugStream->print("Time to first fix: ");
+        this->debugStream->print(duration);
+        this->debugStream->println(" ms");
+    }
+}
+
+bool ArduinoCellular::enableXTRA(bool enable){
+    modem.sendAT(GF("+QGPSXTRA="), enable ? 1 : 0);
+    return modem.waitResult() == 1;
+}
+
+bool ArduinoCellular::uploadXTRA(Stream & source, size_t size, const char * filename){
+    // Uploading fails if the file exists
+    modem.sendAT(GF("+QFDEL=\""), filename, GF("\""));
+    modem.waitResult();
+
+    // +QFUPL=<name>,<size>,<timeout in seconds between two bytes>
+    modem.sendAT(GF("+QFUPL=\""), filename, GF("\","), static_cast<unsigned long>(size), GF(",10"));
+    if(modem.waitResult(5000, "CONNECT") != 1){
+        if(this->debugStream != nullptr){
+            this->debugStream->println("Failed to start the XTRA upload.");
+        }
+        return false;
+    }
+
+    uint8_t buffer[64];
+    size_t remaining = size;
+    while(remaining > 0){
+        size_t length = source.readBytes(buffer, remaining < sizeof(buffer) ? remaining : sizeof(buffer));
+        if(length == 0){
+            // The modem ends the upload with an error after its timeout
+            break;
+        }
+        modem.stream->write(buffer, length);
+        remaining -= length;
+    }
+    modem.stream->flush();
+
+    // +QFUPL: <size>,<checksum>
+    if(modem.waitResult(xtraUploadTimeout) != 1 || remaining > 0){
+        if(this->debugStream != nullptr){
+            this->debugStream->println("Failed to upload the XTRA file.");
+        }
+        return false;
+    }
+    return true;
+}
+
+bool ArduinoCellular::injectXTRA(const char * filename){
+    unsigned long now = getUNIXTime();
+    if(now == 0){
+        if(this->debugStream != nullptr){
+            this->debugStream->println("No time to inject.");
+        }
+        return false;
+    }
+    Time time;
+    time.parseUNIXTimestamp(now);
+
+    // +QGPSXTRATIME=0,<UTC time>,<force>,<uncertainty in use>,<uncertainty in milliseconds>
+    char command[64];
+    snprintf(command, sizeof(command), "+QGPSXTRATIME=0,\"%04d/%02d/%02d,%02d:%02d:%02d\",1,1,3500",
+             time.getYear(), time.getMonth(), time.getDay(), time.getHour(), time.getMinute(), time.getSecond());
+    modem.sendAT(command);
+    if(modem.waitResult() != 1){
+        return false;
+    }
+
+    modem.sendAT(GF("+QGPSXTRADATA=\""), filename, GF("\""));
+    return modem.waitResult(5000) == 1;
+}
+
+XTRAStatus ArduinoCellular::getXTRAStatus(){
+    XTRAStatus status;
+    // +QGPSXTRADATA: <validity in minutes>,"<YYYY/MM/DD,hh:mm:ss>"
+    modem.sendAT(GF("+QGPSXTRADATA?"));
+    StaticATResponseBuffer<96> response;
+    if(modem.waitResponse(1000, response, nullptr, "+QGPSXTRADATA?") != 1){
+        return status;
+    }
+    const char * field = response.find("+QGPSXTRADATA:");
+    if(field == nullptr){
+        return status;
+    }
+    const char * duration = field + 14;
+    const char * start = strchr(duration, '"');
+    status.duration = strtoul(duration, nullptr, 10);
+    if(status.duration == 0 || start == nullptr || strlen(start) < 20){
+        return status;
+    }
+
+    start++;
+    status.injectedAt = Time(atoi(start), atoi(start + 5), atoi(start + 8), atoi(start + 11), atoi(start + 14), atoi(start + 17));
+    status.expiresAt = status.injectedAt.getUNIXTimestamp() + status.duration * 60;
+    status.injected = true;
+    status.valid = !softwareClock.isSynced() || softwareClock.now() < status.expiresAt;
+    return status;
+}
+
+Time ArduinoCellular::getGPSTime(){
+    GNSSFix fix;
+    if(getCachedFix(fix, 1000) && fix.valid){
+        // Advance the time of the fix by its age
+        Time time;
+        time.parseUNIXTimestamp(static_cast<int64_t>(fix.time.getUNIXTimestamp()) + (millis() - fix.acquiredAt) / 1000);
+        applyClockTime(time);
+        return time;
+    }
+
+    if(!queryGNSSFix()){
+        return Time(1970, 1, 1, 0, 0, 0);
+    }
+    // GPS time is UTC, the offset of the network time stays as it is
+    Time time = lastFix.time;
+    applyClockTime(time);
+    return time;
+}
+#endif
+
+Time ArduinoCellular::getCellularTime(){
+    if(!softwareClock.isSynced() || softwareClock.getSyncAge() >= clockSyncInterval){
+        syncClock();
+    }
+    if(!softwareClock.isSynced()){
+        return Time(1970, 1, 1, 0, 0, 0);
+    }
+
+    Time time;
+    time.parseUNIXTimestamp(softwareClock.now(), utcOffset);
+    return time;
+}
+
+unsigned long ArduinoCellular::getUNIXTime(){
+    if(!softwareClock.isSynced()){
+        syncClock();
+    }
+    return softwareClock.now();
+}
+
+bool ArduinoCellular::syncClock(){
+    // The RTC of the modem follows the network time, NTP only improves its accuracy.
+    // The result of +QNTP arrives as a +QNTP: line once the server answered.
+    StaticATResponseBuffer<64> response;
+    modem.sendAT(GF("+QNTP=1,\"pool.ntp.org\""));
+    if(modem.waitResult() == 1){
+        modem.waitLine(10000, "+QNTP:", response);
+    }
+
+    if(sendATCommand("+CCLK?", response) != 1){
+        return false;
+    }
+    return applyClockResponse(response.c_str());
+}
+
+void ArduinoCellular::setClockSyncInterval(unsigned long interval){
+    clockSyncInterval = interval;
+}
+
+bool ArduinoCellular::applyClockTime(const Time & time){
+    if(time.getYear() < minValidYear){
+        return false;
+    }
+    softwareClock.sync(time.getUNIXTimestamp());
+    return true;
+}
+
+void ArduinoCellular::onClockResponse(ATCommandStatus status, const char * response, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    cellular->clockQueryRunning = false;
+    if(status == AT_COMMAND_OK){
+        cellular->applyClockResponse(response);
+    }
+}
+
+bool ArduinoCellular::applyClockResponse(const char * response){
+    // +CCLK: "yy/MM/dd,hh:mm:ss+zz", the offset is given in quarter hours
+    const char * start = strchr(response, '"');
+    const char * end = start != nullptr ? strchr(start + 1, '"') : nullptr;
+    if(end == nullptr){
+        return false;
+    }
+
+    Time time = SMSParser::parseTimestamp(start + 1, end - start - 1);
+    if(!applyClockTime(time)){
+        return false;
+    }
+    utcOffset = time.getOffsetMinutes();
+    return true;
+}
+
+#if ARDUINO_CELLULAR_SMS
+void ArduinoCellular::sendSMS(String number, String message){
+    // Text mode only carries plain ASCII in a single SMS
+    bool textMode = message.length() <= 160;
+    for(size_t i = 0; textMode && i < message.length(); i++){
+        char c = message[i];
+        textMode = (c >= 0x20 && c < 0x7F) || c == '\r' || c == '\n';
+    }
+    if(!textMode){
+        int sent = sendSMSPDU(number.c_str(), message.c_str());
+        if(this->debugStream != nullptr){
+            this->debugStream->println("Segments sent: " + String(sent));
+        }
+        return;
+    }
+
+    // The PDU mode paths switch back to text mode when done, unless that failed
+    if(smsPDUMode && !selectSMSFormat(false)){
+        if(this->debugStream != nullptr){
+            this->debugStream->println("Could not select text mode.");
+        }
+        return;
+    }
+    modem.sendAT(GF("+CMGS=\""), number, GF("\""));
+    if (modem.waitResult(1000, ">") != 1) {
+        if(this->debugStream != nullptr){
+            this->debugStream->println("No prompt for the message.");
+        }
+        return;
+    }
+    modem.stream->print(message);  // Actually send the message
+    modem.stream->write(static_cast<char>(0x1A));  // Terminate the message
+    modem.stream->flush();
+    int8_t response = modem.waitResult(smsSendTimeout);
+    
+    if(this->debugStream != nullptr){
+        this->debugStream->print("Response: ");
+        this->debugStream->println(response);
+    }
+}
+
+int ArduinoCellular::sendSMSPDU(const char * number, const char * message, uint8_t * references, size_t maxReferences){
+    SMSEncoder encoder;
+    if(!encoder.setMessage(message) || !setSMSPDUMode(true)){
+        return -1;
+    }
+
+    int sent = sendSMSSegments(encoder, number, references, maxReferences);
+    setSMSPDUMode(false);
+    return sent > 0 ? sent : -1;
+}
+
+int ArduinoCellular::sendSMSBatch(const char * const * numbers, size_t count, const char * message, int16_t * references){
+    SMSEncoder encoder;
+    if(!encoder.setMessage(message)){
+        return -1;
+    }
+
+    int completed = 0;
+    bool pduMode = setSMSPDUMode(true);
+    for(size_t i = 0; i < count; i++){
+        uint8_t segmentReferences[SMSEncoder::maxSegments];
+        int sent = pduMode ? sendSMSSegments(encoder, numbers[i], segmentReferences, SMSEncoder::maxSegments) : 0;
+        bool complete = sent == static_cast<int>(encoder.getSegmentCount());
+        if(complete){
+            completed++;
+        }
+        if(references != nullptr){
+            references[i] = complete ? segmentReferences[sent - 1] : -1;
+        }
+    }
+    setSMSPDUMode(false);
+    return completed;
+}
+
+bool ArduinoCellular::selectSMSFormat(bool pdu){
+    if(pdu){
+        configurationRecord.noteSMSFormat(true);
+    }
+    modem.sendAT(GF("+CMGF="), pdu ? 0 : 1);
+    if(modem.waitResult() != 1){
+        return false;
+    }
+    noteSMSFormat(pdu);
+    return true;
+}
+
+void ArduinoCellular::noteSMSFormat(bool pdu){
+    smsPDUMode = pdu;
+    configurationRecord.noteSMSFormat(pdu);
+}
+
+bool ArduinoCellular::setSMSPDUMode(bool pdu){
+    if(pdu){
+        if(!selectSMSFormat(true)){
+            return false;
+        }
+        // Keeps the radio link between consecutive messages instead of setting it up for each one
+        modem.sendAT(GF("+CMMS=2"));
+        modem.waitResult();
+        return true;
+    }
+
+    modem.sendAT(GF("+CMMS=0"));
+    modem.waitResult();
+    // Listing and reading messages expects text mode
+    return selectSMSFormat(false);
+}
+
+int ArduinoCellular::sendSMSSegments(const SMSEncoder & encoder, const char * number, uint8_t * references, size_t maxReferences){
+    uint8_t reference = ++concatenationReference;
+    uint8_t pdu[SMSEncoder::maxPDULength];
+    size_t segments = encoder.getSegmentCount();
+
+    for(size_t segment = 0; segment < segments; segment++){
+        size_t length = encoder.encode(segment, number, reference, pdu);
+        int messageReference = length > 0 ? sendPDU(pdu, length) : -1;
+        if(messageReference < 0){
+            if(this->debugStream != nullptr){
+                this->debugStream->println("Failed to send segment " + String(segment + 1) + " of " + String(segments));
+            }
+            return segment;
+        }
+        if(references != nullptr && segment < maxReferences){
+            references[segment] = static_cast<uint8_t>(messageReference);
+        }
+    }
+    return segments;
+}
+
+int ArduinoCellular::sendPDU(const uint8_t * pdu, size_t length){
+    static const char hexDigits[] = "0123456789ABCDEF";
+    char hex[SMSEncoder::maxPDULength * 2];
+    size_t octets = length + 1;
+    for(size_t i = 0; i < octets; i++){
+        hex[i * 2] = hexDigits[pdu[i] >> 4];
+        hex[i * 2 + 1] = hexDigits[pdu[i] & 0x0F];
+    }
+
+    modem.sendAT(GF("+CMGS="), static_cast<int>(length));
+    if(modem.waitResult(1000, ">") != 1){
+        return -1;
+    }
+    modem.stream->write(reinterpret_cast<const uint8_t *>(hex), octets * 2);
+    modem.stream->write(static_cast<char>(0x1A));
+    modem.stream->flush();
+
+    // +CMGS: <mr>
+    StaticATResponseBuffer<48> response;
+    if(modem.waitResponse(smsSendTimeout, response, nullptr, "+CMGS") != 1){
+        return -1;
+    }
+    const char * field = response.find("+CMGS:");
+    return field != nullptr ? atoi(field + 6) : -1;
+}
+#endif
+
+IPAddress ArduinoCellular::getIPAddress(){
+    return modem.localIP();
+}
+
+int ArduinoCellular::getSignalQuality(){
+    // +CSQ: <rssi>,<ber>, 99 means unknown like in TinyGSM
+    StaticATResponseBuffer<48> response;
+    if(sendATCommand("+CSQ", response) != 1){
+        return 99;
+    }
+    const char * field = response.find("+CSQ:");
+    return field != nullptr ? atoi(field + 5) : 99;
+}
+
+TinyGsmClient ArduinoCellular::getNetworkClient(){
+    return TinyGsmClient(modem);
+}
+
+HttpClient ArduinoCellular::getHTTPClient(const char * server, const int port){
+    return HttpClient(httpClients.pin(server, port, false), server, port);
+}
+
+PooledHTTPClient ArduinoCellular::acquireHTTPClient(const char * server, const int port){
+    return httpClients.acquire(server, port, false);
+}
+
+HTTPClientPool & ArduinoCellular::getHTTPClientPool(){
+    return httpClients;
+}
+
+ModemHTTPClient ArduinoCellular::getModemHTTPClient(const char * server, const int port){
+    return ModemHTTPClient(modem, server, port, false);
+}
+
+ModemHTTPClient ArduinoCellular::getModemHTTPSClient(const char * server, const int port){
+    return ModemHTTPClient(modem, server, port, true);
+}
+
+#if defined(ARDUINO_CELLULAR_BEARSSL)
+HttpClient ArduinoCellular::getHTTPSClient(const char * server, const int port){
+    return HttpClient(httpClients.pin(server, port, true), server, port);
+}
+
+PooledHTTPClient ArduinoCellular::acquireHTTPSClient(const char * server, const int port){
+    return httpClients.acquire(server, port, true);
+}
+
+BearSSLClient ArduinoCellular::getSecureNetworkClient(){
+    return BearSSLClient(* new TinyGsmClient(modem));
+}
+#endif
+
+bool ArduinoCellular::isConnectedToOperator(){
+    // LTE registration first, then the circuit switched registration of 2G
+    StaticATResponseBuffer<48> response;
+    if(sendATCommand("+CEREG?", response) == 1 && isRegistered(response.c_str())){
+        return true;
+    }
+    return sendATCommand("+CREG?", response) == 1 && isRegistered(response.c_str());
+}
+
+bool ArduinoCellular::isConnectedToInternet(){
+    return modem.isGprsConnected();
+}
+
+SimStatus ArduinoCellular::getSimStatus(){
+    // The SIM card may not answer yet right after the modem started, TinyGSM also retries for 10 seconds
+    StaticATResponseBuffer<48> response;
+    SimStatus simStatus = SIM_ERROR;
+    for(unsigned long startedAt = millis(); millis() - startedAt < 10000; delay(1000)){
+        if(sendATCommand("+CPIN?", response) != 1 || response.find("+CPIN:") == nullptr){
+            continue;
+        }
+        if(response.find("READY") != nullptr){
+            simStatus = SIM_READY;
+        } else if(response.find("SIM PIN") != nullptr || response.find("SIM PUK") != nullptr){
+            simStatus = SIM_LOCKED;
+        }
+        break;
+    }
+
+    if(this->debugStream != nullptr){
+        this->debugStream->println("SIM Status: " + String(static_cast<int>(simStatus)));
+    }
+    return simStatus;
+}
+
+bool ArduinoCellular::unlockSIM(String pin){
+    SimStatus simStatus = getSimStatus();
+    if(simStatus == SIM_LOCKED) {
+        if(this->debugStream != nullptr){
+            this->debugStream->println("Unlocking SIM...");
+        }
+        modem.sendAT(GF("+CPIN=\""), pin.c_str(), GF("\""));
+        return modem.waitResult() == 1;
+    }
+    else if(simStatus == SIM_ERROR || simStatus == SIM_ANTITHEFT_LOCKED) {
+        return false;
+    }
+    /* SIM is ready */
+    return true;
+}
+
+#if ARDUINO_CELLULAR_GNSS
+bool ArduinoCellular::enableGPS(bool assisted){
+    if(this->debugStream != nullptr){
+        this->debugStream->println("Enabling GPS...");
+    }
+
+    // Modems without positioning mode setting only support standalone GPS
+    const char * mode = getPositioningMode(assisted);
+    StaticATResponseBuffer<64> response;
+    if(mode != nullptr && sendATCommand(mode, response, 10000) != 1){
+        if(this->debugStream != nullptr){
+            this->debugStream->println("Failed to set GPS mode.");
+            this->debugStream->print("Response: ");
+            this->debugStream->println(response.c_str());
+        }
+        return false;
+    }
+
+    return modem.enableGPS();
+}
+
+const char * ArduinoCellular::getPositioningMode(bool assisted) const {
+    if(ModemProfile::detect && model == ModemModel::BG96){
+        return BG96Profile::gnssPositioningMode(assisted);
+    }
+    return ModemProfile::gnssPositioningMode(assisted);
+}
+#endif
+
+String ArduinoCellular::sendATCommand(const char * command, unsigned long timeout){
+    String response;
+    modem.sendAT(command); 
+    modem.collectResponse(timeout, response, command);
+    return response;
+}
+
+int8_t ArduinoCellular::sendATCommand(const char * command, ATResponseBuffer & response, unsigned long timeout){
+    response.clear();
+    modem.sendAT(command);
+    return modem.waitResponse(timeout, response, nullptr, command);
+}
+
+#if ARDUINO_CELLULAR_SMS
+// Collects the streamed messages into a vector
+void appendSMS(const SMSView & sms, void * context) {
+    std::vector<SMS> * smsList = static_cast<std::vector<SMS> *>(context);
+    smsList->push_back(SMS(sms.index, String(sms.sender), String(sms.message), sms.timestamp, sms.status));
+}
+
+// Copies the streamed messages into the arena of a batch
+void addSMSToBatch(const SMSView & sms, void * context) {
+    static_cast<SMSBatch *>(context)->add(sms);
+}
+
+// The destination of the messages joined by a reassembler
+struct ReassemblyTarget {
+    SMSReassembler * reassembler;
+    SMSCallback callback;
+    void * context;
+};
+
+void reassembleSMS(const SMSView & sms, void * context) {
+    ReassemblyTarget * target = static_cast<ReassemblyTarget *>(context);
+    target->reassembler->add(sms, target->callback, target->context);
+}
+
+// The numeric <stat> of +CMGL in PDU mode
+int pduListStatus(const char * status) {
+    static const char * const names[] = { "REC UNREAD", "REC READ", "STO UNSENT", "STO SENT", "ALL" };
+    for(int i = 0; i < 5; i++){
+        if(strcmp(names[i], status) == 0){
+            return i;
+        }
+    }
+    return 4;
+}
+#endif
+
+String ArduinoCellular::sendUSSDCommand(const char * command){
+    // The answer of the network follows the OK as +CUSD: <m>,"<text>",<dcs>
+    StaticATResponseBuffer<256> response;
+    modem.sendAT(GF("+CUSD=1,\""), command, GF("\""));
+    if(modem.waitResult() != 1 || !modem.waitLine(10000, "+CUSD:", response)){
+        return String();
+    }
+    return quotedText(response.c_str());
+}
+
+#if ARDUINO_CELLULAR_SMS
+int ArduinoCellular::listSMS(const char * status, SMSCallback callback, void * context, bool keepStatus, bool reassemble){
+    // The concatenation header is only visible in PDU mode
+    bool switched = smsReassembler != nullptr && !smsPDUMode && selectSMSFormat(true);
+
+    ReassemblyTarget target = { smsReassembler, callback, context };
+    bool reassembling = reassemble && smsReassembler != nullptr && smsPDUMode;
+    SMSParser parser(reassembling ? reassembleSMS : callback, reassembling ? &target : context);
+
+    // Mode 1 of the Quectel +CMGL leaves the status of the listed messages unchanged
+    if(smsPDUMode){
+        modem.sendAT(GF("+CMGL="), pduListStatus(status), keepStatus ? GF(",1") : GF(""));
+    } else {
+        modem.sendAT(GF("+CMGL=\""), status, keepStatus ? GF("\",1") : GF("\""));
+    }
+    int count = receiveSMS(parser);
+
+    if(switched){
+        selectSMSFormat(false);
+    }
+    return count;
+}
+
+int ArduinoCellular::readSMS(uint16_t index, SMSCallback callback, void * context){
+    SMSParser parser(callback, context);
+    parser.setReadIndex(index);
+    modem.sendAT(GF("+CMGR="), index, GF(",1"));
+    return receiveSMS(parser);
+}
+
+int ArduinoCellular::receiveSMS(SMSParser & parser){
+    parser.setURCDispatcher(&urcDispatcher);
+
+    // The timeout is reset by every received byte, long listings do not time out while they stream in
+    unsigned long lastActivity = millis();
+    while(!parser.isDone() && millis() - lastActivity < smsListingTimeout){
+        while(modem.stream->available() > 0){
+            if(parser.feed(static_cast<char>(modem.stream->read()))){
+                break;
+            }
+            lastActivity = millis();
+        }
+    }
+
+    return parser.succeeded() ? static_cast<int>(parser.getCount()) : -1;
+}
+
+int ArduinoCellular::getReadSMS(SMSCallback callback, void * context){
+    return listSMS("REC READ", callback, context);
+}
+
+int ArduinoCellular::getUnreadSMS(SMSCallback callback, void * context){
+    return listSMS("REC UNREAD", callback, context);
 }
 
-ArduinoCellular::ArduinoCellular() {
+int ArduinoCellular::getReadSMS(SMSBatch & batch){
+    batch.clear();
+    return listSMS("REC READ", addSMSToBatch, &batch);
 }
 
-void ArduinoCellular::begin() {
-    modem.init();
- 
-    String modemInfo = this ->sendATCommand("I");
-    if(modemInfo.indexOf("EC200A") > 0){
-        this->model = ModemModel::EC200;
-    } else if (modemInfo.indexOf("EG25") > 0){
-        this->model = ModemModel::EG25;
-    } else {
-        this->model = ModemModel::Unsupported;
+int ArduinoCellular::getUnreadSMS(SMSBatch & batch){
+    batch.clear();
+    return listSMS("REC UNREAD", addSMSToBatch, &batch);
+}
+
+std::vector<SMS> ArduinoCellular::getReadSMS(){
+    std::vector<SMS> smsList;
+    if(getReadSMS(appendSMS, &smsList) < 0){
+        return std::vector<SMS>();
+    }
+    return smsList;
+}
+
+std::vector<SMS> ArduinoCellular::getUnreadSMS(){
+    std::vector<SMS> smsList;
+    if(getUnreadSMS(appendSMS, &smsList) < 0){
+        return std::vector<SMS>();
     }
+    return smsList;
+}
+
+int ArduinoCellular::getAllSMS(SMSCallback callback, void * context){
+    return listSMS("ALL", callback, context, true);
+}
 
-    // Set GSM module to text mode
-    modem.sendAT("+CMGF=1");
-    modem.waitResponse();
+int ArduinoCellular::getAllSMS(SMSBatch & batch){
+    batch.clear();
+    return listSMS("ALL", addSMSToBatch, &batch, true);
+}
 
-    modem.sendAT(GF("+CSCS=\"GSM\""));
-    modem.waitResponse();
+std::vector<SMS> ArduinoCellular::getAllSMS(){
+    std::vector<SMS> smsList;
+    if(getAllSMS(appendSMS, &smsList) < 0){
+        return std::vector<SMS>();
+    }
+    return smsList;
+}
 
-    // Send intrerupt when SMS has been received
-    modem.sendAT("+CNMI=2,1,0,0,0");
-    modem.waitResponse();
+int ArduinoCellular::syncSMS(SMSCallback callback, void * context){
+    int capacity = 0;
+    int stored = getStoredSMSCount(&capacity);
+    if(stored < 0){
+        return -1;
+    }
+    if(inbox.valid && stored == inbox.seenCount){
+        return 0;
+    }
 
-#if defined(ARDUINO_CELLULAR_BEARSSL)
-    ArduinoBearSSL.onGetTime(ArduinoCellular::getTime);
-#endif
+    inbox.callback = callback;
+    inbox.context = context;
+    inbox.delivered = 0;
 
+    // All reads of this call share one switch to PDU mode
+    bool switched = smsReassembler != nullptr && !smsPDUMode && selectSMSFormat(true);
+    int delivered = fetchNewSMS(stored, capacity);
+    if(switched){
+        selectSMSFormat(false);
+    }
+    return delivered;
 }
 
-bool ArduinoCellular::connect(String apn, bool waitForever) {
-    connect(apn,String(""),String(""), waitForever);
+int ArduinoCellular::fetchNewSMS(int stored, int capacity){
+
+    if(inbox.valid && stored > inbox.seenCount){
+        // New messages take free slots, read the unseen ones until all of them are found.
+        // Storage indexes start at 0 or 1 depending on the modem, hence the inclusive bound.
+        int missing = stored - inbox.seenCount;
+        int scanned = capacity < static_cast<int>(maxSMSSlots) - 1 ? capacity : static_cast<int>(maxSMSSlots) - 1;
+        for(int index = 0; index <= scanned && inbox.delivered < missing; index++){
+            if(inbox.seen[index / 32] & (1UL << (index % 32))){
+                continue;
+            }
+            // An empty or invalid slot is answered with OK or an error, either way the scan goes on
+            readSMS(index, collectInboxSMS, this);
+        }
+        if(inbox.delivered == missing){
+            return inbox.delivered;
+        }
+    }
+
+    // Messages disappeared or could not be found one by one, rebuild the bitmap from a full listing.
+    // Only the messages that were not seen before are passed on.
+    uint32_t previous[sizeof(inbox.seen) / sizeof(inbox.seen[0])];
+    memcpy(previous, inbox.seen, sizeof(previous));
+    memset(inbox.seen, 0, sizeof(inbox.seen));
+    inbox.seenCount = 0;
+    inbox.previous = previous;
+    int listed = listSMS("ALL", collectInboxSMS, this, true, false);
+    inbox.previous = nullptr;
+
+    if(listed < 0){
+        // Keep what was known, the next call lists again
+        memcpy(inbox.seen, previous, sizeof(previous));
+        inbox.valid = false;
+        return -1;
+    }
+    inbox.valid = true;
+    return inbox.delivered;
 }
 
+void ArduinoCellular::setSMSReassembler(SMSReassembler * reassembler){
+    smsReassembler = reassembler;
+}
 
-bool ArduinoCellular::connect(String apn, String username, String password, bool waitForever){
-    SimStatus simStatus = getSimStatus();
+void ArduinoCellular::resetSMSSync(){
+    memset(inbox.seen, 0, sizeof(inbox.seen));
+    inbox.seenCount = 0;
+    inbox.valid = false;
+}
 
-    if(simStatus == SimStatus::SIM_LOCKED){
-        if(this->debugStream != nullptr){
-            this->debugStream->println("SIM locked, cannot connect to network.");
+void ArduinoCellular::collectInboxSMS(const SMSView & sms, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    InboxSync & inbox = cellular->inbox;
+
+    bool seenBefore = false;
+    if(inbox.previous != nullptr && sms.index >= 0 && sms.index < static_cast<int16_t>(maxSMSSlots)){
+        seenBefore = (inbox.previous[sms.index / 32] & (1UL << (sms.index % 32))) != 0;
+    }
+    if(cellular->markSMSSeen(sms.index) && !seenBefore){
+        inbox.delivered++;
+        // Parts are marked as seen one by one, the reassembler only passes on complete messages
+        if(cellular->smsReassembler != nullptr){
+            cellular->smsReassembler->add(sms, inbox.callback, inbox.context);
+        } else if(inbox.callback != nullptr){
+            inbox.callback(sms, inbox.context);
         }
-       
-       return false;
     }
+}
 
-    if(simStatus != SimStatus::SIM_READY) {
-        if(this->debugStream != nullptr){
-            this->debugStream->println("SIM not ready, cannot connect to network.");
-        }
+bool ArduinoCellular::markSMSSeen(int16_t index){
+    if(index < 0 || index >= static_cast<int16_t>(maxSMSSlots)){
+        // Not tracked, such messages are passed on again after every full listing
+        inbox.seenCount++;
+        return true;
+    }
+    uint32_t bit = 1UL << (index % 32);
+    if(inbox.seen[index / 32] & bit){
         return false;
     }
+    inbox.seen[index / 32] |= bit;
+    inbox.seenCount++;
+    return true;
+}
+
+void ArduinoCellular::forgetSMS(uint16_t index){
+    if(index >= maxSMSSlots){
+        inbox.valid = false;
+        return;
+    }
+    uint32_t bit = 1UL << (index % 32);
+    if(inbox.seen[index / 32] & bit){
+        inbox.seen[index / 32] &= ~bit;
+        inbox.seenCount--;
+    }
+}
 
-    if(!awaitNetworkRegistration(waitForever)){
+bool ArduinoCellular::deleteSMS(uint16_t index){
+    modem.sendAT(GF("+CMGD="), index);
+    if(modem.waitResult(smsDeleteTimeout) != 1){
         return false;
     }
+    forgetSMS(index);
+    return true;
+}
 
-    if(apn.length() == 0){
-        if(this->debugStream != nullptr){
-            this->debugStream->println("No APN specified, not connecting to GPRS");
+int ArduinoCellular::deleteSMS(const uint16_t * indices, size_t count){
+    char command[ATCommandEngine::commandBufferSize];
+    int deleted = 0;
+
+    for(size_t first = 0; first < count;){
+        // Concatenate as many deletions as fit into one command line, e.g. "+CMGD=1;+CMGD=2"
+        size_t last = first;
+        size_t length = 0;
+        while(last < count){
+            int partLength = snprintf(command + length, sizeof(command) - length, "%s+CMGD=%u",
+                                      last == first ? "" : ";", static_cast<unsigned int>(indices[last]));
+            if(partLength < 0 || length + partLength >= sizeof(command)){
+                break;
+            }
+            length += partLength;
+            last++;
         }
-        return true;       
-    }
+        command[length] = '\0';
 
-    if(connectToGPRS(apn.c_str(), username.c_str(), password.c_str())){
-        auto response = this->sendATCommand("+QIDNSCFG=1,\"8.8.8.8\",\"8.8.4.4\"");
-        
-        if(response.indexOf("OK") != -1){
-            return true;
+        modem.sendAT(command);
+        if(modem.waitResult(smsDeleteTimeout * (last - first)) == 1){
+            deleted += last - first;
+            for(size_t i = first; i < last; i++){
+                forgetSMS(indices[i]);
+            }
         } else {
-            if(this->debugStream != nullptr){
-                this->debugStream->println("Failed to set DNS.");
+            // The modem aborts the line at the first failing command, find out which messages are gone
+            for(size_t i = first; i < last; i++){
+                if(deleteSMS(indices[i])){
+                    deleted++;
+                }
             }
-            return false;
         }
-
+        first = last;
     }
-    
-    return false;
-}
 
+    return deleted;
+}
 
-Geolocation ArduinoCellular::getGPSLocation(unsigned long timeout){
-    if (model == ModemModel::EG25){
-        float latitude = 0.00000;
-        float longitude = 0.00000;
-        unsigned long startTime = millis();
-
-        while((latitude == 0.00000 || longitude == 0.00000) && (millis() - startTime < timeout)) {
-            modem.getGPS(&latitude, &longitude);
-            delay(1000);
-        }
-        
-        Geolocation loc;
-        loc.latitude = latitude;
-        loc.longitude = longitude;
+int ArduinoCellular::deleteSMS(SMSDeleteFilter filter){
+    int storedBefore = getStoredSMSCount();
 
-        return loc;
-    } else {
-        if(this->debugStream != nullptr){
-            this->debugStream->println("Unsupported modem model");
-        }
-        return Geolocation();
+    modem.sendAT(GF("+CMGD=1,"), static_cast<int>(filter));
+    bool accepted = modem.waitResult(smsBulkDeleteTimeout) == 1;
+    // Which slots were freed is unknown, syncSMS() has to list the storage again
+    inbox.valid = false;
+    if(!accepted){
+        return -1;
     }
-}
 
-Time ArduinoCellular::getGPSTime(){
-    int year, month, day, hour, minute, second;
-    modem.getGPSTime(&year, &month, &day, &hour, &minute, &second);
-    return Time(year, month, day, hour, minute, second);
+    int storedAfter = getStoredSMSCount();
+    if(storedBefore < 0 || storedAfter < 0){
+        return 0;
+    }
+    return storedBefore - storedAfter;
 }
 
-Time ArduinoCellular::getCellularTime(){
-    int year = 1970;
-    int month = 1;
-    int day = 1;
-    int hour = 0;
-    int minute = 0;
-    int second = 0;
-    float tz;
-    if (modem.NTPServerSync() == 0) {
-      modem.getNetworkTime(&year, &month, &day, &hour, &minute, &second, &tz);
+int ArduinoCellular::getStoredSMSCount(int * capacity){
+    // +CPMS: <mem1>,<used1>,<total1>,<mem2>,<used2>,<total2>,<mem3>,<used3>,<total3>
+    StaticATResponseBuffer<96> response;
+    modem.sendAT(GF("+CPMS?"));
+    if(modem.waitResponse(1000, response, nullptr, "+CPMS?") != 1){
+        return -1;
+    }
+    const char * fieldStart = response.find("+CPMS:");
+    const char * used = fieldStart != nullptr ? strchr(fieldStart, ',') : nullptr;
+    if(used == nullptr){
+        return -1;
+    }
+    if(capacity != nullptr){
+        const char * total = strchr(used + 1, ',');
+        *capacity = total != nullptr ? atoi(total + 1) : 0;
     }
-    return Time(year, month, day, hour, minute, second);
+    return atoi(used + 1);
 }
+#endif
 
+void ArduinoCellular::setDebugStream(Stream &stream){
+    this->debugStream = &stream;
+}
 
-void ArduinoCellular::sendSMS(String number, String message){
-    modem.sendAT("+CMGF=1"); 
-    modem.waitResponse(1000);
-    modem.sendAT(GF("+CMGS=\""), number, GF("\""));
-    if (modem.waitResponse(GF(">")) != 1) { }
-    modem.stream->print(message);  // Actually send the message
-    modem.stream->write(static_cast<char>(0x1A));  // Terminate the message
-    modem.stream->flush();
-    auto response = modem.waitResponse(10000L);
-    
-    if(this->debugStream != nullptr){
-        this->debugStream->println("Response: " + String(response));
+void ArduinoCellular::poll(){
+    commandEngine.poll();
+    urcDispatcher.dispatch();
+#if ARDUINO_CELLULAR_SMS
+    readNextIncomingSMS();
+#endif
+    advanceConnection();
+#if ARDUINO_CELLULAR_SMS
+    if(smsReassembler != nullptr){
+        smsReassembler->evictStale();
     }
-  }
+#endif
 
+    if(softwareClock.isSynced() && !clockQueryRunning && softwareClock.getSyncAge() >= clockSyncInterval
+       && static_cast<long>(millis() - nextClockQueryAt) >= 0){
+        if(commandEngine.enqueue("+CCLK?", 1000, onClockResponse, this).isValid()){
+            clockQueryRunning = true;
+            // Retry a failed query after a minute rather than on every poll
+            nextClockQueryAt = millis() + 60000;
+        }
+    }
 
-IPAddress ArduinoCellular::getIPAddress(){
-    return modem.localIP();
-}
+#if ARDUINO_CELLULAR_GNSS
+    advanceGNSSStream();
+    if(ttff.running){
+        GNSSFix fix;
+        if(nmeaParser.getLatestFix(fix)){
+            recordFirstFix(fix);
+        }
+    }
 
-int ArduinoCellular::getSignalQuality(){
-    return modem.getSignalQuality();
+    if(locationRequest.active && !locationRequest.queryRunning
+       && static_cast<long>(millis() - locationRequest.nextQueryAt) >= 0){
+        if(commandEngine.enqueue("+QGPSLOC=2", 1000, onGPSLocationResponse, this).isValid()){
+            locationRequest.queryRunning = true;
+        }
+    }
+#endif
 }
 
-TinyGsmClient ArduinoCellular::getNetworkClient(){
-    return TinyGsmClient(modem);
+bool ArduinoCellular::isIdle(){
+#if ARDUINO_CELLULAR_GNSS
+    if(locationRequest.active){
+        return false;
+    }
+#endif
+#if ARDUINO_CELLULAR_SMS
+    if(incomingSMS.pendingCount > 0 || incomingSMS.reading){
+        return false;
+    }
+#endif
+    return commandEngine.isIdle()
+           && (connection.phase == CONNECTION_IDLE || connection.phase == CONNECTION_CONNECTED || connection.phase == CONNECTION_FAILED);
 }
 
-HttpClient ArduinoCellular::getHTTPClient(const char * server, const int port){
-    return HttpClient(* new TinyGsmClient(modem), server, port);
+ATCommandHandle ArduinoCellular::sendATCommandAsync(const char * command, ATCommandCallback callback, void * context, unsigned long timeout){
+    return commandEngine.enqueue(command, timeout, callback, context);
 }
 
-#if defined(ARDUINO_CELLULAR_BEARSSL)
-HttpClient ArduinoCellular::getHTTPSClient(const char * server, const int port){
-    return HttpClient(* new BearSSLClient(* new TinyGsmClient(modem)), server, port);
-}
+#if ARDUINO_CELLULAR_SMS
+ATCommandHandle ArduinoCellular::sendSMSAsync(const char * number, const char * message, ATCommandCallback callback, void * context){
+    char command[48];
+    // The format and the message are queued together, so that +CMGS never runs in another format.
+    // Nothing is queued unless both fit, the message is kept in the slot buffer after the command.
+    int commandLength = snprintf(command, sizeof(command), "+CMGS=\"%s\"", number);
+    if(commandLength >= static_cast<int>(sizeof(command))
+       || commandLength + 1 + strlen(message) + 1 > ATCommandEngine::commandBufferSize
+       || commandEngine.getFreeSlots() < 2){
+        return ATCommandHandle();
+    }
 
-BearSSLClient ArduinoCellular::getSecureNetworkClient(){
-    return BearSSLClient(* new TinyGsmClient(modem));
+    commandEngine.enqueue("+CMGF=1", 1000, onTextModeSelected, this);
+    return commandEngine.enqueueWithPayload(command, message, 10000, callback, context);
 }
 #endif
 
-bool ArduinoCellular::isConnectedToOperator(){
-    return modem.isNetworkConnected();
+#if ARDUINO_CELLULAR_GNSS
+bool ArduinoCellular::getGPSLocationAsync(GeolocationCallback callback, void * context, unsigned long timeout){
+    if(!supportsGNSS() || locationRequest.active){
+        if(!supportsGNSS() && this->debugStream != nullptr){
+            this->debugStream->println("Unsupported modem model");
+        }
+        return false;
+    }
+
+    locationRequest.callback = callback;
+    locationRequest.context = context;
+    locationRequest.startedAt = millis();
+    locationRequest.timeout = timeout;
+    locationRequest.nextQueryAt = locationRequest.startedAt;
+    locationRequest.queryRunning = false;
+    locationRequest.active = true;
+    return true;
 }
 
-bool ArduinoCellular::connectToGPRS(const char * apn, const char * gprsUser, const char * gprsPass){
-    if(this->debugStream != nullptr){
-        this->debugStream->println("Connecting to 4G network...");
+void ArduinoCellular::onGPSLocationResponse(ATCommandStatus status, const char * response, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    LocationRequest & request = cellular->locationRequest;
+    request.queryRunning = false;
+
+    Geolocation location = { 0.0f, 0.0f };
+    if(status == AT_COMMAND_OK){
+        NMEAParser::parseLocationResponse(response, cellular->lastFix);
+        cellular->lastFixCached = true;
+        cellular->recordFirstFix(cellular->lastFix);
+        if(cellular->lastFix.valid){
+            location.latitude = cellular->lastFix.getLatitude();
+            location.longitude = cellular->lastFix.getLongitude();
+            request.active = false;
+            request.callback(true, location, request.context);
+            return;
+        }
     }
-    while(!modem.gprsConnect(apn, gprsUser, gprsPass)) {
+
+    // No fix yet (+CME ERROR: 516), try again in a second
+    if(millis() - request.startedAt >= request.timeout){
+        request.active = false;
+        request.callback(false, location, request.context);
+    } else {
+        request.nextQueryAt = millis() + 1000;
+    }
+}
+
+bool ArduinoCellular::startGNSSStream(GNSSFixCallback callback, void * context, unsigned long interval){
+    if(!supportsGNSS()){
         if(this->debugStream != nullptr){
-            this->debugStream->print(".");
+            this->debugStream->println("Unsupported modem model");
         }
-        delay(2000);
+        return false;
+    }
+
+    // Makes the sentences of the receiver available through +QGPSGNMEA
+    modem.sendAT(GF("+QGPSCFG=\"nmeasrc\",1"));
+    if(modem.waitResult() != 1){
+        return false;
     }
+    if(interval < 1000){
+        // The receiver computes 1, 2, 5 or 10 fixes per second, not every firmware supports the setting
+        unsigned long rate = 1000 / (interval > 100 ? interval : 100);
+        modem.sendAT(GF("+QGPSCFG=\"fixfreq\","), rate >= 10 ? 10 : rate >= 5 ? 5 : rate >= 2 ? 2 : 1);
+        modem.waitResult();
+    }
+
+    nmeaParser.reset();
+    nmeaParser.setCallback(callback, context);
+    gnssStream.interval = interval > 100 ? interval : 100;
+    gnssStream.nextQueryAt = millis();
+    gnssStream.active = true;
     return true;
 }
 
-bool ArduinoCellular::isConnectedToInternet(){
-    return modem.isGprsConnected();
+void ArduinoCellular::stopGNSSStream(){
+    gnssStream.active = false;
 }
 
-SimStatus ArduinoCellular::getSimStatus(){
-    int simStatus = modem.getSimStatus();
-    if(this->debugStream != nullptr){
-        this->debugStream->println("SIM Status: " + String(simStatus));
+bool ArduinoCellular::getLatestFix(GNSSFix & fix) const {
+    return nmeaParser.getLatestFix(fix);
+}
+
+void ArduinoCellular::advanceGNSSStream(){
+    if(!gnssStream.active || gnssStream.queryRunning || static_cast<long>(millis() - gnssStream.nextQueryAt) < 0
+       || commandEngine.getFreeSlots() < 3){
+        return;
     }
 
-    if (simStatus == 0) {
-        return SimStatus::SIM_ERROR;
-    } else if (simStatus == 1) {
-        return SimStatus::SIM_READY;
-    } else if (simStatus == 2) {
-        return SimStatus::SIM_LOCKED;
-    } else if (simStatus == 3) {
-        return SimStatus::SIM_ANTITHEFT_LOCKED;
-    } else {
-        return SimStatus::SIM_ERROR;
+    // GGA comes last, it completes the fix with the data of the RMC and GSA sentences of the same epoch
+    commandEngine.enqueueStreaming("+QGPSGNMEA=\"RMC\"", feedNMEA, 1000, nullptr, this);
+    commandEngine.enqueueStreaming("+QGPSGNMEA=\"GSA\"", feedNMEA, 1000, nullptr, this);
+    commandEngine.enqueueStreaming("+QGPSGNMEA=\"GGA\"", feedNMEA, 1000, onNMEAQueryDone, this);
+    gnssStream.queryRunning = true;
+    gnssStream.lineLength = 0;
+
+    // Keep the rate steady, but do not try to catch up after a stall
+    gnssStream.nextQueryAt += gnssStream.interval;
+    if(static_cast<long>(millis() - gnssStream.nextQueryAt) > 0){
+        gnssStream.nextQueryAt = millis() + gnssStream.interval;
     }
 }
 
-bool ArduinoCellular::unlockSIM(String pin){
-    int simStatus = modem.getSimStatus();
-    if(simStatus == SIM_LOCKED) {
-        if(this->debugStream != nullptr){
-            this->debugStream->println("Unlocking SIM...");
+ATCommandStatus ArduinoCellular::feedNMEA(char c, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    GNSSStream & stream = cellular->gnssStream;
+    cellular->nmeaParser.feed(c);
+
+    if(c == '\r'){
+        return AT_COMMAND_RUNNING;
+    }
+    if(c != '\n'){
+        if(stream.lineLength < sizeof(stream.line) - 1){
+            stream.line[stream.lineLength++] = c;
         }
-        return modem.simUnlock(pin.c_str());
+        return AT_COMMAND_RUNNING;
     }
-    else if(simStatus == SIM_ERROR || simStatus == SIM_ANTITHEFT_LOCKED) {
-        return false;
+
+    stream.line[stream.lineLength] = '\0';
+    stream.lineLength = 0;
+    if(strcmp(stream.line, "OK") == 0){
+        return AT_COMMAND_OK;
     }
-    /* SIM is ready */
-    return true;
+    // No fix yet is reported as +CME ERROR: 516
+    if(strncmp(stream.line, "ERROR", 5) == 0 || strncmp(stream.line, "+CME ERROR", 10) == 0){
+        return AT_COMMAND_ERROR;
+    }
+    return AT_COMMAND_RUNNING;
 }
 
-bool ArduinoCellular::awaitNetworkRegistration(bool waitForever){
-    if(this->debugStream != nullptr){
-        this->debugStream->println("Waiting for network registration...");
+void ArduinoCellular::onNMEAQueryDone(ATCommandStatus status, const char * response, void * context){
+    static_cast<ArduinoCellular *>(context)->gnssStream.queryRunning = false;
+}
+#endif
+
+bool ArduinoCellular::onURC(const char * prefix, URCCallback callback, void * context){
+    return urcDispatcher.on(prefix, callback, context);
+}
+
+#if ARDUINO_CELLULAR_SMS
+void ArduinoCellular::onSMSReceived(SMSCallback callback, void * context){
+    incomingSMS.callback = callback;
+    incomingSMS.context = context;
+}
+
+void ArduinoCellular::onNewMessageIndication(const char * urc, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    IncomingSMS & incoming = cellular->incomingSMS;
+
+    // +CMTI: <mem>,<index>
+    const char * index = strrchr(urc, ',');
+    if(incoming.callback == nullptr || index == nullptr){
+        return;
     }
-    while (!modem.waitForNetwork(waitForNetworkTimeout)) {
-        
-        if(!waitForever) {
-            return false;
-        }
 
-        if(this->debugStream != nullptr){
-            this->debugStream->print(".");
+    if(incoming.pendingCount >= maxPendingSMSReads){
+        if(cellular->debugStream != nullptr){
+            cellular->debugStream->println("Too many new SMS messages, dropping notification.");
         }
-        #if defined(ARDUINO_ARCH_MBED)
-            if(mbed::Watchdog::get_instance().is_running()) {
-                mbed::Watchdog::get_instance().kick();
-            }
-        #endif
-        delay(2000);
+        return;
     }
-    return true;
+    incoming.pending[incoming.pendingCount++] = static_cast<int16_t>(atoi(index + 1));
 }
 
-bool ArduinoCellular::enableGPS(bool assisted){
-    if(this->debugStream != nullptr){
-        this->debugStream->println("Enabling GPS...");
+void ArduinoCellular::readNextIncomingSMS(){
+    if(incomingSMS.reading || incomingSMS.pendingCount == 0){
+        return;
     }
 
-    String response;
+    char command[16];
+    int16_t index = incomingSMS.pending[0];
+    snprintf(command, sizeof(command), "+CMGR=%d", index);
 
-    if(assisted){
-        response = sendATCommand("+QGPSCFG=\"agpsposmode\",33488767", 10000);
-    } else {
-        // Sets the 23rd bit to 1 to enable standalone GPS
-        response = sendATCommand("+QGPSCFG=\"agpsposmode\",8388608", 10000);
+    // The read is wrapped in PDU mode to see the concatenation header, all three commands must fit into the queue.
+    // A modem left in PDU mode by a failed restore reads in PDU mode as it is.
+    bool pduMode = smsReassembler != nullptr && !smsPDUMode;
+    if(pduMode && commandEngine.getFreeSlots() < 3){
+        return;
     }
 
-    if(response.indexOf("OK") == -1){
-        if(this->debugStream != nullptr){
-            this->debugStream->println("Failed to set GPS mode.");
-            this->debugStream->println("Response: " + response);
-        }
-        return false;
+    // The parser is shared by all reads, so only one +CMGR is in flight at a time
+    incomingSMSParser.reset();
+    incomingSMSParser.setReadIndex(index);
+    if(pduMode){
+        // Taken as PDU mode until the restore below has succeeded
+        noteSMSFormat(true);
+        commandEngine.enqueue("+CMGF=0");
+    }
+    if(!commandEngine.enqueueStreaming(command, feedIncomingSMS, 5000, onIncomingSMSRead, this).isValid()){
+        return;
+    }
+    if(pduMode){
+        commandEngine.enqueue("+CMGF=1", 1000, onIncomingSMSTextModeRestored, this);
     }
 
-    return modem.enableGPS();
+    incomingSMS.reading = true;
+    incomingSMS.restoringTextMode = pduMode;
+    incomingSMS.pendingCount--;
+    memmove(incomingSMS.pending, incomingSMS.pending + 1, incomingSMS.pendingCount * sizeof(incomingSMS.pending[0]));
 }
 
-String ArduinoCellular::sendATCommand(const char * command, unsigned long timeout){
-    String response;
-    modem.sendAT(command); 
-    modem.waitResponse(timeout, response);
-    return response;
+ATCommandStatus ArduinoCellular::feedIncomingSMS(char c, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    if(!cellular->incomingSMSParser.feed(c)){
+        return AT_COMMAND_RUNNING;
+    }
+    return cellular->incomingSMSParser.succeeded() ? AT_COMMAND_OK : AT_COMMAND_ERROR;
 }
 
-Time parseTimestamp(const String &timestampStr) {
-  int hour, minute, second, day, month, year, offset;
-  
-  int commaIndex = timestampStr.indexOf(',');
-  String date = timestampStr.substring(0, commaIndex);
-  String time = timestampStr.substring(commaIndex + 1, timestampStr.indexOf('+'));
-  String offsetStr = timestampStr.substring(timestampStr.indexOf('+') + 1);
+void ArduinoCellular::deliverIncomingSMS(const SMSView & sms, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    if(cellular->inbox.valid){
+        // Already passed on here, syncSMS() must not report it again
+        cellular->markSMSSeen(sms.index);
+    }
+    if(cellular->smsReassembler != nullptr){
+        cellular->smsReassembler->add(sms, cellular->incomingSMS.callback, cellular->incomingSMS.context);
+    } else if(cellular->incomingSMS.callback != nullptr){
+        cellular->incomingSMS.callback(sms, cellular->incomingSMS.context);
+    }
+}
 
-  int firstSlashIndex = date.indexOf('/');
-  int secondSlashIndex = date.lastIndexOf('/');
-  year = date.substring(0, firstSlashIndex).toInt() + 2000;
-  month = date.substring(firstSlashIndex + 1, secondSlashIndex).toInt();
-  day = date.substring(secondSlashIndex + 1).toInt();
+void ArduinoCellular::onIncomingSMSRead(ATCommandStatus status, const char * response, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    // With the text mode still to be restored, the next read waits for that
+    if(!cellular->incomingSMS.restoringTextMode){
+        cellular->incomingSMS.reading = false;
+    }
 
-  int firstColonIndex = time.indexOf(':');
-  int secondColonIndex = time.lastIndexOf(':');
-  hour = time.substring(0, firstColonIndex).toInt();
-  minute = time.substring(firstColonIndex + 1, secondColonIndex).toInt();
-  second = time.substring(secondColonIndex + 1).toInt();
+    if(status != AT_COMMAND_OK && cellular->debugStream != nullptr){
+        cellular->debugStream->println("Failed to read new SMS message.");
+    }
+}
 
-  offset = offsetStr.toInt();
+void ArduinoCellular::onIncomingSMSTextModeRestored(ATCommandStatus status, const char * response, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    cellular->incomingSMS.restoringTextMode = false;
+    cellular->incomingSMS.reading = false;
+    onTextModeSelected(status, response, context);
+}
 
-  return Time(year, month, day, hour, minute, second, offset);
+void ArduinoCellular::onTextModeSelected(ATCommandStatus status, const char * response, void * context){
+    if(status == AT_COMMAND_OK){
+        static_cast<ArduinoCellular *>(context)->noteSMSFormat(false);
+    }
 }
+#endif
+
+bool ArduinoCellular::connectAsync(const char * apn, const char * username, const char * password,
+                                   ConnectionCallback callback, void * context, bool waitForever){
+    if(connection.phase != CONNECTION_IDLE && connection.phase != CONNECTION_CONNECTED && connection.phase != CONNECTION_FAILED){
+        return false;
+    }
 
-// Parses a single SMS entry from the data
-SMS parseSMSEntry(const String& entry, const String& message) {
-  SMS sms;
-  int firstQuoteIndex = entry.indexOf('"');
-  int secondQuoteIndex = entry.indexOf('"', firstQuoteIndex + 1);
-  int thirdQuoteIndex = entry.indexOf('"', secondQuoteIndex + 1);
-  int fourthQuoteIndex = entry.indexOf('"', thirdQuoteIndex + 1);
-  int commaIndexBeforeTimestamp = entry.lastIndexOf(',', entry.lastIndexOf(',') - 1);
+    int length = snprintf(connection.contextCommand, sizeof(connection.contextCommand),
+                          "+QICSGP=1,1,\"%s\",\"%s\",\"%s\",1", apn, username, password);
+    if(length < 0 || length >= static_cast<int>(sizeof(connection.contextCommand))){
+        return false;
+    }
 
-  String command = "+CMGL: ";
-  // Index is between "+CMGL: " and first "," symbol
-  sms.index = entry.substring(entry.indexOf(command) + command.length(), entry.indexOf(',')).toInt();
+    connection.callback = callback;
+    connection.context = context;
+    connection.waitForever = waitForever;
+    connection.hasAPN = strlen(apn) > 0;
+    connection.timings = ConnectionTimings();
+    connection.commandRunning = false;
+    connection.startedAt = millis();
+    connection.phase = CONNECTION_IDLE;
+    enterConnectionPhase(CONNECTION_SIM);
+    return true;
+}
 
-  // Extracting number and raw timestamp
-  sms.sender = entry.substring(thirdQuoteIndex + 1, fourthQuoteIndex);
-  String rawTimestamp = entry.substring(commaIndexBeforeTimestamp + 2, entry.indexOf('+', commaIndexBeforeTimestamp) + 3);
+void ArduinoCellular::setConnectionBackoff(const ConnectionBackoff & backoff){
+    connectionBackoff = backoff;
+}
 
-  // Parse the timestamp
-  sms.timestamp = parseTimestamp(rawTimestamp);
-  
-  sms.message = message;
-  return sms;
+ConnectionPhase ArduinoCellular::getConnectionPhase() const {
+    return connection.phase;
 }
 
-// Function to split a string into lines based on a delimiter character
-// Filters out empty lines
-std::vector<String> splitStringByLines(const String& input, char delimiter = '\n') {
-    std::vector<String> lines;
-    int startIndex = 0;
-    while (startIndex < input.length()) {
-        int endIndex = input.indexOf(delimiter, startIndex);
-        if (endIndex == -1)
-            endIndex = input.length();
-        String line = input.substring(startIndex, endIndex);
-        // Remove trailing \r if it exists
-        if (line.endsWith("\r")) {
-            line.remove(line.length() - 1);
-        }
-        lines.push_back(line);
-        startIndex = endIndex + 1;
-    }
-    return lines;
+const ConnectionTimings & ArduinoCellular::getConnectionTimings() const {
+    return connection.timings;
 }
 
-// Splits the entire message string into individual SMS entries and parses them
-std::vector<SMS> parseSMSData(const String& data) {
-    std::vector<SMS> smsList = std::vector<SMS>();    
-    std::vector<String> lines = splitStringByLines(data);
+void ArduinoCellular::enterConnectionPhase(ConnectionPhase phase){
+    unsigned long now = millis();
+    unsigned long duration = now - connection.phaseStartedAt;
 
-    // Remove first line if it's empty
-    if (lines.size() > 0 && lines[0] == "") {
-        lines.erase(lines.begin());
+    switch(connection.phase){
+        case CONNECTION_SIM: connection.timings.sim = duration; break;
+        case CONNECTION_REGISTRATION: connection.timings.registration = duration; break;
+        case CONNECTION_PDP: connection.timings.pdp = duration; break;
+        case CONNECTION_DNS: connection.timings.dns = duration; break;
+        default: break;
     }
 
-    // Remove last 2 lines if second to last line is "OK"
-    if (lines.size() >= 2 && lines.back() == "OK") {
-        lines.erase(lines.end() - 2, lines.end());
-    }
-    
-    for(int i = 0; i < lines.size(); i ++){
-        if (lines[i].startsWith("+CMGL:")) {
-            String entry = lines[i];
-            String message = "";
-            // Loop through the lines until the next +CMGL line and extract the message by concatenating the lines
-            for (int j = i + 1; j < lines.size(); j++) {
-                if (lines[j].startsWith("+CMGL:")) {
-                    i = j - 1;
-                    break;
-                }
-                message += lines[j] + "\n";
-            }
-            // Remove the trailing newline character from the message
-            message.remove(message.length() - 1);
+    connection.phase = phase;
+    connection.phaseStartedAt = now;
+    connection.nextAttemptAt = now;
+    connection.retryDelay = connectionBackoff.initialDelay;
+    connection.step = 0;
+    connection.attempts = 0;
 
-            SMS sms = parseSMSEntry(entry, message);
-            smsList.push_back(sms);
+    if(this->debugStream != nullptr){
+        if(phase == CONNECTION_REGISTRATION){
+            this->debugStream->println("Waiting for network registration...");
+        } else if(phase == CONNECTION_PDP){
+            this->debugStream->println("Connecting to 4G network...");
         }
     }
 
-  return smsList;
+    if(phase == CONNECTION_CONNECTED || phase == CONNECTION_FAILED){
+        connection.timings.total = now - connection.startedAt;
+        if(connection.callback != nullptr){
+            connection.callback(phase == CONNECTION_CONNECTED, connection.timings, connection.context);
+        }
+    }
 }
 
-String ArduinoCellular::sendUSSDCommand(const char * command){
-    return modem.sendUSSD(command);
+void ArduinoCellular::retryConnectionPhase(bool failed){
+    if(failed){
+        connection.attempts++;
+        connection.timings.retries++;
+        // Waiting forever only applies to the registration, which does not count failed attempts
+        if(connectionBackoff.maxAttempts > 0 && connection.attempts >= connectionBackoff.maxAttempts){
+            enterConnectionPhase(CONNECTION_FAILED);
+            return;
+        }
+    }
+
+    connection.step = 0;
+    connection.nextAttemptAt = millis() + connection.retryDelay;
+
+    unsigned long nextDelay = connection.retryDelay * connectionBackoff.multiplier;
+    connection.retryDelay = nextDelay < connectionBackoff.maxDelay ? nextDelay : connectionBackoff.maxDelay;
 }
 
-std::vector<SMS> ArduinoCellular::getReadSMS(){
-    String rawMessages = sendATCommand("+CMGL=\"REC READ\"");
-    if(rawMessages.indexOf("OK") == -1){
-        return std::vector<SMS>();
-    } else if (rawMessages.indexOf("ERROR") != -1){
-        return std::vector<SMS>();
-    } else {
-        return parseSMSData(rawMessages);
+void ArduinoCellular::advanceConnection(){
+    if(connection.phase == CONNECTION_IDLE || connection.phase == CONNECTION_CONNECTED || connection.phase == CONNECTION_FAILED
+       || connection.commandRunning || static_cast<long>(millis() - connection.nextAttemptAt) < 0){
+        return;
     }
-}
 
-std::vector<SMS> ArduinoCellular::getUnreadSMS(){
-    String rawMessages = sendATCommand("+CMGL=\"REC UNREAD\"");
-    if(rawMessages.indexOf("OK") == -1){
-        return std::vector<SMS>();
-    } else if (rawMessages.indexOf("ERROR") != -1){
-        return std::vector<SMS>();
-    } else {
-        return parseSMSData(rawMessages);
+    const char * command = nullptr;
+    unsigned long timeout = 1000;
+
+    switch(connection.phase){
+        case CONNECTION_SIM:
+            command = "+CPIN?";
+            break;
+        case CONNECTION_REGISTRATION:
+            // LTE registration first, then 2G/3G packet domain registration
+            command = connection.step == 0 ? "+CEREG?" : "+CGREG?";
+            break;
+        case CONNECTION_PDP:
+            // Same sequence as TinyGSM's gprsConnect(), starting from a deactivated context
+            if(connection.step == 0){
+                command = "+QIDEACT=1";
+                timeout = 40000;
+            } else if(connection.step == 1){
+                command = connection.contextCommand;
+            } else if(connection.step == 2){
+                command = "+QIACT=1";
+                timeout = 150000;
+            } else {
+                command = "+CGATT=1";
+                timeout = 60000;
+            }
+            break;
+        case CONNECTION_DNS:
+            command = "+QIDNSCFG=1,\"8.8.8.8\",\"8.8.4.4\"";
+            break;
+        default:
+            return;
     }
-}
 
-bool ArduinoCellular::deleteSMS(uint16_t index){
-    String command = "+CMGD=" + String(index);
-    String response = sendATCommand(const_cast<char *>(command.c_str()));
-    return response.indexOf("OK") != -1;
+    if(commandEngine.enqueue(command, timeout, onConnectionResponse, this).isValid()){
+        connection.commandRunning = true;
+    }
 }
 
-void ArduinoCellular::setDebugStream(Stream &stream){
-    this->debugStream = &stream;
+void ArduinoCellular::onConnectionResponse(ATCommandStatus status, const char * response, void * context){
+    ArduinoCellular * cellular = static_cast<ArduinoCellular *>(context);
+    ConnectionRequest & connection = cellular->connection;
+    connection.commandRunning = false;
+
+    switch(connection.phase){
+        case CONNECTION_SIM:
+            // A missing, locked or broken SIM card does not get better by waiting
+            if(status == AT_COMMAND_OK && strstr(response, "READY") != nullptr){
+                cellular->enterConnectionPhase(CONNECTION_REGISTRATION);
+            } else if(strstr(response, "SIM PIN") != nullptr || strstr(response, "SIM PUK") != nullptr){
+                if(cellular->debugStream != nullptr){
+                    cellular->debugStream->println("SIM locked, cannot connect to network.");
+                }
+                cellular->enterConnectionPhase(CONNECTION_FAILED);
+            } else {
+                if(cellular->debugStream != nullptr){
+                    cellular->debugStream->println("SIM not ready, cannot connect to network.");
+                }
+                cellular->enterConnectionPhase(CONNECTION_FAILED);
+            }
+            break;
+
+        case CONNECTION_REGISTRATION:
+            if(status == AT_COMMAND_OK && isRegistered(response)){
+                if(connection.hasAPN){
+                    cellular->enterConnectionPhase(CONNECTION_PDP);
+                } else {
+                    if(cellular->debugStream != nullptr){
+                        cellular->debugStream->println("No APN specified, not connecting to GPRS");
+                    }
+                    cellular->enterConnectionPhase(CONNECTION_CONNECTED);
+                }
+            } else if(connection.step == 0){
+                connection.step = 1;
+            } else if(!connection.waitForever && millis() - connection.phaseStartedAt >= waitForNetworkTimeout){
+                cellular->enterConnectionPhase(CONNECTION_FAILED);
+            } else {
+                // Not registered yet is not a failure, keep querying at the backoff pace
+                cellular->retryConnectionPhase(false);
+            }
+            break;
+
+        case CONNECTION_PDP:
+            // A failing deactivation only means that no context was active
+            if(status == AT_COMMAND_OK || connection.step == 0){
+                if(++connection.step > 3){
+                    cellular->enterConnectionPhase(CONNECTION_DNS);
+                }
+            } else {
+                cellular->retryConnectionPhase(true);
+            }
+            break;
+
+        case CONNECTION_DNS:
+            if(status == AT_COMMAND_OK){
+                cellular->enterConnectionPhase(CONNECTION_CONNECTED);
+            } else {
+                if(cellular->debugStream != nullptr){
+                    cellular->debugStream->println("Failed to set DNS.");
+                }
+                cellular->retryConnectionPhase(true);
+            }
+            break;
+
+        default:
+            break;
+    }
 }
@@ -17,7 +17,10 @@
 #include <Arduino.h>
 #include <vector>
 
-#if defined __has_include
+#include <ModemProfile.h>
+
+// Define ARDUINO_CELLULAR_NO_BEARSSL as build flag to leave out the TLS stack running on the microcontroller
+#if defined __has_include && !defined(ARDUINO_CELLULAR_NO_BEARSSL)
   #if !__has_include (<ArduinoIoTCloud.h>)
     #define ARDUINO_CELLULAR_BEARSSL
   #endif
@@ -30,16 +33,34 @@
 
 #include <ModemInterface.h>
 #include <TimeUtils.h>
+#include <SMSParser.h>
+#include <SMSBatch.h>
+#include <SMSEncoder.h>
+#include <SMSReassembler.h>
+#include <ATCommandEngine.h>
+#include <URCDispatcher.h>
+#include <HTTPClientPool.h>
+#include <ModemHTTPClient.h>
+#include <SoftwareClock.h>
+#include <GNSSFix.h>
+#include <NMEAParser.h>
+#include <PowerSavingTimers.h>
 
+#ifndef ARDUINO_CELLULAR_SMS_SLOTS
 /**
- * @enum ModemModel
- * @brief Represents the model of the modem.
-*/
-enum ModemModel {
-    EC200, /**< Quectel EC200 modem. */
-    EG25,  /**< Quectel EG25 modem. */
-    Unsupported /**< Unsupported modem model. */
-};
+ * Number of SMS storage slots tracked by syncSMS(). Each slot costs one bit.
+ */
+#define ARDUINO_CELLULAR_SMS_SLOTS 256
+#endif
+
+#ifndef ARDUINO_CELLULAR_NOINIT
+/**
+ * Places the configuration fingerprint checked by beginWarm() in RAM that the startup code does not clear, so it
+ * survives resets of the microcontroller. Define it empty if the linker script has no such section;
+ * beginWarm() then applies the configuration after every reset.
+ */
+#define ARDUINO_CELLULAR_NOINIT __attribute__((section(".noinit")))
+#endif
 
 /**
  * Represents an SMS message.
@@ -50,6 +71,7 @@ class SMS {
         String sender; /**< The phone number associated with the SMS. */
         String message; /**< The content of the SMS message. */
         Time timestamp; /**< The timestamp when the SMS was received. */
+        SMSStatus status; /**< The storage status of the SMS when it was read. */
 
         /**
          * Default constructor for SMS.
@@ -60,6 +82,7 @@ class SMS {
             this->sender = "";
             this->message = "";
             this->timestamp = Time();
+            this->status = SMS_STATUS_UNKNOWN;
         }
         
         /**
@@ -68,12 +91,14 @@ class SMS {
          * @param sender The phone number associated with the sender of the SMS.
          * @param message The content of the SMS message.
          * @param timestamp The timestamp when the SMS was received.
+         * @param status The storage status of the SMS.
          */
-        SMS(int16_t index, String sender, String message, Time timestamp) {
+        SMS(int16_t index, String sender, String message, Time timestamp, SMSStatus status = SMS_STATUS_UNKNOWN) {
             this->index = index;
             this->sender = sender;
             this->message = message;
             this->timestamp = timestamp;
+            this->status = status;
         }
 };
 
@@ -87,11 +112,165 @@ struct Geolocation {
     float longitude; /**< The longitude coordinate of the location. */
 };
 
+/**
+ * @brief Callback invoked when an asynchronous location request completes.
+ * @param success True if a fix was obtained before the timeout.
+ * @param location The location, 0.0 for latitude and longitude if no fix was obtained.
+ * @param context The user pointer passed with the request.
+ */
+typedef void (*GeolocationCallback)(bool success, const Geolocation & location, void * context);
+
+/**
+ * @enum GNSSStartType
+ * @brief The aiding data the GNSS receiver keeps when it is restarted. The values are the <delete_type> of +QGPSDEL.
+ */
+enum GNSSStartType {
+    GNSS_START_COLD = 0, /**< All aiding data is deleted, the receiver searches the whole sky. */
+    GNSS_START_HOT = 1, /**< All aiding data is kept. */
+    GNSS_START_WARM = 2 /**< The ephemeris is deleted, almanac, time and last position are kept. */
+};
+
+/**
+ * @struct TTFFStats
+ * @brief Times to first fix of the receiver starts of one type (In milliseconds).
+ */
+struct TTFFStats {
+    uint32_t count = 0; /**< Number of starts that reached a fix. */
+    uint32_t abandoned = 0; /**< Number of starts that were restarted or stopped before a fix. */
+    unsigned long last = 0; /**< Time to first fix of the latest start. */
+    unsigned long minimum = 0; /**< Shortest time to first fix. */
+    unsigned long maximum = 0; /**< Longest time to first fix. */
+    unsigned long total = 0; /**< Sum of all times to first fix. */
+
+    /**
+     * @brief Gets the average time to first fix.
+     * @return The average, 0 if no start reached a fix.
+     */
+    unsigned long getAverage() const { return count > 0 ? total / count : 0; }
+};
+
+/**
+ * @struct XTRAStatus
+ * @brief The gpsOneXTRA assistance data known to the receiver.
+ */
+struct XTRAStatus {
+    bool injected = false; /**< True if XTRA data has been injected. */
+    bool valid = false; /**< True if the injected data has not expired. */
+    Time injectedAt; /**< The UTC time at which the injected data starts to be valid. */
+    unsigned long duration = 0; /**< How long the injected data is valid (In minutes). */
+    unsigned long expiresAt = 0; /**< The UNIX timestamp at which the injected data expires, 0 if none was injected. */
+};
+
+/**
+ * @enum SMSDeleteFilter
+ * @brief Selects the messages removed by a bulk delete. The values are the <delflag> of +CMGD.
+ */
+enum SMSDeleteFilter {
+    SMS_DELETE_READ = 1, /**< All read messages. */
+    SMS_DELETE_READ_AND_SENT = 2, /**< All read and sent messages. */
+    SMS_DELETE_READ_SENT_AND_UNSENT = 3, /**< All read, sent and unsent messages, unread messages are kept. */
+    SMS_DELETE_ALL = 4 /**< All messages. */
+};
+
+/**
+ * @enum ConnectionPhase
+ * @brief Represents the progress of a connection attempt.
+ */
+enum ConnectionPhase {
+    CONNECTION_IDLE, /**< No connection attempt has been started. */
+    CONNECTION_SIM, /**< Waiting for the SIM card to be ready. */
+    CONNECTION_REGISTRATION, /**< Waiting for the registration with the network operator. */
+    CONNECTION_PDP, /**< Activating the PDP context and attaching to the packet domain. */
+    CONNECTION_DNS, /**< Configuring the DNS servers. */
+    CONNECTION_CONNECTED, /**< The connection has been established. */
+    CONNECTION_FAILED /**< The connection attempt failed. */
+};
+
+/**
+ * @struct ConnectionTimings
+ * @brief Durations of the phases of a connection attempt (In milliseconds).
+ * Phases that were not reached have a duration of 0.
+ */
+struct ConnectionTimings {
+    unsigned long sim = 0; /**< Time until the SIM card was ready. */
+    unsigned long registration = 0; /**< Time until the modem was registered with the network. */
+    unsigned long pdp = 0; /**< Time to activate the PDP context. */
+    unsigned long dns = 0; /**< Time to configure the DNS servers. */
+    unsigned long total = 0; /**< Duration of the whole attempt. */
+    uint16_t retries = 0; /**< Number of failed commands that were retried. */
+};
+
+/**
+ * @struct BootTimings
+ * @brief Durations of the phases of begin() or beginWarm() (In milliseconds).
+ * Phases that were skipped have a duration of 0.
+ */
+struct BootTimings {
+    unsigned long power = 0; /**< Time to switch the modem on and wait for it to boot. */
+    unsigned long probe = 0; /**< Time to check whether the modem already answered (beginWarm() only). */
+    unsigned long init = 0; /**< Time of the TinyGSM initialization and the model detection. */
+    unsigned long configuration = 0; /**< Time to apply the configuration line. */
+    unsigned long total = 0; /**< Duration of the whole start. */
+    bool warm = false; /**< True if the modem was already on and the power sequence was skipped. */
+    bool configurationSkipped = false; /**< True if the modem still had the configuration and it was not sent again. */
+};
+
+/**
+ * @enum EDRXAccessTechnology
+ * @brief The radio access technology an eDRX setting applies to. The values are the <AcT-type> of +CEDRXS.
+ */
+enum EDRXAccessTechnology {
+    EDRX_ACCESS_LTE = 4, /**< LTE, including LTE-M (E-UTRAN WB-S1 mode). */
+    EDRX_ACCESS_NB_IOT = 5 /**< NB-IoT (E-UTRAN NB-S1 mode). */
+};
+
+/**
+ * @struct WakeStats
+ * @brief Times from the start of wake() to the first OK of the modem (In milliseconds).
+ */
+struct WakeStats {
+    uint32_t count = 0; /**< Number of wake-ups that reached an OK. */
+    uint32_t failures = 0; /**< Number of wake-ups without answer. */
+    unsigned long last = 0; /**< Wake latency of the latest wake-up. */
+    unsigned long minimum = 0; /**< Shortest wake latency. */
+    unsigned long maximum = 0; /**< Longest wake latency. */
+    unsigned long total = 0; /**< Sum of all wake latencies. */
+
+    /**
+     * @brief Gets the average wake latency.
+     * @return The average, 0 if no wake-up succeeded.
+     */
+    unsigned long getAverage() const { return count > 0 ? total / count : 0; }
+};
+
+/**
+ * @struct ConnectionBackoff
+ * @brief Retry policy of a connection attempt.
+ * The delay between two attempts starts at initialDelay and is multiplied by multiplier after every
+ * attempt, up to maxDelay. The delay also paces the registration queries.
+ */
+struct ConnectionBackoff {
+    unsigned long initialDelay = 500; /**< Delay before the first retry (In milliseconds). */
+    unsigned long maxDelay = 16000; /**< Upper bound of the delay (In milliseconds). */
+    uint8_t multiplier = 2; /**< Growth factor of the delay. */
+    uint8_t maxAttempts = 5; /**< Failed attempts of the PDP and DNS phases before giving up. 0 retries forever. */
+};
+
+/**
+ * @brief Callback invoked when an asynchronous connection attempt completes.
+ * @param success True if the connection has been established.
+ * @param timings The durations of the phases of the attempt.
+ * @param context The user pointer passed with the request.
+ */
+typedef void (*ConnectionCallback)(bool success, const ConnectionTimings & timings, void * context);
+
 /**
  * @class ArduinoCellular
  * 
  * This class provides methods to interact with the Arduino Pro Modem, such as connecting to the network,
  * sending SMS messages, getting GPS location, and more.
+ * The instance registers itself with its URC handlers and parsers, so it can be neither copied nor moved:
+ * declare it directly, e.g. ArduinoCellular cellular;
  */
 class ArduinoCellular {
     public: 
@@ -100,12 +279,96 @@ class ArduinoCellular {
          */
         ArduinoCellular();
 
+        /**
+         * @brief Creates an instance of the ArduinoCellular class that talks to the given modem
+         * instead of the global one, e.g. one attached to a TranscriptPlayer.
+         * @param modem The modem to use.
+         */
+        ArduinoCellular(ModemInterface& modem);
+
+        ArduinoCellular(const ArduinoCellular &) = delete;
+        ArduinoCellular & operator=(const ArduinoCellular &) = delete;
+
         /**
          * @brief Initializes the modem.
          * This function must be called before using any other functions in the library.
          */
         void begin();
 
+        /**
+         * @brief Initializes the modem like begin(), but only does what a modem that is already on needs.
+         * The modem is probed first and the power sequence is skipped if it answers. A modem that does not echo the
+         * probe has not restarted since it was initialized; if it was configured by this build of the sketch before
+         * the microcontroller was reset, as recorded by a fingerprint of the configuration, the initialization
+         * is skipped too. A modem left in PDU mode by the library is switched back to text mode. Changing the SMS or
+         * character set settings with sendATCommand() is not noticed.
+         * @return True if the modem was already on, false if it had to be powered up.
+         */
+        bool beginWarm();
+
+        /**
+         * @brief Gets the phase durations of the last begin() or beginWarm().
+         * @return The durations, in milliseconds.
+         */
+        const BootTimings & getBootTimings() const;
+
+        /**
+         * @brief Configures the power saving mode (PSM) with +CPSMS. In PSM the modem stays registered but
+         * unreachable between periodic tracking area updates. The network may grant other timers than requested.
+         * @param enable True to request PSM, false to disable it.
+         * @param periodicTAU The interval of the tracking area updates, rounded up to a value the network understands (In seconds).
+         * @param activeTime How long the modem stays reachable after a transfer before it enters PSM (In seconds).
+         * @return True if the modem accepted the setting.
+         */
+        bool setPSM(bool enable, unsigned long periodicTAU = 3600, unsigned long activeTime = 60);
+
+        /**
+         * @brief Configures extended discontinuous reception (eDRX) with +CEDRXS. With eDRX the modem stays reachable,
+         * but only listens for pages once per cycle.
+         * @param enable True to request eDRX, false to disable it.
+         * @param cycle The paging cycle, rounded up to the next of the 16 standard values (In milliseconds).
+         * @param technology The access technology the setting applies to.
+         * @return True if the modem accepted the setting.
+         */
+        bool setEDRX(bool enable, unsigned long cycle = 81920, EDRXAccessTechnology technology = EDRX_ACCESS_LTE);
+
+        /**
+         * @brief Enables or disables the sleep mode of the modem with +QSCLK. When enabled, the modem sleeps
+         * while its DTR line is high and no data is exchanged, see sleep() and wake().
+         * @param enable True to allow the modem to sleep.
+         * @param dtrPin The pin driving the DTR line of the modem, -1 to keep the current one.
+         * @return True if the modem accepted the setting.
+         */
+        bool setSleepMode(bool enable, int dtrPin = -1);
+
+        /**
+         * @brief Lets the modem sleep by driving its DTR line high. Sleep must be enabled with setSleepMode().
+         * @return False if no DTR pin is set or commands are still pending.
+         */
+        bool sleep();
+
+        /**
+         * @brief Wakes the modem by driving its DTR line low, if one is set, and resynchronizes the command parser
+         * without a full begin(). Partial lines received before are discarded and the modem is probed with AT until
+         * it answers. URCs the modem sends when it wakes up are dispatched as usual.
+         * Also use it after the modem left PSM or an eDRX cycle on its own.
+         * @param timeout The time the modem has to answer (In milliseconds).
+         * @return True if the modem answered, false on timeout or if commands are still pending.
+         */
+        bool wake(unsigned long timeout = 1000);
+
+        /**
+         * @brief Gets the time from wake() to the first OK of the modem, to weigh the latency of a sleep mode
+         * against the energy it saves.
+         * @return The wake latencies.
+         */
+        const WakeStats & getWakeStats() const;
+
+        /**
+         * @brief Clears the wake latencies.
+         */
+        void resetWakeStats();
+
         /**
          * @brief Unlocks the SIM card using the specified PIN.
          * @param pin The SIM card PIN.
@@ -119,7 +382,8 @@ class ArduinoCellular {
          * @param apn The Access Point Name.
          * @param username The APN username.
          * @param password The APN password.
-         * @param waitForever The function does not return unless a connection has been established
+         * @param waitForever True to wait for the network registration as long as it takes. A SIM card that is not
+         * ready and failing PDP or DNS steps still end the attempt.
          * @return True if the connection is successful, false otherwise.
          */
         bool connect(String apn = "", String username = "", String password = "", bool waitForever = true);
@@ -128,11 +392,46 @@ class ArduinoCellular {
          * @brief Registers with the cellular network and connects to the Internet
          * if the APN, GPRS username, and GPRS password are provided.
          * @param apn The Access Point Name.
-         * @param waitForever The function does not return unless a connection has been established
+         * @param waitForever True to wait for the network registration as long as it takes. A SIM card that is not
+         * ready and failing PDP or DNS steps still end the attempt.
          * @return True if the connection is successful, false otherwise.
          */
         bool connect(String apn, bool waitForever = true);
 
+        /**
+         * @brief Starts registering with the cellular network and connecting to the Internet without blocking.
+         * The SIM check, network registration, PDP context activation and DNS configuration are advanced by poll().
+         * Failed steps are retried according to the backoff policy set with setConnectionBackoff().
+         * @param apn The Access Point Name. If empty, the attempt completes once registered with the network.
+         * @param username The APN username.
+         * @param password The APN password.
+         * @param callback The function called when the attempt completes, may be nullptr.
+         * @param context A user pointer passed to the callback.
+         * @param waitForever If true, the network registration is waited for as long as it takes. A SIM card that is
+         * not ready fails the attempt right away, and the PDP and DNS steps give up after maxAttempts failures.
+         * @return True if the attempt was started, false if another attempt is pending or the credentials are too long.
+         */
+        bool connectAsync(const char * apn = "", const char * username = "", const char * password = "",
+                          ConnectionCallback callback = nullptr, void * context = nullptr, bool waitForever = false);
+
+        /**
+         * @brief Sets the retry policy of connection attempts.
+         * @param backoff The retry policy.
+         */
+        void setConnectionBackoff(const ConnectionBackoff & backoff);
+
+        /**
+         * @brief Gets the progress of the current or last connection attempt.
+         * @return The connection phase.
+         */
+        ConnectionPhase getConnectionPhase() const;
+
+        /**
+         * @brief Gets the phase durations of the current or last connection attempt.
+         * @return The durations, in milliseconds.
+         */
+        const ConnectionTimings & getConnectionTimings() const;
+
         /**
          * @brief Checks if the modem is registered on the network.
          * @return True if the network is connected, false otherwise.
@@ -145,6 +444,7 @@ class ArduinoCellular {
          */
         bool isConnectedToInternet();
 
+        #if ARDUINO_CELLULAR_GNSS
         /**
          * @brief Enables or disables the GPS functionality.
          * @param assisted True to enable assisted GPS, false to disable it. Assist GPS uses the network to get the GPS location faster, so cellular needs to be enabled. 
@@ -158,26 +458,138 @@ class ArduinoCellular {
          * @return The GPS location. If the location is not retrieved, the latitude and longitude will be 0.0.
          */
         Geolocation getGPSLocation(unsigned long timeout = 60000);
+
+        /**
+         * @brief Gets position, altitude, speed, course, HDOP, satellites and UTC time with one +QGPSLOC=2 query.
+         * Only supported by the EG25. (Blocking call)
+         * The result is cached, and a cached or streamed fix younger than maxAge is returned without talking to the modem.
+         * Failed queries are cached as well, so polling for a fix costs at most one query per maxAge.
+         * @param fix Receives the fix. Check its valid flag, the coordinates of an invalid fix are meaningless.
+         * @param maxAge The maximum age of a fix served from the cache (In milliseconds), 0 to always query the modem.
+         * @return True if the fix is valid.
+         */
+        bool getGNSSFix(GNSSFix & fix, unsigned long maxAge = 1000);
         
         /**
-         * @brief Gets the current time from the network.
+         * @brief Restarts the GNSS receiver after deleting the aiding data of the given start type,
+         * and measures the time until the first valid fix. Only supported by the EG25.
+         * The fix is detected by getGNSSFix(), getGPSLocation(), getGPSLocationAsync() or the GNSS stream,
+         * so one of them must be used after the start. A start without fix counts as abandoned when the next one begins.
+         * @param type The start type.
+         * @return True if the receiver was started.
+         */
+        bool startGNSS(GNSSStartType type);
+
+        /**
+         * @brief Gets the times to first fix measured by startGNSS().
+         * @param type The start type.
+         * @return The statistics of the start type.
+         */
+        const TTFFStats & getTTFFStats(GNSSStartType type) const;
+
+        /**
+         * @brief Enables or disables gpsOneXTRA assistance. Takes effect after the modem restarts.
+         * @param enable True to enable XTRA.
+         * @return True if the setting was accepted.
+         */
+        bool enableXTRA(bool enable = true);
+
+        /**
+         * @brief Uploads an XTRA file, e.g. downloaded to an SD card or flash file system, to the file system of the modem.
+         * An existing file with the same name is replaced. (Blocking call)
+         * @param source The stream the file is read from, e.g. a File.
+         * @param size The size of the file (In bytes).
+         * @param filename The name of the file on the modem.
+         * @return True if the whole file was uploaded.
+         */
+        bool uploadXTRA(Stream & source, size_t size, const char * filename = "UFS:xtra2.bin");
+
+        /**
+         * @brief Injects the current time and an uploaded XTRA file into the receiver.
+         * The time is taken from the software clock, which is synced from the network if needed.
+         * @param filename The name of the file on the modem.
+         * @return True if time and data were injected.
+         */
+        bool injectXTRA(const char * filename = "UFS:xtra2.bin");
+
+        /**
+         * @brief Queries the validity of the injected XTRA data.
+         * @return The status. The data counts as valid without checking the expiry if the software clock is not synced.
+         */
+        XTRAStatus getXTRAStatus();
+        #endif
+
+        /**
+         * @brief Gets the current local time from the software clock.
+         * The clock is synced from the network (NTP and +CCLK) the first time and whenever the last sync
+         * is older than the sync interval, otherwise the modem is not involved.
          * @return The current time.
          */
         Time getCellularTime();
 
+        #if ARDUINO_CELLULAR_GNSS
         /**
-         * @brief Gets the current time from the GPS module.
+         * @brief Gets the current time from the GPS module. A valid GPS time also syncs the software clock.
+         * A valid fix younger than one second obtained by getGNSSFix() or the GNSS stream is used without talking to the modem.
          * @return The current time.
          */
         Time getGPSTime();
+        #endif
+
+        /**
+         * @brief Gets the current UTC time from the software clock in O(1), without talking to the modem.
+         * Only the very first call syncs the clock from the network. Afterwards poll() re-syncs it
+         * from +CCLK in the background once per sync interval.
+         * @return The UNIX timestamp, or 0 if the clock could not be synced.
+         */
+        unsigned long getUNIXTime();
+
+        /**
+         * @brief Syncs the software clock from the network. (Blocking call)
+         * @return True if the modem provided a valid time.
+         */
+        bool syncClock();
 
+        /**
+         * @brief Sets how often the software clock is re-synced from the network.
+         * @param interval The sync interval (In milliseconds). Default is one hour.
+         */
+        void setClockSyncInterval(unsigned long interval);
+
+        #if ARDUINO_CELLULAR_SMS
         /**
          * @brief Sends an SMS message to the specified number.
+         * Messages longer than 160 characters or containing non-ASCII characters are sent with sendSMSPDU().
          * @param number The phone number to send the SMS to.
          * @param message The message to send.
          */
         void sendSMS(String number, String message);
 
+        /**
+         * @brief Sends an SMS message in PDU mode.
+         * The message is encoded with the GSM 7-bit alphabet if possible and as UCS-2 otherwise.
+         * Messages that do not fit into one SMS are sent as concatenated segments over a radio link kept open with +CMMS.
+         * @param number The phone number to send the SMS to, with a leading '+' if international.
+         * @param message The message to send, encoded as UTF-8.
+         * @param references Receives the message reference assigned by the network to every sent segment, may be nullptr.
+         * @param maxReferences The number of entries of references.
+         * @return The number of segments sent, or -1 if the message could not be encoded or sending failed.
+         * A value below the number of segments means the message was only sent partially.
+         */
+        int sendSMSPDU(const char * number, const char * message, uint8_t * references = nullptr, size_t maxReferences = 0);
+
+        /**
+         * @brief Sends the same SMS message to several recipients.
+         * The modem is switched to PDU mode and the radio link is kept open with +CMMS once for the whole batch,
+         * so that the messages follow each other at link speed.
+         * @param numbers The phone numbers to send the SMS to.
+         * @param count The number of recipients.
+         * @param message The message to send, encoded as UTF-8.
+         * @param references Receives, for every recipient, the message reference of its last segment or -1 if sending failed. May be nullptr.
+         * @return The number of recipients the whole message was sent to, or -1 if the message could not be encoded.
+         */
+        int sendSMSBatch(const char * const * numbers, size_t count, const char * message, int16_t * references = nullptr);
+
         /**
          * @brief Gets the list of read SMS messages.
          * @return A vector of SMS messages.
@@ -190,6 +602,94 @@ class ArduinoCellular {
          */
         std::vector<SMS> getUnreadSMS();
 
+        /**
+         * @brief Streams the read SMS messages to a callback.
+         * Each message is passed to the callback as soon as it has been received from the modem,
+         * so that the memory use does not depend on the number of stored messages.
+         * @param callback The function called for every message.
+         * @param context A user pointer passed to the callback.
+         * @return The number of messages, or -1 if the listing failed.
+         */
+        int getReadSMS(SMSCallback callback, void * context = nullptr);
+
+        /**
+         * @brief Streams the unread SMS messages to a callback.
+         * Each message is passed to the callback as soon as it has been received from the modem,
+         * so that the memory use does not depend on the number of stored messages.
+         * @param callback The function called for every message.
+         * @param context A user pointer passed to the callback.
+         * @return The number of messages, or -1 if the listing failed.
+         */
+        int getUnreadSMS(SMSCallback callback, void * context = nullptr);
+
+        /**
+         * @brief Fills a batch with the read SMS messages without allocating memory per message.
+         * The batch is cleared first. Messages that do not fit into the batch are dropped and counted by the batch.
+         * @param batch The batch to fill.
+         * @return The number of messages listed by the modem, or -1 if the listing failed.
+         */
+        int getReadSMS(SMSBatch & batch);
+
+        /**
+         * @brief Fills a batch with the unread SMS messages without allocating memory per message.
+         * The batch is cleared first. Messages that do not fit into the batch are dropped and counted by the batch.
+         * @param batch The batch to fill.
+         * @return The number of messages listed by the modem, or -1 if the listing failed.
+         */
+        int getUnreadSMS(SMSBatch & batch);
+
+        /**
+         * @brief Gets all stored SMS messages, whatever their status, with a single listing.
+         * Unlike getUnreadSMS(), the listing does not mark unread messages as read.
+         * @return A vector of SMS messages. Their status field tells them apart.
+         */
+        std::vector<SMS> getAllSMS();
+
+        /**
+         * @brief Streams all stored SMS messages to a callback without changing their status.
+         * @param callback The function called for every message.
+         * @param context A user pointer passed to the callback.
+         * @return The number of messages, or -1 if the listing failed.
+         */
+        int getAllSMS(SMSCallback callback, void * context = nullptr);
+
+        /**
+         * @brief Fills a batch with all stored SMS messages without changing their status.
+         * The batch is cleared first. Messages that do not fit into the batch are dropped and counted by the batch.
+         * @param batch The batch to fill.
+         * @return The number of messages listed by the modem, or -1 if the listing failed.
+         */
+        int getAllSMS(SMSBatch & batch);
+
+        /**
+         * @brief Passes the SMS messages stored since the last call to a callback.
+         * The storage slots already seen are remembered in a bitmap. While the number of stored messages
+         * reported by +CPMS? does not change, a call costs that one query. New messages are read from the
+         * unseen slots with +CMGR, in a way that keeps their status. The first call, and any call after
+         * messages were removed behind the library's back, lists the whole storage once instead.
+         * A message that replaces a removed one between two calls is only found with the next change of the count.
+         * @param callback The function called for every new message.
+         * @param context A user pointer passed to the callback.
+         * @return The number of new messages, each part of a concatenated message counted separately,
+         * or -1 if the modem could not be queried.
+         */
+        int syncSMS(SMSCallback callback, void * context = nullptr);
+
+        /**
+         * @brief Joins the parts of concatenated SMS messages before they are passed on.
+         * While a reassembler is set, the SMS listing and reading functions, syncSMS() and onSMSReceived()
+         * read the messages in PDU mode, which exposes the concatenation header, and deliver one message
+         * once all its parts are there. Its partIndices field lists the storage indexes of all parts.
+         * The modem is switched back to text mode afterwards.
+         * @param reassembler The reassembler, which must outlive its use, or nullptr to pass parts on unchanged.
+         */
+        void setSMSReassembler(SMSReassembler * reassembler);
+
+        /**
+         * @brief Forgets the messages seen by syncSMS(). The next call passes all stored messages again.
+         */
+        void resetSMSSync();
+
         /**
          * @brief Deletes an SMS message at the specified index.
          *
@@ -198,6 +698,25 @@ class ArduinoCellular {
          */
         bool deleteSMS(uint16_t index);
 
+        /**
+         * @brief Deletes several SMS messages.
+         * The +CMGD commands are concatenated into as few command lines as possible,
+         * so that most deletions share a single round trip.
+         * @param indices The indices of the SMS messages to delete.
+         * @param count The number of indices.
+         * @return The number of deleted messages.
+         */
+        int deleteSMS(const uint16_t * indices, size_t count);
+
+        /**
+         * @brief Deletes all SMS messages matching a filter with a single command.
+         * @param filter Selects the messages to delete.
+         * @return The number of deleted messages, 0 if the storage could not be queried,
+         * or -1 if the modem rejected the command.
+         */
+        int deleteSMS(SMSDeleteFilter filter);
+        #endif
+
         /**
          * @brief Sends an AT command to the modem and waits for a response, then returns the response.
          * @param command The AT command to send.
@@ -206,6 +725,130 @@ class ArduinoCellular {
          */
         String sendATCommand(const char * command, unsigned long timeout = 1000);
 
+        /**
+         * @brief Sends an AT command to the modem and collects the response in a buffer instead of a String.
+         * Nothing is allocated, use a StaticATResponseBuffer on the stack for steady-state code.
+         * @param command The AT command to send.
+         * @param response The buffer for the response, cleared first. isTruncated() reports a response that did not fit.
+         * @param timeout The timeout (In milliseconds) to wait for the response. Default is 1000ms.
+         * @return 1 for OK, 2 for ERROR, 3 for +CME ERROR, 4 for +CMS ERROR, 0 on timeout.
+         */
+        int8_t sendATCommand(const char * command, ATResponseBuffer & response, unsigned long timeout = 1000);
+
+        /**
+         * @brief Advances all asynchronous operations. Never blocks.
+         * Must be called frequently, e.g. from loop(), when asynchronous functions are used.
+         * Blocking functions must not be called while asynchronous operations are pending.
+         */
+        void poll();
+
+        /**
+         * @brief Checks whether asynchronous operations are pending.
+         * @return True if no asynchronous command is queued or running.
+         */
+        bool isIdle();
+
+        #if ARDUINO_CELLULAR_COMMAND_STATS
+        /**
+         * @brief Gets the per command statistics of the traffic with the modem: calls, timeouts, errors,
+         * bytes sent and received and a latency histogram. Copy the result to keep a snapshot.
+         * Use ATCommandStats::serialize() to report them.
+         * @return The statistics.
+         */
+        const ATCommandStats & getStats() const { return modem.monitor.getStats(); }
+
+        /**
+         * @brief Clears the per command statistics.
+         */
+        void resetStats() { modem.monitor.resetStats(); }
+        #endif
+
+        /**
+         * @brief Queues an AT command without waiting for the response.
+         * @param command The AT command to send, without the leading "AT".
+         * @param callback The function called when the command completes, may be nullptr.
+         * @param context A user pointer passed to the callback.
+         * @param timeout The timeout (In milliseconds) to wait for the response. Default is 1000ms.
+         * @return A handle to query the status and the response. The handle is invalid if the queue is full.
+         */
+        ATCommandHandle sendATCommandAsync(const char * command, ATCommandCallback callback = nullptr, void * context = nullptr, unsigned long timeout = 1000);
+
+        #if ARDUINO_CELLULAR_SMS
+        /**
+         * @brief Sends an SMS message without waiting for the network.
+         * @param number The phone number to send the SMS to.
+         * @param message The message to send.
+         * @param callback The function called when the modem has accepted or rejected the message, may be nullptr.
+         * @param context A user pointer passed to the callback.
+         * @return A handle to the +CMGS command. The handle is invalid if the queue is full or the message is too long.
+         */
+        ATCommandHandle sendSMSAsync(const char * number, const char * message, ATCommandCallback callback = nullptr, void * context = nullptr);
+        #endif
+
+        #if ARDUINO_CELLULAR_GNSS
+        /**
+         * @brief Requests the GPS location without blocking.
+         * The modem is queried once per second until a fix is obtained or the timeout expires.
+         * @param callback The function called with the result.
+         * @param context A user pointer passed to the callback.
+         * @param timeout The timeout (In milliseconds) to wait for the GPS location.
+         * @return True if the request was started, false if another request is pending or the modem has no GPS.
+         */
+        bool getGPSLocationAsync(GeolocationCallback callback, void * context = nullptr, unsigned long timeout = 60000);
+
+        /**
+         * @brief Starts streaming fixes from the GNSS receiver. Only supported by the EG25.
+         * poll() fetches the latest RMC, GSA and GGA sentences with +QGPSGNMEA at the given interval, without blocking,
+         * and publishes every fix to the callback and to the slot read by getLatestFix().
+         * Intervals below one second also raise the fix rate of the receiver. GPS must be enabled with enableGPS().
+         * The stream does not count as pending operation for isIdle().
+         * @param callback The function called for every fix, may be nullptr.
+         * @param context A user pointer passed to the callback.
+         * @param interval The time between two fixes (In milliseconds), 100 for 10 Hz.
+         * @return True if the stream was started, false if the modem has no GNSS receiver or rejected the configuration.
+         */
+        bool startGNSSStream(GNSSFixCallback callback, void * context = nullptr, unsigned long interval = 1000);
+
+        /**
+         * @brief Stops streaming fixes. A query in flight still completes.
+         */
+        void stopGNSSStream();
+
+        /**
+         * @brief Copies the latest streamed fix. Never talks to the modem.
+         * @param fix Receives the fix.
+         * @return True if a fix has been received since the stream was started.
+         */
+        bool getLatestFix(GNSSFix & fix) const;
+
+        /**
+         * @brief Gets the NMEA parser of the stream, e.g. to feed it sentences read from another port
+         * the receiver writes to, such as the one selected with +QGPSCFG="outport".
+         * @return The parser.
+         */
+        NMEAParser & getNMEAParser() { return nmeaParser; }
+        #endif
+
+        /**
+         * @brief Registers a handler for unsolicited result codes (URCs) such as "+QIURC:" or "+CUSD:".
+         * Handlers are invoked from poll(), never from inside a blocking call.
+         * @param prefix The URC prefix including the colon, e.g. "+QIURC:". Must stay valid.
+         * @param callback The function called with the complete URC line.
+         * @param context A user pointer passed to the callback.
+         * @return True if the handler was registered, false if the handler table is full.
+         */
+        bool onURC(const char * prefix, URCCallback callback, void * context = nullptr);
+
+        #if ARDUINO_CELLULAR_SMS
+        /**
+         * @brief Sets the function called for every newly received SMS message.
+         * The modem announces new messages with +CMTI, which are then fetched by index with +CMGR
+         * from poll(), so that polling the whole inbox is not needed.
+         * @param callback The function called for every new message, or nullptr to stop fetching new messages.
+         * @param context A user pointer passed to the callback.
+         */
+        void onSMSReceived(SMSCallback callback, void * context = nullptr);
+        #endif
 
 
         /**
@@ -233,19 +876,68 @@ class ArduinoCellular {
 
         /**
          * @brief Gets the HTTP client for the specified server and port.
+         * The underlying socket is taken from the client pool and may be shared with other clients, which is why
+         * the client connects for every request. Use acquireHTTPClient() to keep the connection open.
          * @param server The server address.
          * @param port The server port.
-         * @return The HTTP client.
+         * @return The HTTP client. Its requests fail to connect while all pooled clients are leased.
          */
         HttpClient getHTTPClient(const char * server, const int port);
 
         /**
          * @brief Gets the HTTPS client for the specified server and port.
+         * The underlying socket is taken from the client pool and may be shared with other clients, which is why
+         * the client connects for every request. Use acquireHTTPSClient() to keep the connection open.
          * @param server The server address.
          * @param port The server port.
-         * @return The HTTPS client.
+         * @return The HTTPS client. Its requests fail to connect while all pooled clients are leased.
          */
         HttpClient getHTTPSClient(const char * server, const int port);
+
+        /**
+         * @brief Leases a pooled HTTP client for the specified server and port.
+         * The connection is kept open after the request and reused by the next lease for the same server.
+         * The client returns to the pool when the lease goes out of scope.
+         * @param server The server address.
+         * @param port The server port.
+         * @return The lease. It is invalid if all pooled clients are in use.
+         */
+        PooledHTTPClient acquireHTTPClient(const char * server, const int port);
+
+        /**
+         * @brief Leases a pooled HTTPS client for the specified server and port.
+         * The connection and its TLS session are kept open after the request and reused
+         * by the next lease for the same server. The client returns to the pool when the lease goes out of scope.
+         * @param server The server address.
+         * @param port The server port.
+         * @return The lease. It is invalid if all pooled clients are in use.
+         */
+        PooledHTTPClient acquireHTTPSClient(const char * server, const int port);
+
+        /**
+         * @brief Gets the pool of HTTP clients, e.g. to close idle connections or to read its statistics.
+         * @return The client pool.
+         */
+        HTTPClientPool & getHTTPClientPool();
+
+        /**
+         * @brief Gets an HTTP client that runs on the HTTP stack of the modem instead of a socket.
+         * It uses no socket and no receive buffer; request and response bodies are streamed through the UART.
+         * @param server The server address.
+         * @param port The server port.
+         * @return The HTTP client.
+         */
+        ModemHTTPClient getModemHTTPClient(const char * server, const int port);
+
+        /**
+         * @brief Gets an HTTPS client that runs on the HTTP and TLS stacks of the modem instead of BearSSL.
+         * Requests fail until a CA certificate is set with ModemHTTPClient::setCACertificate(), or the verification
+         * of the server is waived with ModemHTTPClient::setInsecure().
+         * @param server The server address.
+         * @param port The server port.
+         * @return The HTTPS client.
+         */
+        ModemHTTPClient getModemHTTPSClient(const char * server, const int port);
         
         /**
          * @brief Gets the local IP address.
@@ -276,15 +968,27 @@ class ArduinoCellular {
         SimStatus getSimStatus();
 
     private:
-        bool connectToGPRS(const char * apn, const char * gprsUser, const char * gprsPass);
-        
+        /**
+         * @brief Queues the next command of the connection attempt once its backoff delay has expired.
+         */
+        void advanceConnection();
 
         /**
-         * @brief Waits for network registration. (Blocking call)
-         * @param waitForever if true the function does not return until a connection has been established
-         * @return True if the network registration is successful, false otherwise.
+         * @brief Ends the current phase of the connection attempt, records its duration and starts the given one.
+         * @param phase The phase to continue with.
          */
-        bool awaitNetworkRegistration(bool waitForever);
+        void enterConnectionPhase(ConnectionPhase phase);
+
+        /**
+         * @brief Schedules the current phase of the connection attempt to be repeated after the backoff delay.
+         * @param failed True if a command failed, which counts towards ConnectionBackoff::maxAttempts.
+         */
+        void retryConnectionPhase(bool failed);
+
+        /**
+         * @brief Handles the response of a command of the connection attempt.
+         */
+        static void onConnectionResponse(ATCommandStatus status, const char * response, void * context);
 
         /**
          * @brief Gets the GPS location. (Blocking call)
@@ -294,16 +998,387 @@ class ArduinoCellular {
          */
         void getGPSLocation(float* latitude, float* longitude, unsigned long timeout = 60000);
 
+        #if ARDUINO_CELLULAR_SMS
+        /**
+         * @brief Lists the SMS messages with the given status and parses the response while it streams in.
+         * @param status The +CMGL status filter, e.g. "REC READ".
+         * @param callback The function called for every message.
+         * @param context A user pointer passed to the callback.
+         * @param keepStatus True to leave unread messages unread.
+         * @param reassemble False to pass the parts of concatenated messages on without the reassembler.
+         * @return The number of messages, or -1 if the listing failed.
+         */
+        int listSMS(const char * status, SMSCallback callback, void * context, bool keepStatus = false, bool reassemble = true);
+
+        /**
+         * @brief Reads the messages announced since the last syncSMS() call. The modem is in the SMS format used for reading.
+         * @param stored The number of stored messages.
+         * @param capacity The number of slots of the storage.
+         * @return The number of new messages, or -1 if the listing failed.
+         */
+        int fetchNewSMS(int stored, int capacity);
+
+        /**
+         * @brief Selects text or PDU mode with +CMGF.
+         * @param pdu True for PDU mode.
+         * @return True if the modem accepted the mode.
+         */
+        bool selectSMSFormat(bool pdu);
+
+        /**
+         * @brief Records the SMS format of the modem, also for beginWarm(), after a switch or before a switch to PDU mode
+         * that may not be undone.
+         * @param pdu True for PDU mode.
+         */
+        void noteSMSFormat(bool pdu);
+
+        /**
+         * @brief Reads the SMS message in a storage slot with +CMGR without changing its status.
+         * @param index The storage index.
+         * @param callback The function called with the message.
+         * @param context A user pointer passed to the callback.
+         * @return 1 if the slot holds a message, 0 if it is empty, or -1 if the read failed.
+         */
+        int readSMS(uint16_t index, SMSCallback callback, void * context);
+
+        /**
+         * @brief Feeds the response of a +CMGL or +CMGR command to a parser until it is complete.
+         * @param parser The parser.
+         * @return The number of messages, or -1 if the command failed.
+         */
+        int receiveSMS(SMSParser & parser);
+
+        /**
+         * @brief Passes a message of a full listing to the syncSMS() callback if it was not seen before.
+         */
+        static void collectInboxSMS(const SMSView & sms, void * context);
+
+        /**
+         * @brief Marks a storage slot as seen by syncSMS().
+         * @param index The storage index.
+         * @return True if the slot was not seen before.
+         */
+        bool markSMSSeen(int16_t index);
+
+        /**
+         * @brief Removes a deleted message from the slots seen by syncSMS().
+         * @param index The storage index.
+         */
+        void forgetSMS(uint16_t index);
+
+        /**
+         * @brief Switches between PDU and text mode and enables or disables the kept-open radio link.
+         * @param pdu True for PDU mode, false for text mode.
+         * @return True if the modem accepted the mode.
+         */
+        bool setSMSPDUMode(bool pdu);
+
+        /**
+         * @brief Sends the PDUs of all segments of a message. The modem must be in PDU mode.
+         * @param encoder The encoder holding the message.
+         * @param number The recipient.
+         * @param references Receives the reference of every sent segment, may be nullptr.
+         * @param maxReferences The number of entries of references.
+         * @return The number of sent segments.
+         */
+        int sendSMSSegments(const SMSEncoder & encoder, const char * number, uint8_t * references, size_t maxReferences);
+
+        /**
+         * @brief Sends one PDU with +CMGS.
+         * @param pdu The PDU, starting with the SMSC octet.
+         * @param length The length of the TPDU, i.e. the PDU without the SMSC octet.
+         * @return The message reference assigned by the network, or -1 if sending failed.
+         */
+        int sendPDU(const uint8_t * pdu, size_t length);
+        #endif
+
+        #if ARDUINO_CELLULAR_GNSS
+        /**
+         * @brief Handles the response of an asynchronous +QGPSLOC query.
+         */
+        static void onGPSLocationResponse(ATCommandStatus status, const char * response, void * context);
+
+        /**
+         * @brief Queries a fix with +QGPSLOC=2 and caches it.
+         * @return True if the fix is valid.
+         */
+        bool queryGNSSFix();
+
+        /**
+         * @brief Completes the time to first fix measurement with a fix.
+         * @param fix The fix.
+         */
+        void recordFirstFix(const GNSSFix & fix);
+
+        /**
+         * @brief Gets the most recent cached or streamed fix.
+         * @param fix Receives the fix.
+         * @return True if there is a fix younger than maxAge.
+         */
+        bool getCachedFix(GNSSFix & fix, unsigned long maxAge) const;
+
+        /**
+         * @brief Passes the response of a +QGPSGNMEA query to the NMEA parser and detects its end.
+         */
+        static ATCommandStatus feedNMEA(char c, void * context);
+
+        /**
+         * @brief Handles the completion of the last +QGPSGNMEA query of a stream interval.
+         */
+        static void onNMEAQueryDone(ATCommandStatus status, const char * response, void * context);
+
+        /**
+         * @brief Queries the next sentences of the GNSS stream when due.
+         */
+        void advanceGNSSStream();
+
+        /**
+         * @brief Checks if the modem has a GNSS receiver. A constant unless the profile detects the model.
+         * @return True if GNSS functions are supported.
+         */
+        bool supportsGNSS() const {
+            return ModemProfile::detect ? model == ModemModel::EG25 || model == ModemModel::BG96 : ModemProfile::hasGNSS;
+        }
+
+        /**
+         * @brief Gets the +QGPSCFG setting selecting assisted or standalone positioning for the modem.
+         * @param assisted True for assisted positioning.
+         * @return The setting, nullptr if the modem has no such setting.
+         */
+        const char * getPositioningMode(bool assisted) const;
+        #endif
+
+        #if ARDUINO_CELLULAR_SMS
+        /**
+         * @brief Handles a +CMTI URC by queueing the announced message for reading.
+         */
+        static void onNewMessageIndication(const char * urc, void * context);
+
+        /**
+         * @brief Passes the response of an asynchronous +CMGR command to the incoming SMS parser.
+         */
+        static ATCommandStatus feedIncomingSMS(char c, void * context);
+
+        /**
+         * @brief Passes a message parsed from a +CMGR response to the user callback.
+         */
+        static void deliverIncomingSMS(const SMSView & sms, void * context);
+
+        /**
+         * @brief Handles the completion of an asynchronous +CMGR command.
+         */
+        static void onIncomingSMSRead(ATCommandStatus status, const char * response, void * context);
+
+        /**
+         * @brief Handles the completion of the +CMGF=1 command that follows a +CMGR command in PDU mode.
+         */
+        static void onIncomingSMSTextModeRestored(ATCommandStatus status, const char * response, void * context);
+
+        /**
+         * @brief Records the text mode once an asynchronous +CMGF=1 command has succeeded.
+         */
+        static void onTextModeSelected(ATCommandStatus status, const char * response, void * context);
+
+        /**
+         * @brief Starts reading the next announced SMS message if none is being read.
+         */
+        void readNextIncomingSMS();
+        #endif
+
+        ModemInterface& modem; /**< The modem used by this instance. */
+
+        ATCommandEngine commandEngine; /**< The engine running the asynchronous AT commands. */
+
+        URCDispatcher urcDispatcher; /**< Routes the URCs found in the modem output to their handlers. */
+
+        #if ARDUINO_CELLULAR_SMS
+        static constexpr size_t maxPendingSMSReads = 8; /**< Number of announced SMS messages that can wait for reading. */
+
+        /**
+         * @struct IncomingSMS
+         * @brief State of the fetching of SMS messages announced by +CMTI.
+         */
+        struct IncomingSMS {
+            SMSCallback callback = nullptr; /**< The function called for every new message. */
+            void * context = nullptr; /**< The user pointer passed to the callback. */
+            int16_t pending[maxPendingSMSReads]; /**< Indexes of the announced messages not yet read. */
+            uint8_t pendingCount = 0; /**< Number of announced messages not yet read. */
+            bool reading = false; /**< True while a +CMGR command, or the restore of text mode after it, is in flight. */
+            bool restoringTextMode = false; /**< True if the +CMGR command in flight is followed by a +CMGF=1 command. */
+        } incomingSMS;
+
+        SMSParser incomingSMSParser; /**< Parses the responses of the +CMGR commands. */
+
+        SMSReassembler * smsReassembler = nullptr; /**< Joins concatenated messages, nullptr if disabled. */
+
+        bool smsPDUMode = false; /**< True while the modem is, or may be, in PDU mode. */
+
+        uint8_t concatenationReference = 0; /**< Reference of the last concatenated SMS sent, shared by its segments. */
+
+        static constexpr size_t maxSMSSlots = ARDUINO_CELLULAR_SMS_SLOTS; /**< Number of storage slots tracked by syncSMS(). */
+
+        /**
+         * @struct InboxSync
+         * @brief The storage slots already passed to the syncSMS() callback.
+         */
+        struct InboxSync {
+            uint32_t seen[(maxSMSSlots + 31) / 32] = {}; /**< One bit per storage slot. */
+            int seenCount = 0; /**< Number of seen messages, including those whose slot is not tracked. */
+            bool valid = false; /**< False until the storage has been listed, and after it changed in unknown ways. */
+            SMSCallback callback = nullptr; /**< The callback of the running syncSMS() call. */
+            void * context = nullptr; /**< The user pointer of the running syncSMS() call. */
+            int delivered = 0; /**< Messages passed to the callback by the running syncSMS() call. */
+            const uint32_t * previous = nullptr; /**< The bitmap from before a running full listing, or nullptr. */
+        } inbox;
+        #endif
+
+        #if ARDUINO_CELLULAR_GNSS
+        /**
+         * @struct LocationRequest
+         * @brief State of a pending asynchronous location request.
+         */
+        struct LocationRequest {
+            GeolocationCallback callback = nullptr; /**< The function called with the result. */
+            void * context = nullptr; /**< The user pointer passed to the callback. */
+            unsigned long startedAt = 0; /**< Start of the request (In milliseconds). */
+            unsigned long timeout = 0; /**< The timeout of the request (In milliseconds). */
+            unsigned long nextQueryAt = 0; /**< When to query the modem next (In milliseconds). */
+            bool active = false; /**< True while the request is pending. */
+            bool queryRunning = false; /**< True while a +QGPSLOC query is in flight. */
+        } locationRequest;
+
+        GNSSFix lastFix; /**< The result of the last +QGPSLOC query. */
+        bool lastFixCached = false; /**< True once lastFix holds a query result. */
+        NMEAParser nmeaParser; /**< Parses the sentences of the GNSS stream. */
+
+        /**
+         * @struct TTFFMeasurement
+         * @brief State of the time to first fix measurement of the latest receiver start.
+         */
+        struct TTFFMeasurement {
+            GNSSStartType type = GNSS_START_HOT; /**< The type of the start. */
+            unsigned long startedAt = 0; /**< When the receiver was started (In milliseconds). */
+            bool running = false; /**< True until the first valid fix. */
+        } ttff;
+        TTFFStats ttffStats[3]; /**< The statistics, indexed by GNSSStartType. */
+        unsigned long xtraUploadTimeout = 60000; /**< Timeout of an XTRA file upload (In milliseconds). */
+
+        /**
+         * @struct GNSSStream
+         * @brief State of the streaming of GNSS fixes.
+         */
+        struct GNSSStream {
+            unsigned long interval = 1000; /**< The time between two queries (In milliseconds). */
+            unsigned long nextQueryAt = 0; /**< When to query the modem next (In milliseconds). */
+            char line[12]; /**< The beginning of the current response line, to detect the final result code. */
+            uint8_t lineLength = 0; /**< Number of characters in line. */
+            bool active = false; /**< True while fixes are streamed. */
+            bool queryRunning = false; /**< True while +QGPSGNMEA queries are in flight. */
+        } gnssStream;
+        #endif
+
+        /**
+         * @brief Initializes and configures the modem once it is on, the part of begin() that beginWarm() may skip.
+         * @param startedAt When the start began, for the total duration (In milliseconds).
+         */
+        void initializeModem(unsigned long startedAt);
+
+        /**
+         * @brief Completes begin() and beginWarm() after the modem is ready.
+         * @param startedAt When the start began, for the total duration (In milliseconds).
+         */
+        void completeBegin(unsigned long startedAt);
+
+        BootTimings bootTimings; /**< The phase durations of the last start. */
+
+        WakeStats wakeStats; /**< The latencies of wake(). */
+
+        static constexpr unsigned long wakeProbeTimeout = 20; /**< Time the modem has to answer each AT sent by wake() (In milliseconds). */
+
+        ConnectionBackoff connectionBackoff; /**< The retry policy of connection attempts. */
+
+        /**
+         * @struct ConnectionRequest
+         * @brief State of the current or last connection attempt.
+         */
+        struct ConnectionRequest {
+            ConnectionCallback callback = nullptr; /**< The function called with the result. */
+            void * context = nullptr; /**< The user pointer passed to the callback. */
+            ConnectionPhase phase = CONNECTION_IDLE; /**< The current phase. */
+            ConnectionTimings timings; /**< The phase durations. */
+            unsigned long startedAt = 0; /**< Start of the attempt (In milliseconds). */
+            unsigned long phaseStartedAt = 0; /**< Start of the current phase (In milliseconds). */
+            unsigned long nextAttemptAt = 0; /**< When to send the next command (In milliseconds). */
+            unsigned long retryDelay = 0; /**< The delay before the next retry (In milliseconds). */
+            uint8_t step = 0; /**< The command of the current phase to send next. */
+            uint8_t attempts = 0; /**< Failed attempts in the current phase. */
+            bool commandRunning = false; /**< True while a command of the attempt is in flight. */
+            bool waitForever = false; /**< True if the attempt never gives up waiting for the registration. */
+            bool hasAPN = false; /**< True if a PDP context must be activated. */
+            char contextCommand[ATCommandEngine::commandBufferSize]; /**< The +QICSGP command configuring the APN. */
+        } connection;
 
         TinyGsmClient client; /**< The GSM client. */
 
-        ModemModel model; /**< The modem model. */
+        HTTPClientPool httpClients; /**< The sockets reused by the HTTP and HTTPS clients. */
+
+        ModemModel model = ModemProfile::model; /**< The modem model, detected by begin() with the automatic profile. */
 
         Stream* debugStream = nullptr; /**< The stream to be used for printing debugging messages. */
 
         static unsigned long getTime(); /** Callback for getting the current time as an unix timestamp. */
 
+        /**
+         * @brief Syncs the software clock from a time reported by the modem.
+         * @param time The time, including its offset from UTC.
+         * @return True if the time is plausible and was applied.
+         */
+        bool applyClockTime(const Time & time);
+
+        /**
+         * @brief Syncs the software clock from the response of +CCLK?.
+         * @param response The response, containing +CCLK: "yy/MM/dd,hh:mm:ss+zz".
+         * @return True if the time is plausible and was applied.
+         */
+        bool applyClockResponse(const char * response);
+
+        /**
+         * @brief Handles the response of an asynchronous +CCLK? query.
+         */
+        static void onClockResponse(ATCommandStatus status, const char * response, void * context);
+
+        static ArduinoCellular * timeSource; /**< The instance serving the BearSSL time callback. */
+
+        SoftwareClock softwareClock; /**< The clock read by getTime(), getUNIXTime() and getCellularTime(). */
+
+        int utcOffset = 0; /**< The offset of the network local time from UTC (In minutes). */
+
+        unsigned long clockSyncInterval = 3600000UL; /**< How often the software clock is re-synced (In milliseconds). */
+
+        bool clockQueryRunning = false; /**< True while a +CCLK? query is in flight. */
+
+        unsigned long nextClockQueryAt = 0; /**< Earliest time of the next +CCLK? query (In milliseconds). */
+
+        static constexpr int minValidYear = 2020; /**< Times before this year come from an unset modem RTC. */
+
         static constexpr unsigned long waitForNetworkTimeout = 20000L; /**< Maximum wait time for network registration (In milliseconds). */
+
+        #if ARDUINO_CELLULAR_SMS
+        static constexpr unsigned long smsListingTimeout = 1000L; /**< Maximum silence on the line while listing SMS messages (In milliseconds). */
+
+        static constexpr unsigned long smsSendTimeout = 10000L; /**< Maximum response time of +CMGS (In milliseconds). */
+
+        static constexpr unsigned long smsDeleteTimeout = 5000L; /**< Maximum response time of +CMGD for one message (In milliseconds). */
+
+        static constexpr unsigned long smsBulkDeleteTimeout = 300000L; /**< Maximum response time of +CMGD with a delete flag (In milliseconds). */
+
+        /**
+         * @brief Gets the number of messages in the SMS storage that is read and deleted from.
+         * @param capacity Set to the number of slots of the storage if not nullptr.
+         * @return The number of stored messages, or -1 if the query failed.
+         */
+        int getStoredSMSCount(int * capacity = nullptr);
+        #endif
 };
 
 
@@ -0,0 +1,386 @@
+#include "BulkSocketClient.h"
+
+BulkSocketClient::BulkSocketClient(ModemInterface & modem, uint8_t * buffer, size_t size, const BulkSocketOptions & options)
+    : modem(modem), options(options), txBuffer(buffer), rxBuffer(buffer + size / 2) {
+    if (this->options.chunkSize == 0 || this->options.chunkSize > maxChunkSize) {
+        this->options.chunkSize = maxChunkSize;
+    }
+    // Transparent mode writes and reads the UART directly and needs no chunk memory
+    if (!this->options.transparent && this->options.chunkSize > size / 2) {
+        this->options.chunkSize = size / 2;
+    }
+    if (this->options.pipelineDepth == 0) {
+        this->options.pipelineDepth = 1;
+    }
+}
+
+BulkSocketClient::~BulkSocketClient() {
+    // A socket left in data mode would swallow all further commands
+    stop();
+}
+
+int BulkSocketClient::connect(IPAddress ip, uint16_t port) {
+    char host[16];
+    snprintf(host, sizeof(host), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    return connect(host, port);
+}
+
+int BulkSocketClient::connect(const char * host, uint16_t port) {
+    stop();
+    if (!options.transparent && options.chunkSize == 0) {
+        // No memory for the chunks
+        return 0;
+    }
+
+    // +QIOPEN=<contextID>,<connectID>,"TCP",<host>,<port>,<local port>,<access mode>
+    modem.sendAT(GF("+QIOPEN="), options.contextId, GF(","), options.connectId, GF(",\"TCP\",\""), host, GF("\","),
+                 port, GF(",0,"), options.transparent ? 2 : 0);
+    opened = true;
+
+    if (options.transparent) {
+        // The modem switches to data mode right after CONNECT
+        open = modem.waitResult(options.connectTimeout, "CONNECT") == 1;
+        if (open) {
+            // The line end of CONNECT is not payload
+            readLine(100);
+            modem.setDataMode(true);
+        }
+        return open ? 1 : 0;
+    }
+
+    if (modem.waitResult() != 1) {
+        return 0;
+    }
+
+    // The result of the connection attempt follows as URC: +QIOPEN: <connectID>,<err>
+    unsigned long startedAt = millis();
+    while (millis() - startedAt < options.connectTimeout) {
+        if (readLine(options.connectTimeout - (millis() - startedAt)) != LINE_OTHER) {
+            continue;
+        }
+        if (strncmp(line, "+QIOPEN:", 8) == 0 && atoi(line + 8) == options.connectId) {
+            const char * error = strchr(line, ',');
+            open = error != nullptr && atoi(error + 1) == 0;
+            // The first query must not wait for the poll interval
+            lastReadPollAt = millis() - options.readPollInterval;
+            return open ? 1 : 0;
+        }
+        handleURC();
+    }
+    return 0;
+}
+
+size_t BulkSocketClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t BulkSocketClient::write(const uint8_t * buffer, size_t size) {
+    if (!open) {
+        return 0;
+    }
+
+    if (options.transparent) {
+        size_t written = modem.stream->write(buffer, size);
+        bytesSent += written;
+        return written;
+    }
+
+    size_t written = 0;
+    while (written < size) {
+        if (txLength == 0 && size - written >= options.chunkSize) {
+            // Full chunks are sent straight from the caller's buffer
+            if (sendChunk(buffer + written, options.chunkSize) == 0) {
+                break;
+            }
+            written += options.chunkSize;
+            continue;
+        }
+
+        size_t count = options.chunkSize - txLength;
+        if (count > size - written) {
+            count = size - written;
+        }
+        memcpy(txBuffer + txLength, buffer + written, count);
+        txLength += count;
+        written += count;
+
+        if (txLength == options.chunkSize) {
+            size_t collected = txLength;
+            if (!sendCollected()) {
+                // The bytes of this call in the lost chunk were not written
+                return written > collected ? written - collected : 0;
+            }
+        }
+    }
+    return written;
+}
+
+int BulkSocketClient::available() {
+    if (rxPosition < rxLength) {
+        return static_cast<int>(rxLength - rxPosition);
+    }
+    if (!opened) {
+        return 0;
+    }
+
+    if (options.transparent) {
+        return modem.stream->available();
+    }
+
+    // The response to the data still held back would never arrive
+    if (txLength > 0 || unacknowledged > 0) {
+        flush();
+    }
+
+    if (millis() - lastReadPollAt < options.readPollInterval) {
+        return 0;
+    }
+    queryReceived();
+    return static_cast<int>(rxLength - rxPosition);
+}
+
+int BulkSocketClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int BulkSocketClient::read(uint8_t * buffer, size_t size) {
+    if (options.transparent) {
+        size_t count = 0;
+        while (count < size && modem.stream->available() > 0) {
+            buffer[count++] = static_cast<uint8_t>(modem.stream->read());
+        }
+        return count > 0 ? static_cast<int>(count) : -1;
+    }
+
+    if (available() <= 0) {
+        return -1;
+    }
+    size_t count = rxLength - rxPosition;
+    if (count > size) {
+        count = size;
+    }
+    memcpy(buffer, rxBuffer + rxPosition, count);
+    rxPosition += count;
+    return static_cast<int>(count);
+}
+
+int BulkSocketClient::peek() {
+    if (options.transparent) {
+        return modem.stream->peek();
+    }
+    return available() > 0 ? rxBuffer[rxPosition] : -1;
+}
+
+void BulkSocketClient::flush() {
+    if (options.transparent) {
+        modem.stream->flush();
+        return;
+    }
+    if (txLength > 0) {
+        sendCollected();
+    }
+    awaitAllSendResults();
+}
+
+void BulkSocketClient::stop() {
+    if (!opened) {
+        return;
+    }
+
+    if (options.transparent) {
+        if (open) {
+            // +++ only escapes data mode if it is surrounded by silence
+            modem.stream->flush();
+            delay(options.escapeGuardTime);
+            modem.stream->print("+++");
+            modem.waitResult(options.escapeGuardTime + 1000);
+            modem.setDataMode(false);
+        }
+    } else if (open) {
+        flush();
+    }
+
+    modem.sendAT(GF("+QICLOSE="), options.connectId);
+    modem.waitResult(10000);
+
+    open = false;
+    opened = false;
+    txLength = 0;
+    rxLength = 0;
+    rxPosition = 0;
+    unacknowledged = 0;
+}
+
+uint8_t BulkSocketClient::connected() {
+    return open || rxPosition < rxLength;
+}
+
+size_t BulkSocketClient::sendChunk(const uint8_t * data, size_t length) {
+    if (unacknowledged >= options.pipelineDepth && !awaitSendResult()) {
+        return 0;
+    }
+
+    modem.sendAT(GF("+QISEND="), options.connectId, GF(","), length);
+
+    // Results of earlier chunks may arrive before the prompt
+    unsigned long startedAt = millis();
+    while (millis() - startedAt < options.sendTimeout) {
+        LineResult result = readLine(options.sendTimeout - (millis() - startedAt));
+        if (result == LINE_PROMPT) {
+            modem.stream->write(data, length);
+            unacknowledged++;
+            chunkCount++;
+            bytesSent += length;
+            return length;
+        }
+        if (result != LINE_OTHER || handleSendResult()) {
+            continue;
+        }
+        if (strcmp(line, "ERROR") == 0 || strncmp(line, "+CME ERROR", 10) == 0) {
+            // The socket is not connected or its send buffer is full
+            sendFailures++;
+            return 0;
+        }
+        handleURC();
+    }
+    sendFailures++;
+    return 0;
+}
+
+bool BulkSocketClient::sendCollected() {
+    size_t length = txLength;
+    txLength = 0;
+    return sendChunk(txBuffer, length) == length;
+}
+
+bool BulkSocketClient::awaitSendResult() {
+    unsigned long startedAt = millis();
+    while (millis() - startedAt < options.sendTimeout) {
+        if (readLine(options.sendTimeout - (millis() - startedAt)) == LINE_OTHER) {
+            if (handleSendResult()) {
+                return true;
+            }
+            handleURC();
+        }
+    }
+
+    // Without an answer the state of the outstanding chunks is unknown
+    sendFailures += unacknowledged;
+    unacknowledged = 0;
+    return false;
+}
+
+bool BulkSocketClient::awaitAllSendResults() {
+    while (unacknowledged > 0) {
+        if (!awaitSendResult()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BulkSocketClient::queryReceived() {
+    rxLength = 0;
+    rxPosition = 0;
+    modem.sendAT(GF("+QIRD="), options.connectId, GF(","), options.chunkSize);
+
+    unsigned long startedAt = millis();
+    while (millis() - startedAt < options.sendTimeout) {
+        if (readLine(options.sendTimeout - (millis() - startedAt)) != LINE_OTHER) {
+            continue;
+        }
+        if (strncmp(line, "+QIRD:", 6) == 0) {
+            size_t length = strtoul(line + 6, nullptr, 10);
+            if (length > options.chunkSize) {
+                length = options.chunkSize;
+            }
+            // The data follows the header line unframed and may contain line ends
+            while (rxLength < length && millis() - startedAt < options.sendTimeout) {
+                if (modem.stream->available() > 0) {
+                    rxBuffer[rxLength++] = static_cast<uint8_t>(modem.stream->read());
+                } else {
+                    yield();
+                }
+            }
+            modem.waitResult();
+            break;
+        }
+        if (strcmp(line, "ERROR") == 0 || strncmp(line, "+CME ERROR", 10) == 0) {
+            break;
+        }
+        handleURC();
+    }
+
+    if (rxLength == 0) {
+        lastReadPollAt = millis();
+    }
+    return rxLength > 0;
+}
+
+BulkSocketClient::LineResult BulkSocketClient::readLine(unsigned long timeout) {
+    Stream & stream = *modem.stream;
+    size_t length = 0;
+    unsigned long startedAt = millis();
+
+    while (millis() - startedAt < timeout) {
+        if (stream.available() <= 0) {
+            yield();
+            continue;
+        }
+
+        char c = static_cast<char>(stream.read());
+        if (c == '\r') {
+            continue;
+        }
+        if (c == '\n') {
+            if (length > 0) {
+                line[length < sizeof(line) ? length : sizeof(line) - 1] = '\0';
+                return LINE_OTHER;
+            }
+            continue;
+        }
+        if (length == 0) {
+            // The prompt is not followed by a line end, the space after it is skipped as leading space of the next line
+            if (c == '>') {
+                return LINE_PROMPT;
+            }
+            if (c == ' ') {
+                continue;
+            }
+        }
+        if (length < sizeof(line) - 1) {
+            line[length] = c;
+        }
+        length++;
+    }
+    return LINE_NONE;
+}
+
+bool BulkSocketClient::handleSendResult() {
+    bool failed = strcmp(line, "SEND FAIL") == 0;
+    if (!failed && strcmp(line, "SEND OK") != 0) {
+        return false;
+    }
+    if (unacknowledged > 0) {
+        unacknowledged--;
+    }
+    if (failed) {
+        sendFailures++;
+    }
+    return true;
+}
+
+void BulkSocketClient::handleURC() {
+    // +QIURC: "recv",<connectID> or +QIURC: "closed",<connectID>, those of other sockets belong to TinyGSM clients
+    if (strncmp(line, "+QIURC: \"closed\",", 17) == 0 && atoi(line + 17) == options.connectId) {
+        open = false;
+    } else if (strncmp(line, "+QIURC: \"recv\",", 15) == 0 && atoi(line + 15) == options.connectId) {
+        // The next available() reads the data without waiting for the poll interval
+        lastReadPollAt = millis() - options.readPollInterval;
+    } else if (strncmp(line, "+QIURC:", 7) == 0) {
+        modem.handleSocketURC(line);
+    } else {
+        modem.dispatchURC(line);
+    }
+}
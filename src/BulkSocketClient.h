@@ -0,0 +1,164 @@
+/**
+ * @file BulkSocketClient.h
+ * @brief Header file for the BulkSocketClient class.
+ */
+
+#ifndef ARDUINO_CELLULAR_BULK_SOCKET_CLIENT_H
+#define ARDUINO_CELLULAR_BULK_SOCKET_CLIENT_H
+
+#include <Arduino.h>
+#include <ModemInterface.h>
+
+/**
+ * @struct BulkSocketOptions
+ * @brief The data path settings of a BulkSocketClient.
+ */
+struct BulkSocketOptions {
+    size_t chunkSize = 1460; /**< Bytes sent per +QISEND and read per +QIRD, at most BulkSocketClient::maxChunkSize and half the buffer. */
+    uint8_t pipelineDepth = 4; /**< Number of +QISEND commands whose SEND OK may still be outstanding. 1 waits for each one. */
+    bool transparent = false; /**< True to open the socket in transparent access mode, where the UART carries the raw payload. */
+    uint8_t contextId = 1; /**< The PDP context the socket is opened on. */
+    uint8_t connectId = TINY_GSM_MUX_COUNT - 1; /**< The modem socket, the lower ones are used by TinyGSM clients and the HTTP client pool. */
+    unsigned long connectTimeout = 150000; /**< Maximum time to open the socket (In milliseconds). */
+    unsigned long sendTimeout = 10000; /**< Maximum time for the modem to accept a chunk (In milliseconds). */
+    unsigned long readPollInterval = 10; /**< Minimum time between two +QIRD queries that found no data (In milliseconds). */
+    unsigned long escapeGuardTime = 1000; /**< Silence required before and after the +++ that leaves transparent mode (In milliseconds). */
+};
+
+/**
+ * @class BulkSocketClient
+ * @brief A TCP Client for bulk transfers that drives the Quectel socket commands itself instead of going through TinyGSM.
+ *
+ * In buffer access mode, small writes are collected into chunks of chunkSize bytes, so that every +QISEND carries
+ * as much payload as possible. The client does not wait for the SEND OK of a chunk before it sends the next
+ * command; up to pipelineDepth chunks may be unacknowledged, and their results are read while waiting for the next
+ * "> " prompt. Received data is read with +QIRD in chunks of the same size.
+ *
+ * In transparent access mode (+QIOPEN access mode 2) the modem switches the UART to data mode once connected, and
+ * payload is written and read without any framing. stop() leaves data mode with +++ and closes the socket.
+ * No other command can be sent to the modem while a transparent socket is open, and the payload is left out of the
+ * command statistics and the transcript.
+ *
+ * The chunks are collected and received in memory supplied by the caller, StaticBulkSocketClient brings its own.
+ * All calls block, like the other blocking calls of the library they must not be used while asynchronous commands
+ * are pending.
+ */
+class BulkSocketClient : public Client {
+    public:
+        static constexpr size_t maxChunkSize = 1460; /**< Largest payload of a single +QISEND. */
+
+        /**
+         * @brief Creates a client.
+         * @param modem The modem the socket is opened on.
+         * @param buffer The memory for the chunk being collected and the chunk last received, must stay valid while
+         * the client is in use. Transparent mode does not use it and takes nullptr.
+         * @param size The size of the memory (In bytes), the chunk size is limited to half of it.
+         * @param options The data path settings.
+         */
+        BulkSocketClient(ModemInterface & modem, uint8_t * buffer, size_t size, const BulkSocketOptions & options = BulkSocketOptions());
+
+        ~BulkSocketClient();
+
+        BulkSocketClient(const BulkSocketClient &) = delete;
+        BulkSocketClient & operator=(const BulkSocketClient &) = delete;
+
+        int connect(IPAddress ip, uint16_t port) override;
+        int connect(const char * host, uint16_t port) override;
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t * buffer, size_t size) override;
+        int available() override;
+        int read() override;
+        int read(uint8_t * buffer, size_t size) override;
+        int peek() override;
+
+        /**
+         * @brief Sends the collected data and waits until the modem accepted all chunks.
+         */
+        void flush() override;
+
+        void stop() override;
+        uint8_t connected() override;
+        operator bool() override { return connected(); }
+
+        /**
+         * @brief Gets the settings of the client.
+         * @return The settings, with the chunk size and pipeline depth limited to the supported range.
+         */
+        const BulkSocketOptions & getOptions() const { return options; }
+
+        /**
+         * @brief Gets the number of payload bytes handed to the modem.
+         * @return The number of bytes.
+         */
+        uint32_t getBytesSent() const { return bytesSent; }
+
+        /**
+         * @brief Gets the number of +QISEND commands, 0 in transparent mode.
+         * @return The number of chunks.
+         */
+        uint32_t getChunkCount() const { return chunkCount; }
+
+        /**
+         * @brief Gets the number of chunks the modem answered with SEND FAIL or ERROR.
+         * @return The number of failed chunks.
+         */
+        uint32_t getSendFailures() const { return sendFailures; }
+
+    private:
+        enum LineResult {
+            LINE_NONE, /**< Timeout. */
+            LINE_PROMPT, /**< The "> " prompt of +QISEND. */
+            LINE_OTHER /**< Any other line, in the line buffer. */
+        };
+
+        size_t sendChunk(const uint8_t * data, size_t length);
+        bool sendCollected();
+        bool awaitSendResult();
+        bool awaitAllSendResults();
+        bool queryReceived();
+        LineResult readLine(unsigned long timeout);
+        bool handleSendResult();
+        void handleURC();
+
+        ModemInterface & modem;
+        BulkSocketOptions options;
+
+        uint8_t * txBuffer; /**< Collects small writes into a chunk, the first half of the caller's memory. */
+        size_t txLength = 0;
+        uint8_t * rxBuffer; /**< The data of the last +QIRD, the second half of the caller's memory. */
+        size_t rxLength = 0;
+        size_t rxPosition = 0;
+
+        char line[URCDispatcher::maxURCLength + 1]; /**< The beginning of the last line read from the modem, long enough for URCs. */
+
+        uint8_t unacknowledged = 0; /**< Chunks whose SEND OK has not been read yet. */
+        bool opened = false; /**< True from connect() until the socket is closed with stop(). */
+        bool open = false; /**< True while the socket is connected, as far as the client knows. */
+        unsigned long lastReadPollAt = 0; /**< When +QIRD last found no data (In milliseconds). */
+
+        uint32_t bytesSent = 0;
+        uint32_t chunkCount = 0;
+        uint32_t sendFailures = 0;
+};
+
+/**
+ * @class StaticBulkSocketClient
+ * @brief A BulkSocketClient with its own chunk memory, e.g. as global variable.
+ * @tparam N The largest chunk size (In bytes), two chunks are stored.
+ */
+template<size_t N = BulkSocketClient::maxChunkSize>
+class StaticBulkSocketClient : public BulkSocketClient {
+    public:
+        /**
+         * @brief Creates a client.
+         * @param modem The modem the socket is opened on.
+         * @param options The data path settings.
+         */
+        explicit StaticBulkSocketClient(ModemInterface & modem, const BulkSocketOptions & options = BulkSocketOptions())
+            : BulkSocketClient(modem, storage, sizeof(storage), options) {}
+
+    private:
+        uint8_t storage[2 * N];
+};
+
+#endif
@@ -0,0 +1,52 @@
+/**
+ * @file GNSSFix.h
+ * @brief Header file for the GNSSFix struct.
+ */
+
+#ifndef ARDUINO_CELLULAR_GNSS_FIX_H
+#define ARDUINO_CELLULAR_GNSS_FIX_H
+
+#include <Arduino.h>
+#include <TimeUtils.h>
+
+/**
+ * @struct GNSSFix
+ * @brief A position fix with its quality and time.
+ *
+ * Coordinates are stored as fixed-point integers, so that no precision is lost to float and
+ * no floating-point arithmetic is needed. An invalid fix is marked by the valid flag, not by its coordinates.
+ */
+struct GNSSFix {
+    int32_t latitude = 0; /**< The latitude (In 1e-7 degrees, positive north). */
+    int32_t longitude = 0; /**< The longitude (In 1e-7 degrees, positive east). */
+    int32_t altitude = 0; /**< The altitude above mean sea level (In centimetres). */
+    uint32_t speed = 0; /**< The speed over ground (In centimetres per second). */
+    uint16_t course = 0; /**< The course over ground (In hundredths of a degree from true north). */
+    uint16_t hdop = 0; /**< The horizontal dilution of precision (In hundredths). */
+    uint8_t satellites = 0; /**< The number of satellites used for the fix. */
+    uint8_t dimension = 0; /**< 2 for a 2D fix, 3 for a 3D fix, 0 if unknown. */
+    bool valid = false; /**< True if the receiver had a fix. */
+    Time time; /**< The UTC time of the fix. */
+    unsigned long acquiredAt = 0; /**< The millis() value at which the fix was received from the modem. */
+
+    /**
+     * @brief Gets the latitude in degrees.
+     * @return The latitude.
+     */
+    double getLatitude() const { return latitude / 1e7; }
+
+    /**
+     * @brief Gets the longitude in degrees.
+     * @return The longitude.
+     */
+    double getLongitude() const { return longitude / 1e7; }
+};
+
+/**
+ * @brief Callback invoked for every new fix.
+ * @param fix The fix.
+ * @param context The user pointer passed when registering the callback.
+ */
+typedef void (*GNSSFixCallback)(const GNSSFix & fix, void * context);
+
+#endif
@@ -0,0 +1,203 @@
+#include "HTTPClientPool.h"
+
+#include <new>
+
+PooledHTTPClient::PooledHTTPClient(PooledHTTPClient && other) : pool(other.pool), slot(other.slot) {
+    other.pool = nullptr;
+}
+
+PooledHTTPClient & PooledHTTPClient::operator=(PooledHTTPClient && other) {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        slot = other.slot;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+void PooledHTTPClient::release() {
+    if (pool != nullptr) {
+        pool->release(slot);
+        pool = nullptr;
+    }
+}
+
+HttpClient * PooledHTTPClient::operator->() const {
+    return pool->slots[slot].http;
+}
+
+HttpClient & PooledHTTPClient::operator*() const {
+    return *pool->slots[slot].http;
+}
+
+HTTPClientPool::HTTPClientPool(TinyGsmBG96 & modem) : modem(&modem) {
+    for (size_t i = 0; i < poolSize; i++) {
+        slots[i].tcp.init(&modem, firstMux + i);
+        slots[i].host[0] = '\0';
+    }
+}
+
+HTTPClientPool::~HTTPClientPool() {
+    for (size_t i = 0; i < poolSize; i++) {
+        if (slots[i].http != nullptr) {
+            slots[i].http->~HttpClient();
+        }
+#if defined(ARDUINO_CELLULAR_BEARSSL)
+        delete slots[i].tls;
+#endif
+    }
+}
+
+Client & HTTPClientPool::client(Slot & slot) {
+#if defined(ARDUINO_CELLULAR_BEARSSL)
+    if (slot.secure) {
+        return *slot.tls;
+    }
+#endif
+    return slot.tcp;
+}
+
+int HTTPClientPool::find(const char * server, uint16_t port, bool secure) const {
+    for (size_t i = 0; i < poolSize; i++) {
+        const Slot & slot = slots[i];
+        if (!slot.leased && slot.port == port && slot.secure == secure && strcmp(slot.host, server) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int HTTPClientPool::assign(const char * server, uint16_t port, bool secure) {
+#if !defined(ARDUINO_CELLULAR_BEARSSL)
+    if (secure) {
+        return -1;
+    }
+#endif
+    size_t hostLength = strlen(server);
+    if (hostLength > maxHostLength) {
+        return -1;
+    }
+
+    // An unused slot, otherwise the one that has been idle for the longest time
+    int candidate = -1;
+    for (size_t i = 0; i < poolSize; i++) {
+        Slot & slot = slots[i];
+        if (slot.leased) {
+            continue;
+        }
+        if (slot.http == nullptr) {
+            candidate = i;
+            break;
+        }
+        if (candidate < 0 || static_cast<long>(slot.lastUsed - slots[candidate].lastUsed) < 0) {
+            candidate = i;
+        }
+    }
+    if (candidate < 0) {
+        return -1;
+    }
+
+    Slot & slot = slots[candidate];
+    if (slot.http != nullptr) {
+        if (slot.open || slot.pinned) {
+            close(slot);
+        }
+        slot.http->~HttpClient();
+        slot.http = nullptr;
+    }
+
+#if defined(ARDUINO_CELLULAR_BEARSSL)
+    if (secure && slot.tls == nullptr) {
+        slot.tls = new BearSSLClient(slot.tcp);
+    }
+#endif
+
+    memcpy(slot.host, server, hostLength + 1);
+    slot.port = port;
+    slot.secure = secure;
+    slot.http = new (slot.httpStorage) HttpClient(client(slot), slot.host, port);
+    slot.http->connectionKeepAlive();
+    return candidate;
+}
+
+PooledHTTPClient HTTPClientPool::acquire(const char * server, uint16_t port, bool secure) {
+    // A server whose client is leased gets a second connection
+    int index = find(server, port, secure);
+    if (index >= 0) {
+        Slot & slot = slots[index];
+        if (slot.pinned) {
+            // The clients handed out by pin() may have connected the socket to another server
+            close(slot);
+        } else if (client(slot).connected()) {
+            reused++;
+        } else if (slot.open) {
+            // Closed by the server, free the socket in the modem before the client reconnects
+            close(slot);
+        }
+    } else {
+        index = assign(server, port, secure);
+        if (index < 0) {
+            return PooledHTTPClient();
+        }
+    }
+
+    slots[index].leased = true;
+    slots[index].open = true;
+    return PooledHTTPClient(this, index);
+}
+
+Client & HTTPClientPool::pin(const char * server, uint16_t port, bool secure) {
+    int index = find(server, port, secure);
+    if (index < 0) {
+        index = assign(server, port, secure);
+        if (index < 0) {
+            return unavailable;
+        }
+    }
+
+    // The slot remains a candidate for reassignment, by the time it was last handed out
+    Slot & slot = slots[index];
+    slot.pinned = true;
+    slot.open = true;
+    slot.lastUsed = millis();
+    return client(slot);
+}
+
+void HTTPClientPool::release(uint8_t index) {
+    Slot & slot = slots[index];
+    slot.leased = false;
+    slot.lastUsed = millis();
+    if (!client(slot).connected()) {
+        close(slot);
+    }
+}
+
+void HTTPClientPool::close(Slot & slot) {
+    client(slot).stop();
+    slot.open = false;
+}
+
+size_t HTTPClientPool::reclaim() {
+    size_t reclaimed = 0;
+    for (size_t i = 0; i < poolSize; i++) {
+        Slot & slot = slots[i];
+        if (!slot.open || slot.leased || slot.pinned) {
+            continue;
+        }
+        if (!client(slot).connected()) {
+            close(slot);
+            reclaimed++;
+        }
+    }
+    return reclaimed;
+}
+
+void HTTPClientPool::closeAll() {
+    for (size_t i = 0; i < poolSize; i++) {
+        Slot & slot = slots[i];
+        if (slot.open && !slot.leased && !slot.pinned) {
+            close(slot);
+        }
+    }
+}
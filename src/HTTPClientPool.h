@@ -0,0 +1,204 @@
+/**
+ * @file HTTPClientPool.h
+ * @brief Header file for the HTTPClientPool class.
+ */
+
+#ifndef ARDUINO_CELLULAR_HTTP_CLIENT_POOL_H
+#define ARDUINO_CELLULAR_HTTP_CLIENT_POOL_H
+
+#include <ModemInterface.h>
+
+#if defined(ARDUINO_CELLULAR_BEARSSL)
+  #include <ArduinoBearSSL.h>
+#endif
+
+#ifndef ARDUINO_CELLULAR_CLIENT_POOL_SIZE
+/**
+ * Number of sockets kept by the HTTP client pool. Every pooled socket holds a receive buffer of TINY_GSM_RX_BUFFER bytes.
+ */
+#define ARDUINO_CELLULAR_CLIENT_POOL_SIZE 2
+#endif
+
+class HTTPClientPool;
+
+/**
+ * @class PooledHTTPClient
+ * @brief A lease of an HTTP client from an HTTPClientPool.
+ *
+ * The client is returned to the pool when the lease is destroyed or release() is called.
+ * The socket stays open for the next request to the same server unless the client was stopped.
+ */
+class PooledHTTPClient {
+    public:
+        /**
+         * @brief Creates a lease that does not refer to any client.
+         */
+        PooledHTTPClient() {}
+
+        /**
+         * @brief Takes over the client of another lease.
+         * @param other The lease to move from. It is left invalid.
+         */
+        PooledHTTPClient(PooledHTTPClient && other);
+
+        /**
+         * @brief Releases the current client and takes over the client of another lease.
+         * @param other The lease to move from. It is left invalid.
+         * @return This lease.
+         */
+        PooledHTTPClient & operator=(PooledHTTPClient && other);
+
+        PooledHTTPClient(const PooledHTTPClient &) = delete;
+        PooledHTTPClient & operator=(const PooledHTTPClient &) = delete;
+
+        ~PooledHTTPClient() { release(); }
+
+        /**
+         * @brief Checks whether the lease refers to a client.
+         * @return True if a client was available in the pool.
+         */
+        bool isValid() const { return pool != nullptr; }
+
+        /**
+         * @brief Returns the client to the pool. The lease becomes invalid.
+         */
+        void release();
+
+        /**
+         * @brief Accesses the leased client. The lease must be valid.
+         */
+        HttpClient * operator->() const;
+
+        /**
+         * @brief Accesses the leased client. The lease must be valid.
+         */
+        HttpClient & operator*() const;
+
+    private:
+        friend class HTTPClientPool;
+        PooledHTTPClient(HTTPClientPool * pool, uint8_t slot) : pool(pool), slot(slot) {}
+
+        HTTPClientPool * pool = nullptr;
+        uint8_t slot = 0;
+};
+
+/**
+ * @class HTTPClientPool
+ * @brief A fixed set of sockets and HTTP clients, keyed by server and port.
+ *
+ * The pool owns one modem socket per slot. A slot keeps its server until it has to be reused for
+ * another one, so consecutive requests to the same server go over the open keep-alive connection
+ * and skip opening the socket and, for HTTPS, the TLS handshake. Sockets closed by the remote end
+ * are released in the modem when found.
+ */
+class HTTPClientPool {
+    public:
+        static constexpr size_t poolSize = ARDUINO_CELLULAR_CLIENT_POOL_SIZE; /**< Number of slots. */
+        static constexpr uint8_t firstMux = 1; /**< First modem socket used by the pool, socket 0 is left to getNetworkClient(). */
+        static constexpr size_t maxHostLength = 63; /**< Maximum length of a server name. */
+
+        static_assert(firstMux + poolSize <= TINY_GSM_MUX_COUNT, "The client pool needs more sockets than the modem has");
+
+        /**
+         * @brief Creates a pool whose sockets are opened by the given modem.
+         * @param modem The modem.
+         */
+        explicit HTTPClientPool(TinyGsmBG96 & modem);
+
+        ~HTTPClientPool();
+
+        HTTPClientPool(const HTTPClientPool &) = delete;
+        HTTPClientPool & operator=(const HTTPClientPool &) = delete;
+
+        /**
+         * @brief Leases the HTTP client of a server, preferably one whose connection is still open.
+         * If no slot belongs to the server, the least recently used free slot is closed and reassigned.
+         * @param server The server address.
+         * @param port The server port.
+         * @param secure True to connect over TLS.
+         * @return The lease. It is invalid if all slots are in use or the server name is too long.
+         */
+        PooledHTTPClient acquire(const char * server, uint16_t port, bool secure);
+
+        /**
+         * @brief Hands out the socket client of a slot without a lease.
+         * Used by getHTTPClient() and getHTTPSClient(), whose clients are never released. The slot stays
+         * in the pool and is reassigned by least recent use like any free slot, so the clients handed out
+         * may share a socket with other servers. They have to connect for every request, which HttpClient
+         * does unless connectionKeepAlive() was called. Leases never reuse the connection of such a slot.
+         * @param server The server address.
+         * @param port The server port.
+         * @param secure True to get a TLS client.
+         * @return The client. If all slots are leased or the server name is too long, it is a client that
+         * fails to connect.
+         */
+        Client & pin(const char * server, uint16_t port, bool secure);
+
+        /**
+         * @brief Releases the sockets of the free slots that were closed by the remote end.
+         * @return The number of released sockets.
+         */
+        size_t reclaim();
+
+        /**
+         * @brief Closes the sockets of all free slots.
+         */
+        void closeAll();
+
+        /**
+         * @brief Gets the number of leases that found the connection to their server still open.
+         * @return The number of reused connections.
+         */
+        uint32_t getReusedCount() const { return reused; }
+
+    private:
+        friend class PooledHTTPClient;
+
+        /**
+         * The client pin() hands out when no slot can be assigned. Requests on it fail to connect.
+         */
+        class UnavailableClient : public Client {
+            public:
+                int connect(IPAddress, uint16_t) override { return 0; }
+                int connect(const char *, uint16_t) override { return 0; }
+                size_t write(uint8_t) override { return 0; }
+                size_t write(const uint8_t *, size_t) override { return 0; }
+                int available() override { return 0; }
+                int read() override { return -1; }
+                int read(uint8_t *, size_t) override { return -1; }
+                int peek() override { return -1; }
+                void flush() override {}
+                void stop() override {}
+                uint8_t connected() override { return 0; }
+                operator bool() override { return false; }
+        };
+
+        struct Slot {
+            TinyGsmClient tcp;
+#if defined(ARDUINO_CELLULAR_BEARSSL)
+            BearSSLClient * tls = nullptr; /**< Allocated the first time the slot is used for HTTPS, then reused. */
+#endif
+            alignas(HttpClient) unsigned char httpStorage[sizeof(HttpClient)];
+            HttpClient * http = nullptr;
+            char host[maxHostLength + 1];
+            uint16_t port = 0;
+            bool secure = false;
+            bool leased = false;
+            bool pinned = false; /**< Handed out by pin(), its clients may have connected the socket to any server. */
+            bool open = false; /**< False once the socket is known to be closed. */
+            unsigned long lastUsed = 0;
+        };
+
+        int find(const char * server, uint16_t port, bool secure) const;
+        int assign(const char * server, uint16_t port, bool secure);
+        Client & client(Slot & slot);
+        void close(Slot & slot);
+        void release(uint8_t slot);
+
+        TinyGsmBG96 * modem;
+        Slot slots[poolSize];
+        UnavailableClient unavailable;
+        uint32_t reused = 0;
+};
+
+#endif
@@ -0,0 +1,571 @@
+#include "ModemHTTPClient.h"
+
+namespace {
+
+// Follows the response in the +QHTTPREAD output, before its error code
+constexpr char readTrailer[] = "\r\nOK\r\n\r\n+QHTTPREAD: ";
+
+constexpr char userAgent[] = "Arduino/2.2.0";
+
+}
+
+static_assert(sizeof(readTrailer) - 1 == 20, "trailerLength does not match the +QHTTPREAD trailer");
+
+ModemHTTPClient::ModemHTTPClient(ModemInterface & modem, const char * server, uint16_t port, bool secure)
+    : modem(modem), server(server), port(port), secure(secure) {
+    headerLine[0] = '\0';
+}
+
+void ModemHTTPClient::setCACertificate(const char * filename) {
+    caCertificate = filename;
+}
+
+void ModemHTTPClient::setInsecure() {
+    insecure = true;
+}
+
+void ModemHTTPClient::beginRequest() {
+    requestBegun = true;
+}
+
+int ModemHTTPClient::startRequest(const char * url, const char * method, const char * contentType, int contentLength, const byte body[]) {
+    bool begun = requestBegun;
+    stop();
+
+    // The modem only has commands for GET and POST
+    bool isPost = strcmp(method, HTTP_METHOD_POST) == 0;
+    if (!isPost && strcmp(method, HTTP_METHOD_GET) != 0) {
+        return fail(HTTP_ERROR_API);
+    }
+    if (secure && caCertificate == nullptr && !insecure) {
+        // An unauthenticated server has to be accepted explicitly with setInsecure()
+        return fail(HTTP_ERROR_API);
+    }
+    if (!configure() || !applyVerification() || !setURL(url)) {
+        return fail(HTTP_ERROR_CONNECTION_FAILED);
+    }
+
+    postRequest = isPost;
+    headerLength = 0;
+    headerOverflow = false;
+    bodyLength = -1;
+    state = STATE_COLLECTING_HEADERS;
+
+    appendHeader(method);
+    appendHeader(" ");
+    appendHeader(url);
+    appendHeader(" HTTP/1.1\r\n");
+    if (defaultHeaders) {
+        appendHeader("Host: ");
+        appendHeader(server);
+        if (port != (secure ? 443 : HttpClient::kHttpPort)) {
+            char portText[8];
+            snprintf(portText, sizeof(portText), ":%u", port);
+            appendHeader(portText);
+        }
+        appendHeader("\r\n");
+        sendHeader(HTTP_HEADER_USER_AGENT, userAgent);
+    }
+    if (contentType != nullptr) {
+        sendHeader(HTTP_HEADER_CONTENT_TYPE, contentType);
+    }
+    if (contentLength > -1) {
+        sendHeader(HTTP_HEADER_CONTENT_LENGTH, contentLength);
+    }
+
+    bool hasBody = body != nullptr && contentLength > 0;
+    if ((!begun || hasBody) && !finishHeaders()) {
+        return failure;
+    }
+    if (hasBody) {
+        write(body, contentLength);
+    }
+    return HTTP_SUCCESS;
+}
+
+int ModemHTTPClient::endRequest() {
+    requestBegun = false;
+    if (state == STATE_COLLECTING_HEADERS && !finishHeaders()) {
+        return failure;
+    }
+    return state == STATE_FAILED ? failure : HTTP_SUCCESS;
+}
+
+void ModemHTTPClient::beginBody() {
+    if (state == STATE_COLLECTING_HEADERS) {
+        finishHeaders();
+    }
+}
+
+void ModemHTTPClient::sendHeader(const char * header) {
+    if (state != STATE_COLLECTING_HEADERS) {
+        return;
+    }
+    size_t nameLength = strlen(HTTP_HEADER_CONTENT_LENGTH);
+    if (strncasecmp(header, HTTP_HEADER_CONTENT_LENGTH, nameLength) == 0 && header[nameLength] == ':') {
+        bodyLength = atol(header + nameLength + 1);
+    }
+    appendHeader(header);
+    appendHeader("\r\n");
+}
+
+void ModemHTTPClient::sendHeader(const char * name, const char * value) {
+    if (state != STATE_COLLECTING_HEADERS) {
+        return;
+    }
+    if (strcasecmp(name, HTTP_HEADER_CONTENT_LENGTH) == 0) {
+        bodyLength = atol(value);
+    }
+    appendHeader(name);
+    appendHeader(": ");
+    appendHeader(value);
+    appendHeader("\r\n");
+}
+
+void ModemHTTPClient::sendHeader(const char * name, int value) {
+    char text[12];
+    snprintf(text, sizeof(text), "%d", value);
+    sendHeader(name, text);
+}
+
+int ModemHTTPClient::responseStatusCode() {
+    int result = awaitResponse();
+    return result == HTTP_SUCCESS ? statusCode : result;
+}
+
+bool ModemHTTPClient::headerAvailable() {
+    if (!startReading() || state != STATE_READING_HEADERS) {
+        return false;
+    }
+
+    size_t length = readResponseLine(headerLine, sizeof(headerLine));
+    if (length == 0) {
+        // An empty line ends the headers
+        state = STATE_READING_BODY;
+        return false;
+    }
+
+    char * colon = strchr(headerLine, ':');
+    headerValueOffset = length;
+    if (colon != nullptr) {
+        *colon = '\0';
+        headerValueOffset = colon + 1 - headerLine;
+        while (headerLine[headerValueOffset] == ' ') {
+            headerValueOffset++;
+        }
+    }
+    if (strcasecmp(headerLine, HTTP_HEADER_CONTENT_LENGTH) == 0) {
+        responseLength = atol(headerLine + headerValueOffset);
+    }
+    return true;
+}
+
+int ModemHTTPClient::skipResponseHeaders() {
+    while (headerAvailable()) {
+    }
+    if (state == STATE_READING_BODY) {
+        return HTTP_SUCCESS;
+    }
+    return state == STATE_FAILED ? failure : HTTP_ERROR_API;
+}
+
+int ModemHTTPClient::contentLength() {
+    if (!endOfHeadersReached()) {
+        skipResponseHeaders();
+    }
+    return responseLength;
+}
+
+bool ModemHTTPClient::endOfBodyReached() const {
+    return state == STATE_READING_BODY && readComplete && heldLength == 0 && peeked < 0;
+}
+
+String ModemHTTPClient::responseBody() {
+    String body;
+    if (skipResponseHeaders() != HTTP_SUCCESS) {
+        return body;
+    }
+    if (responseLength > 0) {
+        body.reserve(responseLength);
+    }
+    int c;
+    while ((c = takeByte(true)) >= 0) {
+        body += static_cast<char>(c);
+    }
+    return body;
+}
+
+int ModemHTTPClient::connect(IPAddress ip, uint16_t port) {
+    // The modem connects for each request
+    return configure() ? 1 : 0;
+}
+
+int ModemHTTPClient::connect(const char * host, uint16_t port) {
+    return configure() ? 1 : 0;
+}
+
+size_t ModemHTTPClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t ModemHTTPClient::write(const uint8_t * buffer, size_t size) {
+    if (state == STATE_COLLECTING_HEADERS && !finishHeaders()) {
+        return 0;
+    }
+    if (state != STATE_SENDING_BODY) {
+        return 0;
+    }
+
+    // The modem takes exactly the announced number of bytes
+    size_t written = modem.stream->write(buffer, size < bodyRemaining ? size : bodyRemaining);
+    bodyRemaining -= written;
+    if (bodyRemaining == 0) {
+        state = STATE_REQUEST_SENT;
+    }
+    return written;
+}
+
+int ModemHTTPClient::available() {
+    if (!prepareBody()) {
+        return 0;
+    }
+    if (peeked < 0) {
+        peeked = nextByte(false);
+    }
+    return peeked >= 0 ? 1 : 0;
+}
+
+int ModemHTTPClient::read() {
+    return prepareBody() ? takeByte(false) : -1;
+}
+
+int ModemHTTPClient::read(uint8_t * buffer, size_t size) {
+    if (!prepareBody()) {
+        return -1;
+    }
+    size_t count = 0;
+    int c;
+    while (count < size && (c = takeByte(false)) >= 0) {
+        buffer[count++] = static_cast<uint8_t>(c);
+    }
+    return count > 0 ? static_cast<int>(count) : -1;
+}
+
+int ModemHTTPClient::peek() {
+    if (!prepareBody()) {
+        return -1;
+    }
+    if (peeked < 0) {
+        peeked = nextByte(false);
+    }
+    return peeked;
+}
+
+void ModemHTTPClient::flush() {
+    modem.stream->flush();
+}
+
+void ModemHTTPClient::stop() {
+    if (state == STATE_SENDING_BODY) {
+        // Completing the body would send a request the caller gave up on. Without the announced number of bytes
+        // the modem drops the request once the input time has passed, and takes commands again.
+        unsigned long inputEndsAt = inputTime * 1000UL;
+        unsigned long elapsed = millis() - inputStartedAt;
+        modem.waitResult(elapsed < inputEndsAt ? inputEndsAt - elapsed + 5000 : 5000);
+        modem.sendAT(GF("+QHTTPSTOP"));
+        modem.waitResult(10000);
+    } else if (state == STATE_REQUEST_SENT) {
+        modem.waitResult(responseTimeout);
+        modem.sendAT(GF("+QHTTPSTOP"));
+        modem.waitResult(10000);
+    } else if (state == STATE_READING_HEADERS || state == STATE_READING_BODY) {
+        // The output of +QHTTPREAD cannot be interrupted, the rest of it is discarded
+        while (takeByte(true) >= 0) {
+        }
+    }
+
+    state = STATE_IDLE;
+    requestBegun = false;
+    peeked = -1;
+    heldLength = 0;
+}
+
+uint8_t ModemHTTPClient::connected() {
+    switch (state) {
+        case STATE_IDLE:
+        case STATE_FAILED:
+            return false;
+        case STATE_READING_BODY:
+            return !endOfBodyReached();
+        default:
+            return true;
+    }
+}
+
+bool ModemHTTPClient::configure() {
+    if (configured) {
+        return true;
+    }
+
+    // The request and response headers are passed through, so that they can be written and read like with HttpClient
+    modem.sendAT(GF("+QHTTPCFG=\"contextid\","), pdpContextId);
+    if (modem.waitResult() != 1) {
+        return false;
+    }
+    modem.sendAT(GF("+QHTTPCFG=\"requestheader\",1"));
+    if (modem.waitResult() != 1) {
+        return false;
+    }
+    modem.sendAT(GF("+QHTTPCFG=\"responseheader\",1"));
+    if (modem.waitResult() != 1) {
+        return false;
+    }
+
+    if (secure) {
+        // Any TLS version and cipher suite the server offers
+        modem.sendAT(GF("+QSSLCFG=\"sslversion\","), sslContextId, GF(",4"));
+        modem.waitResult();
+        modem.sendAT(GF("+QSSLCFG=\"ciphersuite\","), sslContextId, GF(",0xFFFF"));
+        modem.waitResult();
+        // Older firmware does not know SNI
+        modem.sendAT(GF("+QSSLCFG=\"sni\","), sslContextId, GF(",1"));
+        modem.waitResult();
+    }
+
+    configured = true;
+    return true;
+}
+
+bool ModemHTTPClient::applyVerification() {
+    if (!secure) {
+        return true;
+    }
+    if (caCertificate == nullptr && !insecure) {
+        return false;
+    }
+
+    // The modem has one set of HTTP and SSL settings for all clients, another client may have changed them
+    modem.sendAT(GF("+QHTTPCFG=\"sslctxid\","), sslContextId);
+    if (modem.waitResult() != 1) {
+        return false;
+    }
+    if (caCertificate != nullptr) {
+        modem.sendAT(GF("+QSSLCFG=\"cacert\","), sslContextId, GF(",\""), caCertificate, GF("\""));
+        if (modem.waitResult() != 1) {
+            return false;
+        }
+    }
+    // Security level 1 verifies the server with the CA certificate, 0 only after setInsecure()
+    modem.sendAT(GF("+QSSLCFG=\"seclevel\","), sslContextId, GF(","), caCertificate != nullptr ? 1 : 0);
+    return modem.waitResult() == 1;
+}
+
+bool ModemHTTPClient::setURL(const char * path) {
+    const char * scheme = secure ? "https://" : "http://";
+    char portText[8];
+    snprintf(portText, sizeof(portText), ":%u", port);
+
+    // +QHTTPURL=<URL length>,<input time in seconds>
+    size_t length = strlen(scheme) + strlen(server) + strlen(portText) + strlen(path);
+    modem.sendAT(GF("+QHTTPURL="), length, GF(","), inputTime);
+    if (modem.waitResult(5000, "CONNECT") != 1) {
+        return false;
+    }
+    modem.stream->print(scheme);
+    modem.stream->print(server);
+    modem.stream->print(portText);
+    modem.stream->print(path);
+    return modem.waitResult(5000) == 1;
+}
+
+void ModemHTTPClient::appendHeader(const char * text) {
+    size_t length = strlen(text);
+    if (headerLength + length > sizeof(header)) {
+        headerOverflow = true;
+        return;
+    }
+    memcpy(header + headerLength, text, length);
+    headerLength += length;
+}
+
+bool ModemHTTPClient::finishHeaders() {
+    appendHeader("\r\n");
+    if (headerOverflow) {
+        // Sending the truncated headers would corrupt the request, and the modem already has the URL
+        fail(HTTP_ERROR_API);
+        return false;
+    }
+
+    size_t body = bodyLength > 0 ? static_cast<size_t>(bodyLength) : 0;
+    unsigned long responseSeconds = (responseTimeout + 999) / 1000;
+    // +QHTTPPOST=<data length>,<input time>,<response time>, +QHTTPGET=<response time>,<data length>,<input time>
+    if (postRequest) {
+        modem.sendAT(GF("+QHTTPPOST="), headerLength + body, GF(","), inputTime, GF(","), responseSeconds);
+    } else {
+        modem.sendAT(GF("+QHTTPGET="), responseSeconds, GF(","), headerLength + body, GF(","), inputTime);
+    }
+    // The modem connects to the server before it asks for the request
+    if (modem.waitResult(responseTimeout, "CONNECT") != 1) {
+        fail(HTTP_ERROR_CONNECTION_FAILED);
+        return false;
+    }
+
+    inputStartedAt = millis();
+    modem.stream->write(reinterpret_cast<const uint8_t *>(header), headerLength);
+    bodyRemaining = body;
+    state = bodyRemaining > 0 ? STATE_SENDING_BODY : STATE_REQUEST_SENT;
+    return true;
+}
+
+int ModemHTTPClient::awaitResponse() {
+    if (state == STATE_COLLECTING_HEADERS) {
+        endRequest();
+    }
+    switch (state) {
+        case STATE_IDLE:
+        case STATE_SENDING_BODY:
+            // The modem only answers once it has the whole request
+            return HTTP_ERROR_API;
+        case STATE_FAILED:
+            return failure;
+        case STATE_REQUEST_SENT:
+            break;
+        default:
+            return HTTP_SUCCESS;
+    }
+
+    // OK for the request, then +QHTTPGET: <err>,<status code>,<content length> or +QHTTPPOST: ... once the server answered
+    if (modem.waitResult(responseTimeout) != 1) {
+        return fail(HTTP_ERROR_CONNECTION_FAILED);
+    }
+    if (modem.waitResult(responseTimeout, postRequest ? "+QHTTPPOST:" : "+QHTTPGET:") != 1) {
+        return fail(HTTP_ERROR_TIMED_OUT);
+    }
+    char result[24];
+    readModemLine(result, sizeof(result), 1000);
+    const char * status = strchr(result, ',');
+    if (atoi(result) != 0 || status == nullptr) {
+        return fail(HTTP_ERROR_CONNECTION_FAILED);
+    }
+
+    statusCode = atoi(status + 1);
+    responseLength = HttpClient::kNoContentLengthHeader;
+    state = STATE_RESPONSE_RECEIVED;
+    return HTTP_SUCCESS;
+}
+
+bool ModemHTTPClient::startReading() {
+    if (awaitResponse() != HTTP_SUCCESS) {
+        return false;
+    }
+    if (state != STATE_RESPONSE_RECEIVED) {
+        return true;
+    }
+
+    // +QHTTPREAD=<wait time> answers CONNECT, followed by the response
+    modem.sendAT(GF("+QHTTPREAD="), (responseTimeout + 999) / 1000);
+    if (modem.waitResult(responseTimeout, "CONNECT") != 1) {
+        fail(HTTP_ERROR_TIMED_OUT);
+        return false;
+    }
+    char line[8];
+    readModemLine(line, sizeof(line), 1000);
+
+    heldLength = 0;
+    peeked = -1;
+    readComplete = false;
+    state = STATE_READING_HEADERS;
+
+    // The status code is already known from the result of the request
+    readResponseLine(headerLine, sizeof(headerLine));
+    headerLine[0] = '\0';
+    return true;
+}
+
+bool ModemHTTPClient::prepareBody() {
+    return state == STATE_READING_BODY || skipResponseHeaders() == HTTP_SUCCESS;
+}
+
+int ModemHTTPClient::nextByte(bool wait) {
+    unsigned long startedAt = millis();
+    while (true) {
+        // Held bytes are released as soon as they can no longer be the start of the trailer
+        if (heldLength > 0 && (readComplete || memcmp(held, readTrailer, heldLength) != 0)) {
+            int c = static_cast<uint8_t>(held[0]);
+            memmove(held, held + 1, --heldLength);
+            return c;
+        }
+        if (readComplete) {
+            return -1;
+        }
+        if (heldLength == trailerLength) {
+            // The error code of the read ends the output
+            char result[8];
+            readModemLine(result, sizeof(result), 1000);
+            heldLength = 0;
+            readComplete = true;
+            return -1;
+        }
+
+        if (modem.stream->available() <= 0) {
+            if (!wait) {
+                return -1;
+            }
+            if (millis() - startedAt >= responseTimeout) {
+                // The modem stopped sending, whatever is held is part of the response
+                readComplete = true;
+                continue;
+            }
+            yield();
+            continue;
+        }
+        held[heldLength++] = static_cast<char>(modem.stream->read());
+    }
+}
+
+int ModemHTTPClient::takeByte(bool wait) {
+    if (peeked >= 0) {
+        int c = peeked;
+        peeked = -1;
+        return c;
+    }
+    return nextByte(wait);
+}
+
+size_t ModemHTTPClient::readResponseLine(char * buffer, size_t size) {
+    size_t length = 0;
+    int c;
+    while ((c = takeByte(true)) >= 0 && c != '\n') {
+        if (c != '\r' && length < size - 1) {
+            buffer[length++] = static_cast<char>(c);
+        }
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+size_t ModemHTTPClient::readModemLine(char * buffer, size_t size, unsigned long timeout) {
+    size_t length = 0;
+    unsigned long startedAt = millis();
+    while (millis() - startedAt < timeout) {
+        if (modem.stream->available() <= 0) {
+            yield();
+            continue;
+        }
+        char c = static_cast<char>(modem.stream->read());
+        if (c == '\n') {
+            break;
+        }
+        if (c != '\r' && length < size - 1) {
+            buffer[length++] = c;
+        }
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+int ModemHTTPClient::fail(int error) {
+    failure = error;
+    state = STATE_FAILED;
+    return error;
+}
@@ -0,0 +1,280 @@
+/**
+ * @file ModemHTTPClient.h
+ * @brief Header file for the ModemHTTPClient class.
+ */
+
+#ifndef ARDUINO_CELLULAR_MODEM_HTTP_CLIENT_H
+#define ARDUINO_CELLULAR_MODEM_HTTP_CLIENT_H
+
+#include <Arduino.h>
+#include <ArduinoHttpClient.h>
+#include <ModemInterface.h>
+
+#ifndef ARDUINO_CELLULAR_HTTP_HEADER_SIZE
+/**
+ * Size of the buffer collecting the request line and headers of a ModemHTTPClient request (In bytes).
+ * The headers are sent to the modem in one piece once their length is known.
+ */
+#define ARDUINO_CELLULAR_HTTP_HEADER_SIZE 384
+#endif
+
+/**
+ * @class ModemHTTPClient
+ * @brief An HTTP and HTTPS client with the interface of HttpClient that runs on the HTTP stack and TLS stack of the modem
+ * (+QHTTPCFG, +QHTTPURL, +QHTTPGET, +QHTTPPOST, +QHTTPREAD and +QSSLCFG) instead of a socket and BearSSL on the board.
+ *
+ * The request headers are collected in a buffer of ARDUINO_CELLULAR_HTTP_HEADER_SIZE bytes and handed to the modem
+ * together with the body, which is written straight to the UART. The modem needs the length of the whole request up
+ * front, so a request with a body must announce it with a Content-Length header, as post() does.
+ * The response, including its headers, is read from the UART while it arrives; only the last few bytes are held back
+ * to find its end. Reading the body skips any headers that have not been read yet.
+ *
+ * Only GET and POST requests are supported. The modem runs one HTTP request at a time and opens a new connection
+ * for each one. HTTPS requests need the CA certificate the server is verified with, see setCACertificate(); they fail
+ * without it, unless setInsecure() explicitly waives the verification. The modem keeps one SSL configuration for all
+ * clients, so the verification settings of a client are sent again before each of its HTTPS requests.
+ * All calls block, like the other blocking calls of the library they must not be used while asynchronous commands are pending.
+ */
+class ModemHTTPClient : public Client {
+    public:
+        static constexpr uint8_t pdpContextId = 1; /**< The PDP context the requests use, the one ArduinoCellular::connect() activates. */
+        static constexpr uint8_t sslContextId = 1; /**< The SSL context configured for HTTPS requests. */
+        static constexpr uint16_t inputTime = 60; /**< Maximum time for writing the URL or the request to the modem (In seconds). */
+
+        /**
+         * @brief Creates a client.
+         * @param modem The modem the requests are sent with.
+         * @param server The server name, must stay valid while the client is in use.
+         * @param port The server port.
+         * @param secure True for HTTPS.
+         */
+        ModemHTTPClient(ModemInterface & modem, const char * server, uint16_t port = HttpClient::kHttpPort, bool secure = false);
+
+        /**
+         * @brief Sets the CA certificate the HTTPS server is verified with.
+         * @param filename The certificate file in the modem file system, e.g. "UFS:cacert.pem" uploaded with +QFUPL.
+         * Must stay valid while the client is in use. nullptr removes it, HTTPS requests then fail unless setInsecure() was called.
+         */
+        void setCACertificate(const char * filename);
+
+        /**
+         * @brief Accepts any HTTPS server without verifying its certificate, if no CA certificate is set.
+         * The connection is encrypted but not authenticated, so only use this for testing.
+         */
+        void setInsecure();
+
+        /**
+         * @brief Starts a request that is completed with endRequest(). Headers can be added in between.
+         */
+        void beginRequest();
+
+        /**
+         * @brief Starts a request.
+         * Unless beginRequest() was called first, or a body is given, the headers are completed and sent right away.
+         * @param url The path of the resource on the server.
+         * @param method HTTP_METHOD_GET or HTTP_METHOD_POST.
+         * @param contentType The value of the Content-Type header, nullptr for none.
+         * @param contentLength The length of the body, -1 if it is not known yet.
+         * @param body The body, nullptr to write it later.
+         * @return HTTP_SUCCESS, HTTP_ERROR_API for other methods or HTTP_ERROR_CONNECTION_FAILED if the modem refused the request.
+         */
+        int startRequest(const char * url, const char * method, const char * contentType = nullptr, int contentLength = -1, const byte body[] = nullptr);
+
+        /**
+         * @brief Completes the headers of a request started with beginRequest(), if that has not happened yet.
+         * @return HTTP_SUCCESS or HTTP_ERROR_CONNECTION_FAILED.
+         */
+        int endRequest();
+
+        /**
+         * @brief Completes the headers, so that the body can be written.
+         */
+        void beginBody();
+
+        int get(const char * url) { return startRequest(url, HTTP_METHOD_GET); }
+        int get(const String & url) { return get(url.c_str()); }
+        int post(const char * url) { return startRequest(url, HTTP_METHOD_POST); }
+        int post(const String & url) { return post(url.c_str()); }
+        int post(const char * url, const char * contentType, const char * body) {
+            return post(url, contentType, strlen(body), reinterpret_cast<const byte *>(body));
+        }
+        int post(const String & url, const String & contentType, const String & body) {
+            return post(url.c_str(), contentType.c_str(), body.length(), reinterpret_cast<const byte *>(body.c_str()));
+        }
+        int post(const char * url, const char * contentType, int contentLength, const byte body[]) {
+            return startRequest(url, HTTP_METHOD_POST, contentType, contentLength, body);
+        }
+
+        /**
+         * @brief Adds a header line to the request.
+         * @param header The complete header, e.g. "Accept: text/plain".
+         */
+        void sendHeader(const char * header);
+
+        /**
+         * @brief Adds a header to the request.
+         * @param name The header name.
+         * @param value The header value.
+         */
+        void sendHeader(const char * name, const char * value);
+
+        /**
+         * @brief Adds a header with a numeric value to the request.
+         * @param name The header name.
+         * @param value The header value.
+         */
+        void sendHeader(const char * name, int value);
+
+        void sendHeader(const String & header) { sendHeader(header.c_str()); }
+        void sendHeader(const String & name, const String & value) { sendHeader(name.c_str(), value.c_str()); }
+
+        /**
+         * @brief Has no effect, the modem opens a connection for each request.
+         */
+        void connectionKeepAlive() {}
+
+        /**
+         * @brief Leaves out the Host and User-Agent headers of the following requests.
+         */
+        void noDefaultRequestHeaders() { defaultHeaders = false; }
+
+        /**
+         * @brief Sets the time the server may take to answer.
+         * @param timeout The timeout (In milliseconds).
+         */
+        void setHttpResponseTimeout(uint32_t timeout) { responseTimeout = timeout; }
+
+        /**
+         * @brief Waits for the response of the request.
+         * @return The HTTP status code, or a negative HTTP_ERROR code.
+         */
+        int responseStatusCode();
+
+        /**
+         * @brief Reads the next response header.
+         * @return True if a header was read, false at the end of the headers or on errors.
+         */
+        bool headerAvailable();
+
+        /**
+         * @brief Gets the name of the header read by headerAvailable().
+         * @return The name, truncated to the header line buffer.
+         */
+        String readHeaderName() { return String(headerLine); }
+
+        /**
+         * @brief Gets the value of the header read by headerAvailable().
+         * @return The value, truncated to the header line buffer.
+         */
+        String readHeaderValue() { return String(headerLine + headerValueOffset); }
+
+        /**
+         * @brief Reads the remaining response headers.
+         * @return HTTP_SUCCESS, or a negative HTTP_ERROR code.
+         */
+        int skipResponseHeaders();
+
+        /**
+         * @brief Checks whether all response headers have been read.
+         * @return True if the body is next.
+         */
+        bool endOfHeadersReached() const { return state == STATE_READING_BODY; }
+
+        /**
+         * @brief Gets the length of the response body, reading the remaining headers first.
+         * @return The value of the Content-Length header, HttpClient::kNoContentLengthHeader if there is none.
+         */
+        int contentLength();
+
+        /**
+         * @brief Checks whether the whole response has been read.
+         * @return True once the modem has ended the response.
+         */
+        bool endOfBodyReached() const;
+
+        /**
+         * @brief Reads the whole response body. Unlike read(), this holds the complete body in memory.
+         * @return The body, empty on errors.
+         */
+        String responseBody();
+
+        int connect(IPAddress ip, uint16_t port) override;
+        int connect(const char * host, uint16_t port) override;
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t * buffer, size_t size) override;
+        int available() override;
+        int read() override;
+        int read(uint8_t * buffer, size_t size) override;
+        int peek() override;
+        void flush() override;
+
+        /**
+         * @brief Ends the current request. The rest of a response that is being read is discarded.
+         * A request whose body is incomplete is not sent: the modem drops it once inputTime has passed since
+         * the headers were written, which this waits for.
+         */
+        void stop() override;
+
+        uint8_t connected() override;
+        operator bool() override { return true; }
+
+    private:
+        enum State {
+            STATE_IDLE, /**< No request. */
+            STATE_COLLECTING_HEADERS, /**< The request headers are being collected. */
+            STATE_SENDING_BODY, /**< The modem reads the request body. */
+            STATE_REQUEST_SENT, /**< The modem has the complete request. */
+            STATE_RESPONSE_RECEIVED, /**< The modem has reported the status of the response. */
+            STATE_READING_HEADERS, /**< The response headers are being read. */
+            STATE_READING_BODY, /**< The response body is being read. */
+            STATE_FAILED /**< The request failed, see failure. */
+        };
+
+        static constexpr size_t trailerLength = 20; /**< Length of the text that ends the +QHTTPREAD output. */
+
+        bool configure();
+        bool applyVerification();
+        bool setURL(const char * path);
+        void appendHeader(const char * text);
+        bool finishHeaders();
+        int awaitResponse();
+        bool startReading();
+        bool prepareBody();
+        int nextByte(bool wait);
+        int takeByte(bool wait);
+        size_t readResponseLine(char * buffer, size_t size);
+        size_t readModemLine(char * buffer, size_t size, unsigned long timeout);
+        int fail(int error);
+
+        ModemInterface & modem;
+        const char * server;
+        uint16_t port;
+        bool secure;
+        const char * caCertificate = nullptr;
+        bool insecure = false; /**< True if setInsecure() waived the verification of the server. */
+        uint32_t responseTimeout = 30000; /**< In milliseconds. */
+        bool configured = false; /**< True once the settings that are the same for all clients have been sent to the modem. */
+        bool defaultHeaders = true;
+        bool requestBegun = false; /**< True between beginRequest() and the request line. */
+
+        State state = STATE_IDLE;
+        int failure = HTTP_ERROR_API; /**< The error of a failed request. */
+        bool postRequest = false;
+        char header[ARDUINO_CELLULAR_HTTP_HEADER_SIZE]; /**< The request line and headers. */
+        size_t headerLength = 0;
+        bool headerOverflow = false;
+        long bodyLength = -1; /**< The announced length of the request body, -1 if unknown. */
+        size_t bodyRemaining = 0; /**< Request body bytes the modem still expects. */
+        unsigned long inputStartedAt = 0; /**< When the modem started to read the request (In milliseconds). */
+
+        int statusCode = 0;
+        long responseLength = HttpClient::kNoContentLengthHeader; /**< The Content-Length of the response. */
+        char headerLine[96]; /**< The name and, after the terminator at headerValueOffset, the value of the last response header. */
+        size_t headerValueOffset = 0;
+        char held[trailerLength]; /**< Received bytes that may be the start of the end of the +QHTTPREAD output. */
+        size_t heldLength = 0;
+        int peeked = -1; /**< A byte returned by peek() and not read yet, -1 if there is none. */
+        bool readComplete = false; /**< True once the modem has ended the +QHTTPREAD output. */
+};
+
+#endif
@@ -4,6 +4,10 @@
 
 #include <ModemInterface.h>
 
+#if defined(ARDUINO_CELLULAR_RECORD_TRANSCRIPT) && !defined(DUMP_AT_COMMANDS)
+    #include <TranscriptRecorder.h>
+#endif
+
 #if defined(ARDUINO_PORTENTA_C33)
     // On the C33 the Serial1 object is already defined, but it does not have hardware flow control
     // mbed allows us to define a UART object with software flow control on given pins 
@@ -17,6 +21,9 @@
     // the init_priority attribute is used to set the priority of the constructor, the lower the number the higher the priority (101 to 65535)
     // for more information see https://gcc.gnu.org/onlinedocs/gcc/C_002b_002b-Attributes.html
     __attribute__ ((init_priority (101))) ModemInterface        modem(debugger, PORTENTA_C33_MODEM_ON_PIN);
+    #elif defined(ARDUINO_CELLULAR_RECORD_TRANSCRIPT)
+    TranscriptRecorder      recorder(Serial1_FC, Serial);
+    __attribute__ ((init_priority (101))) ModemInterface        modem(recorder, PORTENTA_C33_MODEM_ON_PIN);
     #else
     __attribute__ ((init_priority (101))) ModemInterface        modem(Serial1_FC, PORTENTA_C33_MODEM_ON_PIN);
     #endif
@@ -28,8 +35,229 @@
     #ifdef DUMP_AT_COMMANDS
     StreamDebugger          debugger(Serial1, Serial);
     __attribute__ ((init_priority (101))) ModemInterface modem(debugger, PinNameToIndex(PORTENTA_H7_MODEM_ON_PIN));
+    #elif defined(ARDUINO_CELLULAR_RECORD_TRANSCRIPT)
+    TranscriptRecorder      recorder(Serial1, Serial);
+    __attribute__ ((init_priority (101))) ModemInterface modem(recorder, PinNameToIndex(PORTENTA_H7_MODEM_ON_PIN));
     #else
     __attribute__ ((init_priority (101))) ModemInterface modem(Serial1, PinNameToIndex(PORTENTA_H7_MODEM_ON_PIN));
     #endif
 
 #endif
+
+namespace {
+
+// Classifies a complete line, 1 for OK, 2 for ERROR, 3 for +CME ERROR, 4 for +CMS ERROR, 0 for any other line
+int8_t resultCode(const char* line, size_t length) {
+  if (length == 2 && strncmp(line, "OK", 2) == 0) {
+    return 1;
+  }
+  if (length == 5 && strncmp(line, "ERROR", 5) == 0) {
+    return 2;
+  }
+  if (length >= 11 && strncmp(line, "+CME ERROR:", 11) == 0) {
+    return 3;
+  }
+  if (length >= 11 && strncmp(line, "+CMS ERROR:", 11) == 0) {
+    return 4;
+  }
+  return 0;
+}
+
+// Collects a response in a String for collectResponse(), like an ATResponseBuffer without the size limit
+class StringResponse {
+public:
+  explicit StringResponse(String& text) : text(text) {}
+
+  void append(char c) {
+    text += c;
+  }
+
+private:
+  String& text;
+};
+
+// TinyGSM lets only the modem class at the state of its clients. A pointer to a protected member, named
+// through a derived class, is the access C++ grants everyone else.
+struct SocketState : TinyGsmBG96::GsmClientBG96 {
+  static bool TinyGsmBG96::GsmClientBG96::* connectedFlag() { return &SocketState::sock_connected; }
+  static bool TinyGsmBG96::GsmClientBG96::* gotDataFlag() { return &SocketState::got_data; }
+};
+
+template<typename Response>
+void appendLine(Response& response, const char* line, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    response.append(line[i]);
+  }
+}
+
+}
+
+int8_t ModemInterface::waitResponse(uint32_t timeout, ATResponseBuffer& response, const char* expected, const char* command) {
+  return collectLines(timeout, response, expected, command);
+}
+
+int8_t ModemInterface::collectResponse(uint32_t timeout, String& response, const char* command) {
+  StringResponse text(response);
+  return collectLines(timeout, text, nullptr, command);
+}
+
+template<typename Response>
+int8_t ModemInterface::collectLines(uint32_t timeout, Response& response, const char* expected, const char* command) {
+  // A line is held back until it is known not to be a URC. Once it outgrows the buffer it can only be part
+  // of the response, the rest goes there directly and the buffer keeps the beginning for the result codes.
+  char line[URCDispatcher::maxURCLength + 1];
+  size_t lineLength = 0;
+  size_t held = 0;
+  size_t expectedLength = expected != nullptr ? strlen(expected) : 0;
+  if (expectedLength >= sizeof(line)) {
+    expectedLength = 0;
+  }
+  unsigned long start = millis();
+
+  while (millis() - start < timeout) {
+    if (stream->available() <= 0) {
+      yield();
+      continue;
+    }
+
+    char c = static_cast<char>(stream->read());
+
+    if (c == '\n') {
+      size_t textLength = lineLength < sizeof(line) ? lineLength : sizeof(line) - 1;
+      line[textLength] = '\0';
+      if (held == lineLength && strncmp(line, "+QIURC:", 7) == 0) {
+        handleSocketURC(line);
+      } else if (held == lineLength && urcDispatcher != nullptr && urcDispatcher->accepts(line, command)) {
+        urcDispatcher->push(line);
+      } else {
+        appendLine(response, line, held);
+        response.append('\r');
+        response.append(c);
+        int8_t result = resultCode(line, lineLength);
+        if (result != 0) {
+          return result;
+        }
+      }
+      lineLength = 0;
+      held = 0;
+      continue;
+    }
+    if (c == '\r') {
+      continue;
+    }
+
+    if (lineLength < sizeof(line) - 1) {
+      line[lineLength] = c;
+      held++;
+    } else {
+      appendLine(response, line, held);
+      held = 0;
+      response.append(c);
+    }
+    lineLength++;
+
+    if (lineLength == expectedLength && held == lineLength && strncmp(line, expected, expectedLength) == 0) {
+      appendLine(response, line, held);
+      return 1;
+    }
+  }
+  appendLine(response, line, held);
+  return 0;
+}
+
+bool ModemInterface::waitLine(uint32_t timeout, const char* prefix, ATResponseBuffer& response) {
+  // Only the beginning of a line is held, a line that starts with the prefix goes to the response as a whole
+  char line[URCDispatcher::maxURCLength + 1];
+  size_t lineLength = 0;
+  size_t prefixLength = strlen(prefix);
+  bool matched = false;
+  unsigned long start = millis();
+
+  while (millis() - start < timeout) {
+    if (stream->available() <= 0) {
+      yield();
+      continue;
+    }
+
+    char c = static_cast<char>(stream->read());
+
+    if (c == '\n') {
+      if (matched) {
+        return true;
+      }
+      line[lineLength < sizeof(line) ? lineLength : sizeof(line) - 1] = '\0';
+      if (strncmp(line, "+QIURC:", 7) == 0) {
+        handleSocketURC(line);
+      } else {
+        dispatchURC(line);
+      }
+      lineLength = 0;
+      continue;
+    }
+    if (c == '\r') {
+      continue;
+    }
+    if (matched) {
+      response.append(c);
+      continue;
+    }
+
+    if (lineLength < sizeof(line) - 1) {
+      line[lineLength] = c;
+    }
+    lineLength++;
+
+    if (lineLength == prefixLength && strncmp(line, prefix, prefixLength) == 0) {
+      appendLine(response, line, lineLength);
+      matched = true;
+    }
+  }
+  return false;
+}
+
+bool ModemInterface::dispatchURC(const char* line) {
+  if (urcDispatcher == nullptr || !urcDispatcher->accepts(line)) {
+    return false;
+  }
+  urcDispatcher->push(line);
+  return true;
+}
+
+void ModemInterface::handleSocketURC(const char* line) {
+  // +QIURC: "recv",<connectID> or +QIURC: "closed",<connectID>
+  bool received = strncmp(line, "+QIURC: \"recv\",", 15) == 0;
+  bool closed = strncmp(line, "+QIURC: \"closed\",", 17) == 0;
+  if (!received && !closed) {
+    return;
+  }
+  int mux = atoi(line + (received ? 15 : 17));
+  if (mux < 0 || mux >= TINY_GSM_MUX_COUNT || sockets[mux] == nullptr) {
+    return;
+  }
+  if (received) {
+    sockets[mux]->*SocketState::gotDataFlag() = true;
+  } else {
+    sockets[mux]->*SocketState::connectedFlag() = false;
+  }
+}
+
+void ModemInterface::setDataMode(bool active) {
+#if ARDUINO_CELLULAR_COMMAND_STATS
+  monitor.setSuspended(active);
+#endif
+#if defined(ARDUINO_CELLULAR_RECORD_TRANSCRIPT) && !defined(DUMP_AT_COMMANDS) \
+    && (defined(ARDUINO_PORTENTA_C33) || defined(ARDUINO_PORTENTA_H7_M7) || defined(CORE_CM4))
+  recorder.setEnabled(!active);
+#endif
+}
+
+bool ModemInterface::probe(ATResponseBuffer& response, uint8_t attempts, uint32_t timeout) {
+  for (uint8_t attempt = 0; attempt < attempts; attempt++) {
+    response.clear();
+    sendAT(GF(""));
+    if (waitResponse(timeout, response) == 1) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -7,8 +7,16 @@
 #define ARDUINO_4G_MODULE_H
 
 //#define DUMP_AT_COMMANDS
+// Writes a replayable transcript of the modem traffic to Serial, see TranscriptRecorder
+//#define ARDUINO_CELLULAR_RECORD_TRANSCRIPT
 
+#ifndef TINY_GSM_RX_BUFFER
+/**
+ * Size of the receive buffer of each TinyGSM socket client (In bytes). Define it as build flag to trade
+ * RAM for throughput, it has to be the same for the library and the sketch.
+ */
 #define TINY_GSM_RX_BUFFER 1024
+#endif
 #define TINY_GSM_MODEM_BG96
 
 #if defined(ARDUINO_PORTENTA_H7_M7) || defined(CORE_CM4)
@@ -20,10 +28,22 @@
 #endif
 
 
+#ifndef ARDUINO_CELLULAR_COMMAND_STATS
+/**
+ * Set to 0 to remove the ATCommandMonitor that collects per command statistics from the modem traffic.
+ */
+#define ARDUINO_CELLULAR_COMMAND_STATS 1
+#endif
+
 #include <Arduino.h>
 #include <StreamDebugger.h>
 #include <TinyGsmClient.h>
 #include <ArduinoHttpClient.h>
+#include <ATResponseBuffer.h>
+#include <URCDispatcher.h>
+#if ARDUINO_CELLULAR_COMMAND_STATS
+#include <ATCommandMonitor.h>
+#endif
 
 /**
  * @class ModemInterface
@@ -35,10 +55,20 @@ public:
    * @brief Constructor for the ModemInterface class.
    * @param stream The stream object for communication with the modem.
    * @param powerPin The pin number for controlling the power of the modem.
+   * Use -1 if the stream is not a hardware UART (e.g. a TranscriptPlayer) and the modem needs no power sequence.
    */
+#if ARDUINO_CELLULAR_COMMAND_STATS
+  // TinyGSM only keeps the reference to the monitor, which is constructed right after it
+  explicit ModemInterface(Stream& stream, int powerPin) : TinyGsmBG96(monitor),monitor(stream),stream(&monitor),powerPin(powerPin) {
+    
+  };
+#else
   explicit ModemInterface(Stream& stream, int powerPin) : TinyGsmBG96(stream),stream(&stream),powerPin(powerPin) {
     
   };
+#endif
+
+  static constexpr unsigned long powerOnDelay = 1000; /**< Time the modem needs after the power pin went high before it answers (In milliseconds). */
 
   /**
    * @brief Initializes the modem interface. (Overrides the init method in TinyGsmBG96)
@@ -46,27 +76,184 @@ public:
    * @return True if initialization is successful, false otherwise.
    */
   bool init(const char* pin = NULL) {
-    // Power on the modem
-    pinMode(powerPin, OUTPUT);
-    digitalWrite(powerPin, HIGH);
-    delay(1000);
+    powerOn();
+    return TinyGsmBG96::init();
+  };
+
+  /**
+   * @brief Drives the power pin of the modem high and opens the UART. Does nothing if there is no power pin.
+   * Only the first call switches the modem on, later calls only wait for the rest of the boot time if settle is set.
+   * @param settle True to wait until the modem had powerOnDelay milliseconds to boot,
+   * false to return right away, e.g. to probe whether the modem was already on.
+   */
+  void powerOn(bool settle = true) {
+    if (powerPin < 0) {
+      return;
+    }
 
-    #ifdef DUMP_AT_COMMANDS
-      #if defined(ARDUINO_PORTENTA_C33)
-        // On the C33 we have defined a UART object with software flow control on given pins in the .cpp file, we'll use extern to access and begin communication
+    if (!powered) {
+      // Power on the modem
+      pinMode(powerPin, OUTPUT);
+      digitalWrite(powerPin, HIGH);
+      poweredAt = millis();
+      powered = true;
 
-        extern UART Serial1_FC;
-        Serial1_FC.begin(115200);
+      #if defined(DUMP_AT_COMMANDS) || defined(ARDUINO_CELLULAR_RECORD_TRANSCRIPT)
+        #if defined(ARDUINO_PORTENTA_C33)
+          // On the C33 we have defined a UART object with software flow control on given pins in the .cpp file, we'll use extern to access and begin communication
+
+          extern UART Serial1_FC;
+          Serial1_FC.begin(115200);
+        #endif
+      #else
+      ((arduino::HardwareSerial*)&getSerialStream())->begin(115200);
       #endif
+    }
+
+    unsigned long elapsed = millis() - poweredAt;
+    if (settle && elapsed < powerOnDelay) {
+      delay(powerOnDelay - elapsed);
+    }
+  }
+
+  /**
+   * @brief Sets the pin driving the DTR line of the modem and drives it low, which keeps the modem awake.
+   * @param pin The pin, -1 if DTR is not connected.
+   */
+  void setDTRPin(int pin) {
+    dtrPin = pin;
+    setDTR(false);
+  }
+
+  /**
+   * @brief Drives the DTR line. Once sleep is enabled with +QSCLK=1, the modem sleeps while DTR is high
+   * and wakes up when it goes low.
+   * @param high True to let the modem sleep, false to wake it up.
+   * @return False if no DTR pin is set.
+   */
+  bool setDTR(bool high) {
+    if (dtrPin < 0) {
+      return false;
+    }
+    pinMode(dtrPin, OUTPUT);
+    digitalWrite(dtrPin, high ? HIGH : LOW);
+    return true;
+  }
+
+  /**
+   * @brief Checks whether the modem answers, without waiting for it to boot.
+   * @param response The buffer for the answer to the last attempt. It starts with the echo of the command
+   * if the modem echoes commands, which it does after a restart until it receives ATE0.
+   * @param attempts The number of times the command is sent.
+   * @param timeout The time to wait for the answer of each attempt (In milliseconds).
+   * @return True if the modem answered OK.
+   */
+  bool probe(ATResponseBuffer& response, uint8_t attempts = 3, uint32_t timeout = 100);
+
+  using TinyGsmBG96::waitResponse;
+
+  /**
+   * @brief Waits for the final result code of a command and collects the response without allocating memory.
+   * Unlike the TinyGSM variants, which build a String per call, this reads the stream directly.
+   * The response, including the final result code line, is written to the buffer, which is not cleared first.
+   * URCs received meanwhile are left out: lines with a handler go to the URC dispatcher, and +QIURC socket
+   * notifications update the TinyGSM clients like its own waitResponse() does.
+   * @param timeout The timeout (In milliseconds).
+   * @param response The buffer for the response.
+   * @param expected An additional line that ends the wait as success, e.g. ">" or "CONNECT" (optional).
+   * It matches as soon as it was received, without waiting for the end of the line, and can have up to 95 characters.
+   * @param command The command without "AT", e.g. "+CPMS?", so that its response lines are not taken for URCs (optional).
+   * @return 1 for OK or the expected line, 2 for ERROR, 3 for +CME ERROR, 4 for +CMS ERROR, 0 on timeout.
+   */
+  int8_t waitResponse(uint32_t timeout, ATResponseBuffer& response, const char* expected = nullptr, const char* command = nullptr);
+
+  /**
+   * @brief Waits for the final result code of a command and discards the response, without allocating memory.
+   * @param timeout The timeout (In milliseconds).
+   * @param expected An additional line that ends the wait as success, see waitResponse() (optional).
+   * @return 1 for OK or the expected line, 2 for ERROR, 3 for +CME ERROR, 4 for +CMS ERROR, 0 on timeout.
+   */
+  int8_t waitResult(uint32_t timeout = 1000, const char* expected = nullptr) {
+    ATResponseBuffer discarded;
+    return waitResponse(timeout, discarded, expected);
+  }
+
+  /**
+   * @brief Waits for the final result code of a command and collects the response in a String.
+   * URCs received meanwhile are left out like in waitResponse(). This replaces the TinyGSM variant taking a
+   * String, which keeps the URCs in the response and hands them to no one.
+   * @param timeout The timeout (In milliseconds).
+   * @param response The String the response is appended to, including the final result code line.
+   * @param command The command without "AT", so that its response lines are not taken for URCs (optional).
+   * @return 1 for OK, 2 for ERROR, 3 for +CME ERROR, 4 for +CMS ERROR, 0 on timeout.
+   */
+  int8_t collectResponse(uint32_t timeout, String& response, const char* command = nullptr);
+
+  /**
+   * @brief Waits for a line that arrives after the final result code, e.g. the +QNTP: or +CUSD: answer
+   * of a command that completes in the background. Other lines meanwhile are treated as URCs.
+   * @param timeout The timeout (In milliseconds).
+   * @param prefix The beginning of the line, e.g. "+CUSD:". It can have up to 95 characters.
+   * @param response The buffer the line is appended to, without its line ending.
+   * @return True once the line was received, false on timeout.
+   */
+  bool waitLine(uint32_t timeout, const char* prefix, ATResponseBuffer& response);
+
+  /**
+   * @brief Passes a line read outside waitResponse() to the URC dispatcher.
+   * @param line The complete line without its line ending.
+   * @return True if the dispatcher took the line, false if no handler accepts it.
+   */
+  bool dispatchURC(const char* line);
+
+  /**
+   * @brief Passes a +QIURC socket notification read outside waitResponse() to the TinyGSM client of its socket,
+   * which learns that data arrived or that the remote end closed the connection.
+   * @param line The complete line without its line ending, e.g. +QIURC: "closed",1.
+   */
+  void handleSocketURC(const char* line);
+
+  /**
+   * @brief Marks the time the UART carries the payload of a transparent socket instead of AT commands.
+   * The command statistics and the transcript of ARDUINO_CELLULAR_RECORD_TRANSCRIPT leave the payload out.
+   * @param active True once the modem switched to data mode, false once it is back in command mode.
+   */
+  void setDataMode(bool active);
+
+  /**
+   * @brief Sets the dispatcher that receives the URCs arriving while waitResponse() waits.
+   * @param dispatcher The dispatcher, nullptr to keep the URCs in the response.
+   */
+  void setURCDispatcher(URCDispatcher* dispatcher) {
+    urcDispatcher = dispatcher;
+  }
+
+  /**
+   * @brief Gets the stream passed to the constructor, e.g. the modem UART.
+   * @return The stream.
+   */
+  Stream& getSerialStream() {
+    #if ARDUINO_CELLULAR_COMMAND_STATS
+      return monitor.getStream();
     #else
-    ((arduino::HardwareSerial*)stream)->begin(115200);
+      return *stream;
     #endif
-    return TinyGsmBG96::init();
-  };
+  }
+
+private:
+  template<typename Response>
+  int8_t collectLines(uint32_t timeout, Response& response, const char* expected, const char* command);
 
 public:
+  #if ARDUINO_CELLULAR_COMMAND_STATS
+  ATCommandMonitor monitor; /**< Collects statistics from the traffic with the modem. */
+  #endif
   Stream* stream; /**< The stream object for communication with the modem. */
   int powerPin; /**< The pin number for controlling the power of the modem. */
+  int dtrPin = -1; /**< The pin number driving the DTR line of the modem, -1 if it is not connected. */
+  bool powered = false; /**< True once powerOn() has driven the power pin high. */
+  unsigned long poweredAt = 0; /**< When the power pin was driven high (In milliseconds). */
+  URCDispatcher* urcDispatcher = nullptr; /**< Receives the URCs arriving during waitResponse(), nullptr if none. */
 };
 
 /**
@@ -0,0 +1,160 @@
+/**
+ * @file ModemProfile.h
+ * @brief Compile-time descriptions of the supported modems.
+ */
+
+#ifndef ARDUINO_CELLULAR_MODEM_PROFILE_H
+#define ARDUINO_CELLULAR_MODEM_PROFILE_H
+
+#include <Arduino.h>
+
+#define ARDUINO_CELLULAR_PROFILE_AUTO 0 /**< The modem is detected in begin(), the code for all modems is included. */
+#define ARDUINO_CELLULAR_PROFILE_EC200A 1 /**< Quectel EC200A-EU, as on the TPX00201 module. */
+#define ARDUINO_CELLULAR_PROFILE_EG25 2 /**< Quectel EG25-G, as on the TPX00200 module. */
+#define ARDUINO_CELLULAR_PROFILE_BG96 3 /**< Quectel BG96 and compatible modems. */
+
+#ifndef ARDUINO_CELLULAR_PROFILE
+/**
+ * The modem the library is built for. A fixed profile skips the detection in begin() and leaves out the code
+ * of features the modem does not have. Define it as build flag, so that the library and the sketch agree on it.
+ */
+#define ARDUINO_CELLULAR_PROFILE ARDUINO_CELLULAR_PROFILE_AUTO
+#endif
+
+#ifndef ARDUINO_CELLULAR_GNSS
+/**
+ * Set to 0 to remove the GNSS functions. Defaults to 0 for profiles of modems without GNSS receiver.
+ */
+#if ARDUINO_CELLULAR_PROFILE == ARDUINO_CELLULAR_PROFILE_EC200A
+#define ARDUINO_CELLULAR_GNSS 0
+#else
+#define ARDUINO_CELLULAR_GNSS 1
+#endif
+#endif
+
+#ifndef ARDUINO_CELLULAR_SMS
+/**
+ * Set to 0 to remove the SMS functions, e.g. for data-only SIM cards.
+ */
+#define ARDUINO_CELLULAR_SMS 1
+#endif
+
+/**
+ * @enum ModemModel
+ * @brief Represents the model of the modem.
+*/
+enum ModemModel {
+    EC200, /**< Quectel EC200 modem. */
+    EG25,  /**< Quectel EG25 modem. */
+    BG96, /**< Quectel BG96 modem. */
+    Unsupported /**< Unsupported modem model. */
+};
+
+/**
+ * @struct EC200AProfile
+ * @brief The Quectel EC200A-EU, which has no GNSS receiver.
+ */
+struct EC200AProfile {
+    static constexpr ModemModel model = EC200; /**< The model. */
+    static constexpr bool detect = false; /**< True if the model is only known after begin(). */
+    static constexpr bool hasGNSS = false; /**< True if the modem has a GNSS receiver. */
+    static constexpr size_t locationResponseSize = 0; /**< Size of the buffer for a +QGPSLOC=2 response (In bytes). */
+
+    /**
+     * @brief Gets the text identifying the modem in the ATI response.
+     * @return The text.
+     */
+    static constexpr const char * identifier() { return "EC200A"; }
+
+    /**
+     * @brief Gets the +QGPSCFG setting selecting assisted or standalone positioning.
+     * @param assisted True for assisted positioning.
+     * @return The setting, nullptr if the modem has no such setting.
+     */
+    static constexpr const char * gnssPositioningMode(bool assisted) { return nullptr; }
+};
+
+/**
+ * @struct EG25Profile
+ * @brief The Quectel EG25-G, with GNSS receiver and gpsOneXTRA support.
+ */
+struct EG25Profile {
+    static constexpr ModemModel model = EG25; /**< The model. */
+    static constexpr bool detect = false; /**< True if the model is only known after begin(). */
+    static constexpr bool hasGNSS = true; /**< True if the modem has a GNSS receiver. */
+    static constexpr size_t locationResponseSize = 160; /**< Size of the buffer for a +QGPSLOC=2 response (In bytes). */
+
+    /**
+     * @brief Gets the text identifying the modem in the ATI response.
+     * @return The text.
+     */
+    static constexpr const char * identifier() { return "EG25"; }
+
+    /**
+     * @brief Gets the +QGPSCFG setting selecting assisted or standalone positioning.
+     * Standalone sets the 23rd bit of the positioning mode.
+     * @param assisted True for assisted positioning.
+     * @return The setting, nullptr if the modem has no such setting.
+     */
+    static constexpr const char * gnssPositioningMode(bool assisted) {
+        return assisted ? "+QGPSCFG=\"agpsposmode\",33488767" : "+QGPSCFG=\"agpsposmode\",8388608";
+    }
+};
+
+/**
+ * @struct BG96Profile
+ * @brief The Quectel BG96, the modem the TinyGSM driver is written for. Its receiver has no positioning mode setting.
+ */
+struct BG96Profile {
+    static constexpr ModemModel model = BG96; /**< The model. */
+    static constexpr bool detect = false; /**< True if the model is only known after begin(). */
+    static constexpr bool hasGNSS = true; /**< True if the modem has a GNSS receiver. */
+    static constexpr size_t locationResponseSize = 160; /**< Size of the buffer for a +QGPSLOC=2 response (In bytes). */
+
+    /**
+     * @brief Gets the text identifying the modem in the ATI response.
+     * @return The text.
+     */
+    static constexpr const char * identifier() { return "BG96"; }
+
+    /**
+     * @brief Gets the +QGPSCFG setting selecting assisted or standalone positioning.
+     * @param assisted True for assisted positioning.
+     * @return The setting, nullptr if the modem has no such setting.
+     */
+    static constexpr const char * gnssPositioningMode(bool assisted) { return nullptr; }
+};
+
+/**
+ * @struct AutoProfile
+ * @brief Any of the supported modems, detected in begin() by the identifiers of the other profiles.
+ * GNSS functions check the detected model at runtime.
+ */
+struct AutoProfile {
+    static constexpr ModemModel model = Unsupported; /**< The model, before detection. */
+    static constexpr bool detect = true; /**< True if the model is only known after begin(). */
+    static constexpr bool hasGNSS = true; /**< True if the modem may have a GNSS receiver. */
+    static constexpr size_t locationResponseSize = 160; /**< Size of the buffer for a +QGPSLOC=2 response (In bytes). */
+
+    /**
+     * @brief Gets the +QGPSCFG setting selecting assisted or standalone positioning of the EG25.
+     * A detected BG96 has no such setting, see BG96Profile.
+     * @param assisted True for assisted positioning.
+     * @return The setting.
+     */
+    static constexpr const char * gnssPositioningMode(bool assisted) { return EG25Profile::gnssPositioningMode(assisted); }
+};
+
+#if ARDUINO_CELLULAR_PROFILE == ARDUINO_CELLULAR_PROFILE_EC200A
+typedef EC200AProfile ModemProfile; /**< The profile selected with ARDUINO_CELLULAR_PROFILE. */
+#elif ARDUINO_CELLULAR_PROFILE == ARDUINO_CELLULAR_PROFILE_EG25
+typedef EG25Profile ModemProfile; /**< The profile selected with ARDUINO_CELLULAR_PROFILE. */
+#elif ARDUINO_CELLULAR_PROFILE == ARDUINO_CELLULAR_PROFILE_BG96
+typedef BG96Profile ModemProfile; /**< The profile selected with ARDUINO_CELLULAR_PROFILE. */
+#else
+typedef AutoProfile ModemProfile; /**< The profile selected with ARDUINO_CELLULAR_PROFILE. */
+#endif
+
+static_assert(!ARDUINO_CELLULAR_GNSS || ModemProfile::hasGNSS, "The selected modem has no GNSS receiver, set ARDUINO_CELLULAR_GNSS to 0");
+
+#endif
@@ -0,0 +1,245 @@
+#include "NMEAParser.h"
+
+#include <atomic>
+
+namespace {
+
+// Parses a decimal number into an integer scaled by 10^decimals, further decimals are truncated
+int64_t parseFixed(const char * text, int decimals) {
+    bool negative = *text == '-';
+    if (negative) {
+        text++;
+    }
+    int64_t value = 0;
+    int fraction = -1;
+    for (; *text != '\0'; text++) {
+        if (*text == '.') {
+            fraction = 0;
+        } else if (*text >= '0' && *text <= '9') {
+            if (fraction >= decimals) {
+                continue;
+            }
+            value = value * 10 + (*text - '0');
+            if (fraction >= 0) {
+                fraction++;
+            }
+        } else {
+            break;
+        }
+    }
+    for (int i = fraction < 0 ? 0 : fraction; i < decimals; i++) {
+        value *= 10;
+    }
+    return negative ? -value : value;
+}
+
+// Converts "ddmm.mmmmm" or "dddmm.mmmmm" and its hemisphere to 1e-7 degrees
+int32_t parseCoordinate(const char * value, const char * hemisphere) {
+    int64_t minutes = parseFixed(value, 5);
+    int64_t degrees = minutes / 10000000;
+    int64_t coordinate = degrees * 10000000 + (minutes % 10000000) * 100 / 60;
+    return static_cast<int32_t>((*hemisphere == 'S' || *hemisphere == 'W') ? -coordinate : coordinate);
+}
+
+int twoDigits(const char * text) {
+    return (text[0] - '0') * 10 + (text[1] - '0');
+}
+
+bool isType(const char * field, const char * type) {
+    // The first two characters are the talker
+    return strlen(field) == 5 && strcmp(field + 2, type) == 0;
+}
+
+}
+
+NMEAParser::NMEAParser(GNSSFixCallback callback, void * context) : callback(callback), context(context) {
+}
+
+void NMEAParser::setCallback(GNSSFixCallback callback, void * context) {
+    this->callback = callback;
+    this->context = context;
+}
+
+void NMEAParser::reset() {
+    length = 0;
+    inSentence = false;
+    pending = GNSSFix();
+}
+
+void NMEAParser::feed(char c) {
+    if (c == '$') {
+        inSentence = true;
+        length = 0;
+        return;
+    }
+    if (!inSentence) {
+        return;
+    }
+    if (c == '\r' || c == '\n') {
+        inSentence = false;
+        sentence[length] = '\0';
+        endSentence();
+        return;
+    }
+    if (length >= maxSentenceLength) {
+        inSentence = false;
+        return;
+    }
+    sentence[length++] = c;
+}
+
+void NMEAParser::endSentence() {
+    // <fields>*<two hexadecimal digits of the XOR of all characters between '$' and '*'>
+    char * star = strrchr(sentence, '*');
+    if (star == nullptr || strlen(star) < 3) {
+        checksumErrors++;
+        return;
+    }
+    uint8_t checksum = 0;
+    for (char * c = sentence; c < star; c++) {
+        checksum ^= static_cast<uint8_t>(*c);
+    }
+    if (strtoul(star + 1, nullptr, 16) != checksum) {
+        checksumErrors++;
+        return;
+    }
+    *star = '\0';
+
+    char * fields[maxFields];
+    size_t count = 0;
+    fields[count++] = sentence;
+    for (char * c = sentence; *c != '\0' && count < maxFields; c++) {
+        if (*c == ',') {
+            *c = '\0';
+            fields[count++] = c + 1;
+        }
+    }
+
+    if (isType(fields[0], "RMC")) {
+        parseRMC(fields, count);
+    } else if (isType(fields[0], "GSA")) {
+        parseGSA(fields, count);
+    } else if (isType(fields[0], "GGA")) {
+        parseGGA(fields, count);
+    }
+}
+
+void NMEAParser::parseRMC(char ** fields, size_t count) {
+    // $xxRMC,<time>,<status>,<lat>,<N/S>,<lon>,<E/W>,<speed in knots>,<course>,<ddmmyy>,...
+    if (count < 10) {
+        return;
+    }
+    if (strlen(fields[9]) >= 6) {
+        day = twoDigits(fields[9]);
+        month = twoDigits(fields[9] + 2);
+        year = 2000 + twoDigits(fields[9] + 4);
+    }
+    // One knot is 51.4444 cm/s
+    pending.speed = static_cast<uint32_t>(parseFixed(fields[7], 3) * 514444 / 10000000);
+    pending.course = static_cast<uint16_t>(parseFixed(fields[8], 2));
+}
+
+void NMEAParser::parseGSA(char ** fields, size_t count) {
+    // $xxGSA,<mode>,<fix type: 1 none, 2 2D, 3 3D>,<12 satellite ids>,<PDOP>,<HDOP>,<VDOP>
+    if (count < 3) {
+        return;
+    }
+    int type = atoi(fields[2]);
+    pending.dimension = type >= 2 ? type : 0;
+}
+
+void NMEAParser::parseGGA(char ** fields, size_t count) {
+    // $xxGGA,<hhmmss.ss>,<lat>,<N/S>,<lon>,<E/W>,<quality>,<satellites>,<HDOP>,<altitude>,M,...
+    if (count < 10) {
+        return;
+    }
+    pending.valid = atoi(fields[6]) > 0 && fields[2][0] != '\0' && fields[4][0] != '\0';
+    if (pending.valid) {
+        pending.latitude = parseCoordinate(fields[2], fields[3]);
+        pending.longitude = parseCoordinate(fields[4], fields[5]);
+        pending.altitude = static_cast<int32_t>(parseFixed(fields[9], 2));
+    }
+    pending.satellites = static_cast<uint8_t>(atoi(fields[7]));
+    pending.hdop = static_cast<uint16_t>(parseFixed(fields[8], 2));
+
+    const char * time = fields[1];
+    if (strlen(time) >= 6) {
+        pending.time = Time(year, month, day, twoDigits(time), twoDigits(time + 2), twoDigits(time + 4));
+    }
+    publish();
+}
+
+void NMEAParser::publish() {
+    pending.acquiredAt = millis();
+
+    sequence = sequence + 1;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    latest = pending;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    sequence = sequence + 1;
+    fixCount++;
+
+    if (callback != nullptr) {
+        callback(latest, context);
+    }
+}
+
+bool NMEAParser::getLatestFix(GNSSFix & fix) const {
+    uint32_t before;
+    do {
+        before = sequence;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        fix = latest;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    } while ((before & 1) != 0 || before != sequence);
+    return before != 0;
+}
+
+bool NMEAParser::parseLocationResponse(const char * response, GNSSFix & fix) {
+    fix = GNSSFix();
+    fix.acquiredAt = millis();
+    const char * line = strstr(response, "+QGPSLOC:");
+    if (line == nullptr) {
+        return false;
+    }
+    line += 9;
+    while (*line == ' ') {
+        line++;
+    }
+
+    // Splits a copy of the line, the numbers are terminated by the commas
+    char fields[11][16];
+    size_t count = 0;
+    while (count < 11) {
+        size_t length = strcspn(line, ",\r\n");
+        size_t copied = length < sizeof(fields[0]) - 1 ? length : sizeof(fields[0]) - 1;
+        memcpy(fields[count], line, copied);
+        fields[count][copied] = '\0';
+        count++;
+        if (line[length] != ',') {
+            break;
+        }
+        line += length + 1;
+    }
+    if (count < 11 || strlen(fields[0]) < 6 || strlen(fields[9]) < 6) {
+        return false;
+    }
+
+    // Mode 2 reports the coordinates in degrees with five decimals
+    fix.latitude = static_cast<int32_t>(parseFixed(fields[1], 7));
+    fix.longitude = static_cast<int32_t>(parseFixed(fields[2], 7));
+    fix.hdop = static_cast<uint16_t>(parseFixed(fields[3], 2));
+    fix.altitude = static_cast<int32_t>(parseFixed(fields[4], 2));
+    int dimension = atoi(fields[5]);
+    fix.dimension = dimension >= 2 ? dimension : 0;
+    // The course is given as degrees and minutes
+    int64_t course = parseFixed(fields[6], 2);
+    fix.course = static_cast<uint16_t>(course / 100 * 100 + course % 100 * 100 / 60);
+    // Tenths of km/h to cm/s
+    fix.speed = static_cast<uint32_t>(parseFixed(fields[7], 1) * 25 / 9);
+    fix.satellites = static_cast<uint8_t>(atoi(fields[10]));
+    fix.time = Time(2000 + twoDigits(fields[9] + 4), twoDigits(fields[9] + 2), twoDigits(fields[9]),
+                    twoDigits(fields[0]), twoDigits(fields[0] + 2), twoDigits(fields[0] + 4));
+    fix.valid = true;
+    return true;
+}
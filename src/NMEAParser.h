@@ -0,0 +1,107 @@
+/**
+ * @file NMEAParser.h
+ * @brief Header file for the NMEAParser class.
+ */
+
+#ifndef ARDUINO_CELLULAR_NMEA_PARSER_H
+#define ARDUINO_CELLULAR_NMEA_PARSER_H
+
+#include <Arduino.h>
+#include <GNSSFix.h>
+
+/**
+ * @class NMEAParser
+ * @brief Incremental, allocation-free parser of NMEA 0183 GGA, RMC and GSA sentences.
+ *
+ * The parser consumes characters one at a time, from any source: +QGPSGNMEA responses, a UART the
+ * receiver writes to, or a log. Text outside of sentences is ignored and sentences with a wrong checksum
+ * are dropped. A fix is published with every GGA sentence, completed with the speed, course and date of the
+ * latest RMC sentence and the dimension of the latest GSA sentence. Sentences of any talker (GP, GN, GL, ...) are accepted.
+ *
+ * The latest fix is kept in a slot protected by a sequence counter, so that it can be read consistently
+ * without locks even if the parser is fed from an interrupt.
+ */
+class NMEAParser {
+    public:
+        static constexpr size_t maxSentenceLength = 96; /**< Longest accepted sentence, NMEA allows 82 characters. */
+        static constexpr size_t maxFields = 24; /**< Maximum number of fields of a sentence. */
+
+        /**
+         * @brief Creates a parser.
+         * @param callback The function called for every published fix, may be nullptr.
+         * @param context A user pointer passed to the callback.
+         */
+        NMEAParser(GNSSFixCallback callback = nullptr, void * context = nullptr);
+
+        /**
+         * @brief Sets the function called for every published fix.
+         * @param callback The function, may be nullptr.
+         * @param context A user pointer passed to the callback.
+         */
+        void setCallback(GNSSFixCallback callback, void * context = nullptr);
+
+        /**
+         * @brief Consumes one character.
+         * @param c The character.
+         */
+        void feed(char c);
+
+        /**
+         * @brief Drops the sentence being received and the data collected for the next fix.
+         */
+        void reset();
+
+        /**
+         * @brief Copies the latest published fix.
+         * @param fix Receives the fix.
+         * @return True if a fix has been published.
+         */
+        bool getLatestFix(GNSSFix & fix) const;
+
+        /**
+         * @brief Parses the response of a +QGPSLOC=2 query, which holds a complete fix in one line:
+         * +QGPSLOC: <hhmmss.sss>,<latitude>,<longitude>,<HDOP>,<altitude>,<fix>,<ddd.mm course>,<km/h>,<knots>,<ddmmyy>,<satellites>
+         * @param response The response, may contain other lines.
+         * @param fix Receives the fix. Its valid flag is cleared if the response holds no fix, e.g. +CME ERROR: 516.
+         * @return True if the response held a fix.
+         */
+        static bool parseLocationResponse(const char * response, GNSSFix & fix);
+
+        /**
+         * @brief Gets the number of published fixes.
+         * @return The number of fixes, valid or not.
+         */
+        uint32_t getFixCount() const { return fixCount; }
+
+        /**
+         * @brief Gets the number of sentences dropped because of a wrong or missing checksum.
+         * @return The number of dropped sentences.
+         */
+        uint32_t getChecksumErrorCount() const { return checksumErrors; }
+
+    private:
+        void endSentence();
+        void parseGGA(char ** fields, size_t count);
+        void parseRMC(char ** fields, size_t count);
+        void parseGSA(char ** fields, size_t count);
+        void publish();
+
+        GNSSFixCallback callback;
+        void * context;
+
+        char sentence[maxSentenceLength + 1];
+        size_t length = 0;
+        bool inSentence = false;
+
+        GNSSFix pending; /**< The fix being assembled from the sentences of the current epoch. */
+        uint8_t day = 1; /**< The date of the latest RMC sentence. */
+        uint8_t month = 1;
+        uint16_t year = 1970;
+
+        GNSSFix latest;
+        volatile uint32_t sequence = 0; /**< Odd while the latest fix is being written. */
+        uint32_t fixCount = 0;
+        uint32_t checksumErrors = 0;
+};
+
+#endif
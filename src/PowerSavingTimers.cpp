@@ -0,0 +1,68 @@
+#include "PowerSavingTimers.h"
+
+namespace {
+
+// The value of the upper 3 bits of a timer and the length of one step of the multiplier
+struct TimerUnit {
+    uint8_t code;
+    unsigned long seconds;
+};
+
+// Sorted by step length, so that the first unit that fits gives the finest resolution
+const TimerUnit periodicTAUUnits[] = {
+    { 0x3, 2 }, { 0x4, 30 }, { 0x5, 60 }, { 0x0, 600 }, { 0x1, 3600 }, { 0x2, 36000 }, { 0x6, 1152000 }
+};
+
+const TimerUnit activeTimeUnits[] = {
+    { 0x0, 2 }, { 0x1, 60 }, { 0x2, 360 }
+};
+
+const unsigned long eDRXCycles[] = {
+    5120, 10240, 20480, 40960, 61440, 81920, 102400, 122880,
+    143360, 163840, 327680, 655360, 1310720, 2621440, 5242880, 10485760
+};
+
+constexpr unsigned long maxMultiplier = 31;
+
+void writeBits(uint8_t value, size_t count, char * bits) {
+    for (size_t i = 0; i < count; i++) {
+        bits[i] = (value >> (count - 1 - i)) & 1 ? '1' : '0';
+    }
+    bits[count] = '\0';
+}
+
+template <size_t N>
+unsigned long encodeTimer(unsigned long seconds, const TimerUnit (&units)[N], char * bits) {
+    for (size_t i = 0; i < N; i++) {
+        unsigned long multiplier = seconds / units[i].seconds + (seconds % units[i].seconds != 0 ? 1 : 0);
+        if (multiplier <= maxMultiplier) {
+            writeBits(static_cast<uint8_t>(units[i].code << 5 | multiplier), PowerSavingTimers::timerLength, bits);
+            return multiplier * units[i].seconds;
+        }
+    }
+
+    // Longer than the timer can express
+    const TimerUnit & longest = units[N - 1];
+    writeBits(static_cast<uint8_t>(longest.code << 5 | maxMultiplier), PowerSavingTimers::timerLength, bits);
+    return maxMultiplier * longest.seconds;
+}
+
+}
+
+unsigned long PowerSavingTimers::encodePeriodicTAU(unsigned long seconds, char * bits) {
+    return encodeTimer(seconds, periodicTAUUnits, bits);
+}
+
+unsigned long PowerSavingTimers::encodeActiveTime(unsigned long seconds, char * bits) {
+    return encodeTimer(seconds, activeTimeUnits, bits);
+}
+
+unsigned long PowerSavingTimers::encodeEDRXCycle(unsigned long milliseconds, char * bits) {
+    const size_t count = sizeof(eDRXCycles) / sizeof(eDRXCycles[0]);
+    size_t index = 0;
+    while (index < count - 1 && eDRXCycles[index] < milliseconds) {
+        index++;
+    }
+    writeBits(static_cast<uint8_t>(index), cycleLength, bits);
+    return eDRXCycles[index];
+}
@@ -0,0 +1,50 @@
+/**
+ * @file PowerSavingTimers.h
+ * @brief Header file for the PowerSavingTimers class.
+ */
+
+#ifndef ARDUINO_CELLULAR_POWER_SAVING_TIMERS_H
+#define ARDUINO_CELLULAR_POWER_SAVING_TIMERS_H
+
+#include <Arduino.h>
+
+/**
+ * @class PowerSavingTimers
+ * @brief Encodes durations into the bit strings that +CPSMS and +CEDRXS expect (3GPP TS 24.008).
+ *
+ * A PSM timer is one octet written as 8 binary digits: the upper 3 bits select a unit and the lower
+ * 5 bits are a multiplier from 0 to 31. An eDRX cycle is one of 16 fixed values written as 4 binary digits.
+ * Durations that cannot be represented exactly are rounded up to the next representable one, and the
+ * encoders return the duration that is actually requested from the network.
+ */
+class PowerSavingTimers {
+    public:
+        static constexpr size_t timerLength = 8; /**< Number of binary digits of a PSM timer, without the terminator. */
+        static constexpr size_t cycleLength = 4; /**< Number of binary digits of an eDRX cycle, without the terminator. */
+
+        /**
+         * @brief Encodes the periodic tracking area update timer (T3412 extended).
+         * @param seconds The requested period, at most 31 * 320 hours.
+         * @param bits The buffer for the result, at least timerLength + 1 characters.
+         * @return The encoded period (In seconds).
+         */
+        static unsigned long encodePeriodicTAU(unsigned long seconds, char * bits);
+
+        /**
+         * @brief Encodes the active time after which the modem enters PSM (T3324).
+         * @param seconds The requested time, at most 31 * 6 minutes.
+         * @param bits The buffer for the result, at least timerLength + 1 characters.
+         * @return The encoded time (In seconds).
+         */
+        static unsigned long encodeActiveTime(unsigned long seconds, char * bits);
+
+        /**
+         * @brief Encodes an eDRX cycle length for LTE (WB-S1 mode).
+         * @param milliseconds The requested cycle length, from 5.12 to 10485.76 seconds.
+         * @param bits The buffer for the result, at least cycleLength + 1 characters.
+         * @return The encoded cycle length (In milliseconds).
+         */
+        static unsigned long encodeEDRXCycle(unsigned long milliseconds, char * bits);
+};
+
+#endif
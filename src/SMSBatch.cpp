@@ -0,0 +1,116 @@
+#include "SMSBatch.h"
+#include <new>
+
+SMSBatch::SMSBatch(char * buffer, size_t size) : arena(buffer), capacity(size), ownsArena(false) {
+}
+
+SMSBatch::SMSBatch(size_t size) : arena(new char[size]), capacity(size), ownsArena(true) {
+}
+
+SMSBatch::SMSBatch(SMSBatch && other)
+    : arena(other.arena), capacity(other.capacity), ownsArena(other.ownsArena),
+      textLength(other.textLength), count(other.count), dropped(other.dropped) {
+    other.arena = nullptr;
+    other.capacity = 0;
+    other.ownsArena = false;
+    other.clear();
+}
+
+SMSBatch & SMSBatch::operator=(SMSBatch && other) {
+    if (this != &other) {
+        release();
+        arena = other.arena;
+        capacity = other.capacity;
+        ownsArena = other.ownsArena;
+        textLength = other.textLength;
+        count = other.count;
+        dropped = other.dropped;
+
+        other.arena = nullptr;
+        other.capacity = 0;
+        other.ownsArena = false;
+        other.clear();
+    }
+    return *this;
+}
+
+SMSBatch::~SMSBatch() {
+    release();
+}
+
+void SMSBatch::release() {
+    if (ownsArena) {
+        delete[] arena;
+    }
+    arena = nullptr;
+    capacity = 0;
+    ownsArena = false;
+    clear();
+}
+
+void SMSBatch::clear() {
+    textLength = 0;
+    count = 0;
+    dropped = 0;
+}
+
+SMSBatch::Entry * SMSBatch::entry(size_t position) const {
+    // Records grow downwards from the aligned end of the arena
+    uintptr_t end = reinterpret_cast<uintptr_t>(arena + capacity) & ~static_cast<uintptr_t>(alignof(Entry) - 1);
+    return reinterpret_cast<Entry *>(end) - (position + 1);
+}
+
+bool SMSBatch::add(const SMSView & sms) {
+    if (arena == nullptr) {
+        dropped++;
+        return false;
+    }
+
+    size_t senderLength = strlen(sms.sender);
+    size_t needed = senderLength + 1 + sms.messageLength + 1;
+    uintptr_t recordStart = reinterpret_cast<uintptr_t>(entry(count));
+    uintptr_t textEnd = reinterpret_cast<uintptr_t>(arena + textLength);
+
+    if (recordStart < textEnd || recordStart - textEnd < needed) {
+        dropped++;
+        return false;
+    }
+
+    Entry * record = new (entry(count)) Entry();
+    record->index = sms.index;
+    record->timestamp = sms.timestamp;
+    record->status = sms.status;
+    record->partReference = sms.partReference;
+    record->partNumber = sms.partNumber;
+    record->partCount = sms.partCount;
+
+    record->senderOffset = textLength;
+    memcpy(arena + textLength, sms.sender, senderLength + 1);
+    textLength += senderLength + 1;
+
+    record->messageOffset = textLength;
+    record->messageLength = sms.messageLength;
+    memcpy(arena + textLength, sms.message, sms.messageLength);
+    arena[textLength + sms.messageLength] = '\0';
+    textLength += sms.messageLength + 1;
+
+    count++;
+    return true;
+}
+
+SMSView SMSBatch::operator[](size_t position) const {
+    const Entry * record = entry(position);
+
+    SMSView view;
+    view.index = record->index;
+    view.sender = arena + record->senderOffset;
+    view.message = arena + record->messageOffset;
+    view.messageLength = record->messageLength;
+    view.timestamp = record->timestamp;
+    view.status = static_cast<SMSStatus>(record->status);
+    view.partReference = record->partReference;
+    view.partNumber = record->partNumber;
+    view.partCount = record->partCount;
+    view.partIndices = nullptr;
+    return view;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file SMSBatch.h
+ * @brief Header file for the SMSBatch class.
+ */
+
+#ifndef ARDUINO_CELLULAR_SMS_BATCH_H
+#define ARDUINO_CELLULAR_SMS_BATCH_H
+
+#include <Arduino.h>
+#include <SMSParser.h>
+
+/**
+ * @class SMSBatch
+ * @brief A container of SMS messages backed by a single contiguous memory arena.
+ *
+ * Senders and message bodies are packed from the start of the arena, the per-message records
+ * from its end. Adding a message never allocates: if the arena is full the message is dropped
+ * and counted. The arena is either supplied by the caller or allocated once by the batch and
+ * reused every time the batch is refilled.
+ */
+class SMSBatch {
+    public:
+        /**
+         * @brief Creates a batch that uses a caller supplied buffer as its arena.
+         * The buffer must outlive the batch.
+         * @param buffer The memory used to store the messages.
+         * @param size The size of the buffer in bytes.
+         */
+        SMSBatch(char * buffer, size_t size);
+
+        /**
+         * @brief Creates a batch that allocates its arena once.
+         * @param size The size of the arena in bytes.
+         */
+        explicit SMSBatch(size_t size);
+
+        /**
+         * @brief Moves the messages and the arena of another batch into a new one.
+         * @param other The batch to move from. It is left empty and without arena.
+         */
+        SMSBatch(SMSBatch && other);
+
+        /**
+         * @brief Moves the messages and the arena of another batch into this one.
+         * @param other The batch to move from. It is left empty and without arena.
+         * @return This batch.
+         */
+        SMSBatch & operator=(SMSBatch && other);
+
+        SMSBatch(const SMSBatch &) = delete;
+        SMSBatch & operator=(const SMSBatch &) = delete;
+
+        ~SMSBatch();
+
+        /**
+         * @brief Removes all messages. The arena is kept for reuse.
+         */
+        void clear();
+
+        /**
+         * @brief Copies a message into the arena.
+         * @param sms The message to add.
+         * @return True if the message was stored, false if the arena is full.
+         */
+        bool add(const SMSView & sms);
+
+        /**
+         * @brief Gets a view of the message at the given position.
+         * The view stays valid until the batch is cleared, refilled or destroyed.
+         * @param position The position of the message, from 0 to size() - 1.
+         * @return A view of the message.
+         */
+        SMSView operator[](size_t position) const;
+
+        /**
+         * @brief Gets the number of messages in the batch.
+         * @return The number of messages.
+         */
+        size_t size() const { return count; }
+
+        /**
+         * @brief Gets the number of messages dropped because the arena was full.
+         * @return The number of dropped messages since the last clear().
+         */
+        size_t getDroppedCount() const { return dropped; }
+
+        /**
+         * @brief Gets the number of arena bytes in use.
+         * @return The used bytes, including the per-message records.
+         */
+        size_t getUsedBytes() const { return textLength + count * sizeof(Entry); }
+
+        /**
+         * @brief Gets the size of the arena.
+         * @return The size of the arena in bytes.
+         */
+        size_t getCapacity() const { return capacity; }
+
+    private:
+        struct Entry {
+            Time timestamp;
+            uint32_t senderOffset;
+            uint32_t messageOffset;
+            uint32_t messageLength;
+            int16_t index;
+            uint16_t partReference;
+            uint8_t partNumber;
+            uint8_t partCount;
+            uint8_t status;
+        };
+
+        Entry * entry(size_t position) const;
+        void release();
+
+        char * arena = nullptr;
+        size_t capacity = 0;
+        bool ownsArena = false;
+
+        size_t textLength = 0;
+        size_t count = 0;
+        size_t dropped = 0;
+};
+
+#endif
@@ -0,0 +1,240 @@
+#include "SMSDecoder.h"
+#include "SMSEncoder.h"
+
+namespace {
+
+// Reads the septet at the given position of packed GSM 7-bit data
+uint8_t unpackSeptet(const uint8_t * data, size_t position) {
+    size_t bit = position * 7;
+    size_t octet = bit / 8;
+    size_t shift = bit % 8;
+    uint16_t value = data[octet] >> shift;
+    if (shift > 1) {
+        value |= data[octet + 1] << (8 - shift);
+    }
+    return value & 0x7F;
+}
+
+// Two swapped BCD digits, as used by the timestamp
+int swappedDecimal(uint8_t octet) {
+    return (octet & 0x0F) * 10 + (octet >> 4);
+}
+
+}
+
+SMSDecoder::SMSDecoder(char * sender, size_t senderSize, char * text, size_t textSize)
+    : sender(sender), senderSize(senderSize), text(text), textSize(textSize) {
+}
+
+void SMSDecoder::append(uint32_t codePoint, char * out, size_t size, size_t & length) {
+    char encoded[4];
+    size_t count;
+    if (codePoint < 0x80) {
+        encoded[0] = static_cast<char>(codePoint);
+        count = 1;
+    } else if (codePoint < 0x800) {
+        encoded[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+        encoded[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        count = 2;
+    } else if (codePoint < 0x10000) {
+        encoded[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+        encoded[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        encoded[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        count = 3;
+    } else {
+        encoded[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+        encoded[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        encoded[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        encoded[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        count = 4;
+    }
+
+    // Characters are never cut in half, the terminator always fits
+    if (length + count >= size) {
+        return;
+    }
+    memcpy(out + length, encoded, count);
+    length += count;
+    out[length] = '\0';
+}
+
+void SMSDecoder::decodeGSM7(const uint8_t * userData, size_t septets, size_t firstSeptet, char * out, size_t size, size_t & length) {
+    bool escaped = false;
+    for (size_t i = firstSeptet; i < septets; i++) {
+        uint8_t septet = unpackSeptet(userData, i);
+        if (septet == 0x1B && !escaped) {
+            escaped = true;
+            continue;
+        }
+        append(SMSEncoder::fromGSM7(septet, escaped), out, size, length);
+        escaped = false;
+    }
+}
+
+bool SMSDecoder::decodeAddress(const uint8_t * address, uint8_t digits, uint8_t type) {
+    size_t length = 0;
+    sender[0] = '\0';
+
+    if ((type & 0x70) == 0x50) {
+        // Alphanumeric sender, packed GSM 7-bit characters
+        decodeGSM7(address, digits * 4 / 7, 0, sender, senderSize, length);
+        return true;
+    }
+
+    if ((type & 0x70) == 0x10) {
+        append('+', sender, senderSize, length);
+    }
+    static const char semiOctets[] = "0123456789*#abc";
+    for (size_t i = 0; i < digits; i++) {
+        uint8_t value = (i % 2 == 0) ? (address[i / 2] & 0x0F) : (address[i / 2] >> 4);
+        if (value == 0x0F) {
+            break;
+        }
+        append(semiOctets[value], sender, senderSize, length);
+    }
+    return true;
+}
+
+void SMSDecoder::decodeUserDataHeader(const uint8_t * header, size_t length) {
+    // Information elements: <identifier>,<length>,<data>
+    for (size_t position = 0; position + 2 <= length;) {
+        uint8_t identifier = header[position];
+        uint8_t elementLength = header[position + 1];
+        const uint8_t * data = header + position + 2;
+        if (position + 2 + elementLength > length) {
+            return;
+        }
+        if (identifier == 0x00 && elementLength == 3) {
+            partReference = data[0];
+            partCount = data[1];
+            partNumber = data[2];
+        } else if (identifier == 0x08 && elementLength == 4) {
+            partReference = (data[0] << 8) | data[1];
+            partCount = data[2];
+            partNumber = data[3];
+        }
+        position += 2 + elementLength;
+    }
+
+    // Malformed concatenation information, treat the part as a standalone message
+    if (partCount == 0 || partNumber == 0 || partNumber > partCount) {
+        partReference = 0;
+        partCount = 1;
+        partNumber = 1;
+    }
+}
+
+bool SMSDecoder::decode(const uint8_t * pdu, size_t length) {
+    textLength = 0;
+    text[0] = '\0';
+    sender[0] = '\0';
+    timestamp = Time();
+    partReference = 0;
+    partNumber = 1;
+    partCount = 1;
+
+    // SMSC address, then the first octet
+    size_t position = 1 + static_cast<size_t>(pdu[0]);
+    if (length == 0 || position >= length) {
+        return false;
+    }
+    uint8_t firstOctet = pdu[position++];
+    bool submit = (firstOctet & 0x03) == 0x01;
+    if (submit) {
+        position++; // Message reference
+    }
+
+    // Originating address of a received message, destination address of a stored one
+    if (position + 2 > length) {
+        return false;
+    }
+    uint8_t digits = pdu[position++];
+    uint8_t type = pdu[position++];
+    if (position + (digits + 1) / 2 > length) {
+        return false;
+    }
+    decodeAddress(pdu + position, digits, type);
+    position += (digits + 1) / 2;
+
+    if (position + 2 > length) {
+        return false;
+    }
+    position++; // Protocol identifier
+    uint8_t dataCoding = pdu[position++];
+
+    if (submit) {
+        // Validity period: none, relative (1 octet) or absolute / enhanced (7 octets)
+        uint8_t validityFormat = (firstOctet >> 3) & 0x03;
+        position += validityFormat == 0 ? 0 : (validityFormat == 2 ? 1 : 7);
+    } else {
+        if (position + 7 > length) {
+            return false;
+        }
+        const uint8_t * stamp = pdu + position;
+        timestamp = Time(2000 + swappedDecimal(stamp[0]), swappedDecimal(stamp[1]), swappedDecimal(stamp[2]),
+                         swappedDecimal(stamp[3]), swappedDecimal(stamp[4]), swappedDecimal(stamp[5]));
+        // The offset is given in quarter hours, bit 3 is its sign
+        int quarters = swappedDecimal(stamp[6] & 0xF7);
+        timestamp.setOffsetMinutes((stamp[6] & 0x08) ? -quarters * 15 : quarters * 15);
+        position += 7;
+    }
+
+    if (position >= length) {
+        return false;
+    }
+    size_t userDataLength = pdu[position++];
+    const uint8_t * userData = pdu + position;
+    size_t available = length - position;
+
+    // Data coding groups 00xx and 01xx carry the alphabet in bits 2 and 3, group 1111 in bit 2
+    uint8_t alphabet = 0;
+    if ((dataCoding & 0x80) == 0) {
+        alphabet = (dataCoding >> 2) & 0x03;
+    } else if ((dataCoding & 0xF0) == 0xF0) {
+        alphabet = (dataCoding >> 2) & 0x01;
+    } else if ((dataCoding & 0xF0) == 0xE0) {
+        alphabet = 2;
+    }
+
+    size_t headerOctets = 0;
+    if ((firstOctet & 0x40) && available > 0) {
+        headerOctets = userData[0] + 1;
+        if (headerOctets > available) {
+            return false;
+        }
+        decodeUserDataHeader(userData + 1, headerOctets - 1);
+    }
+
+    if (alphabet == 0) {
+        // The length counts septets, the header is padded to a septet boundary
+        if ((userDataLength * 7 + 7) / 8 > available) {
+            return false;
+        }
+        decodeGSM7(userData, userDataLength, (headerOctets * 8 + 6) / 7, text, textSize, textLength);
+    } else if (alphabet == 2) {
+        if (userDataLength > available) {
+            return false;
+        }
+        for (size_t i = headerOctets; i + 1 < userDataLength; i += 2) {
+            uint32_t unit = (userData[i] << 8) | userData[i + 1];
+            if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < userDataLength) {
+                uint32_t low = (userData[i + 2] << 8) | userData[i + 3];
+                unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                i += 2;
+            }
+            append(unit, text, textSize, textLength);
+        }
+    } else {
+        if (userDataLength > available) {
+            return false;
+        }
+        size_t octets = userDataLength - (headerOctets < userDataLength ? headerOctets : userDataLength);
+        if (octets > textSize - 1) {
+            octets = textSize - 1;
+        }
+        memcpy(text, userData + headerOctets, octets);
+        text[octets] = '\0';
+        textLength = octets;
+    }
+    return true;
+}
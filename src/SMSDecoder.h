@@ -0,0 +1,87 @@
+/**
+ * @file SMSDecoder.h
+ * @brief Header file for the SMSDecoder class.
+ */
+
+#ifndef ARDUINO_CELLULAR_SMS_DECODER_H
+#define ARDUINO_CELLULAR_SMS_DECODER_H
+
+#include <Arduino.h>
+#include <TimeUtils.h>
+
+/**
+ * @class SMSDecoder
+ * @brief Decodes SMS-DELIVER and SMS-SUBMIT PDUs as listed by +CMGL and read by +CMGR in PDU mode.
+ *
+ * The sender and the text are written as UTF-8 into buffers supplied by the caller, so that
+ * decoding never allocates. GSM 7-bit, 8-bit and UCS-2 user data are supported. 8-bit data is
+ * copied unchanged. The concatenation information of the user data header is extracted.
+ */
+class SMSDecoder {
+    public:
+        /**
+         * @brief Creates a decoder writing into the given buffers.
+         * @param sender The buffer receiving the sender (or recipient) address, null-terminated.
+         * @param senderSize The size of the sender buffer.
+         * @param text The buffer receiving the text, null-terminated. Text that does not fit is truncated.
+         * @param textSize The size of the text buffer.
+         */
+        SMSDecoder(char * sender, size_t senderSize, char * text, size_t textSize);
+
+        /**
+         * @brief Decodes a PDU that starts with the SMSC address.
+         * @param pdu The PDU.
+         * @param length The number of octets.
+         * @return True if the PDU is well-formed.
+         */
+        bool decode(const uint8_t * pdu, size_t length);
+
+        /**
+         * @brief Gets the length of the decoded text.
+         * @return The length in bytes.
+         */
+        size_t getTextLength() const { return textLength; }
+
+        /**
+         * @brief Gets the service centre timestamp. Stored SMS-SUBMIT PDUs have none.
+         * @return The timestamp.
+         */
+        const Time & getTimestamp() const { return timestamp; }
+
+        /**
+         * @brief Gets the reference shared by the parts of a concatenated message.
+         * @return The reference, 0 if the message is not concatenated.
+         */
+        uint16_t getPartReference() const { return partReference; }
+
+        /**
+         * @brief Gets the position of the part in the concatenated message.
+         * @return The part number, starting at 1. 1 if the message is not concatenated.
+         */
+        uint8_t getPartNumber() const { return partNumber; }
+
+        /**
+         * @brief Gets the number of parts of the concatenated message.
+         * @return The number of parts, 1 if the message is not concatenated.
+         */
+        uint8_t getPartCount() const { return partCount; }
+
+    private:
+        bool decodeAddress(const uint8_t * address, uint8_t digits, uint8_t type);
+        void decodeUserDataHeader(const uint8_t * header, size_t length);
+        void decodeGSM7(const uint8_t * userData, size_t septets, size_t firstSeptet, char * out, size_t size, size_t & length);
+        void append(uint32_t codePoint, char * out, size_t size, size_t & length);
+
+        char * sender;
+        size_t senderSize;
+        char * text;
+        size_t textSize;
+
+        size_t textLength = 0;
+        Time timestamp;
+        uint16_t partReference = 0;
+        uint8_t partNumber = 1;
+        uint8_t partCount = 1;
+};
+
+#endif
@@ -0,0 +1,252 @@
+#include "SMSEncoder.h"
+
+namespace {
+
+constexpr size_t singleLength[] = { 160, 70 }; // Units of one SMS, by encoding
+constexpr size_t segmentLength[] = { 153, 67 }; // Units of a segment, after the concatenation header
+constexpr size_t headerLength = 6; // UDHL, IEI 0x00, IEDL, reference, total, sequence
+constexpr size_t headerSeptets = 7; // The header padded to a septet boundary
+
+// The GSM 7-bit default alphabet, by septet
+const uint16_t gsm7Alphabet[128] = {
+    0x0040, 0x00A3, 0x0024, 0x00A5, 0x00E8, 0x00E9, 0x00F9, 0x00EC, 0x00F2, 0x00C7, 0x000A, 0x00D8, 0x00F8, 0x000D, 0x00C5, 0x00E5,
+    0x0394, 0x005F, 0x03A6, 0x0393, 0x039B, 0x03A9, 0x03A0, 0x03A8, 0x03A3, 0x0398, 0x039E, 0xFFFF, 0x00C6, 0x00E6, 0x00DF, 0x00C9,
+    0x0020, 0x0021, 0x0022, 0x0023, 0x00A4, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+    0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+    0x00A1, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+    0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x00C4, 0x00D6, 0x00D1, 0x00DC, 0x00A7,
+    0x00BF, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F,
+    0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007A, 0x00E4, 0x00F6, 0x00F1, 0x00FC, 0x00E0,
+};
+
+// The extension table, reached with the escape septet 0x1B
+struct ExtensionCharacter {
+    uint16_t codePoint;
+    uint8_t septet;
+};
+
+const ExtensionCharacter gsm7Extension[] = {
+    { 0x000C, 0x0A }, { 0x005E, 0x14 }, { 0x007B, 0x28 }, { 0x007D, 0x29 }, { 0x005C, 0x2F },
+    { 0x005B, 0x3C }, { 0x007E, 0x3D }, { 0x005D, 0x3E }, { 0x007C, 0x40 }, { 0x20AC, 0x65 },
+};
+
+// Writes a septet at the given bit position of the packed user data
+void packSeptet(uint8_t * userData, size_t bit, uint8_t septet) {
+    size_t octet = bit / 8;
+    size_t shift = bit % 8;
+    userData[octet] |= static_cast<uint8_t>(septet << shift);
+    if (shift > 1) {
+        userData[octet + 1] |= static_cast<uint8_t>(septet >> (8 - shift));
+    }
+}
+
+}
+
+int SMSEncoder::toGSM7(uint32_t codePoint) {
+    // Most ASCII characters map to themselves
+    if (codePoint >= 0x20 && codePoint < 0x80 && gsm7Alphabet[codePoint] == codePoint) {
+        return static_cast<int>(codePoint);
+    }
+    for (size_t i = 0; i < sizeof(gsm7Alphabet) / sizeof(gsm7Alphabet[0]); i++) {
+        if (gsm7Alphabet[i] == codePoint && i != 0x1B) {
+            return static_cast<int>(i);
+        }
+    }
+    for (const ExtensionCharacter & character : gsm7Extension) {
+        if (character.codePoint == codePoint) {
+            return 0x1B00 | character.septet;
+        }
+    }
+    return -1;
+}
+
+uint32_t SMSEncoder::fromGSM7(uint8_t septet, bool extension) {
+    septet &= 0x7F;
+    if (extension) {
+        for (const ExtensionCharacter & character : gsm7Extension) {
+            if (character.septet == septet) {
+                return character.codePoint;
+            }
+        }
+    }
+    // The escape septet on its own has no meaning, show it as a space
+    return septet == 0x1B ? 0x20 : gsm7Alphabet[septet];
+}
+
+uint32_t SMSEncoder::nextCodePoint(const char *& cursor) {
+    uint8_t lead = static_cast<uint8_t>(*cursor++);
+    if (lead < 0x80) {
+        return lead;
+    }
+
+    size_t continuation;
+    uint32_t codePoint;
+    if ((lead & 0xE0) == 0xC0) {
+        continuation = 1;
+        codePoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        continuation = 2;
+        codePoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        continuation = 3;
+        codePoint = lead & 0x07;
+    } else {
+        return 0xFFFD;
+    }
+
+    for (size_t i = 0; i < continuation; i++) {
+        uint8_t next = static_cast<uint8_t>(*cursor);
+        if ((next & 0xC0) != 0x80) {
+            return 0xFFFD;
+        }
+        codePoint = (codePoint << 6) | (next & 0x3F);
+        cursor++;
+    }
+    return codePoint <= 0x10FFFF ? codePoint : 0xFFFD;
+}
+
+size_t SMSEncoder::units(uint32_t codePoint) const {
+    if (encoding == SMS_ENCODING_GSM7) {
+        return toGSM7(codePoint) > 0xFF ? 2 : 1;
+    }
+    return codePoint > 0xFFFF ? 2 : 1;
+}
+
+bool SMSEncoder::setMessage(const char * message) {
+    this->message = message;
+    encoding = SMS_ENCODING_GSM7;
+
+    size_t total = 0;
+    for (const char * cursor = message; *cursor != '\0';) {
+        uint32_t codePoint = nextCodePoint(cursor);
+        if (encoding == SMS_ENCODING_GSM7 && toGSM7(codePoint) < 0) {
+            encoding = SMS_ENCODING_UCS2;
+        }
+        total += codePoint > 0xFFFF ? 2 : 1;
+    }
+    if (encoding == SMS_ENCODING_GSM7) {
+        total = 0;
+        for (const char * cursor = message; *cursor != '\0';) {
+            total += units(nextCodePoint(cursor));
+        }
+    }
+
+    segmentCount = 1;
+    segmentStart[0] = 0;
+    if (total <= singleLength[encoding]) {
+        segmentStart[1] = strlen(message);
+        return true;
+    }
+
+    // Split before the character that would overflow the segment
+    size_t used = 0;
+    for (const char * cursor = message; *cursor != '\0';) {
+        const char * start = cursor;
+        size_t size = units(nextCodePoint(cursor));
+        if (used + size > segmentLength[encoding]) {
+            if (segmentCount == maxSegments) {
+                segmentCount = 0;
+                return false;
+            }
+            segmentStart[segmentCount++] = start - message;
+            used = 0;
+        }
+        used += size;
+    }
+    segmentStart[segmentCount] = strlen(message);
+    return true;
+}
+
+size_t SMSEncoder::encodeGSM7(const char * start, const char * end, uint8_t * userData, size_t offset) const {
+    size_t septets = offset;
+    for (const char * cursor = start; cursor < end;) {
+        int septet = toGSM7(nextCodePoint(cursor));
+        if (septet > 0xFF) {
+            packSeptet(userData, septets++ * 7, 0x1B);
+        }
+        packSeptet(userData, septets++ * 7, static_cast<uint8_t>(septet & 0x7F));
+    }
+    return septets;
+}
+
+size_t SMSEncoder::encodeUCS2(const char * start, const char * end, uint8_t * userData) const {
+    size_t length = 0;
+    for (const char * cursor = start; cursor < end;) {
+        uint32_t codePoint = nextCodePoint(cursor);
+        if (codePoint > 0xFFFF) {
+            // Characters outside the BMP take a surrogate pair
+            codePoint -= 0x10000;
+            uint16_t high = 0xD800 | (codePoint >> 10);
+            userData[length++] = high >> 8;
+            userData[length++] = high & 0xFF;
+            codePoint = 0xDC00 | (codePoint & 0x3FF);
+        }
+        userData[length++] = static_cast<uint8_t>(codePoint >> 8);
+        userData[length++] = static_cast<uint8_t>(codePoint & 0xFF);
+    }
+    return length;
+}
+
+size_t SMSEncoder::encode(size_t segment, const char * number, uint8_t reference, uint8_t * pdu) const {
+    if (segment >= segmentCount) {
+        return 0;
+    }
+
+    bool international = number[0] == '+';
+    const char * digits = international ? number + 1 : number;
+    size_t digitCount = strlen(digits);
+    if (digitCount == 0 || digitCount > maxNumberDigits) {
+        return 0;
+    }
+
+    bool concatenated = segmentCount > 1;
+    size_t length = 0;
+    pdu[length++] = 0x00; // Use the SMSC stored in the SIM
+    pdu[length++] = concatenated ? 0x41 : 0x01; // SMS-SUBMIT, with UDHI if a header follows
+    pdu[length++] = 0x00; // Message reference, assigned by the modem
+    pdu[length++] = static_cast<uint8_t>(digitCount);
+    pdu[length++] = international ? 0x91 : 0x81;
+
+    // The digits as swapped semi-octets, padded with 0xF
+    for (size_t i = 0; i < digitCount; i += 2) {
+        if (digits[i] < '0' || digits[i] > '9' || (i + 1 < digitCount && (digits[i + 1] < '0' || digits[i + 1] > '9'))) {
+            return 0;
+        }
+        uint8_t low = digits[i] - '0';
+        uint8_t high = i + 1 < digitCount ? digits[i + 1] - '0' : 0x0F;
+        pdu[length++] = static_cast<uint8_t>((high << 4) | low);
+    }
+
+    pdu[length++] = 0x00; // Protocol identifier
+    pdu[length++] = encoding == SMS_ENCODING_UCS2 ? 0x08 : 0x00; // Data coding scheme
+
+    uint8_t * userDataLength = pdu + length++;
+    uint8_t * userData = pdu + length;
+    memset(userData, 0, maxPDULength - length);
+
+    size_t headerOctets = 0;
+    if (concatenated) {
+        userData[0] = headerLength - 1;
+        userData[1] = 0x00; // Concatenated short message, 8-bit reference
+        userData[2] = 0x03;
+        userData[3] = reference;
+        userData[4] = static_cast<uint8_t>(segmentCount);
+        userData[5] = static_cast<uint8_t>(segment + 1);
+        headerOctets = headerLength;
+    }
+
+    const char * start = message + segmentStart[segment];
+    const char * end = message + segmentStart[segment + 1];
+    if (encoding == SMS_ENCODING_GSM7) {
+        // The user data length counts septets, the header included
+        size_t septets = encodeGSM7(start, end, userData, concatenated ? headerSeptets : 0);
+        *userDataLength = static_cast<uint8_t>(septets);
+        length += (septets * 7 + 7) / 8;
+    } else {
+        size_t octets = headerOctets + encodeUCS2(start, end, userData + headerOctets);
+        *userDataLength = static_cast<uint8_t>(octets);
+        length += octets;
+    }
+
+    return length - 1;
+}
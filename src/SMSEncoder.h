@@ -0,0 +1,107 @@
+/**
+ * @file SMSEncoder.h
+ * @brief Header file for the SMSEncoder class.
+ */
+
+#ifndef ARDUINO_CELLULAR_SMS_ENCODER_H
+#define ARDUINO_CELLULAR_SMS_ENCODER_H
+
+#include <Arduino.h>
+
+#ifndef ARDUINO_CELLULAR_SMS_MAX_SEGMENTS
+/**
+ * Maximum number of segments a message sent in PDU mode is split into.
+ */
+#define ARDUINO_CELLULAR_SMS_MAX_SEGMENTS 8
+#endif
+
+/**
+ * @enum SMSEncoding
+ * @brief The alphabet used for the user data of an SMS PDU.
+ */
+enum SMSEncoding {
+    SMS_ENCODING_GSM7, /**< The GSM 7-bit default alphabet and its extension table, 160 characters per SMS. */
+    SMS_ENCODING_UCS2 /**< UCS-2 (UTF-16), 70 characters per SMS. */
+};
+
+/**
+ * @class SMSEncoder
+ * @brief Builds SMS-SUBMIT PDUs from a UTF-8 message.
+ *
+ * A message whose characters all exist in the GSM 7-bit alphabet is packed into septets,
+ * any other message is encoded as UCS-2. Messages longer than one SMS are split into segments
+ * carrying a concatenation user data header. Escape sequences and surrogate pairs are never split.
+ * The encoder keeps a pointer to the message, which must stay valid while PDUs are built.
+ */
+class SMSEncoder {
+    public:
+        static constexpr size_t maxSegments = ARDUINO_CELLULAR_SMS_MAX_SEGMENTS; /**< Maximum number of segments of a message. */
+        static constexpr size_t maxNumberDigits = 20; /**< Maximum number of digits of a phone number. */
+        static constexpr size_t maxPDULength = 1 + 1 + 1 + 2 + maxNumberDigits / 2 + 1 + 1 + 1 + 140; /**< Size of a PDU buffer, including the SMSC octet. */
+
+        static_assert(maxSegments >= 1 && maxSegments <= 255, "A concatenated SMS has between 1 and 255 segments");
+
+        /**
+         * @brief Analyses a message and splits it into segments.
+         * @param message The message, encoded as UTF-8. Invalid sequences are replaced.
+         * @return True if the message fits into maxSegments segments.
+         */
+        bool setMessage(const char * message);
+
+        /**
+         * @brief Gets the alphabet chosen for the message.
+         * @return The encoding.
+         */
+        SMSEncoding getEncoding() const { return encoding; }
+
+        /**
+         * @brief Gets the number of SMS the message is sent as.
+         * @return The number of segments.
+         */
+        size_t getSegmentCount() const { return segmentCount; }
+
+        /**
+         * @brief Builds the PDU of one segment, starting with an empty SMSC address so that the default SMSC is used.
+         * @param segment The segment, from 0 to getSegmentCount() - 1.
+         * @param number The recipient, digits with an optional leading '+' for an international number.
+         * @param reference The concatenation reference shared by all segments of the message.
+         * @param pdu The buffer receiving the PDU, at least maxPDULength bytes.
+         * @return The length of the TPDU, which is the PDU without the SMSC octet and the length passed to +CMGS,
+         * or 0 if the number is invalid.
+         */
+        size_t encode(size_t segment, const char * number, uint8_t reference, uint8_t * pdu) const;
+
+        /**
+         * @brief Maps a Unicode character to the GSM 7-bit alphabet.
+         * @param codePoint The character.
+         * @return The septet, 0x1B00 | septet for characters of the extension table, or -1 if the character does not exist.
+         */
+        static int toGSM7(uint32_t codePoint);
+
+        /**
+         * @brief Maps a septet of the GSM 7-bit alphabet to Unicode.
+         * @param septet The septet.
+         * @param extension True if the septet follows the escape septet 0x1B.
+         * @return The character. Septets missing from the extension table map to the default alphabet.
+         */
+        static uint32_t fromGSM7(uint8_t septet, bool extension);
+
+        /**
+         * @brief Decodes the next character of a UTF-8 string.
+         * @param cursor The position in the string. It is advanced past the character.
+         * @return The character, or U+FFFD for an invalid sequence.
+         */
+        static uint32_t nextCodePoint(const char *& cursor);
+
+    private:
+        size_t units(uint32_t codePoint) const;
+        size_t encodeGSM7(const char * start, const char * end, uint8_t * userData, size_t offset) const;
+        size_t encodeUCS2(const char * start, const char * end, uint8_t * userData) const;
+
+        const char * message = nullptr;
+        SMSEncoding encoding = SMS_ENCODING_GSM7;
+        size_t segmentCount = 0;
+        size_t segmentStart[maxSegments + 1]; /**< Offsets of the segments in the message, the last one is its length. */
+};
+
+#endif
@@ -0,0 +1,312 @@
+#include "SMSParser.h"
+
+namespace {
+
+bool startsWith(const char * text, const char * prefix) {
+    return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+bool isHeader(const char * line) {
+    return startsWith(line, "+CMGL:") || startsWith(line, "+CMGR:");
+}
+
+// Returns the next comma separated field of a result line, without surrounding quotes.
+// Commas inside quotes are part of the field.
+bool nextField(const char *& cursor, const char *& start, size_t & length) {
+    if (*cursor == '\0') {
+        return false;
+    }
+    while (*cursor == ' ') {
+        cursor++;
+    }
+
+    if (*cursor == '"') {
+        start = ++cursor;
+        while (*cursor != '\0' && *cursor != '"') {
+            cursor++;
+        }
+        length = cursor - start;
+        if (*cursor == '"') {
+            cursor++;
+        }
+    } else {
+        start = cursor;
+        while (*cursor != '\0' && *cursor != ',') {
+            cursor++;
+        }
+        length = cursor - start;
+    }
+
+    while (*cursor != '\0' && *cursor != ',') {
+        cursor++;
+    }
+    if (*cursor == ',') {
+        cursor++;
+    }
+    return true;
+}
+
+}
+
+SMSParser::SMSParser(SMSCallback callback, void * context)
+    : callback(callback), context(context), decoder(sender, sizeof(sender), message, sizeof(message)) {
+    reset();
+}
+
+void SMSParser::reset() {
+    lineLength = 0;
+    lineFlushed = false;
+    previousLineEmpty = true;
+    sender[0] = '\0';
+    messageLength = 0;
+    pendingNewlines = 0;
+    index = -1;
+    status = SMS_STATUS_UNKNOWN;
+    partReference = 0;
+    partNumber = 1;
+    partCount = 1;
+    pduLength = 0;
+    inPDU = false;
+    inMessage = false;
+    done = false;
+    success = false;
+    count = 0;
+}
+
+bool SMSParser::feed(char c) {
+    if (done) {
+        return true;
+    }
+
+    if (c == '\r') {
+        return false;
+    }
+
+    if (inPDU) {
+        if (c == '\n') {
+            endPDU();
+            return done;
+        }
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else {
+            return false;
+        }
+        if (pduHighNibble) {
+            if (pduLength < maxPDULength) {
+                pdu[pduLength] = nibble << 4;
+            }
+        } else if (pduLength < maxPDULength) {
+            pdu[pduLength++] |= nibble;
+        }
+        pduHighNibble = !pduHighNibble;
+        return false;
+    }
+
+    if (c == '\n') {
+        endLine();
+        return done;
+    }
+
+    if (lineLength >= maxLineLength) {
+        if (isHeader(line)) {
+            // Over-long headers are truncated, the fields we need come first
+            return false;
+        }
+        flushLineToMessage();
+    }
+    line[lineLength++] = c;
+    return false;
+}
+
+void SMSParser::flushLineToMessage() {
+    if (inMessage) {
+        if (!lineFlushed) {
+            while (pendingNewlines > 0 && messageLength < maxMessageLength) {
+                message[messageLength++] = '\n';
+                pendingNewlines--;
+            }
+            pendingNewlines = 0;
+        }
+        for (size_t i = 0; i < lineLength && messageLength < maxMessageLength; i++) {
+            message[messageLength++] = line[i];
+        }
+    }
+    lineLength = 0;
+    lineFlushed = true;
+}
+
+void SMSParser::endLine() {
+    line[lineLength] = '\0';
+    bool empty = false;
+
+    if (lineFlushed) {
+        // The beginning of this line was already classified as message content
+        flushLineToMessage();
+        pendingNewlines = 1;
+    } else if (lineLength == 0) {
+        empty = true;
+        if (inMessage && messageLength > 0 && pendingNewlines < 255) {
+            pendingNewlines++;
+        }
+    } else if (urcDispatcher != nullptr && urcDispatcher->accepts(line)) {
+        urcDispatcher->push(line);
+        // The URC is not part of the message, keep the line structure around it unchanged
+        empty = previousLineEmpty;
+    } else if (isHeader(line)) {
+        if (inMessage) {
+            emit();
+        }
+        parseHeader();
+    } else if (startsWith(line, "+CMS ERROR") || startsWith(line, "+CME ERROR")
+               || ((!inMessage || previousLineEmpty) && strcmp(line, "ERROR") == 0)) {
+        inMessage = false;
+        done = true;
+        success = false;
+    } else if ((!inMessage || previousLineEmpty) && strcmp(line, "OK") == 0) {
+        // A message body may itself read "OK", the final result code follows an empty line
+        if (inMessage) {
+            emit();
+        }
+        done = true;
+        success = true;
+    } else {
+        flushLineToMessage();
+        pendingNewlines = 1;
+    }
+
+    previousLineEmpty = empty;
+    lineLength = 0;
+    lineFlushed = false;
+}
+
+void SMSParser::parseHeader() {
+    // +CMGL: <index>,<stat>,<oa>,[<alpha>],[<scts>]
+    // +CMGR: <stat>,<oa>,[<alpha>],[<scts>]
+    bool listing = startsWith(line, "+CMGL:");
+    const char * cursor = line + strlen("+CMGL:");
+    const char * start;
+    size_t length;
+
+    index = listing ? -1 : readIndex;
+    sender[0] = '\0';
+    timestamp = Time();
+    status = SMS_STATUS_UNKNOWN;
+    partReference = 0;
+    partNumber = 1;
+    partCount = 1;
+    bool pduMode = false;
+
+    for (int field = listing ? 0 : 1; nextField(cursor, start, length); field++) {
+        if (field == 0) {
+            index = static_cast<int16_t>(atoi(start));
+        } else if (field == 1) {
+            status = parseStatus(start, length);
+            // Text mode quotes the status, PDU mode reports a number and puts the message into the next line
+            pduMode = start == line || start[-1] != '"';
+        } else if (pduMode) {
+            break;
+        } else if (field == 2) {
+            size_t n = length < maxSenderLength ? length : maxSenderLength;
+            memcpy(sender, start, n);
+            sender[n] = '\0';
+        } else if (field == 4) {
+            timestamp = parseTimestamp(start, length);
+        }
+    }
+
+    messageLength = 0;
+    pendingNewlines = 0;
+    if (pduMode) {
+        inPDU = true;
+        pduHighNibble = true;
+        pduLength = 0;
+    } else {
+        inMessage = true;
+    }
+}
+
+void SMSParser::endPDU() {
+    inPDU = false;
+    previousLineEmpty = false;
+    if (pduLength == 0 || !decoder.decode(pdu, pduLength)) {
+        // Not a PDU after all, the line is dropped
+        return;
+    }
+    messageLength = decoder.getTextLength();
+    timestamp = decoder.getTimestamp();
+    partReference = decoder.getPartReference();
+    partNumber = decoder.getPartNumber();
+    partCount = decoder.getPartCount();
+    emit();
+}
+
+void SMSParser::emit() {
+    message[messageLength] = '\0';
+
+    SMSView view;
+    view.index = index;
+    view.sender = sender;
+    view.message = message;
+    view.messageLength = messageLength;
+    view.timestamp = timestamp;
+    view.status = status;
+    view.partReference = partReference;
+    view.partNumber = partNumber;
+    view.partCount = partCount;
+    view.partIndices = nullptr;
+
+    if (callback != nullptr) {
+        callback(view, context);
+    }
+    count++;
+    inMessage = false;
+}
+
+Time SMSParser::parseTimestamp(const char * timestamp, size_t length) {
+    // yy/MM/dd,hh:mm:ss+zz
+    int values[7] = { 0, 0, 0, 0, 0, 0, 0 };
+    int field = 0;
+    int sign = 1;
+    bool inNumber = false;
+
+    for (size_t i = 0; i < length && field < 7; i++) {
+        char c = timestamp[i];
+        if (c >= '0' && c <= '9') {
+            values[field] = values[field] * 10 + (c - '0');
+            inNumber = true;
+            continue;
+        }
+        if (inNumber) {
+            field++;
+            inNumber = false;
+        }
+        if (field == 6 && c == '-') {
+            sign = -1;
+        }
+    }
+
+    // The offset is given in quarter hours
+    Time time(values[0] + 2000, values[1], values[2], values[3], values[4], values[5]);
+    time.setOffsetMinutes(sign * values[6] * 15);
+    return time;
+}
+
+SMSStatus SMSParser::parseStatus(const char * status, size_t length) {
+    // Text mode reports a string, PDU mode the numeric value 0 to 3
+    static const char * const names[] = { "REC UNREAD", "REC READ", "STO UNSENT", "STO SENT" };
+    for (size_t i = 0; i < 4; i++) {
+        if (strlen(names[i]) == length && strncmp(names[i], status, length) == 0) {
+            return static_cast<SMSStatus>(SMS_STATUS_UNREAD + i);
+        }
+    }
+    if (length == 1 && status[0] >= '0' && status[0] <= '3') {
+        return static_cast<SMSStatus>(SMS_STATUS_UNREAD + (status[0] - '0'));
+    }
+    return SMS_STATUS_UNKNOWN;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file SMSParser.h
+ * @brief Header file for the SMSParser class.
+ */
+
+#ifndef ARDUINO_CELLULAR_SMS_PARSER_H
+#define ARDUINO_CELLULAR_SMS_PARSER_H
+
+#include <Arduino.h>
+#include <TimeUtils.h>
+#include <URCDispatcher.h>
+#include <SMSDecoder.h>
+
+#ifndef ARDUINO_CELLULAR_SMS_MAX_LENGTH
+/**
+ * Maximum number of characters of a single SMS message kept by the parser. Longer messages are truncated.
+ */
+#define ARDUINO_CELLULAR_SMS_MAX_LENGTH 320
+#endif
+
+/**
+ * @enum SMSStatus
+ * @brief The storage status of an SMS message, as reported in the <stat> field of +CMGL and +CMGR.
+ */
+enum SMSStatus {
+    SMS_STATUS_UNKNOWN, /**< The status was not reported. */
+    SMS_STATUS_UNREAD, /**< Received and not yet read ("REC UNREAD"). */
+    SMS_STATUS_READ, /**< Received and read ("REC READ"). */
+    SMS_STATUS_UNSENT, /**< Stored and not yet sent ("STO UNSENT"). */
+    SMS_STATUS_SENT /**< Stored and sent ("STO SENT"). */
+};
+
+/**
+ * @struct SMSView
+ * @brief A lightweight, non-owning view of an SMS message.
+ * The pointers are only valid for the duration of the callback that receives the view.
+ */
+struct SMSView {
+    int16_t index; /**< The index of the SMS message. */
+    const char * sender; /**< The phone number associated with the SMS (null-terminated). */
+    const char * message; /**< The content of the SMS message (null-terminated). */
+    size_t messageLength; /**< The length of the message in bytes. */
+    Time timestamp; /**< The timestamp when the SMS was received. */
+    SMSStatus status; /**< The storage status of the SMS when it was read. */
+    uint16_t partReference; /**< The reference shared by the parts of a concatenated SMS, 0 for a standalone message. */
+    uint8_t partNumber; /**< The position of this part in the concatenated SMS, starting at 1. */
+    uint8_t partCount; /**< The number of parts of the concatenated SMS, 1 for a standalone message. */
+    const int16_t * partIndices; /**< The storage indexes of all parts of a reassembled message (partCount entries), nullptr otherwise. */
+};
+
+/**
+ * @brief Callback invoked for every SMS message as soon as it has been parsed.
+ * @param sms The parsed message.
+ * @param context The user pointer passed when registering the callback.
+ */
+typedef void (*SMSCallback)(const SMSView & sms, void * context);
+
+/**
+ * @class SMSParser
+ * @brief Incremental parser for +CMGL listings and +CMGR reads in text or PDU mode.
+ *
+ * The parser consumes the modem response one character at a time and emits each message
+ * through a callback as soon as it is complete. Its memory use is fixed and bounded by
+ * the size of a single message, independently of the number of messages in the listing.
+ * The mode is recognized from the <stat> field of each header, which PDU mode reports as a number.
+ * PDU lines are decoded into binary as they stream in and never pass through the line window.
+ */
+class SMSParser {
+    public:
+        static constexpr size_t maxLineLength = 128; /**< Size of the window used to classify lines. */
+        static constexpr size_t maxSenderLength = 32; /**< Maximum length of the sender address. */
+        static constexpr size_t maxMessageLength = ARDUINO_CELLULAR_SMS_MAX_LENGTH; /**< Maximum length of a message. */
+        static constexpr size_t maxPDULength = 176; /**< Maximum length of a PDU, SMSC address included. */
+
+        /**
+         * @brief Creates a parser.
+         * @param callback The function called for every parsed message.
+         * @param context A user pointer passed to the callback.
+         */
+        SMSParser(SMSCallback callback, void * context = nullptr);
+
+        /**
+         * @brief Resets the parser so that it can consume a new response.
+         */
+        void reset();
+
+        /**
+         * @brief Sets the index reported for messages read with +CMGR, whose header does not contain it.
+         * @param index The storage index passed to +CMGR.
+         */
+        void setReadIndex(int16_t index) { readIndex = index; }
+
+        /**
+         * @brief Sets the dispatcher that receives URCs interleaved with the response.
+         * Without a dispatcher such lines would be taken as part of a message body.
+         * @param dispatcher The dispatcher, or nullptr.
+         */
+        void setURCDispatcher(URCDispatcher * dispatcher) { urcDispatcher = dispatcher; }
+
+        /**
+         * @brief Consumes one character of the modem response.
+         * @param c The character.
+         * @return True once the final result code (OK or ERROR) has been consumed.
+         */
+        bool feed(char c);
+
+        /**
+         * @brief Checks whether the final result code has been received.
+         * @return True if the response is complete.
+         */
+        bool isDone() const { return done; }
+
+        /**
+         * @brief Checks whether the response ended with OK.
+         * @return True if the listing was successful.
+         */
+        bool succeeded() const { return done && success; }
+
+        /**
+         * @brief Gets the number of messages emitted so far.
+         * @return The number of messages.
+         */
+        size_t getCount() const { return count; }
+
+        /**
+         * @brief Parses an SMS timestamp in the format "yy/MM/dd,hh:mm:ss+zz".
+         * @param timestamp The timestamp characters.
+         * @param length The number of characters.
+         * @return The parsed time.
+         */
+        static Time parseTimestamp(const char * timestamp, size_t length);
+
+        /**
+         * @brief Parses the <stat> field of a +CMGL or +CMGR header, e.g. "REC UNREAD".
+         * @param status The status characters.
+         * @param length The number of characters.
+         * @return The status, or SMS_STATUS_UNKNOWN if it is not recognized.
+         */
+        static SMSStatus parseStatus(const char * status, size_t length);
+
+    private:
+        void endLine();
+        void flushLineToMessage();
+        void parseHeader();
+        void emit();
+        void endPDU();
+
+        SMSCallback callback;
+        void * context;
+        URCDispatcher * urcDispatcher = nullptr;
+        int16_t readIndex = -1;
+
+        char line[maxLineLength + 1];
+        size_t lineLength;
+        bool lineFlushed;
+        bool previousLineEmpty;
+
+        char sender[maxSenderLength + 1];
+        char message[maxMessageLength + 1];
+        size_t messageLength;
+        uint8_t pendingNewlines;
+        int16_t index;
+        Time timestamp;
+        SMSStatus status;
+        uint16_t partReference;
+        uint8_t partNumber;
+        uint8_t partCount;
+
+        SMSDecoder decoder;
+        uint8_t pdu[maxPDULength];
+        size_t pduLength;
+        bool inPDU; /**< True while the hexadecimal PDU line following a PDU mode header is read. */
+        bool pduHighNibble;
+
+        bool inMessage;
+        bool done;
+        bool success;
+        size_t count;
+};
+
+#endif
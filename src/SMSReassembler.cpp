@@ -0,0 +1,136 @@
+#include "SMSReassembler.h"
+
+SMSReassembler::Slot & SMSReassembler::findSlot(const SMSView & sms) {
+    Slot * oldest = nullptr;
+    Slot * free = nullptr;
+    for (Slot & slot : slots) {
+        if (!slot.active) {
+            if (free == nullptr) {
+                free = &slot;
+            }
+            continue;
+        }
+        if (slot.reference == sms.partReference && slot.count == sms.partCount && strcmp(slot.sender, sms.sender) == 0) {
+            return slot;
+        }
+        if (oldest == nullptr || static_cast<long>(slot.updatedAt - oldest->updatedAt) < 0) {
+            oldest = &slot;
+        }
+    }
+
+    Slot * slot = free;
+    if (slot == nullptr) {
+        // The table is full, the message that has waited longest for its parts gives way
+        slot = oldest;
+        evicted++;
+    }
+    strncpy(slot->sender, sms.sender, sizeof(slot->sender) - 1);
+    slot->sender[sizeof(slot->sender) - 1] = '\0';
+    slot->reference = sms.partReference;
+    slot->count = sms.partCount;
+    slot->received = 0;
+    slot->receivedParts = 0;
+    slot->timestamp = sms.timestamp;
+    slot->status = sms.status;
+    slot->used = 0;
+    slot->active = true;
+    return *slot;
+}
+
+void SMSReassembler::add(const SMSView & sms, SMSCallback callback, void * context) {
+    evictStale();
+
+    if (sms.partCount <= 1 || sms.partCount > maxParts || sms.partNumber < 1 || sms.partNumber > sms.partCount) {
+        if (callback != nullptr) {
+            callback(sms, context);
+        }
+        return;
+    }
+
+    Slot & slot = findSlot(sms);
+    size_t part = sms.partNumber - 1;
+    if (slot.receivedParts & (1UL << part)) {
+        // Listed again, e.g. by a second listing of the storage
+        return;
+    }
+
+    size_t length = sms.messageLength;
+    if (length > maxLength - slot.used) {
+        length = maxLength - slot.used;
+    }
+    memcpy(slot.text + slot.used, sms.message, length);
+    slot.offsets[part] = slot.used;
+    slot.lengths[part] = length;
+    slot.indices[part] = sms.index;
+    slot.used += length;
+
+    // The message counts as unread as long as one of its parts is, and is dated by its first part
+    if (sms.status == SMS_STATUS_UNREAD) {
+        slot.status = SMS_STATUS_UNREAD;
+    }
+    if (part == 0) {
+        slot.timestamp = sms.timestamp;
+    }
+    slot.receivedParts |= 1UL << part;
+    slot.received++;
+    slot.updatedAt = millis();
+
+    if (slot.received == slot.count) {
+        emit(slot, callback, context);
+    }
+}
+
+void SMSReassembler::emit(Slot & slot, SMSCallback callback, void * context) {
+    size_t length = 0;
+    for (size_t part = 0; part < slot.count; part++) {
+        memcpy(assembled + length, slot.text + slot.offsets[part], slot.lengths[part]);
+        length += slot.lengths[part];
+    }
+    assembled[length] = '\0';
+    slot.active = false;
+
+    SMSView view;
+    view.index = slot.indices[0];
+    view.sender = slot.sender;
+    view.message = assembled;
+    view.messageLength = length;
+    view.timestamp = slot.timestamp;
+    view.status = slot.status;
+    view.partReference = slot.reference;
+    view.partNumber = 1;
+    view.partCount = slot.count;
+    view.partIndices = slot.indices;
+
+    if (callback != nullptr) {
+        callback(view, context);
+    }
+}
+
+size_t SMSReassembler::evictStale() {
+    size_t count = 0;
+    unsigned long now = millis();
+    for (Slot & slot : slots) {
+        if (slot.active && now - slot.updatedAt >= timeout) {
+            slot.active = false;
+            count++;
+        }
+    }
+    evicted += count;
+    return count;
+}
+
+void SMSReassembler::clear() {
+    for (Slot & slot : slots) {
+        slot.active = false;
+    }
+}
+
+size_t SMSReassembler::getPendingCount() const {
+    size_t count = 0;
+    for (const Slot & slot : slots) {
+        if (slot.active) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file SMSReassembler.h
+ * @brief Header file for the SMSReassembler class.
+ */
+
+#ifndef ARDUINO_CELLULAR_SMS_REASSEMBLER_H
+#define ARDUINO_CELLULAR_SMS_REASSEMBLER_H
+
+#include <Arduino.h>
+#include <SMSParser.h>
+
+#ifndef ARDUINO_CELLULAR_SMS_REASSEMBLY_SLOTS
+/**
+ * Number of concatenated SMS messages that can be reassembled at the same time.
+ */
+#define ARDUINO_CELLULAR_SMS_REASSEMBLY_SLOTS 4
+#endif
+
+#ifndef ARDUINO_CELLULAR_SMS_REASSEMBLY_LENGTH
+/**
+ * Maximum length of a reassembled message in bytes. Longer messages are truncated.
+ */
+#define ARDUINO_CELLULAR_SMS_REASSEMBLY_LENGTH 640
+#endif
+
+#ifndef ARDUINO_CELLULAR_SMS_REASSEMBLY_PARTS
+/**
+ * Maximum number of parts of a reassembled message. Messages with more parts are passed on part by part.
+ */
+#define ARDUINO_CELLULAR_SMS_REASSEMBLY_PARTS 8
+#endif
+
+/**
+ * @class SMSReassembler
+ * @brief Joins the parts of concatenated SMS messages into one message.
+ *
+ * Parts are matched by sender, concatenation reference and number of parts, and may arrive in any order.
+ * Each message being reassembled occupies one slot of a fixed table. When all its parts are there,
+ * the message is passed on with its parts in order and the slot is freed. Slots whose message has not
+ * been completed within the timeout are evicted, as is the oldest slot when a new message finds the table full.
+ * Standalone messages are passed on unchanged.
+ */
+class SMSReassembler {
+    public:
+        static constexpr size_t slotCount = ARDUINO_CELLULAR_SMS_REASSEMBLY_SLOTS; /**< Number of messages reassembled at the same time. */
+        static constexpr size_t maxLength = ARDUINO_CELLULAR_SMS_REASSEMBLY_LENGTH; /**< Maximum length of a reassembled message. */
+        static constexpr size_t maxParts = ARDUINO_CELLULAR_SMS_REASSEMBLY_PARTS; /**< Maximum number of parts of a reassembled message. */
+        static constexpr unsigned long defaultTimeout = 600000UL; /**< Time after which an incomplete message is evicted (In milliseconds). */
+
+        static_assert(slotCount >= 1, "The reassembler needs at least one slot");
+        static_assert(maxParts >= 2 && maxParts <= 32, "A reassembled message has between 2 and 32 parts");
+
+        /**
+         * @brief Adds a received message or part.
+         * @param sms The message. Its partReference, partNumber and partCount fields identify it as part.
+         * @param callback The function the message is passed to once it is complete.
+         * @param context A user pointer passed to the callback.
+         */
+        void add(const SMSView & sms, SMSCallback callback, void * context);
+
+        /**
+         * @brief Evicts the incomplete messages whose last part arrived longer than the timeout ago.
+         * @return The number of evicted messages.
+         */
+        size_t evictStale();
+
+        /**
+         * @brief Sets the time after which an incomplete message is evicted.
+         * @param timeout The timeout (In milliseconds).
+         */
+        void setTimeout(unsigned long timeout) { this->timeout = timeout; }
+
+        /**
+         * @brief Discards all incomplete messages.
+         */
+        void clear();
+
+        /**
+         * @brief Gets the number of incomplete messages.
+         * @return The number of occupied slots.
+         */
+        size_t getPendingCount() const;
+
+        /**
+         * @brief Gets the number of incomplete messages that were evicted.
+         * @return The number of evictions since the reassembler was created.
+         */
+        uint32_t getEvictedCount() const { return evicted; }
+
+    private:
+        struct Slot {
+            char sender[SMSParser::maxSenderLength + 1];
+            uint16_t reference;
+            uint8_t count;
+            uint8_t received;
+            uint32_t receivedParts; /**< One bit per part. */
+            int16_t indices[maxParts];
+            uint16_t offsets[maxParts];
+            uint16_t lengths[maxParts];
+            Time timestamp;
+            SMSStatus status;
+            size_t used;
+            unsigned long updatedAt;
+            bool active = false;
+            char text[maxLength];
+        };
+
+        Slot & findSlot(const SMSView & sms);
+        void emit(Slot & slot, SMSCallback callback, void * context);
+
+        Slot slots[slotCount];
+        char assembled[maxLength + 1];
+        unsigned long timeout = defaultTimeout;
+        uint32_t evicted = 0;
+};
+
+#endif
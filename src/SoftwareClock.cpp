@@ -0,0 +1,50 @@
+#include "SoftwareClock.h"
+
+uint64_t SoftwareClock::elapsedSinceSync(unsigned long atMillis) const {
+    uint64_t elapsed = static_cast<unsigned long>(atMillis - syncedAt);
+    int64_t correction = static_cast<int64_t>(elapsed) * drift / 1000000;
+    return elapsed + correction;
+}
+
+uint32_t SoftwareClock::now() const {
+    if (!synced) {
+        return 0;
+    }
+    uint64_t time = baseTime + elapsedSinceSync(millis());
+    if (time < floorTime) {
+        time = floorTime;
+    }
+    return static_cast<uint32_t>(time / 1000);
+}
+
+void SoftwareClock::sync(uint32_t unixTime, unsigned long atMillis) {
+    uint64_t time = static_cast<uint64_t>(unixTime) * 1000;
+
+    if (synced) {
+        unsigned long interval = atMillis - syncedAt;
+        uint64_t extrapolated = baseTime + elapsedSinceSync(atMillis);
+
+        // The source has a resolution of one second, only long intervals give a meaningful estimate
+        if (interval >= minDriftInterval) {
+            int64_t error = static_cast<int64_t>(time) - static_cast<int64_t>(baseTime + interval);
+            int32_t measured = static_cast<int32_t>(error * 1000000 / static_cast<int64_t>(interval));
+            if (measured > maxDrift) {
+                measured = maxDrift;
+            } else if (measured < -maxDrift) {
+                measured = -maxDrift;
+            }
+            drift = (drift + measured) / 2;
+        }
+
+        if (extrapolated > time && extrapolated - time <= maxBackwardStep) {
+            floorTime = extrapolated;
+        } else if (extrapolated > time) {
+            // A step this large corrects a wrong time rather than the drift, follow the source
+            floorTime = 0;
+        }
+    }
+
+    baseTime = time;
+    syncedAt = atMillis;
+    synced = true;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file SoftwareClock.h
+ * @brief Header file for the SoftwareClock class.
+ */
+
+#ifndef ARDUINO_CELLULAR_SOFTWARE_CLOCK_H
+#define ARDUINO_CELLULAR_SOFTWARE_CLOCK_H
+
+#include <Arduino.h>
+
+/**
+ * @class SoftwareClock
+ * @brief A UTC clock that is set from an external time source and extrapolated with millis().
+ *
+ * Reading the clock is O(1) and never talks to the modem. Every sync compares the extrapolated
+ * time with the source and estimates the drift of the local oscillator, which is then compensated.
+ * The clock does not go backwards: if a sync moves it back by up to maxBackwardStep, it holds its value
+ * until the new time catches up. Larger steps are taken as corrections of a wrong time and applied.
+ * The clock has to be synced at least once every 49 days, the wrap-around period of millis().
+ */
+class SoftwareClock {
+    public:
+        static constexpr int32_t maxDrift = 500; /**< Largest accepted drift estimate (In parts per million). */
+        static constexpr uint64_t maxBackwardStep = 60000; /**< Largest backward correction that is absorbed by holding the clock (In milliseconds). */
+        static constexpr unsigned long minDriftInterval = 3600000UL; /**< Shortest sync interval used to estimate the drift (In milliseconds). */
+
+        /**
+         * @brief Sets the clock.
+         * @param unixTime The current UTC time as UNIX timestamp.
+         * @param atMillis The millis() value at which unixTime was valid.
+         */
+        void sync(uint32_t unixTime, unsigned long atMillis);
+
+        /**
+         * @brief Sets the clock to the given time, valid now.
+         * @param unixTime The current UTC time as UNIX timestamp.
+         */
+        void sync(uint32_t unixTime) { sync(unixTime, millis()); }
+
+        /**
+         * @brief Checks whether the clock has been set.
+         * @return True after the first sync.
+         */
+        bool isSynced() const { return synced; }
+
+        /**
+         * @brief Gets the current UTC time.
+         * @return The UNIX timestamp, or 0 if the clock has never been synced.
+         */
+        uint32_t now() const;
+
+        /**
+         * @brief Gets the time elapsed since the last sync.
+         * @return The age of the last sync (In milliseconds).
+         */
+        unsigned long getSyncAge() const { return millis() - syncedAt; }
+
+        /**
+         * @brief Gets the estimated drift of millis().
+         * @return The drift (In parts per million). Positive if millis() runs slow.
+         */
+        int32_t getDrift() const { return drift; }
+
+    private:
+        uint64_t elapsedSinceSync(unsigned long atMillis) const;
+
+        uint64_t baseTime = 0; /**< UTC time of the last sync (In milliseconds since the epoch). */
+        uint64_t floorTime = 0; /**< Value the clock does not go below, in milliseconds since the epoch. */
+        unsigned long syncedAt = 0; /**< millis() value of the last sync. */
+        int32_t drift = 0;
+        bool synced = false;
+};
+
+#endif
@@ -1,14 +1,31 @@
+#ifndef ARDUINO_CELLULAR_TIME_UTILS_H
+#define ARDUINO_CELLULAR_TIME_UTILS_H
+
 #include <Arduino.h>
 
 /**
  * @class Time
  * @brief Represents a point in time with year, month, day, hour, minute, second, and offset.
- * 
+ *
  * The Time class provides methods to manipulate and retrieve information about a specific point in time.
  * It supports conversion to and from ISO8601 format and UNIX timestamp.
+ * The components are the local time, the offset tells how far the local time is ahead of UTC.
+ * All conversions are exact for the proleptic Gregorian calendar and do not allocate memory.
  */
 class Time {
     public:
+        /**
+         * @struct CivilDate
+         * @brief A calendar date.
+         */
+        struct CivilDate {
+            int year; /**< The year. */
+            int month; /**< The month, from 1 to 12. */
+            int day; /**< The day of the month, from 1 to 31. */
+        };
+
+        static constexpr size_t ISO8601Length = 25; /**< Length of an ISO8601 string, e.g. "2024-04-17T09:58:09+02:00". */
+
         /**
          * Constructor for Time class.
          * Initializes the year, month, day, hour, minute, second, and offset to zero.
@@ -21,13 +38,7 @@ class Time {
          * @param offset The timezone offset in hours (default is 0).
          */
         Time(int year, int month, int day, int hour, int minute, int second, int offset = 0) {
-            this->year = year;
-            this->month = month;
-            this->day = day;
-            this->hour = hour;
-            this->minute = minute;
-            this->second = second;
-            this->offset = offset;
+            fromComponents(year, month, day, hour, minute, second, offset);
         }
 
         /**
@@ -38,20 +49,55 @@ class Time {
 
         }
 
+        /**
+         * Returns the number of days from 1970-01-01 to the given date.
+         * @param year The year.
+         * @param month The month, from 1 to 12.
+         * @param day The day of the month.
+         * @return The number of days, negative for dates before 1970.
+         */
+        static constexpr long daysFromCivil(int year, int month, int day) {
+            // Shift the year to start in March, so that the leap day is the last day of the year
+            year -= month <= 2 ? 1 : 0;
+            const long era = (year >= 0 ? year : year - 399) / 400;
+            const unsigned long yearOfEra = static_cast<unsigned long>(year - era * 400);
+            const unsigned long dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+            const unsigned long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+            return era * 146097 + static_cast<long>(dayOfEra) - 719468;
+        }
+
+        /**
+         * Returns the date that is the given number of days after 1970-01-01.
+         * @param days The number of days, negative for dates before 1970.
+         * @return The date.
+         */
+        static constexpr CivilDate civilFromDays(long days) {
+            days += 719468;
+            const long era = (days >= 0 ? days : days - 146096) / 146097;
+            const unsigned long dayOfEra = static_cast<unsigned long>(days - era * 146097);
+            const unsigned long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+            const unsigned long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+            const unsigned long shiftedMonth = (5 * dayOfYear + 2) / 153;
+            const int day = static_cast<int>(dayOfYear - (153 * shiftedMonth + 2) / 5 + 1);
+            const int month = static_cast<int>(shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9);
+            const int year = static_cast<int>(static_cast<long>(yearOfEra) + era * 400) + (month <= 2 ? 1 : 0);
+            return CivilDate{ year, month, day };
+        }
+
         /**
          * Parses an ISO8601 formatted string and sets the time components accordingly.
          * @param ISO8601 The ISO8601 formatted string to parse.
          */
-        void fromISO8601(String ISO8601) {
-            parseISO8601(ISO8601);
+        void fromISO8601(const String & ISO8601) {
+            parseISO8601(ISO8601.c_str());
         }
 
         /**
          * Parses a UNIX timestamp and sets the time components accordingly.
          * @param UNIXTimestamp The UNIX timestamp to parse.
          */
-        void fromUNIXTimestamp(String UNIXTimestamp) {
-            parseUNIXTimestamp(UNIXTimestamp.toInt());
+        void fromUNIXTimestamp(const String & UNIXTimestamp) {
+            parseUNIXTimestamp(strtoll(UNIXTimestamp.c_str(), nullptr, 10));
         }
 
         /**
@@ -71,7 +117,7 @@ class Time {
             this->hour = hour;
             this->minute = minute;
             this->second = second;
-            this->offset = offset;
+            this->offset = offset * 60;
         }
 
 
@@ -80,63 +126,153 @@ class Time {
          * Returns the time in ISO8601 format.
          * @return The time in ISO8601 format.
          */
-        String getISO8601() {
-            char buffer[25];
-            sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d%+03d:00", year, month, day, hour, minute, second, offset);
+        String getISO8601() const {
+            char buffer[ISO8601Length + 1];
+            formatISO8601(buffer, sizeof(buffer));
             return String(buffer);
         }
 
+        /**
+         * Writes the time in ISO8601 format, e.g. "2024-04-17T09:58:09+02:00", into a buffer.
+         * @param buffer The buffer, at least ISO8601Length + 1 bytes long.
+         * @param size The size of the buffer.
+         * @return The length of the string, or 0 if the buffer is too small.
+         */
+        size_t formatISO8601(char * buffer, size_t size) const {
+            if (size < ISO8601Length + 1) {
+                if (size > 0) {
+                    buffer[0] = '\0';
+                }
+                return 0;
+            }
+            int absoluteOffset = offset < 0 ? -offset : offset;
+            char * cursor = buffer;
+            cursor = formatNumber(cursor, year, 4);
+            *cursor++ = '-';
+            cursor = formatNumber(cursor, month, 2);
+            *cursor++ = '-';
+            cursor = formatNumber(cursor, day, 2);
+            *cursor++ = 'T';
+            cursor = formatNumber(cursor, hour, 2);
+            *cursor++ = ':';
+            cursor = formatNumber(cursor, minute, 2);
+            *cursor++ = ':';
+            cursor = formatNumber(cursor, second, 2);
+            *cursor++ = offset < 0 ? '-' : '+';
+            cursor = formatNumber(cursor, absoluteOffset / 60, 2);
+            *cursor++ = ':';
+            cursor = formatNumber(cursor, absoluteOffset % 60, 2);
+            *cursor = '\0';
+            return cursor - buffer;
+        }
+
         /**
          * Returns the time in UNIX timestamp format.
          * @return The time in UNIX timestamp format.
          */
-        String getUNIXTimestampString() {
-            // Simple conversion to UNIX timestamp, not accounting for leap years or time zones
-            long timestamp = second + minute*60 + hour*3600 + day*86400 + (month-1)*2629743 + (year-1970)*31556926;
-            return String(timestamp);
+        String getUNIXTimestampString() const {
+            return String(getUNIXTimestamp());
         }
 
         /**
          * Returns the time in UNIX timestamp format.
-         * @return The time in UNIX timestamp format.
+         * @return The number of seconds since 1970-01-01T00:00:00Z.
+         */
+        unsigned long getUNIXTimestamp() const {
+            // 64 bit arithmetic, the seconds after 2038 do not fit into a signed 32 bit long
+            return static_cast<unsigned long>(static_cast<int64_t>(daysFromCivil(year, month, day)) * 86400
+                                              + hour * 3600L + minute * 60L + second - offset * 60L);
+        }
+
+        /**
+         * Parses an ISO8601 string such as "2024-04-17T09:58:09+02:00", "2024-04-17T07:58:09Z" or
+         * "2024-04-17T09:58:09.123+0200" and sets the time components accordingly.
+         * Fractional seconds are ignored, a missing offset means UTC.
+         * @param iso8601 The ISO8601 formatted string to parse.
+         * @return True if the string is a valid ISO8601 date and time.
          */
-        unsigned long getUNIXTimestamp() {
-            // Simple conversion to UNIX timestamp, not accounting for leap years or time zones
-            unsigned long timestamp = second + minute*60 + hour*3600 + day*86400 + (month-1)*2629743 + (year-1970)*31556926;
-            return timestamp;
+        bool parseISO8601(const char * iso8601) {
+            const char * cursor = iso8601;
+            int values[6];
+            static const char separators[] = { '-', '-', 'T', ':', ':' };
+
+            for (int i = 0; i < 6; i++) {
+                if (!parseNumber(cursor, i == 0 ? 4 : 2, values[i])) {
+                    return false;
+                }
+                if (i < 5) {
+                    if (*cursor != separators[i] && !(i == 2 && *cursor == ' ')) {
+                        return false;
+                    }
+                    cursor++;
+                }
+            }
+
+            if (*cursor == '.') {
+                do {
+                    cursor++;
+                } while (*cursor >= '0' && *cursor <= '9');
+            }
+
+            int offsetMinutes = 0;
+            if (*cursor == '+' || *cursor == '-') {
+                int sign = *cursor++ == '-' ? -1 : 1;
+                int hours = 0;
+                int minutes = 0;
+                if (!parseNumber(cursor, 2, hours)) {
+                    return false;
+                }
+                if (*cursor == ':') {
+                    cursor++;
+                }
+                if (*cursor != '\0' && !parseNumber(cursor, 2, minutes)) {
+                    return false;
+                }
+                offsetMinutes = sign * (hours * 60 + minutes);
+            } else if (*cursor == 'Z') {
+                cursor++;
+            }
+
+            if (*cursor != '\0') {
+                return false;
+            }
+
+            fromComponents(values[0], values[1], values[2], values[3], values[4], values[5]);
+            offset = offsetMinutes;
+            return true;
         }
 
         /**
-         * Returns the year component of the time.\
-         * @param iso8601 The ISO8601 formatted string to parse. 
+         * Parses an ISO8601 formatted string and sets the time components accordingly.
+         * @param iso8601 The ISO8601 formatted string to parse.
+         * @return True if the string is a valid ISO8601 date and time.
          */
-        void parseISO8601(String iso8601) {
-            // Simplified parsing, assuming format "YYYY-MM-DDTHH:MM:SS+00:00"
-            year = iso8601.substring(0, 4).toInt();
-            month = iso8601.substring(5, 7).toInt();
-            day = iso8601.substring(8, 10).toInt();
-            hour = iso8601.substring(11, 13).toInt();
-            minute = iso8601.substring(14, 16).toInt();
-            second = iso8601.substring(17, 19).toInt();
-            // This does not parse the timezone offset correctly, just a placeholder
-            offset = 0;
-            // TODO: don't use substrings, use index of comma, dash etc
+        bool parseISO8601(const String & iso8601) {
+            return parseISO8601(iso8601.c_str());
         }
-        
+
         /**
          * Parses a UNIX timestamp and sets the time components accordingly.
          * @param unixTimestamp The UNIX timestamp to parse.
+         * @param offsetMinutes The timezone offset of the resulting local time in minutes (default is 0, UTC).
          */
-        void parseUNIXTimestamp(long unixTimestamp) {
-            // Simplified conversion, not accounting for leap years or time zones
-            second = unixTimestamp % 60;
-            minute = (unixTimestamp / 60) % 60;
-            hour = (unixTimestamp / 3600) % 24;
-            day = (unixTimestamp / 86400) % 30; // Simplification
-            month = (unixTimestamp / 2629743) % 12 + 1; // Approximation
-            year = (unixTimestamp / 31556926) + 1970; // Approximation
-            // This does not set the timezone offset, as UNIX timestamp is typically considered UTC
-            offset = 0;
+        void parseUNIXTimestamp(int64_t unixTimestamp, int offsetMinutes = 0) {
+            int64_t local = unixTimestamp + offsetMinutes * 60L;
+            long days = static_cast<long>(local / 86400);
+            long secondOfDay = static_cast<long>(local % 86400);
+            if (secondOfDay < 0) {
+                secondOfDay += 86400;
+                days--;
+            }
+
+            CivilDate date = civilFromDays(days);
+            year = date.year;
+            month = date.month;
+            day = date.day;
+            hour = secondOfDay / 3600;
+            minute = (secondOfDay / 60) % 60;
+            second = secondOfDay % 60;
+            offset = offsetMinutes;
         }
 
         /**
@@ -144,7 +280,7 @@ class Time {
          * @param year The year component of the time.
          */
         void setYear(int year) { this->year = year; }
-        
+
         /**
          * Sets the month component of the time.
          * @param month The month component of the time.
@@ -177,52 +313,95 @@ class Time {
 
         /**
          * Sets the timezone offset of the time.
-         * @param offset The timezone offset of the time.
+         * @param offset The timezone offset of the time in hours.
          */
-        void setOffset(int offset) { this->offset = offset; }
+        void setOffset(int offset) { this->offset = offset * 60; }
+
+        /**
+         * Sets the timezone offset of the time with minute precision, e.g. for +05:45.
+         * @param offset The timezone offset of the time in minutes.
+         */
+        void setOffsetMinutes(int offset) { this->offset = offset; }
 
         /**
          * Returns the year component of the time.
          * @return The year component of the time.
          */
-        int getYear() { return year; }
+        int getYear() const { return year; }
 
         /**
          * Returns the month component of the time.
          * @return The month component of the time.
          */
-        int getMonth() { return month; }
+        int getMonth() const { return month; }
 
         /**
          * Returns the day component of the time.
          * @return The day component of the time.
          */
-        int getDay() { return day; }
+        int getDay() const { return day; }
 
         /**
          * Returns the hour component of the time.
          * @return The hour component of the time.
          */
-        int getHour() { return hour; }
+        int getHour() const { return hour; }
 
         /**
          * Returns the minute component of the time.
          * @return The minute component of the time.
          */
-        int getMinute() { return minute; }
+        int getMinute() const { return minute; }
 
         /**
          * Returns the second component of the time.
          * @return The second component of the time.
          */
-        int getSecond() { return second; }
+        int getSecond() const { return second; }
 
         /**
          * Returns the timezone offset of the time.
-         * @return The timezone offset of the time.
+         * @return The timezone offset of the time in whole hours.
+         */
+        int getOffset() const { return offset / 60; }
+
+        /**
+         * Returns the timezone offset of the time with minute precision.
+         * @return The timezone offset of the time in minutes.
          */
-        int getOffset() { return offset; }
+        int getOffsetMinutes() const { return offset; }
 
 private:
-    int year, month, day, hour, minute, second, offset;
-};
\ No newline at end of file
+    static char * formatNumber(char * cursor, int value, int digits) {
+        if (value < 0) {
+            value = 0;
+        }
+        for (int i = digits - 1; i >= 0; i--) {
+            cursor[i] = '0' + value % 10;
+            value /= 10;
+        }
+        return cursor + digits;
+    }
+
+    static bool parseNumber(const char *& cursor, int digits, int & value) {
+        value = 0;
+        for (int i = 0; i < digits; i++) {
+            if (cursor[i] < '0' || cursor[i] > '9') {
+                return false;
+            }
+            value = value * 10 + (cursor[i] - '0');
+        }
+        cursor += digits;
+        return true;
+    }
+
+    int year = 1970, month = 1, day = 1, hour = 0, minute = 0, second = 0;
+    int offset = 0; /**< The timezone offset in minutes. */
+};
+
+static_assert(Time::daysFromCivil(1970, 1, 1) == 0, "Wrong epoch");
+static_assert(Time::daysFromCivil(2000, 3, 1) == 11017, "Wrong leap year handling");
+static_assert(Time::daysFromCivil(2100, 12, 31) == 47846, "Wrong century handling");
+static_assert(Time::civilFromDays(11016).month == 2 && Time::civilFromDays(11016).day == 29, "Wrong leap day");
+
+#endif
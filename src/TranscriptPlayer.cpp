@@ -0,0 +1,173 @@
+#include "TranscriptPlayer.h"
+
+namespace {
+
+int hexValue(int c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return 0;
+}
+
+}
+
+TranscriptPlayer::TranscriptPlayer(Stream & transcript) : source(&transcript) {
+}
+
+TranscriptPlayer::TranscriptPlayer(const char * transcript) : text(transcript) {
+}
+
+int TranscriptPlayer::nextTranscriptChar() {
+    if (source != nullptr) {
+        return source->read();
+    }
+    if (*text == '\0') {
+        return -1;
+    }
+    return static_cast<uint8_t>(*text++);
+}
+
+bool TranscriptPlayer::loadRecord() {
+    // <direction> <delta> <escaped data>\n, blank and malformed lines are skipped
+    int c;
+    do {
+        c = nextTranscriptChar();
+        if (c < 0) {
+            return false;
+        }
+    } while (c != '>' && c != '<');
+    direction = static_cast<char>(c);
+
+    nextTranscriptChar();
+    gap = 0;
+    while ((c = nextTranscriptChar()) >= '0' && c <= '9') {
+        gap = gap * 10 + (c - '0');
+    }
+
+    length = 0;
+    position = 0;
+    while ((c = nextTranscriptChar()) >= 0 && c != '\n') {
+        if (c == '\\') {
+            c = nextTranscriptChar();
+            if (c == 'r') {
+                c = '\r';
+            } else if (c == 'n') {
+                c = '\n';
+            } else if (c == 'x') {
+                int high = hexValue(nextTranscriptChar());
+                c = high << 4 | hexValue(nextTranscriptChar());
+            }
+        }
+        if (length < sizeof(data)) {
+            data[length++] = static_cast<uint8_t>(c);
+        }
+    }
+    return length > 0;
+}
+
+void TranscriptPlayer::ensureLoaded() {
+    if (!anchored) {
+        // The first record is timed from the first use of the player
+        anchor = micros();
+        anchored = true;
+    }
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+    if (!loadRecord()) {
+        direction = 0;
+        return;
+    }
+    recordNumber++;
+
+    if (direction == '>' && pendingCount > 0) {
+        // Match the bytes the library wrote while the previous response was being played
+        uint8_t pending[maxPendingWrites];
+        size_t count = pendingCount;
+        memcpy(pending, pendingWrites, count);
+        pendingCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            write(pending[i]);
+        }
+    }
+}
+
+unsigned long TranscriptPlayer::getWaitTime() const {
+    return speed > 0.0f ? static_cast<unsigned long>(gap / speed) : 0;
+}
+
+bool TranscriptPlayer::isReleased() {
+    return micros() - anchor >= getWaitTime();
+}
+
+void TranscriptPlayer::finishRecord(unsigned long playedAt) {
+    anchor = playedAt;
+    loaded = false;
+}
+
+bool TranscriptPlayer::isFinished() {
+    ensureLoaded();
+    return direction == 0;
+}
+
+int TranscriptPlayer::available() {
+    ensureLoaded();
+    if (direction != '<' || !isReleased()) {
+        return 0;
+    }
+    return length - position;
+}
+
+int TranscriptPlayer::read() {
+    if (available() <= 0) {
+        return -1;
+    }
+    uint8_t c = data[position++];
+    if (position == length) {
+        // The next record is timed from the moment this response was complete, not from when it was read
+        finishRecord(anchor + getWaitTime());
+    }
+    return c;
+}
+
+int TranscriptPlayer::peek() {
+    if (available() <= 0) {
+        return -1;
+    }
+    return data[position];
+}
+
+size_t TranscriptPlayer::write(uint8_t c) {
+    ensureLoaded();
+    if (direction == '>') {
+        compare(c);
+        if (position == length) {
+            finishRecord(micros());
+        }
+    } else if (direction == '<' && pendingCount < maxPendingWrites) {
+        pendingWrites[pendingCount++] = c;
+    } else {
+        // Written after the end of the transcript, or too far ahead of it
+        mismatches++;
+        if (firstMismatchRecord == 0) {
+            firstMismatchRecord = recordNumber;
+        }
+    }
+    return 1;
+}
+
+void TranscriptPlayer::compare(uint8_t c) {
+    if (data[position++] != c) {
+        mismatches++;
+        if (firstMismatchRecord == 0) {
+            firstMismatchRecord = recordNumber;
+        }
+    }
+}
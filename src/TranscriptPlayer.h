@@ -0,0 +1,108 @@
+/**
+ * @file TranscriptPlayer.h
+ * @brief Header file for the TranscriptPlayer class.
+ */
+
+#ifndef ARDUINO_CELLULAR_TRANSCRIPT_PLAYER_H
+#define ARDUINO_CELLULAR_TRANSCRIPT_PLAYER_H
+
+#include <Arduino.h>
+#include <TranscriptRecorder.h>
+
+/**
+ * @class TranscriptPlayer
+ * @brief A Stream that plays the part of the modem in a transcript written by a TranscriptRecorder.
+ *
+ * Pass the player to a ModemInterface (with a power pin of -1) and run the code that produced the transcript.
+ * The recorded responses become readable with their recorded timing, scaled by the speed, and the bytes
+ * written by the library are compared with the recorded ones. The timing of a response is relative to
+ * the end of the command before it, so that a library that is faster or slower than the recorded one
+ * still sees the responses in the right order.
+ *
+ * Records are read one at a time, from a Stream (e.g. a File) or from a string in memory.
+ */
+class TranscriptPlayer : public Stream {
+    public:
+        static constexpr size_t maxPendingWrites = 64; /**< Bytes the library may write ahead of the transcript. */
+
+        /**
+         * @brief Creates a player reading the transcript from a stream.
+         * @param transcript The stream the transcript is read from.
+         */
+        explicit TranscriptPlayer(Stream & transcript);
+
+        /**
+         * @brief Creates a player reading the transcript from memory.
+         * @param transcript The transcript, must stay valid while the player is in use.
+         */
+        explicit TranscriptPlayer(const char * transcript);
+
+        /**
+         * @brief Sets the replay speed.
+         * @param speed 1 for the recorded timing, 10 for ten times faster, 0 to deliver responses without delay.
+         */
+        void setSpeed(float speed) { this->speed = speed; }
+
+        /**
+         * @brief Checks if all records have been played.
+         * @return True at the end of the transcript.
+         */
+        bool isFinished();
+
+        /**
+         * @brief Gets the number of the record being played, counted from 1.
+         * @return The record number.
+         */
+        uint32_t getRecordNumber() const { return recordNumber; }
+
+        /**
+         * @brief Gets the number of written bytes that differ from the transcript.
+         * @return The number of mismatching bytes.
+         */
+        uint32_t getMismatchCount() const { return mismatches; }
+
+        /**
+         * @brief Gets the number of the first record whose written bytes differ from the transcript.
+         * @return The record number, 0 if all written bytes matched.
+         */
+        uint32_t getFirstMismatchRecord() const { return firstMismatchRecord; }
+
+        int available() override;
+        int read() override;
+        int peek() override;
+        size_t write(uint8_t c) override;
+        using Print::write;
+        void flush() override {}
+
+    private:
+        int nextTranscriptChar();
+        bool loadRecord();
+        void ensureLoaded();
+        void finishRecord(unsigned long playedAt);
+        unsigned long getWaitTime() const;
+        bool isReleased();
+        void compare(uint8_t c);
+
+        Stream * source = nullptr;
+        const char * text = nullptr;
+
+        char direction = 0; /**< The direction of the current record, 0 at the end of the transcript. */
+        uint8_t data[TranscriptRecorder::maxRecordLength];
+        size_t length = 0;
+        size_t position = 0;
+        unsigned long gap = 0; /**< The recorded time between the previous record and the current one (In microseconds). */
+        bool loaded = false; /**< True once the current record has been read from the transcript. */
+
+        float speed = 1.0f;
+        unsigned long anchor = 0; /**< When the previous record was played (In microseconds). */
+        bool anchored = false;
+
+        uint8_t pendingWrites[maxPendingWrites]; /**< Bytes written while a response was being played. */
+        size_t pendingCount = 0;
+
+        uint32_t recordNumber = 0;
+        uint32_t mismatches = 0;
+        uint32_t firstMismatchRecord = 0;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "TranscriptRecorder.h"
+
+TranscriptRecorder::TranscriptRecorder(Stream & modem, Print & transcript) : modem(modem), transcript(transcript) {
+}
+
+void TranscriptRecorder::setEnabled(bool enabled) {
+    if (!enabled) {
+        writeRecord();
+    }
+    this->enabled = enabled;
+}
+
+int TranscriptRecorder::available() {
+    return modem.available();
+}
+
+int TranscriptRecorder::read() {
+    int c = modem.read();
+    if (c >= 0) {
+        append('<', static_cast<uint8_t>(c));
+    }
+    return c;
+}
+
+int TranscriptRecorder::peek() {
+    return modem.peek();
+}
+
+size_t TranscriptRecorder::write(uint8_t c) {
+    append('>', c);
+    return modem.write(c);
+}
+
+size_t TranscriptRecorder::write(const uint8_t * buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        append('>', buffer[i]);
+    }
+    return modem.write(buffer, size);
+}
+
+void TranscriptRecorder::flush() {
+    writeRecord();
+    modem.flush();
+}
+
+void TranscriptRecorder::append(char direction, uint8_t c) {
+    if (!enabled) {
+        return;
+    }
+    if (length > 0 && direction != this->direction) {
+        writeRecord();
+    }
+    if (length == 0) {
+        this->direction = direction;
+        recordStartedAt = micros();
+    }
+    data[length++] = c;
+    if (c == '\n' || length == maxRecordLength) {
+        writeRecord();
+    }
+}
+
+void TranscriptRecorder::writeRecord() {
+    if (length == 0) {
+        return;
+    }
+
+    // Deltas keep the records short and do not wrap with micros()
+    unsigned long delta = started ? recordStartedAt - previousRecordAt : 0;
+    previousRecordAt = recordStartedAt;
+    started = true;
+
+    static const char hexDigits[] = "0123456789ABCDEF";
+    char line[maxRecordLength * 4 + 16];
+    size_t used = snprintf(line, sizeof(line), "%c %lu ", direction, delta);
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+        if (c == '\r' || c == '\n' || c == '\\') {
+            line[used++] = '\\';
+            line[used++] = c == '\r' ? 'r' : c == '\n' ? 'n' : '\\';
+        } else if (c < 0x20 || c >= 0x7F) {
+            line[used++] = '\\';
+            line[used++] = 'x';
+            line[used++] = hexDigits[c >> 4];
+            line[used++] = hexDigits[c & 0x0F];
+        } else {
+            line[used++] = c;
+        }
+    }
+    line[used++] = '\n';
+    transcript.write(reinterpret_cast<const uint8_t *>(line), used);
+
+    length = 0;
+    recordCount++;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file TranscriptRecorder.h
+ * @brief Header file for the TranscriptRecorder class.
+ */
+
+#ifndef ARDUINO_CELLULAR_TRANSCRIPT_RECORDER_H
+#define ARDUINO_CELLULAR_TRANSCRIPT_RECORDER_H
+
+#include <Arduino.h>
+
+/**
+ * @class TranscriptRecorder
+ * @brief A Stream that sits between the library and the modem and records all traffic as a transcript.
+ *
+ * The transcript is line based, one record per line:
+ *
+ *     <direction> <microseconds since the previous record> <data>
+ *
+ * The direction is '>' for bytes written to the modem and '<' for bytes read from it. The data is escaped:
+ * "\r", "\n" and "\\" stand for CR, LF and the backslash, "\xHH" for any other byte outside of printable ASCII.
+ * A record ends with every line feed, when the direction changes, when it is full, and on flush().
+ * Received bytes are timestamped when the library reads them.
+ *
+ * Pass the recorder to a ModemInterface instead of the modem UART. The transcript can be written to any Print,
+ * e.g. a File or a second serial port, and be fed back into the library with a TranscriptPlayer.
+ */
+class TranscriptRecorder : public Stream {
+    public:
+        static constexpr size_t maxRecordLength = 64; /**< Maximum number of bytes of a record. */
+
+        /**
+         * @brief Creates a recorder.
+         * @param modem The stream connected to the modem.
+         * @param transcript Where the transcript is written.
+         */
+        TranscriptRecorder(Stream & modem, Print & transcript);
+
+        /**
+         * @brief Pauses or resumes recording. The traffic is passed through while paused.
+         * @param enabled True to record.
+         */
+        void setEnabled(bool enabled);
+
+        /**
+         * @brief Gets the number of records written.
+         * @return The number of records.
+         */
+        uint32_t getRecordCount() const { return recordCount; }
+
+        int available() override;
+        int read() override;
+        int peek() override;
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t * buffer, size_t size) override;
+        using Print::write;
+        void flush() override;
+
+    private:
+        void append(char direction, uint8_t c);
+        void writeRecord();
+
+        Stream & modem;
+        Print & transcript;
+        bool enabled = true;
+
+        char direction = 0; /**< The direction of the buffered record, 0 if none. */
+        uint8_t data[maxRecordLength];
+        size_t length = 0;
+        unsigned long recordStartedAt = 0; /**< When the first byte of the buffered record passed (In microseconds). */
+        unsigned long previousRecordAt = 0; /**< When the first byte of the last written record passed (In microseconds). */
+        bool started = false; /**< True once the first record has been written. */
+        uint32_t recordCount = 0;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "URCDispatcher.h"
+
+bool URCDispatcher::on(const char * prefix, URCCallback callback, void * context) {
+    if (handlerCount >= maxHandlers) {
+        return false;
+    }
+    handlers[handlerCount++] = { prefix, callback, context };
+    return true;
+}
+
+const URCDispatcher::Handler * URCDispatcher::findHandler(const char * line) const {
+    for (size_t i = 0; i < handlerCount; i++) {
+        if (strncmp(line, handlers[i].prefix, strlen(handlers[i].prefix)) == 0) {
+            return &handlers[i];
+        }
+    }
+    return nullptr;
+}
+
+bool URCDispatcher::accepts(const char * line, const char * runningCommand) const {
+    const Handler * handler = findHandler(line);
+    if (handler == nullptr) {
+        return false;
+    }
+    if (runningCommand != nullptr) {
+        // "+CUSD:" answers "+CUSD=...", compare the names without the colon
+        size_t nameLength = strcspn(handler->prefix, ":");
+        if (strncmp(runningCommand, handler->prefix, nameLength) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool URCDispatcher::push(const char * urc) {
+    uint8_t currentHead = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    uint8_t nextHead = (currentHead + 1) % queueLength;
+    if (nextHead == __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&dropped, dropped + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    strncpy(queue[currentHead], urc, maxURCLength);
+    queue[currentHead][maxURCLength] = '\0';
+    // Publish the slot only once its content is complete
+    __atomic_store_n(&head, nextHead, __ATOMIC_RELEASE);
+    return true;
+}
+
+size_t URCDispatcher::dispatch() {
+    size_t dispatched = 0;
+    uint8_t currentTail = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+
+    while (currentTail != __atomic_load_n(&head, __ATOMIC_ACQUIRE)) {
+        const char * urc = queue[currentTail];
+        const Handler * handler = findHandler(urc);
+        if (handler != nullptr) {
+            handler->callback(urc, handler->context);
+        }
+        currentTail = (currentTail + 1) % queueLength;
+        // Hand the slot back to the producer only after the handler is done with it
+        __atomic_store_n(&tail, currentTail, __ATOMIC_RELEASE);
+        dispatched++;
+    }
+    return dispatched;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file URCDispatcher.h
+ * @brief Header file for the URCDispatcher class.
+ */
+
+#ifndef ARDUINO_CELLULAR_URC_DISPATCHER_H
+#define ARDUINO_CELLULAR_URC_DISPATCHER_H
+
+#include <Arduino.h>
+
+#ifndef ARDUINO_CELLULAR_URC_QUEUE_LENGTH
+/**
+ * Number of unsolicited result codes that can wait for dispatching.
+ */
+#define ARDUINO_CELLULAR_URC_QUEUE_LENGTH 8
+#endif
+
+/**
+ * @brief Callback invoked for an unsolicited result code.
+ * @param urc The complete URC line, e.g. "+CMTI: \"SM\",3". Valid only during the callback.
+ * @param context The user pointer passed when registering the handler.
+ */
+typedef void (*URCCallback)(const char * urc, void * context);
+
+/**
+ * @class URCDispatcher
+ * @brief Routes unsolicited result codes (URCs) from the modem to registered handlers.
+ *
+ * The code reading the modem stream calls accepts() for every received line and push()es
+ * the URCs into a single-producer single-consumer ring buffer. Neither call blocks or allocates,
+ * so lines can also be pushed from an interrupt. dispatch() later drains the ring buffer from
+ * the main context and invokes the handlers.
+ */
+class URCDispatcher {
+    public:
+        static constexpr size_t maxHandlers = 8; /**< Maximum number of registered handlers. */
+        static constexpr size_t queueLength = ARDUINO_CELLULAR_URC_QUEUE_LENGTH; /**< Capacity of the ring buffer. */
+        static constexpr size_t maxURCLength = 96; /**< Maximum length of a queued URC, longer ones are truncated. */
+
+        /**
+         * @brief Registers a handler for the URCs starting with the given prefix.
+         * @param prefix The URC prefix including the colon, e.g. "+CMTI:". Must stay valid.
+         * @param callback The function to call.
+         * @param context A user pointer passed to the callback.
+         * @return True if the handler was registered, false if the handler table is full.
+         */
+        bool on(const char * prefix, URCCallback callback, void * context = nullptr);
+
+        /**
+         * @brief Checks whether a received line is a URC with a registered handler.
+         * A line that starts like the response of the running command (e.g. "+CUSD:" while "+CUSD=..." runs)
+         * is considered part of the response.
+         * @param line The received line.
+         * @param runningCommand The command waiting for its response without "AT", or nullptr if none.
+         * @return True if the line should be pushed instead of being treated as a response.
+         */
+        bool accepts(const char * line, const char * runningCommand = nullptr) const;
+
+        /**
+         * @brief Queues a URC for dispatching. Lock-free and safe to call from an interrupt.
+         * @param urc The URC line.
+         * @return True if the URC was queued, false if the ring buffer is full.
+         */
+        bool push(const char * urc);
+
+        /**
+         * @brief Invokes the handlers of all queued URCs. Must be called from the main context.
+         * @return The number of dispatched URCs.
+         */
+        size_t dispatch();
+
+        /**
+         * @brief Gets the number of URCs lost because the ring buffer was full.
+         * @return The number of dropped URCs.
+         */
+        uint32_t getDroppedCount() const { return dropped; }
+
+    private:
+        struct Handler {
+            const char * prefix;
+            URCCallback callback;
+            void * context;
+        };
+
+        const Handler * findHandler(const char * line) const;
+
+        Handler handlers[maxHandlers];
+        size_t handlerCount = 0;
+
+        char queue[queueLength][maxURCLength + 1];
+        volatile uint8_t head = 0; /**< Next slot written by the producer. */
+        volatile uint8_t tail = 0; /**< Next slot read by the consumer. */
+        volatile uint32_t dropped = 0;
+};
+
+#endif